@@ -24,6 +24,7 @@
 
 #include "relay.h"
 #include "dispatcher.h"
+#include "queue.h"
 #include "server.h"
 #include "aggregator.h"
 #include "collector.h"
@@ -56,6 +57,8 @@ collector_runner(void *s)
 	size_t stalls;
 	size_t dropped;
 	size_t sleeps;
+	size_t p50;
+	size_t p99;
 	time_t now;
 	time_t nextcycle;
 	char destbuf[1024];  /* sort of POSIX_MAX_PATH */
@@ -73,6 +76,18 @@ collector_runner(void *s)
 	size_t (*s_metrics)(server *) = NULL;
 	size_t (*s_stalls)(server *) = NULL;
 	size_t (*s_dropped)(server *) = NULL;
+	size_t (*s_spilled)(server *) = NULL;
+	size_t (*s_replayed)(server *) = NULL;
+	size_t (*s_datagrams)(server *) = NULL;
+	size_t (*s_senderrors)(server *) = NULL;
+	size_t (*s_sslfull)(server *) = NULL;
+	size_t (*s_sslresumed)(server *) = NULL;
+	size_t (*s_ktls)(server *) = NULL;
+	size_t (*s_stolen)(server *) = NULL;
+	size_t (*s_breakeropens)(server *) = NULL;
+	size_t (*s_breakerprobes)(server *) = NULL;
+	size_t (*s_expired)(server *) = NULL;
+	size_t (*s_stallticks)(server *) = NULL;
 	size_t (*d_ticks)(dispatcher *) = NULL;
 	size_t (*d_metrics)(dispatcher *) = NULL;
 	size_t (*d_blackholes)(dispatcher *) = NULL;
@@ -118,6 +133,18 @@ collector_runner(void *s)
 				s_metrics = server_get_metrics_sub;
 				s_stalls = server_get_stalls_sub;
 				s_dropped = server_get_dropped_sub;
+				s_spilled = server_get_spilled_sub;
+				s_replayed = server_get_replayed_sub;
+				s_datagrams = server_get_datagrams_sub;
+				s_senderrors = server_get_senderrors_sub;
+				s_sslfull = server_get_sslfull_sub;
+				s_sslresumed = server_get_sslresumed_sub;
+				s_ktls = server_get_ktls_sub;
+				s_stolen = server_get_stolen_sub;
+				s_breakeropens = server_get_breakeropens_sub;
+				s_breakerprobes = server_get_breakerprobes_sub;
+				s_expired = server_get_expired_sub;
+				s_stallticks = server_get_stallticks_sub;
 				d_ticks = dispatch_get_ticks_sub;
 				d_metrics = dispatch_get_metrics_sub;
 				d_blackholes = dispatch_get_blackholes_sub;
@@ -131,6 +158,18 @@ collector_runner(void *s)
 				s_metrics = server_get_metrics;
 				s_stalls = server_get_stalls;
 				s_dropped = server_get_dropped;
+				s_spilled = server_get_spilled;
+				s_replayed = server_get_replayed;
+				s_datagrams = server_get_datagrams;
+				s_senderrors = server_get_senderrors;
+				s_sslfull = server_get_sslfull;
+				s_sslresumed = server_get_sslresumed;
+				s_ktls = server_get_ktls;
+				s_stolen = server_get_stolen;
+				s_breakeropens = server_get_breakeropens;
+				s_breakerprobes = server_get_breakerprobes;
+				s_expired = server_get_expired;
+				s_stallticks = server_get_stallticks;
 				d_ticks = dispatch_get_ticks;
 				d_metrics = dispatch_get_metrics;
 				d_blackholes = dispatch_get_blackholes;
@@ -200,13 +239,16 @@ collector_runner(void *s)
 				totsleeps, (size_t)now);
 		send(metric);
 
-#define send_server_metrics(ipbuf, ticks, metrics, queued, stalls, dropped) \
+#define send_server_metrics(ipbuf, ticks, metrics, queued, qbytes, stalls, dropped) \
 			snprintf(m, sizem, "destinations.%s.sent %zu %zu\n", \
 					ipbuf, metrics, (size_t)now); \
 			send(metric); \
 			snprintf(m, sizem, "destinations.%s.queued %zu %zu\n", \
 					ipbuf, queued, (size_t)now); \
 			send(metric); \
+			snprintf(m, sizem, "destinations.%s.queuedBytes %zu %zu\n", \
+					ipbuf, qbytes, (size_t)now); \
+			send(metric); \
 			snprintf(m, sizem, "destinations.%s.stalls %zu %zu\n", \
 					ipbuf, stalls, (size_t)now); \
 			send(metric); \
@@ -231,7 +273,8 @@ collector_runner(void *s)
 		stalls = s_stalls(submission);
 		dropped = s_dropped(submission);
 		send_server_metrics(server_ip(submission),
-				ticks, metrics, queued, stalls, dropped);
+				ticks, metrics, queued, server_get_queue_bytes(submission),
+				stalls, dropped);
 
 		for (i = 0; srvs[i] != NULL; i++) {
 			switch (server_ctype(srvs[i])) {
@@ -261,7 +304,81 @@ collector_runner(void *s)
 			totstalls += stalls = s_stalls(srvs[i]);
 			totdropped += dropped = s_dropped(srvs[i]);
 			send_server_metrics(destbuf,
-					ticks, metrics, queued, stalls, dropped);
+					ticks, metrics, queued, server_get_queue_bytes(srvs[i]),
+					stalls, dropped);
+			snprintf(m, sizem, "destinations.%s.stallTime %zu %zu\n",
+					destbuf, s_stallticks(srvs[i]), (size_t)now);
+			send(metric);
+			server_get_latency(srvs[i], &p50, &p99);
+			snprintf(m, sizem, "destinations.%s.latencyP50 %zu %zu\n",
+					destbuf, p50, (size_t)now);
+			send(metric);
+			snprintf(m, sizem, "destinations.%s.latencyP99 %zu %zu\n",
+					destbuf, p99, (size_t)now);
+			send(metric);
+			if (server_has_lanes(srvs[i])) {
+				snprintf(m, sizem, "destinations.%s.connections %zu %zu\n",
+						destbuf, server_get_conns(srvs[i]), (size_t)now);
+				send(metric);
+			}
+			if (server_has_steal(srvs[i])) {
+				snprintf(m, sizem, "destinations.%s.stolen %zu %zu\n",
+						destbuf, s_stolen(srvs[i]), (size_t)now);
+				send(metric);
+			}
+			if (server_has_expire(srvs[i])) {
+				snprintf(m, sizem, "destinations.%s.expired %zu %zu\n",
+						destbuf, s_expired(srvs[i]), (size_t)now);
+				send(metric);
+			}
+			if (server_ctype(srvs[i]) == CON_TCP) {
+				snprintf(m, sizem, "destinations.%s.breakerState %d %zu\n",
+						destbuf, server_get_breaker(srvs[i]), (size_t)now);
+				send(metric);
+				snprintf(m, sizem, "destinations.%s.breakerOpens %zu %zu\n",
+						destbuf, s_breakeropens(srvs[i]), (size_t)now);
+				send(metric);
+				snprintf(m, sizem, "destinations.%s.breakerProbes %zu %zu\n",
+						destbuf, s_breakerprobes(srvs[i]), (size_t)now);
+				send(metric);
+			}
+			if (server_ctype(srvs[i]) == CON_UDP) {
+				snprintf(m, sizem, "destinations.%s.datagrams %zu %zu\n",
+						destbuf, s_datagrams(srvs[i]), (size_t)now);
+				send(metric);
+				snprintf(m, sizem, "destinations.%s.sendErrors %zu %zu\n",
+						destbuf, s_senderrors(srvs[i]), (size_t)now);
+				send(metric);
+			}
+			if (server_transport(srvs[i]) & W_SSL) {
+				snprintf(m, sizem, "destinations.%s.sslFullHandshakes "
+						"%zu %zu\n",
+						destbuf, s_sslfull(srvs[i]), (size_t)now);
+				send(metric);
+				snprintf(m, sizem, "destinations.%s.sslResumedHandshakes "
+						"%zu %zu\n",
+						destbuf, s_sslresumed(srvs[i]), (size_t)now);
+				send(metric);
+#ifdef HAVE_SSL
+				if (sslktls) {
+					snprintf(m, sizem, "destinations.%s.ktlsOffloaded "
+							"%zu %zu\n",
+							destbuf, s_ktls(srvs[i]), (size_t)now);
+					send(metric);
+				}
+#endif
+			}
+			if (server_has_spool(srvs[i])) {
+				snprintf(m, sizem, "destinations.%s.spilledBytes %zu %zu\n",
+						destbuf, s_spilled(srvs[i]), (size_t)now);
+				send(metric);
+				snprintf(m, sizem, "destinations.%s.replayedBytes %zu %zu\n",
+						destbuf, s_replayed(srvs[i]), (size_t)now);
+				send(metric);
+				snprintf(m, sizem, "destinations.%s.spoolAge %zu %zu\n",
+						destbuf, server_get_spool_age(srvs[i]), (size_t)now);
+				send(metric);
+			}
 		}
 
 		snprintf(m, sizem, "metricsSent %zu %zu\n",
@@ -270,6 +387,9 @@ collector_runner(void *s)
 		snprintf(m, sizem, "metricsQueued %zu %zu\n",
 				totqueued, (size_t)now);
 		send(metric);
+		snprintf(m, sizem, "metricsQueuedBytes %zu %zu\n",
+				queue_totbytes(), (size_t)now);
+		send(metric);
 		snprintf(m, sizem, "metricStalls %zu %zu\n",
 				totstalls, (size_t)now);
 		send(metric);
@@ -285,6 +405,13 @@ collector_runner(void *s)
 		snprintf(m, sizem, "disconnects %zu %zu\n",
 				dispatch_get_closed_connections(), (size_t)now);
 		send(metric);
+#ifdef HAVE_SSL
+		if (sslktls) {
+			snprintf(m, sizem, "ktlsConnections %zu %zu\n",
+					dispatch_get_ktls_connections(), (size_t)now);
+			send(metric);
+		}
+#endif
 
 		if (numaggregators > 0) {
 			snprintf(m, sizem, "aggregators.metricsReceived %zu %zu\n",
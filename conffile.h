@@ -50,6 +50,22 @@ typedef struct _servers {
 	struct _servers *next;
 } servers;
 
+typedef struct _ratelimit {
+	size_t metrics;   /* per second */
+	size_t bytes;     /* per second, 0 for unlimited */
+	size_t burst;     /* metrics sent in one go, 0 for a second's worth */
+	size_t catchup;   /* rate used while more than above are queued */
+	size_t above;
+} ratelimit;
+
+typedef struct _filesink {
+	size_t buffer;    /* bytes per write buffer, 0 for unbuffered */
+	unsigned char dbl:1;  /* write full buffers from a writer thread */
+	int sync;         /* seconds between syncs, -1 after writes, 0 never */
+	int rotatesecs;   /* start a new file every so many seconds */
+	size_t rotatebytes;  /* start a new file when this big */
+} filesink;
+
 typedef struct {
 	unsigned char repl_factor;
 	ch_ring *ring;
@@ -62,15 +78,36 @@ typedef struct {
 	servers *list;
 } serverlist;
 
+#define VAL_NUMERIC    (1 << 0)  /* value is a number */
+#define VAL_FINITE     (1 << 1)  /* value is a number, but not inf or nan */
+#define VAL_TIMESTAMP  (1 << 2)  /* timestamp is an integer */
+#define VAL_TSDRIFT    (1 << 3)  /* timestamp is within tsdrift from now */
+
 typedef struct _validate {
-	struct _route *rule;
+	struct _route *rule;     /* regex on the data, NULL for builtin checks */
+	unsigned char checks;    /* builtin VAL_* checks to perform */
+	unsigned int tsdrift;    /* seconds the timestamp may be off from now */
 	enum { VAL_LOG, VAL_DROP } action;
 } validate;
 
+typedef struct _routeprof {
+	size_t evals;     /* number of times the rule was tried */
+	size_t matches;   /* number of times the rule (or cluster) matched */
+	size_t nsec;      /* time spent in matching */
+	char pad[64 - 3 * sizeof(size_t)];  /* one cacheline per worker */
+} routeprof;
+
 typedef struct _cluster {
 	char *name;
 	enum clusttype type;
 	unsigned char isdynamic:1;
+	unsigned char steal:1;    /* any_of members take over work */
+	unsigned char balanced:1; /* any_of picks the lighter of two */
+	ratelimit *rate;  /* pace sending to the members, or NULL */
+	int expire;       /* seconds metrics may stay queued, 0 for ever */
+	unsigned char nostall:1;  /* drop instead of stalling clients */
+	filesink *file;   /* how to write, only for file clusters */
+	routeprof *prof;  /* per worker counters, only set when profiling */
 	union {
 		chashring *ch;
 		servers *forward;
@@ -104,6 +141,7 @@ typedef struct _route {
 		ENDS_WITH,    /* metric must end with string */
 		MATCHES       /* metric matches string exactly */
 	} matchtype;      /* how to interpret the pattern */
+	routeprof *prof;  /* per worker counters, only set when profiling */
 	struct _route *next;
 } route;
 
@@ -146,151 +146,186 @@ enum yysymbol_kind_t
   YYSYMBOL_crDYNAMIC = 13,                 /* crDYNAMIC  */
   YYSYMBOL_crPROTO = 14,                   /* crPROTO  */
   YYSYMBOL_crUSEALL = 15,                  /* crUSEALL  */
-  YYSYMBOL_crUDP = 16,                     /* crUDP  */
-  YYSYMBOL_crTCP = 17,                     /* crTCP  */
-  YYSYMBOL_crMATCH = 18,                   /* crMATCH  */
-  YYSYMBOL_crVALIDATE = 19,                /* crVALIDATE  */
-  YYSYMBOL_crELSE = 20,                    /* crELSE  */
-  YYSYMBOL_crLOG = 21,                     /* crLOG  */
-  YYSYMBOL_crDROP = 22,                    /* crDROP  */
-  YYSYMBOL_crROUTE = 23,                   /* crROUTE  */
-  YYSYMBOL_crUSING = 24,                   /* crUSING  */
-  YYSYMBOL_crSEND = 25,                    /* crSEND  */
-  YYSYMBOL_crTO = 26,                      /* crTO  */
-  YYSYMBOL_crBLACKHOLE = 27,               /* crBLACKHOLE  */
-  YYSYMBOL_crSTOP = 28,                    /* crSTOP  */
-  YYSYMBOL_crREWRITE = 29,                 /* crREWRITE  */
-  YYSYMBOL_crINTO = 30,                    /* crINTO  */
-  YYSYMBOL_crAGGREGATE = 31,               /* crAGGREGATE  */
-  YYSYMBOL_crEVERY = 32,                   /* crEVERY  */
-  YYSYMBOL_crSECONDS = 33,                 /* crSECONDS  */
-  YYSYMBOL_crEXPIRE = 34,                  /* crEXPIRE  */
-  YYSYMBOL_crAFTER = 35,                   /* crAFTER  */
-  YYSYMBOL_crTIMESTAMP = 36,               /* crTIMESTAMP  */
-  YYSYMBOL_crAT = 37,                      /* crAT  */
-  YYSYMBOL_crSTART = 38,                   /* crSTART  */
-  YYSYMBOL_crMIDDLE = 39,                  /* crMIDDLE  */
-  YYSYMBOL_crEND = 40,                     /* crEND  */
-  YYSYMBOL_crOF = 41,                      /* crOF  */
-  YYSYMBOL_crBUCKET = 42,                  /* crBUCKET  */
-  YYSYMBOL_crCOMPUTE = 43,                 /* crCOMPUTE  */
-  YYSYMBOL_crSUM = 44,                     /* crSUM  */
-  YYSYMBOL_crCOUNT = 45,                   /* crCOUNT  */
-  YYSYMBOL_crMAX = 46,                     /* crMAX  */
-  YYSYMBOL_crMIN = 47,                     /* crMIN  */
-  YYSYMBOL_crAVERAGE = 48,                 /* crAVERAGE  */
-  YYSYMBOL_crMEDIAN = 49,                  /* crMEDIAN  */
-  YYSYMBOL_crVARIANCE = 50,                /* crVARIANCE  */
-  YYSYMBOL_crSTDDEV = 51,                  /* crSTDDEV  */
-  YYSYMBOL_crPERCENTILE = 52,              /* crPERCENTILE  */
-  YYSYMBOL_crWRITE = 53,                   /* crWRITE  */
-  YYSYMBOL_crSTATISTICS = 54,              /* crSTATISTICS  */
-  YYSYMBOL_crSUBMIT = 55,                  /* crSUBMIT  */
-  YYSYMBOL_crRESET = 56,                   /* crRESET  */
-  YYSYMBOL_crCOUNTERS = 57,                /* crCOUNTERS  */
-  YYSYMBOL_crINTERVAL = 58,                /* crINTERVAL  */
-  YYSYMBOL_crPREFIX = 59,                  /* crPREFIX  */
-  YYSYMBOL_crWITH = 60,                    /* crWITH  */
-  YYSYMBOL_crLISTEN = 61,                  /* crLISTEN  */
-  YYSYMBOL_crTYPE = 62,                    /* crTYPE  */
-  YYSYMBOL_crLINEMODE = 63,                /* crLINEMODE  */
-  YYSYMBOL_crSYSLOGMODE = 64,              /* crSYSLOGMODE  */
-  YYSYMBOL_crTRANSPORT = 65,               /* crTRANSPORT  */
-  YYSYMBOL_crPLAIN = 66,                   /* crPLAIN  */
-  YYSYMBOL_crGZIP = 67,                    /* crGZIP  */
-  YYSYMBOL_crLZ4 = 68,                     /* crLZ4  */
-  YYSYMBOL_crSNAPPY = 69,                  /* crSNAPPY  */
-  YYSYMBOL_crSSL = 70,                     /* crSSL  */
-  YYSYMBOL_crMTLS = 71,                    /* crMTLS  */
-  YYSYMBOL_crUNIX = 72,                    /* crUNIX  */
-  YYSYMBOL_crPROTOMIN = 73,                /* crPROTOMIN  */
-  YYSYMBOL_crPROTOMAX = 74,                /* crPROTOMAX  */
-  YYSYMBOL_crSSL3 = 75,                    /* crSSL3  */
-  YYSYMBOL_crTLS1_0 = 76,                  /* crTLS1_0  */
-  YYSYMBOL_crTLS1_1 = 77,                  /* crTLS1_1  */
-  YYSYMBOL_crTLS1_2 = 78,                  /* crTLS1_2  */
-  YYSYMBOL_crTLS1_3 = 79,                  /* crTLS1_3  */
-  YYSYMBOL_crCIPHERS = 80,                 /* crCIPHERS  */
-  YYSYMBOL_crCIPHERSUITES = 81,            /* crCIPHERSUITES  */
-  YYSYMBOL_crINCLUDE = 82,                 /* crINCLUDE  */
-  YYSYMBOL_crCOMMENT = 83,                 /* crCOMMENT  */
-  YYSYMBOL_crSTRING = 84,                  /* crSTRING  */
-  YYSYMBOL_crUNEXPECTED = 85,              /* crUNEXPECTED  */
-  YYSYMBOL_crINTVAL = 86,                  /* crINTVAL  */
-  YYSYMBOL_87_ = 87,                       /* ';'  */
-  YYSYMBOL_88_ = 88,                       /* '='  */
-  YYSYMBOL_89_ = 89,                       /* '*'  */
-  YYSYMBOL_YYACCEPT = 90,                  /* $accept  */
-  YYSYMBOL_stmts = 91,                     /* stmts  */
-  YYSYMBOL_opt_stmt = 92,                  /* opt_stmt  */
-  YYSYMBOL_stmt = 93,                      /* stmt  */
-  YYSYMBOL_command = 94,                   /* command  */
-  YYSYMBOL_cluster = 95,                   /* cluster  */
-  YYSYMBOL_cluster_type = 96,              /* cluster_type  */
-  YYSYMBOL_cluster_useall = 97,            /* cluster_useall  */
-  YYSYMBOL_cluster_opt_useall = 98,        /* cluster_opt_useall  */
-  YYSYMBOL_cluster_ch = 99,                /* cluster_ch  */
-  YYSYMBOL_cluster_opt_repl = 100,         /* cluster_opt_repl  */
-  YYSYMBOL_cluster_opt_dynamic = 101,      /* cluster_opt_dynamic  */
-  YYSYMBOL_cluster_file = 102,             /* cluster_file  */
-  YYSYMBOL_cluster_paths = 103,            /* cluster_paths  */
-  YYSYMBOL_cluster_opt_path = 104,         /* cluster_opt_path  */
-  YYSYMBOL_cluster_path = 105,             /* cluster_path  */
-  YYSYMBOL_cluster_hosts = 106,            /* cluster_hosts  */
-  YYSYMBOL_cluster_opt_host = 107,         /* cluster_opt_host  */
-  YYSYMBOL_cluster_host = 108,             /* cluster_host  */
-  YYSYMBOL_cluster_opt_instance = 109,     /* cluster_opt_instance  */
-  YYSYMBOL_cluster_opt_proto = 110,        /* cluster_opt_proto  */
-  YYSYMBOL_cluster_opt_type = 111,         /* cluster_opt_type  */
-  YYSYMBOL_cluster_opt_transport = 112,    /* cluster_opt_transport  */
-  YYSYMBOL_cluster_transport_trans = 113,  /* cluster_transport_trans  */
-  YYSYMBOL_cluster_transport_opt_ssl = 114, /* cluster_transport_opt_ssl  */
-  YYSYMBOL_match = 115,                    /* match  */
-  YYSYMBOL_match_exprs = 116,              /* match_exprs  */
-  YYSYMBOL_match_exprs2 = 117,             /* match_exprs2  */
-  YYSYMBOL_match_opt_expr = 118,           /* match_opt_expr  */
-  YYSYMBOL_match_expr = 119,               /* match_expr  */
-  YYSYMBOL_match_opt_validate = 120,       /* match_opt_validate  */
-  YYSYMBOL_match_log_or_drop = 121,        /* match_log_or_drop  */
-  YYSYMBOL_match_opt_route = 122,          /* match_opt_route  */
-  YYSYMBOL_match_opt_send_to = 123,        /* match_opt_send_to  */
-  YYSYMBOL_match_send_to = 124,            /* match_send_to  */
-  YYSYMBOL_match_dsts = 125,               /* match_dsts  */
-  YYSYMBOL_match_dsts2 = 126,              /* match_dsts2  */
-  YYSYMBOL_match_opt_dst = 127,            /* match_opt_dst  */
-  YYSYMBOL_match_dst = 128,                /* match_dst  */
-  YYSYMBOL_match_opt_stop = 129,           /* match_opt_stop  */
-  YYSYMBOL_rewrite = 130,                  /* rewrite  */
-  YYSYMBOL_aggregate = 131,                /* aggregate  */
-  YYSYMBOL_aggregate_opt_timestamp = 132,  /* aggregate_opt_timestamp  */
-  YYSYMBOL_aggregate_ts_when = 133,        /* aggregate_ts_when  */
-  YYSYMBOL_aggregate_computes = 134,       /* aggregate_computes  */
-  YYSYMBOL_aggregate_opt_compute = 135,    /* aggregate_opt_compute  */
-  YYSYMBOL_aggregate_compute = 136,        /* aggregate_compute  */
-  YYSYMBOL_aggregate_comp_type = 137,      /* aggregate_comp_type  */
-  YYSYMBOL_aggregate_opt_send_to = 138,    /* aggregate_opt_send_to  */
-  YYSYMBOL_send = 139,                     /* send  */
-  YYSYMBOL_statistics = 140,               /* statistics  */
-  YYSYMBOL_statistics_opt_interval = 141,  /* statistics_opt_interval  */
-  YYSYMBOL_statistics_opt_counters = 142,  /* statistics_opt_counters  */
-  YYSYMBOL_statistics_opt_prefix = 143,    /* statistics_opt_prefix  */
-  YYSYMBOL_listen = 144,                   /* listen  */
-  YYSYMBOL_listener = 145,                 /* listener  */
-  YYSYMBOL_transport_ssl_or_mtls = 146,    /* transport_ssl_or_mtls  */
-  YYSYMBOL_transport_opt_ssl = 147,        /* transport_opt_ssl  */
-  YYSYMBOL_transport_opt_ssl_protos = 148, /* transport_opt_ssl_protos  */
-  YYSYMBOL_transport_ssl_proto = 149,      /* transport_ssl_proto  */
-  YYSYMBOL_transport_ssl_prototype = 150,  /* transport_ssl_prototype  */
-  YYSYMBOL_transport_ssl_protover = 151,   /* transport_ssl_protover  */
-  YYSYMBOL_transport_opt_ssl_ciphers = 152, /* transport_opt_ssl_ciphers  */
-  YYSYMBOL_transport_opt_ssl_ciphersuites = 153, /* transport_opt_ssl_ciphersuites  */
-  YYSYMBOL_transport_mode_trans = 154,     /* transport_mode_trans  */
-  YYSYMBOL_transport_mode = 155,           /* transport_mode  */
-  YYSYMBOL_receptors = 156,                /* receptors  */
-  YYSYMBOL_opt_receptor = 157,             /* opt_receptor  */
-  YYSYMBOL_receptor = 158,                 /* receptor  */
-  YYSYMBOL_rcptr_proto = 159,              /* rcptr_proto  */
-  YYSYMBOL_include = 160                   /* include  */
+  YYSYMBOL_crSTEAL = 16,                   /* crSTEAL  */
+  YYSYMBOL_crBALANCED = 17,                /* crBALANCED  */
+  YYSYMBOL_crRATE = 18,                    /* crRATE  */
+  YYSYMBOL_crBYTES = 19,                   /* crBYTES  */
+  YYSYMBOL_crBURST = 20,                   /* crBURST  */
+  YYSYMBOL_crCATCHUP = 21,                 /* crCATCHUP  */
+  YYSYMBOL_crABOVE = 22,                   /* crABOVE  */
+  YYSYMBOL_crNOSTALL = 23,                 /* crNOSTALL  */
+  YYSYMBOL_crUDP = 24,                     /* crUDP  */
+  YYSYMBOL_crTCP = 25,                     /* crTCP  */
+  YYSYMBOL_crBUFFER = 26,                  /* crBUFFER  */
+  YYSYMBOL_crDOUBLE = 27,                  /* crDOUBLE  */
+  YYSYMBOL_crSYNC = 28,                    /* crSYNC  */
+  YYSYMBOL_crALWAYS = 29,                  /* crALWAYS  */
+  YYSYMBOL_crROTATE = 30,                  /* crROTATE  */
+  YYSYMBOL_crMATCH = 31,                   /* crMATCH  */
+  YYSYMBOL_crVALIDATE = 32,                /* crVALIDATE  */
+  YYSYMBOL_crELSE = 33,                    /* crELSE  */
+  YYSYMBOL_crLOG = 34,                     /* crLOG  */
+  YYSYMBOL_crDROP = 35,                    /* crDROP  */
+  YYSYMBOL_crROUTE = 36,                   /* crROUTE  */
+  YYSYMBOL_crUSING = 37,                   /* crUSING  */
+  YYSYMBOL_crSEND = 38,                    /* crSEND  */
+  YYSYMBOL_crTO = 39,                      /* crTO  */
+  YYSYMBOL_crBLACKHOLE = 40,               /* crBLACKHOLE  */
+  YYSYMBOL_crSTOP = 41,                    /* crSTOP  */
+  YYSYMBOL_crNUMERIC = 42,                 /* crNUMERIC  */
+  YYSYMBOL_crFINITE = 43,                  /* crFINITE  */
+  YYSYMBOL_crWITHIN = 44,                  /* crWITHIN  */
+  YYSYMBOL_crREWRITE = 45,                 /* crREWRITE  */
+  YYSYMBOL_crINTO = 46,                    /* crINTO  */
+  YYSYMBOL_crAGGREGATE = 47,               /* crAGGREGATE  */
+  YYSYMBOL_crEVERY = 48,                   /* crEVERY  */
+  YYSYMBOL_crSECONDS = 49,                 /* crSECONDS  */
+  YYSYMBOL_crEXPIRE = 50,                  /* crEXPIRE  */
+  YYSYMBOL_crAFTER = 51,                   /* crAFTER  */
+  YYSYMBOL_crTIMESTAMP = 52,               /* crTIMESTAMP  */
+  YYSYMBOL_crAT = 53,                      /* crAT  */
+  YYSYMBOL_crSTART = 54,                   /* crSTART  */
+  YYSYMBOL_crMIDDLE = 55,                  /* crMIDDLE  */
+  YYSYMBOL_crEND = 56,                     /* crEND  */
+  YYSYMBOL_crOF = 57,                      /* crOF  */
+  YYSYMBOL_crBUCKET = 58,                  /* crBUCKET  */
+  YYSYMBOL_crCOMPUTE = 59,                 /* crCOMPUTE  */
+  YYSYMBOL_crSUM = 60,                     /* crSUM  */
+  YYSYMBOL_crCOUNT = 61,                   /* crCOUNT  */
+  YYSYMBOL_crMAX = 62,                     /* crMAX  */
+  YYSYMBOL_crMIN = 63,                     /* crMIN  */
+  YYSYMBOL_crAVERAGE = 64,                 /* crAVERAGE  */
+  YYSYMBOL_crMEDIAN = 65,                  /* crMEDIAN  */
+  YYSYMBOL_crVARIANCE = 66,                /* crVARIANCE  */
+  YYSYMBOL_crSTDDEV = 67,                  /* crSTDDEV  */
+  YYSYMBOL_crPERCENTILE = 68,              /* crPERCENTILE  */
+  YYSYMBOL_crWRITE = 69,                   /* crWRITE  */
+  YYSYMBOL_crSTATISTICS = 70,              /* crSTATISTICS  */
+  YYSYMBOL_crSUBMIT = 71,                  /* crSUBMIT  */
+  YYSYMBOL_crRESET = 72,                   /* crRESET  */
+  YYSYMBOL_crCOUNTERS = 73,                /* crCOUNTERS  */
+  YYSYMBOL_crINTERVAL = 74,                /* crINTERVAL  */
+  YYSYMBOL_crPREFIX = 75,                  /* crPREFIX  */
+  YYSYMBOL_crWITH = 76,                    /* crWITH  */
+  YYSYMBOL_crLISTEN = 77,                  /* crLISTEN  */
+  YYSYMBOL_crTYPE = 78,                    /* crTYPE  */
+  YYSYMBOL_crLINEMODE = 79,                /* crLINEMODE  */
+  YYSYMBOL_crSYSLOGMODE = 80,              /* crSYSLOGMODE  */
+  YYSYMBOL_crPICKLE = 81,                  /* crPICKLE  */
+  YYSYMBOL_crTRANSPORT = 82,               /* crTRANSPORT  */
+  YYSYMBOL_crPLAIN = 83,                   /* crPLAIN  */
+  YYSYMBOL_crGZIP = 84,                    /* crGZIP  */
+  YYSYMBOL_crLZ4 = 85,                     /* crLZ4  */
+  YYSYMBOL_crSNAPPY = 86,                  /* crSNAPPY  */
+  YYSYMBOL_crZSTD = 87,                    /* crZSTD  */
+  YYSYMBOL_crSSL = 88,                     /* crSSL  */
+  YYSYMBOL_crMTLS = 89,                    /* crMTLS  */
+  YYSYMBOL_crUNIX = 90,                    /* crUNIX  */
+  YYSYMBOL_crPROTOMIN = 91,                /* crPROTOMIN  */
+  YYSYMBOL_crPROTOMAX = 92,                /* crPROTOMAX  */
+  YYSYMBOL_crSSL3 = 93,                    /* crSSL3  */
+  YYSYMBOL_crTLS1_0 = 94,                  /* crTLS1_0  */
+  YYSYMBOL_crTLS1_1 = 95,                  /* crTLS1_1  */
+  YYSYMBOL_crTLS1_2 = 96,                  /* crTLS1_2  */
+  YYSYMBOL_crTLS1_3 = 97,                  /* crTLS1_3  */
+  YYSYMBOL_crCIPHERS = 98,                 /* crCIPHERS  */
+  YYSYMBOL_crCIPHERSUITES = 99,            /* crCIPHERSUITES  */
+  YYSYMBOL_crINCLUDE = 100,                /* crINCLUDE  */
+  YYSYMBOL_crCOMMENT = 101,                /* crCOMMENT  */
+  YYSYMBOL_crSTRING = 102,                 /* crSTRING  */
+  YYSYMBOL_crUNEXPECTED = 103,             /* crUNEXPECTED  */
+  YYSYMBOL_crINTVAL = 104,                 /* crINTVAL  */
+  YYSYMBOL_105_ = 105,                     /* ';'  */
+  YYSYMBOL_106_ = 106,                     /* '='  */
+  YYSYMBOL_107_ = 107,                     /* '*'  */
+  YYSYMBOL_YYACCEPT = 108,                 /* $accept  */
+  YYSYMBOL_stmts = 109,                    /* stmts  */
+  YYSYMBOL_opt_stmt = 110,                 /* opt_stmt  */
+  YYSYMBOL_stmt = 111,                     /* stmt  */
+  YYSYMBOL_command = 112,                  /* command  */
+  YYSYMBOL_cluster = 113,                  /* cluster  */
+  YYSYMBOL_cluster_type = 114,             /* cluster_type  */
+  YYSYMBOL_cluster_useall = 115,           /* cluster_useall  */
+  YYSYMBOL_cluster_opt_useall = 116,       /* cluster_opt_useall  */
+  YYSYMBOL_cluster_opt_steal = 117,        /* cluster_opt_steal  */
+  YYSYMBOL_cluster_opt_balanced = 118,     /* cluster_opt_balanced  */
+  YYSYMBOL_cluster_ch = 119,               /* cluster_ch  */
+  YYSYMBOL_cluster_opt_repl = 120,         /* cluster_opt_repl  */
+  YYSYMBOL_cluster_opt_dynamic = 121,      /* cluster_opt_dynamic  */
+  YYSYMBOL_cluster_file = 122,             /* cluster_file  */
+  YYSYMBOL_cluster_opt_buffer = 123,       /* cluster_opt_buffer  */
+  YYSYMBOL_cluster_opt_double = 124,       /* cluster_opt_double  */
+  YYSYMBOL_cluster_opt_sync = 125,         /* cluster_opt_sync  */
+  YYSYMBOL_cluster_opt_rotate = 126,       /* cluster_opt_rotate  */
+  YYSYMBOL_cluster_opt_rotevery = 127,     /* cluster_opt_rotevery  */
+  YYSYMBOL_cluster_opt_rotat = 128,        /* cluster_opt_rotat  */
+  YYSYMBOL_cluster_paths = 129,            /* cluster_paths  */
+  YYSYMBOL_cluster_opt_path = 130,         /* cluster_opt_path  */
+  YYSYMBOL_cluster_path = 131,             /* cluster_path  */
+  YYSYMBOL_cluster_opt_rate = 132,         /* cluster_opt_rate  */
+  YYSYMBOL_cluster_opt_ratebytes = 133,    /* cluster_opt_ratebytes  */
+  YYSYMBOL_cluster_opt_burst = 134,        /* cluster_opt_burst  */
+  YYSYMBOL_cluster_opt_catchup = 135,      /* cluster_opt_catchup  */
+  YYSYMBOL_cluster_opt_expire = 136,       /* cluster_opt_expire  */
+  YYSYMBOL_cluster_opt_nostall = 137,      /* cluster_opt_nostall  */
+  YYSYMBOL_cluster_hosts = 138,            /* cluster_hosts  */
+  YYSYMBOL_cluster_opt_host = 139,         /* cluster_opt_host  */
+  YYSYMBOL_cluster_host = 140,             /* cluster_host  */
+  YYSYMBOL_cluster_opt_instance = 141,     /* cluster_opt_instance  */
+  YYSYMBOL_cluster_opt_proto = 142,        /* cluster_opt_proto  */
+  YYSYMBOL_cluster_opt_type = 143,         /* cluster_opt_type  */
+  YYSYMBOL_cluster_opt_transport = 144,    /* cluster_opt_transport  */
+  YYSYMBOL_cluster_transport_trans = 145,  /* cluster_transport_trans  */
+  YYSYMBOL_cluster_transport_opt_ssl = 146, /* cluster_transport_opt_ssl  */
+  YYSYMBOL_match = 147,                    /* match  */
+  YYSYMBOL_match_exprs = 148,              /* match_exprs  */
+  YYSYMBOL_match_exprs2 = 149,             /* match_exprs2  */
+  YYSYMBOL_match_opt_expr = 150,           /* match_opt_expr  */
+  YYSYMBOL_match_expr = 151,               /* match_expr  */
+  YYSYMBOL_match_opt_validate = 152,       /* match_opt_validate  */
+  YYSYMBOL_match_validators = 153,         /* match_validators  */
+  YYSYMBOL_match_validator = 154,          /* match_validator  */
+  YYSYMBOL_match_log_or_drop = 155,        /* match_log_or_drop  */
+  YYSYMBOL_match_opt_route = 156,          /* match_opt_route  */
+  YYSYMBOL_match_opt_send_to = 157,        /* match_opt_send_to  */
+  YYSYMBOL_match_send_to = 158,            /* match_send_to  */
+  YYSYMBOL_match_dsts = 159,               /* match_dsts  */
+  YYSYMBOL_match_dsts2 = 160,              /* match_dsts2  */
+  YYSYMBOL_match_opt_dst = 161,            /* match_opt_dst  */
+  YYSYMBOL_match_dst = 162,                /* match_dst  */
+  YYSYMBOL_match_opt_stop = 163,           /* match_opt_stop  */
+  YYSYMBOL_rewrite = 164,                  /* rewrite  */
+  YYSYMBOL_aggregate = 165,                /* aggregate  */
+  YYSYMBOL_aggregate_opt_timestamp = 166,  /* aggregate_opt_timestamp  */
+  YYSYMBOL_aggregate_ts_when = 167,        /* aggregate_ts_when  */
+  YYSYMBOL_aggregate_computes = 168,       /* aggregate_computes  */
+  YYSYMBOL_aggregate_opt_compute = 169,    /* aggregate_opt_compute  */
+  YYSYMBOL_aggregate_compute = 170,        /* aggregate_compute  */
+  YYSYMBOL_aggregate_comp_type = 171,      /* aggregate_comp_type  */
+  YYSYMBOL_aggregate_opt_send_to = 172,    /* aggregate_opt_send_to  */
+  YYSYMBOL_send = 173,                     /* send  */
+  YYSYMBOL_statistics = 174,               /* statistics  */
+  YYSYMBOL_statistics_opt_interval = 175,  /* statistics_opt_interval  */
+  YYSYMBOL_statistics_opt_counters = 176,  /* statistics_opt_counters  */
+  YYSYMBOL_statistics_opt_prefix = 177,    /* statistics_opt_prefix  */
+  YYSYMBOL_listen = 178,                   /* listen  */
+  YYSYMBOL_listener = 179,                 /* listener  */
+  YYSYMBOL_listener_type = 180,            /* listener_type  */
+  YYSYMBOL_transport_ssl_or_mtls = 181,    /* transport_ssl_or_mtls  */
+  YYSYMBOL_transport_opt_ssl = 182,        /* transport_opt_ssl  */
+  YYSYMBOL_transport_opt_ssl_protos = 183, /* transport_opt_ssl_protos  */
+  YYSYMBOL_transport_ssl_proto = 184,      /* transport_ssl_proto  */
+  YYSYMBOL_transport_ssl_prototype = 185,  /* transport_ssl_prototype  */
+  YYSYMBOL_transport_ssl_protover = 186,   /* transport_ssl_protover  */
+  YYSYMBOL_transport_opt_ssl_ciphers = 187, /* transport_opt_ssl_ciphers  */
+  YYSYMBOL_transport_opt_ssl_ciphersuites = 188, /* transport_opt_ssl_ciphersuites  */
+  YYSYMBOL_transport_mode_trans = 189,     /* transport_mode_trans  */
+  YYSYMBOL_transport_mode = 190,           /* transport_mode  */
+  YYSYMBOL_receptors = 191,                /* receptors  */
+  YYSYMBOL_opt_receptor = 192,             /* opt_receptor  */
+  YYSYMBOL_receptor = 193,                 /* receptor  */
+  YYSYMBOL_rcptr_proto = 194,              /* rcptr_proto  */
+  YYSYMBOL_include = 195                   /* include  */
 };
 typedef enum yysymbol_kind_t yysymbol_kind_t;
 
@@ -407,7 +442,7 @@ typedef int yytype_uint16;
 
 
 /* Stored state numbers (used for stacks). */
-typedef yytype_uint8 yy_state_t;
+typedef yytype_int16 yy_state_t;
 
 /* State numbers in computations.  */
 typedef int yy_state_fast_t;
@@ -621,19 +656,19 @@ union yyalloc
 /* YYFINAL -- State number of the termination state.  */
 #define YYFINAL  35
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   146
+#define YYLAST   203
 
 /* YYNTOKENS -- Number of terminals.  */
-#define YYNTOKENS  90
+#define YYNTOKENS  108
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  71
+#define YYNNTS  88
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  145
+#define YYNRULES  186
 /* YYNSTATES -- Number of states.  */
-#define YYNSTATES  214
+#define YYNSTATES  276
 
 /* YYMAXUTOK -- Last valid token kind.  */
-#define YYMAXUTOK   341
+#define YYMAXUTOK   359
 
 
 /* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
@@ -651,9 +686,9 @@ static const yytype_int8 yytranslate[] =
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-       2,     2,    89,     2,     2,     2,     2,     2,     2,     2,
-       2,     2,     2,     2,     2,     2,     2,     2,     2,    87,
-       2,    88,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,   107,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,   105,
+       2,   106,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -681,28 +716,33 @@ static const yytype_int8 yytranslate[] =
       55,    56,    57,    58,    59,    60,    61,    62,    63,    64,
       65,    66,    67,    68,    69,    70,    71,    72,    73,    74,
       75,    76,    77,    78,    79,    80,    81,    82,    83,    84,
-      85,    86
+      85,    86,    87,    88,    89,    90,    91,    92,    93,    94,
+      95,    96,    97,    98,    99,   100,   101,   102,   103,   104
 };
 
 #if ROUTER_YYDEBUG
 /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_int16 yyrline[] =
 {
-       0,   168,   168,   171,   172,   175,   178,   179,   180,   181,
-     182,   183,   184,   185,   189,   263,   304,   306,   310,   311,
-     312,   315,   316,   319,   320,   321,   324,   325,   328,   329,
-     332,   333,   336,   338,   339,   341,   361,   363,   364,   366,
-     388,   389,   390,   400,   401,   402,   405,   406,   407,   411,
-     422,   441,   442,   452,   462,   474,   485,   504,   527,   582,
-     594,   597,   599,   600,   603,   622,   623,   642,   643,   646,
-     647,   650,   651,   654,   657,   667,   670,   672,   673,   676,
-     692,   693,   698,   743,   834,   835,   840,   841,   842,   845,
-     849,   850,   852,   867,   868,   869,   870,   871,   872,   873,
-     883,   884,   887,   888,   893,   908,   933,   934,   945,   946,
-     949,   950,   955,   987,  1011,  1012,  1015,  1018,  1044,  1047,
-    1052,  1065,  1066,  1068,  1069,  1070,  1071,  1072,  1075,  1076,
-    1080,  1081,  1085,  1095,  1112,  1129,  1149,  1158,  1169,  1172,
-    1173,  1176,  1213,  1235,  1236,  1241
+       0,   193,   193,   196,   197,   200,   203,   204,   205,   206,
+     207,   208,   209,   210,   214,   308,   360,   363,   367,   368,
+     369,   372,   373,   376,   377,   380,   381,   384,   385,   386,
+     389,   390,   393,   394,   397,   398,   401,   402,   420,   421,
+     423,   424,   425,   436,   437,   449,   450,   462,   463,   475,
+     477,   478,   480,   500,   501,   516,   517,   528,   529,   541,
+     549,   565,   566,   577,   578,   581,   583,   584,   586,   621,
+     622,   623,   633,   634,   635,   638,   639,   640,   641,   645,
+     656,   675,   676,   686,   696,   706,   718,   729,   748,   771,
+     828,   840,   843,   845,   846,   849,   868,   869,   886,   901,
+     902,   909,   914,   919,   924,   936,   937,   940,   941,   944,
+     945,   948,   951,   961,   964,   966,   967,   970,   986,   987,
+     992,  1037,  1128,  1129,  1134,  1135,  1136,  1139,  1143,  1144,
+    1146,  1161,  1162,  1163,  1164,  1165,  1166,  1167,  1177,  1178,
+    1181,  1182,  1187,  1202,  1227,  1228,  1239,  1240,  1243,  1244,
+    1249,  1281,  1316,  1317,  1320,  1321,  1324,  1327,  1353,  1356,
+    1361,  1374,  1375,  1377,  1378,  1379,  1380,  1381,  1384,  1385,
+    1389,  1390,  1394,  1404,  1421,  1438,  1455,  1475,  1484,  1495,
+    1498,  1499,  1502,  1539,  1561,  1562,  1567
 };
 #endif
 
@@ -721,27 +761,36 @@ static const char *const yytname[] =
   "\"end of file\"", "error", "\"invalid token\"", "crCLUSTER",
   "crFORWARD", "crANY_OF", "crFAILOVER", "crCARBON_CH", "crFNV1A_CH",
   "crJUMP_FNV1A_CH", "crFILE", "crIP", "crREPLICATION", "crDYNAMIC",
-  "crPROTO", "crUSEALL", "crUDP", "crTCP", "crMATCH", "crVALIDATE",
-  "crELSE", "crLOG", "crDROP", "crROUTE", "crUSING", "crSEND", "crTO",
-  "crBLACKHOLE", "crSTOP", "crREWRITE", "crINTO", "crAGGREGATE", "crEVERY",
-  "crSECONDS", "crEXPIRE", "crAFTER", "crTIMESTAMP", "crAT", "crSTART",
-  "crMIDDLE", "crEND", "crOF", "crBUCKET", "crCOMPUTE", "crSUM", "crCOUNT",
-  "crMAX", "crMIN", "crAVERAGE", "crMEDIAN", "crVARIANCE", "crSTDDEV",
+  "crPROTO", "crUSEALL", "crSTEAL", "crBALANCED", "crRATE", "crBYTES",
+  "crBURST", "crCATCHUP", "crABOVE", "crNOSTALL", "crUDP", "crTCP",
+  "crBUFFER", "crDOUBLE", "crSYNC", "crALWAYS", "crROTATE", "crMATCH",
+  "crVALIDATE", "crELSE", "crLOG", "crDROP", "crROUTE", "crUSING",
+  "crSEND", "crTO", "crBLACKHOLE", "crSTOP", "crNUMERIC", "crFINITE",
+  "crWITHIN", "crREWRITE", "crINTO", "crAGGREGATE", "crEVERY", "crSECONDS",
+  "crEXPIRE", "crAFTER", "crTIMESTAMP", "crAT", "crSTART", "crMIDDLE",
+  "crEND", "crOF", "crBUCKET", "crCOMPUTE", "crSUM", "crCOUNT", "crMAX",
+  "crMIN", "crAVERAGE", "crMEDIAN", "crVARIANCE", "crSTDDEV",
   "crPERCENTILE", "crWRITE", "crSTATISTICS", "crSUBMIT", "crRESET",
   "crCOUNTERS", "crINTERVAL", "crPREFIX", "crWITH", "crLISTEN", "crTYPE",
-  "crLINEMODE", "crSYSLOGMODE", "crTRANSPORT", "crPLAIN", "crGZIP",
-  "crLZ4", "crSNAPPY", "crSSL", "crMTLS", "crUNIX", "crPROTOMIN",
-  "crPROTOMAX", "crSSL3", "crTLS1_0", "crTLS1_1", "crTLS1_2", "crTLS1_3",
-  "crCIPHERS", "crCIPHERSUITES", "crINCLUDE", "crCOMMENT", "crSTRING",
-  "crUNEXPECTED", "crINTVAL", "';'", "'='", "'*'", "$accept", "stmts",
-  "opt_stmt", "stmt", "command", "cluster", "cluster_type",
-  "cluster_useall", "cluster_opt_useall", "cluster_ch", "cluster_opt_repl",
-  "cluster_opt_dynamic", "cluster_file", "cluster_paths",
-  "cluster_opt_path", "cluster_path", "cluster_hosts", "cluster_opt_host",
-  "cluster_host", "cluster_opt_instance", "cluster_opt_proto",
-  "cluster_opt_type", "cluster_opt_transport", "cluster_transport_trans",
-  "cluster_transport_opt_ssl", "match", "match_exprs", "match_exprs2",
-  "match_opt_expr", "match_expr", "match_opt_validate",
+  "crLINEMODE", "crSYSLOGMODE", "crPICKLE", "crTRANSPORT", "crPLAIN",
+  "crGZIP", "crLZ4", "crSNAPPY", "crZSTD", "crSSL", "crMTLS", "crUNIX",
+  "crPROTOMIN", "crPROTOMAX", "crSSL3", "crTLS1_0", "crTLS1_1", "crTLS1_2",
+  "crTLS1_3", "crCIPHERS", "crCIPHERSUITES", "crINCLUDE", "crCOMMENT",
+  "crSTRING", "crUNEXPECTED", "crINTVAL", "';'", "'='", "'*'", "$accept",
+  "stmts", "opt_stmt", "stmt", "command", "cluster", "cluster_type",
+  "cluster_useall", "cluster_opt_useall", "cluster_opt_steal",
+  "cluster_opt_balanced", "cluster_ch", "cluster_opt_repl",
+  "cluster_opt_dynamic", "cluster_file", "cluster_opt_buffer",
+  "cluster_opt_double", "cluster_opt_sync", "cluster_opt_rotate",
+  "cluster_opt_rotevery", "cluster_opt_rotat", "cluster_paths",
+  "cluster_opt_path", "cluster_path", "cluster_opt_rate",
+  "cluster_opt_ratebytes", "cluster_opt_burst", "cluster_opt_catchup",
+  "cluster_opt_expire", "cluster_opt_nostall", "cluster_hosts",
+  "cluster_opt_host", "cluster_host", "cluster_opt_instance",
+  "cluster_opt_proto", "cluster_opt_type", "cluster_opt_transport",
+  "cluster_transport_trans", "cluster_transport_opt_ssl", "match",
+  "match_exprs", "match_exprs2", "match_opt_expr", "match_expr",
+  "match_opt_validate", "match_validators", "match_validator",
   "match_log_or_drop", "match_opt_route", "match_opt_send_to",
   "match_send_to", "match_dsts", "match_dsts2", "match_opt_dst",
   "match_dst", "match_opt_stop", "rewrite", "aggregate",
@@ -749,12 +798,12 @@ static const char *const yytname[] =
   "aggregate_opt_compute", "aggregate_compute", "aggregate_comp_type",
   "aggregate_opt_send_to", "send", "statistics", "statistics_opt_interval",
   "statistics_opt_counters", "statistics_opt_prefix", "listen", "listener",
-  "transport_ssl_or_mtls", "transport_opt_ssl", "transport_opt_ssl_protos",
-  "transport_ssl_proto", "transport_ssl_prototype",
-  "transport_ssl_protover", "transport_opt_ssl_ciphers",
-  "transport_opt_ssl_ciphersuites", "transport_mode_trans",
-  "transport_mode", "receptors", "opt_receptor", "receptor", "rcptr_proto",
-  "include", YY_NULLPTR
+  "listener_type", "transport_ssl_or_mtls", "transport_opt_ssl",
+  "transport_opt_ssl_protos", "transport_ssl_proto",
+  "transport_ssl_prototype", "transport_ssl_protover",
+  "transport_opt_ssl_ciphers", "transport_opt_ssl_ciphersuites",
+  "transport_mode_trans", "transport_mode", "receptors", "opt_receptor",
+  "receptor", "rcptr_proto", "include", YY_NULLPTR
 };
 
 static const char *
@@ -764,7 +813,7 @@ yysymbol_name (yysymbol_kind_t yysymbol)
 }
 #endif
 
-#define YYPACT_NINF (-101)
+#define YYPACT_NINF (-117)
 
 #define yypact_value_is_default(Yyn) \
   ((Yyn) == YYPACT_NINF)
@@ -776,30 +825,36 @@ yysymbol_name (yysymbol_kind_t yysymbol)
 
 /* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
    STATE-NUM.  */
-static const yytype_int8 yypact[] =
+static const yytype_int16 yypact[] =
 {
-      -2,   -56,   -82,   -28,   -22,   -15,    12,     6,   -13,    70,
-    -101,    -2,   -12,  -101,  -101,  -101,  -101,  -101,  -101,  -101,
-    -101,    35,  -101,  -101,    53,  -101,   -15,    47,    44,    45,
-      46,    20,    16,  -101,  -101,  -101,  -101,  -101,  -101,  -101,
-    -101,  -101,  -101,  -101,    71,    -3,    68,    72,     1,     2,
-      64,  -101,  -101,   -24,     4,     3,     5,    33,    34,    27,
-    -101,     7,  -101,    -3,  -101,  -101,     8,    83,  -101,  -101,
-       1,    77,    74,    75,  -101,  -101,    73,  -101,    15,  -101,
-      69,    76,    78,    43,    75,   -54,   -17,    22,   -62,    90,
-    -101,  -101,  -101,  -101,  -101,  -101,  -101,    29,    23,    82,
-      73,  -101,  -101,  -101,  -101,  -101,    80,  -101,    52,    28,
-    -101,    73,  -101,  -101,  -101,  -101,  -101,  -101,    31,  -101,
-      97,  -101,    22,  -101,  -101,    39,    54,  -101,  -101,  -101,
-    -101,   -24,  -101,    84,  -101,  -101,  -101,   -16,   -11,  -101,
-    -101,  -101,  -101,     0,    55,  -101,    32,  -101,  -101,    37,
-     -16,   -58,  -101,  -101,  -101,  -101,  -101,  -101,   -20,  -101,
-      -5,    88,    38,    42,  -101,  -101,  -101,  -101,  -101,  -101,
-    -101,  -101,  -101,  -101,  -101,  -101,    40,  -101,    89,  -101,
-      48,  -101,    49,    91,    86,  -101,  -101,   -30,   -14,    75,
-      86,  -101,  -101,  -101,    85,  -101,  -101,  -101,  -101,  -101,
-    -101,  -101,  -101,  -101,    81,    73,  -101,  -101,    93,   101,
-    -101,  -101,    56,  -101
+      -2,   -92,   -93,   -57,   -86,   -76,   -41,   -43,   -22,    86,
+    -117,    -2,   -18,  -117,  -117,  -117,  -117,  -117,  -117,  -117,
+    -117,    15,  -117,  -117,    56,  -117,   -76,    50,    44,    43,
+      45,    20,     0,  -117,  -117,  -117,  -117,  -117,  -117,  -117,
+    -117,  -117,  -117,  -117,    83,    -7,    81,    85,    -3,   -37,
+      64,  -117,  -117,   -38,    -1,     1,     3,    29,    31,  -117,
+    -117,    21,  -117,     4,    90,    -7,  -117,    88,     5,    98,
+    -117,    87,    -3,  -117,  -117,    68,    82,   -25,  -117,    77,
+      78,  -117,  -117,    76,  -117,    16,  -117,    70,    71,    72,
+      46,    78,   -46,   -33,    19,   -60,   110,    23,    75,  -117,
+    -117,  -117,   109,  -117,  -117,  -117,    24,   101,  -117,  -117,
+      26,    28,    28,  -117,    30,    92,    76,  -117,  -117,  -117,
+    -117,  -117,    84,  -117,    59,    33,  -117,    76,  -117,  -117,
+    -117,  -117,  -117,  -117,  -117,    34,  -117,   123,  -117,    19,
+    -117,  -117,    42,    60,   120,    89,   118,  -117,  -117,   115,
+     -17,   113,    95,  -117,  -117,  -117,  -117,  -117,   -38,  -117,
+      94,  -117,  -117,  -117,    -9,   -21,  -117,  -117,  -117,  -117,
+     -47,    65,    48,   126,    49,  -117,  -117,  -117,  -117,  -117,
+      51,   100,  -117,  -117,  -117,    52,  -117,  -117,    61,    -9,
+     -36,  -117,  -117,  -117,  -117,  -117,  -117,  -117,   -13,  -117,
+      -4,  -117,    53,   128,   105,   111,    54,    97,   112,    62,
+      63,  -117,  -117,  -117,  -117,  -117,  -117,  -117,  -117,  -117,
+    -117,  -117,  -117,  -117,    66,  -117,  -117,    67,  -117,  -117,
+    -117,   114,    69,  -117,   117,  -117,    73,  -117,    74,   143,
+    -117,   147,   119,   108,  -117,  -117,    79,  -117,    22,   -14,
+      78,   108,  -117,  -117,  -117,  -117,   121,  -117,  -117,  -117,
+    -117,  -117,  -117,  -117,  -117,  -117,   116,    76,  -117,  -117,
+     122,   131,  -117,  -117,    80,  -117
 };
 
 /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
@@ -807,163 +862,197 @@ static const yytype_int8 yypact[] =
    means the default is an error.  */
 static const yytype_uint8 yydefact[] =
 {
-       3,     0,     0,     0,     0,     0,   106,     0,     0,     0,
+       3,     0,     0,     0,     0,     0,   144,     0,     0,     0,
        2,     3,     0,     6,     7,     8,     9,    10,    11,    12,
-      13,     0,    64,    59,    65,    60,    62,     0,     0,     0,
-       0,   108,     0,   112,   145,     1,     4,     5,    18,    19,
-      20,    23,    24,    25,    31,     0,    21,    26,     0,     0,
-      69,    63,    61,     0,     0,     0,     0,     0,   110,   136,
-      30,    40,    14,    37,    22,    16,     0,    28,    35,    15,
-      33,     0,     0,    71,    74,    79,    80,    75,    77,    82,
-       0,     0,     0,     0,   102,     0,   116,     0,     0,    43,
-      38,    36,    27,    29,    17,    32,    34,     0,     0,     0,
-      80,    72,    81,   104,    78,    76,     0,   107,     0,     0,
-     103,    80,   132,   133,   134,   135,   114,   115,     0,   137,
-       0,   113,   139,    41,    42,     0,    46,    67,    68,    66,
-      70,     0,    58,     0,   109,   111,   105,   118,     0,   140,
-     138,    44,    45,     0,    49,    73,     0,   121,   122,   128,
-     118,     0,   144,   143,   142,   141,    47,    48,     0,    39,
-      55,     0,     0,   130,   119,   123,   124,   125,   126,   127,
-     120,    51,    52,    53,    54,    56,     0,    50,    84,   129,
-       0,   117,     0,     0,     0,   131,    57,     0,     0,   102,
-      90,    86,    87,    88,     0,    93,    94,    95,    96,    97,
-      98,   100,   101,    99,     0,    80,    91,    89,     0,     0,
-      83,    85,     0,    92
+      13,     0,    95,    90,    96,    91,    93,     0,     0,     0,
+       0,   146,     0,   150,   186,     1,     4,     5,    18,    19,
+      20,    27,    28,    29,    35,     0,    21,    30,     0,     0,
+     107,    94,    92,     0,     0,     0,     0,     0,   148,   152,
+     153,   177,    34,    69,    53,    66,    22,    23,     0,    32,
+      52,    36,    50,   101,   102,   103,     0,     0,    99,     0,
+     109,   112,   117,   118,   113,   115,   120,     0,     0,     0,
+       0,   140,     0,   156,     0,     0,    72,     0,    61,    67,
+      65,    24,    25,    31,    33,    17,     0,    40,    49,    51,
+       0,     0,     0,   100,     0,     0,   118,   110,   119,   142,
+     116,   114,     0,   145,     0,     0,   141,   118,   172,   173,
+     174,   175,   176,   154,   155,     0,   178,     0,   151,   180,
+      70,    71,     0,    75,    55,     0,    63,    26,    16,    38,
+       0,    43,     0,   105,   106,    97,    98,   108,     0,    89,
+       0,   147,   149,   143,   158,     0,   181,   179,    73,    74,
+       0,    79,     0,    57,     0,    64,    14,    39,    37,    41,
+       0,    45,    15,   104,   111,     0,   161,   162,   168,   158,
+       0,   185,   184,   183,   182,    76,    77,    78,     0,    68,
+      86,    56,     0,    59,     0,     0,     0,    47,     0,     0,
+     170,   159,   163,   164,   165,   166,   167,   160,    81,    82,
+      83,    84,    85,    87,     0,    80,    58,     0,    54,    62,
+      42,     0,     0,    44,   122,   169,     0,   157,     0,     0,
+      46,     0,     0,     0,   171,    88,     0,    48,     0,     0,
+     140,   128,    60,   124,   125,   126,     0,   131,   132,   133,
+     134,   135,   136,   138,   139,   137,     0,   118,   129,   127,
+       0,     0,   121,   123,     0,   130
 };
 
 /* YYPGOTO[NTERM-NUM].  */
-static const yytype_int8 yypgoto[] =
+static const yytype_int16 yypgoto[] =
 {
-    -101,  -101,   119,  -101,  -101,  -101,  -101,  -101,  -101,  -101,
-    -101,  -101,  -101,  -101,  -101,    61,    79,  -101,  -101,  -101,
-    -101,  -101,  -101,  -101,  -101,  -101,  -101,    -1,  -101,  -101,
-    -101,  -101,  -101,  -101,    63,    10,    59,  -101,  -101,  -100,
-    -101,  -101,  -101,  -101,   -52,  -101,  -101,  -101,   -50,  -101,
-    -101,  -101,  -101,  -101,  -101,  -101,  -101,  -101,    -7,  -101,
-    -101,  -101,  -101,  -101,  -101,  -101,    24,  -101,  -101,  -101,
-    -101
+    -117,  -117,   163,  -117,  -117,  -117,  -117,  -117,  -117,  -117,
+    -117,  -117,  -117,  -117,  -117,  -117,  -117,  -117,  -117,  -117,
+    -117,  -117,  -117,   107,  -117,  -117,  -117,  -117,  -117,  -117,
+     124,  -117,  -117,  -117,  -117,  -117,  -117,  -117,  -117,  -117,
+    -117,     2,  -117,  -117,  -117,  -117,   104,    91,  -117,  -117,
+     106,    32,    99,  -117,  -117,  -116,  -117,  -117,  -117,  -117,
+     -74,  -117,  -117,  -117,   -63,  -117,  -117,  -117,  -117,  -117,
+    -117,  -117,  -117,  -117,  -117,     6,  -117,  -117,  -117,  -117,
+    -117,  -117,  -117,    55,  -117,  -117,  -117,  -117
 };
 
 /* YYDEFGOTO[NTERM-NUM].  */
-static const yytype_uint8 yydefgoto[] =
+static const yytype_int16 yydefgoto[] =
 {
-       0,     9,    10,    11,    12,    13,    45,    46,    65,    47,
-      67,    94,    48,    69,    95,    70,    62,    91,    63,    89,
-     126,   144,   159,   160,   177,    14,    24,    25,    52,    26,
-      50,   129,    73,   100,   110,    76,    77,   105,    78,   103,
-      15,    16,   184,   194,   189,   207,   190,   204,   111,    17,
-      18,    31,    58,    84,    19,    33,   118,   119,   149,   150,
-     151,   170,   163,   181,    86,    87,   121,   140,   122,   155,
-      20
+       0,     9,    10,    11,    12,    13,    45,    46,    67,   102,
+     148,    47,    69,   105,    48,   107,   178,   151,   182,   207,
+     233,    71,   108,    72,    98,   173,   203,   228,   146,   176,
+      64,   100,    65,    96,   143,   171,   199,   200,   225,    14,
+      24,    25,    52,    26,    50,    77,    78,   155,    80,   116,
+     126,    83,    84,   121,    85,   119,    15,    16,   243,   256,
+     250,   269,   251,   266,   127,    17,    18,    31,    58,    91,
+      19,    33,    61,   135,   136,   188,   189,   190,   217,   210,
+     237,    93,    94,   138,   167,   139,   194,    20
 };
 
 /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
    positive, shift that token.  If negative, reduce the rule whose
    number is the opposite.  If YYTABLE_NINF, syntax error.  */
-static const yytype_uint8 yytable[] =
+static const yytype_int16 yytable[] =
 {
-     132,     1,    22,    74,    29,   152,   153,    23,   191,   192,
-     193,   136,   112,   113,   114,   115,     2,   165,   166,   167,
-     168,   169,   123,     3,   124,    51,    27,     4,    21,     5,
-     195,   196,   197,   198,   199,   200,   201,   202,   203,    38,
-      39,    40,    41,    42,    43,    44,   171,   172,   173,   174,
-     127,   128,     6,   116,   117,   141,   142,   147,   148,     7,
-      75,   154,    28,   156,   157,   175,   176,    30,    32,    22,
-      35,    34,    49,    53,    54,    37,    57,    55,    56,    59,
-       8,    61,    60,    64,    66,    68,    71,    72,    79,    80,
-      82,    81,    85,    83,    92,    88,    93,    97,    98,    75,
-      99,   102,   106,   109,   125,   210,   120,   130,   131,   107,
-     134,   138,   135,   108,   133,   137,   143,   162,   161,   146,
-     158,   178,   179,   180,   182,   183,   208,   212,   187,   188,
-      36,    96,   185,   186,   209,   211,   101,   104,   206,   205,
-     213,   145,    90,   164,     0,     0,   139
+     159,     1,    81,   191,   192,    73,    74,    29,   112,    22,
+      21,   163,   179,    27,    23,    75,    28,    73,    74,    38,
+      39,    40,    41,    42,    43,    44,    22,    75,    51,     2,
+      30,   180,   195,   196,   197,    32,     3,   128,   129,   130,
+     131,   132,   140,     4,   141,     5,   257,   258,   259,   260,
+     261,   262,   263,   264,   265,   133,   134,   212,   213,   214,
+     215,   216,   153,   154,    82,    76,   168,   169,     6,   193,
+     218,   219,   220,   221,   222,     7,   253,   254,   255,    59,
+      34,    60,   186,   187,   223,   224,    35,    37,    49,    53,
+      54,    55,    57,    56,    62,    63,    66,    68,     8,    70,
+      79,    86,    89,    92,   101,    87,    90,    88,    97,   103,
+      95,   104,   110,   106,   114,   111,   115,   118,    82,   122,
+     123,   137,   125,   124,   142,   145,   147,   144,   149,   150,
+     152,   158,   157,   161,   160,   162,   164,   165,   170,   172,
+     174,   175,   177,   181,   183,   185,   202,   198,   206,   227,
+     232,   272,   201,   204,   229,   205,   208,   226,   231,   209,
+     230,   234,   236,   240,   235,   246,   247,   249,   238,   242,
+     274,   239,   248,   241,    36,   244,   245,   268,   270,   109,
+     273,   113,   275,   252,   120,   271,   117,   267,     0,    99,
+     184,     0,     0,     0,   166,   211,     0,     0,     0,     0,
+       0,     0,     0,   156
 };
 
 static const yytype_int16 yycheck[] =
 {
-     100,     3,    84,    27,     5,    16,    17,    89,    38,    39,
-      40,   111,    66,    67,    68,    69,    18,    75,    76,    77,
-      78,    79,    84,    25,    86,    26,    54,    29,    84,    31,
-      44,    45,    46,    47,    48,    49,    50,    51,    52,     4,
-       5,     6,     7,     8,     9,    10,    66,    67,    68,    69,
-      21,    22,    54,    70,    71,    16,    17,    73,    74,    61,
-      84,    72,    84,    63,    64,    70,    71,    55,    62,    84,
-       0,    84,    19,    26,    30,    87,    56,    32,    32,    63,
-      82,    84,    11,    15,    12,    84,    84,    23,    84,    86,
-      57,    86,    65,    59,    86,    88,    13,    20,    24,    84,
-      25,    28,    33,    60,    14,   205,    84,    84,    26,    33,
-      58,    14,    84,    35,    34,    84,    62,    80,    86,    35,
-      65,    33,    84,    81,    84,    36,    41,    26,    37,    43,
-      11,    70,    84,    84,    53,    42,    73,    78,   190,   189,
-      84,   131,    63,   150,    -1,    -1,   122
+     116,     3,    40,    24,    25,    42,    43,     5,    33,   102,
+     102,   127,    29,    70,   107,    52,   102,    42,    43,     4,
+       5,     6,     7,     8,     9,    10,   102,    52,    26,    31,
+      71,    48,    79,    80,    81,    78,    38,    83,    84,    85,
+      86,    87,   102,    45,   104,    47,    60,    61,    62,    63,
+      64,    65,    66,    67,    68,    88,    89,    93,    94,    95,
+      96,    97,    34,    35,   102,   102,    24,    25,    70,    90,
+      83,    84,    85,    86,    87,    77,    54,    55,    56,    79,
+     102,    81,    91,    92,    88,    89,     0,   105,    32,    39,
+      46,    48,    72,    48,    11,   102,    15,    12,   100,   102,
+      36,   102,    73,    82,    16,   104,    75,   104,    18,   104,
+     106,    13,    44,    26,    37,    33,    38,    41,   102,    49,
+      49,   102,    76,    51,    14,    50,    17,   104,   104,    28,
+     104,    39,   102,    74,    50,   102,   102,    14,    78,    19,
+      51,    23,    27,    30,    49,    51,    20,    82,    48,    21,
+      53,   267,   104,   104,    49,   104,   104,   104,   104,    98,
+      49,    49,    99,    49,   102,    22,    19,    59,   102,    52,
+      39,   104,    53,   104,    11,   102,   102,   251,    57,    72,
+      58,    77,   102,   104,    85,    69,    80,   250,    -1,    65,
+     158,    -1,    -1,    -1,   139,   189,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,   112
 };
 
 /* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
    state STATE-NUM.  */
 static const yytype_uint8 yystos[] =
 {
-       0,     3,    18,    25,    29,    31,    54,    61,    82,    91,
-      92,    93,    94,    95,   115,   130,   131,   139,   140,   144,
-     160,    84,    84,    89,   116,   117,   119,    54,    84,   117,
-      55,   141,    62,   145,    84,     0,    92,    87,     4,     5,
-       6,     7,     8,     9,    10,    96,    97,    99,   102,    19,
-     120,   117,   118,    26,    30,    32,    32,    56,   142,    63,
-      11,    84,   106,   108,    15,    98,    12,   100,    84,   103,
-     105,    84,    23,   122,    27,    84,   125,   126,   128,    84,
-      86,    86,    57,    59,   143,    65,   154,   155,    88,   109,
-     106,   107,    86,    13,   101,   104,   105,    20,    24,    25,
-     123,   124,    28,   129,   126,   127,    33,    33,    35,    60,
-     124,   138,    66,    67,    68,    69,    70,    71,   146,   147,
-      84,   156,   158,    84,    86,    14,   110,    21,    22,   121,
-      84,    26,   129,    34,    58,    84,   129,    84,    14,   156,
-     157,    16,    17,    62,   111,   125,    35,    73,    74,   148,
-     149,   150,    16,    17,    72,   159,    63,    64,    65,   112,
-     113,    86,    80,   152,   148,    75,    76,    77,    78,    79,
-     151,    66,    67,    68,    69,    70,    71,   114,    33,    84,
-      81,   153,    84,    36,   132,    84,    84,    37,    43,   134,
-     136,    38,    39,    40,   133,    44,    45,    46,    47,    48,
-      49,    50,    51,    52,   137,   138,   134,   135,    41,    53,
-     129,    42,    26,    84
+       0,     3,    31,    38,    45,    47,    70,    77,   100,   109,
+     110,   111,   112,   113,   147,   164,   165,   173,   174,   178,
+     195,   102,   102,   107,   148,   149,   151,    70,   102,   149,
+      71,   175,    78,   179,   102,     0,   110,   105,     4,     5,
+       6,     7,     8,     9,    10,   114,   115,   119,   122,    32,
+     152,   149,   150,    39,    46,    48,    48,    72,   176,    79,
+      81,   180,    11,   102,   138,   140,    15,   116,    12,   120,
+     102,   129,   131,    42,    43,    52,   102,   153,   154,    36,
+     156,    40,   102,   159,   160,   162,   102,   104,   104,    73,
+      75,   177,    82,   189,   190,   106,   141,    18,   132,   138,
+     139,    16,   117,   104,    13,   121,    26,   123,   130,   131,
+      44,    33,    33,   154,    37,    38,   157,   158,    41,   163,
+     160,   161,    49,    49,    51,    76,   158,   172,    83,    84,
+      85,    86,    87,    88,    89,   181,   182,   102,   191,   193,
+     102,   104,    14,   142,   104,    50,   136,    17,   118,   104,
+      28,   125,   104,    34,    35,   155,   155,   102,    39,   163,
+      50,    74,   102,   163,   102,    14,   191,   192,    24,    25,
+      78,   143,    19,   133,    51,    23,   137,    27,   124,    29,
+      48,    30,   126,    49,   159,    51,    91,    92,   183,   184,
+     185,    24,    25,    90,   194,    79,    80,    81,    82,   144,
+     145,   104,    20,   134,   104,   104,    48,   127,   104,    98,
+     187,   183,    93,    94,    95,    96,    97,   186,    83,    84,
+      85,    86,    87,    88,    89,   146,   104,    21,   135,    49,
+      49,   104,    53,   128,    49,   102,    99,   188,   102,   104,
+      49,   104,    52,   166,   102,   102,    22,    19,    53,    59,
+     168,   170,   104,    54,    55,    56,   167,    60,    61,    62,
+      63,    64,    65,    66,    67,    68,   171,   172,   168,   169,
+      57,    69,   163,    58,    39,   102
 };
 
 /* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
 static const yytype_uint8 yyr1[] =
 {
-       0,    90,    91,    92,    92,    93,    94,    94,    94,    94,
-      94,    94,    94,    94,    95,    95,    96,    96,    97,    97,
-      97,    98,    98,    99,    99,    99,   100,   100,   101,   101,
-     102,   102,   103,   104,   104,   105,   106,   107,   107,   108,
-     109,   109,   109,   110,   110,   110,   111,   111,   111,   112,
-     112,   113,   113,   113,   113,   114,   114,   114,   115,   116,
-     116,   117,   118,   118,   119,   120,   120,   121,   121,   122,
-     122,   123,   123,   124,   125,   125,   126,   127,   127,   128,
-     129,   129,   130,   131,   132,   132,   133,   133,   133,   134,
-     135,   135,   136,   137,   137,   137,   137,   137,   137,   137,
-     137,   137,   138,   138,   139,   140,   141,   141,   142,   142,
-     143,   143,   144,   145,   146,   146,   147,   147,   148,   148,
-     149,   150,   150,   151,   151,   151,   151,   151,   152,   152,
-     153,   153,   154,   154,   154,   154,   155,   155,   156,   157,
-     157,   158,   158,   159,   159,   160
+       0,   108,   109,   110,   110,   111,   112,   112,   112,   112,
+     112,   112,   112,   112,   113,   113,   114,   114,   115,   115,
+     115,   116,   116,   117,   117,   118,   118,   119,   119,   119,
+     120,   120,   121,   121,   122,   122,   123,   123,   124,   124,
+     125,   125,   125,   126,   126,   127,   127,   128,   128,   129,
+     130,   130,   131,   132,   132,   133,   133,   134,   134,   135,
+     135,   136,   136,   137,   137,   138,   139,   139,   140,   141,
+     141,   141,   142,   142,   142,   143,   143,   143,   143,   144,
+     144,   145,   145,   145,   145,   145,   146,   146,   146,   147,
+     148,   148,   149,   150,   150,   151,   152,   152,   152,   153,
+     153,   154,   154,   154,   154,   155,   155,   156,   156,   157,
+     157,   158,   159,   159,   160,   161,   161,   162,   163,   163,
+     164,   165,   166,   166,   167,   167,   167,   168,   169,   169,
+     170,   171,   171,   171,   171,   171,   171,   171,   171,   171,
+     172,   172,   173,   174,   175,   175,   176,   176,   177,   177,
+     178,   179,   180,   180,   181,   181,   182,   182,   183,   183,
+     184,   185,   185,   186,   186,   186,   186,   186,   187,   187,
+     188,   188,   189,   189,   189,   189,   189,   190,   190,   191,
+     192,   192,   193,   193,   194,   194,   195
 };
 
 /* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr2[] =
 {
        0,     2,     1,     0,     2,     2,     1,     1,     1,     1,
-       1,     1,     1,     1,     4,     4,     2,     3,     1,     1,
-       1,     0,     1,     1,     1,     1,     0,     2,     0,     1,
-       2,     1,     2,     0,     1,     1,     2,     0,     1,     5,
-       0,     2,     2,     0,     2,     2,     0,     2,     2,     0,
-       2,     2,     2,     2,     2,     0,     1,     3,     6,     1,
-       1,     2,     0,     1,     1,     0,     4,     1,     1,     0,
-       3,     0,     1,     3,     1,     1,     2,     0,     1,     1,
-       0,     1,     4,    13,     0,     5,     1,     1,     1,     2,
-       0,     1,     5,     1,     1,     1,     1,     1,     1,     1,
-       1,     1,     0,     1,     5,     6,     0,     4,     0,     4,
-       0,     3,     2,     4,     1,     1,     0,     5,     0,     2,
+       1,     1,     1,     1,     7,     7,     4,     3,     1,     1,
+       1,     0,     1,     0,     1,     0,     1,     1,     1,     1,
+       0,     2,     0,     1,     2,     1,     0,     3,     0,     1,
+       0,     2,     4,     0,     3,     0,     3,     0,     3,     2,
+       0,     1,     1,     0,     5,     0,     2,     0,     2,     0,
+       4,     0,     4,     0,     1,     2,     0,     1,     5,     0,
+       2,     2,     0,     2,     2,     0,     2,     2,     2,     0,
+       2,     2,     2,     2,     2,     2,     0,     1,     3,     6,
+       1,     1,     2,     0,     1,     1,     0,     4,     4,     1,
+       2,     1,     1,     1,     4,     1,     1,     0,     3,     0,
+       1,     3,     1,     1,     2,     0,     1,     1,     0,     1,
+       4,    13,     0,     5,     1,     1,     1,     2,     0,     1,
+       5,     1,     1,     1,     1,     1,     1,     1,     1,     1,
+       0,     1,     5,     6,     0,     4,     0,     4,     0,     3,
+       2,     4,     1,     1,     1,     1,     0,     5,     0,     2,
        2,     1,     1,     1,     1,     1,     1,     1,     0,     2,
-       0,     2,     2,     2,     2,     2,     0,     2,     2,     0,
-       1,     3,     3,     1,     1,     2
+       0,     2,     2,     2,     2,     2,     2,     0,     2,     2,
+       0,     1,     3,     3,     1,     1,     2
 };
 
 
@@ -1826,8 +1915,8 @@ yyreduce:
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-  case 14: /* cluster: crCLUSTER crSTRING cluster_type cluster_hosts  */
-#line 190 "conffile.y"
+  case 14: /* cluster: crCLUSTER crSTRING cluster_type cluster_hosts cluster_opt_rate cluster_opt_expire cluster_opt_nostall  */
+#line 217 "conffile.y"
            {
 	   	struct _clhost *w;
 		char *err;
@@ -1838,27 +1927,30 @@ yyreduce:
 		(void)yynerrs;
 
 		/* count number of servers for ch_new */
-		for (srvcnt = 0, w = (yyvsp[0].cluster_hosts); w != NULL; w = w->next, srvcnt++)
+		for (srvcnt = 0, w = (yyvsp[-3].cluster_hosts); w != NULL; w = w->next, srvcnt++)
 			;
 
 		if (((yyval.cluster) = ra_malloc(ralloc, sizeof(cluster))) == NULL) {
-			logerr("malloc failed for cluster '%s'\n", (yyvsp[-2].crSTRING));
+			logerr("malloc failed for cluster '%s'\n", (yyvsp[-5].crSTRING));
 			YYABORT;
 		}
-		(yyval.cluster)->name = ra_strdup(ralloc, (yyvsp[-2].crSTRING));
+		(yyval.cluster)->name = ra_strdup(ralloc, (yyvsp[-5].crSTRING));
 		(yyval.cluster)->next = NULL;
-		(yyval.cluster)->type = (yyvsp[-1].cluster_type).t;
+		(yyval.cluster)->type = (yyvsp[-4].cluster_type).t;
+		(yyval.cluster)->rate = (yyvsp[-2].cluster_opt_rate);
+		(yyval.cluster)->expire = (yyvsp[-1].cluster_opt_expire);
+		(yyval.cluster)->nostall = (yyvsp[0].cluster_opt_nostall);
 		switch ((yyval.cluster)->type) {
 			case CARBON_CH:
 			case FNV1A_CH:
 			case JUMP_CH:
 				(yyval.cluster)->members.ch = ra_malloc(ralloc, sizeof(chashring));
 				if ((yyval.cluster)->members.ch == NULL) {
-					logerr("malloc failed for ch in cluster '%s'\n", (yyvsp[-2].crSTRING));
+					logerr("malloc failed for ch in cluster '%s'\n", (yyvsp[-5].crSTRING));
 					YYABORT;
 				}
-				replcnt = (yyvsp[-1].cluster_type).ival / 10;
-				(yyval.cluster)->isdynamic = (yyvsp[-1].cluster_type).ival - (replcnt * 10) == 2;
+				replcnt = (yyvsp[-4].cluster_type).ival / 10;
+				(yyval.cluster)->isdynamic = (yyvsp[-4].cluster_type).ival - (replcnt * 10) == 2;
 				if (replcnt < 1 || replcnt > 255) {
 					router_yyerror(&yylloc, yyscanner, rtr, ralloc, palloc,
 						"replication count must be between 1 and 255");
@@ -1870,25 +1962,40 @@ yyreduce:
 					(yyval.cluster)->type == FNV1A_CH ? FNV1a :
 					JUMP_FNV1a, srvcnt);
 				(yyval.cluster)->members.ch->servers = NULL;
-				(yyvsp[-1].cluster_type).ival = 0;  /* hack, avoid triggering use_all */
+				(yyvsp[-4].cluster_type).ival = 0;  /* hack, avoid triggering use_all */
 				break;
 			case FORWARD:
-				(yyval.cluster)->members.forward = NULL;
-				break;
 			case ANYOF:
 			case FAILOVER:
-				(yyval.cluster)->members.anyof = NULL;
+				(yyval.cluster)->steal = ((yyvsp[-4].cluster_type).ival & 2) != 0;
+				if ((yyval.cluster)->steal && (yyval.cluster)->type != ANYOF) {
+					router_yyerror(&yylloc, yyscanner, rtr, ralloc, palloc,
+						"steal is only supported for any_of clusters");
+					YYERROR;
+				}
+				(yyval.cluster)->balanced = ((yyvsp[-4].cluster_type).ival & 4) != 0;
+				if ((yyval.cluster)->balanced && (yyval.cluster)->type != ANYOF) {
+					router_yyerror(&yylloc, yyscanner, rtr, ralloc, palloc,
+						"balanced is only supported for any_of clusters");
+					YYERROR;
+				}
+				(yyvsp[-4].cluster_type).ival &= 1;  /* leave only useall */
+				if ((yyval.cluster)->type == FORWARD) {
+					(yyval.cluster)->members.forward = NULL;
+				} else {
+					(yyval.cluster)->members.anyof = NULL;
+				}
 				break;
 			default:
 				logerr("unknown cluster type %zd!\n", (ssize_t)(yyval.cluster)->type);
 				YYABORT;
 		}
 		
-		for (w = (yyvsp[0].cluster_hosts); w != NULL; w = w->next) {
+		for (w = (yyvsp[-3].cluster_hosts); w != NULL; w = w->next) {
 			err = router_add_server(rtr, w->ip, w->port, w->inst,
 					w->type, w->trnsp->mode, w->trnsp->mtlspemcert,
 					w->trnsp->mtlspemkey, w->proto,
-					w->saddr, w->hint, (char)(yyvsp[-1].cluster_type).ival, (yyval.cluster));
+					w->saddr, w->hint, (char)(yyvsp[-4].cluster_type).ival, (yyval.cluster));
 			if (err != NULL) {
 				router_yyerror(&yylloc, yyscanner, rtr, ralloc, palloc, err);
 				YYERROR;
@@ -1901,22 +2008,22 @@ yyreduce:
 			YYERROR;
 		}
 	   }
-#line 1905 "conffile.tab.c"
+#line 2012 "conffile.tab.c"
     break;
 
-  case 15: /* cluster: crCLUSTER crSTRING cluster_file cluster_paths  */
-#line 264 "conffile.y"
+  case 15: /* cluster: crCLUSTER crSTRING cluster_file cluster_paths cluster_opt_buffer cluster_opt_sync cluster_opt_rotate  */
+#line 310 "conffile.y"
            {
 	   	struct _clhost *w;
 		char *err;
 
 		if (((yyval.cluster) = ra_malloc(ralloc, sizeof(cluster))) == NULL) {
-			logerr("malloc failed for cluster '%s'\n", (yyvsp[-2].crSTRING));
+			logerr("malloc failed for cluster '%s'\n", (yyvsp[-5].crSTRING));
 			YYABORT;
 		}
-		(yyval.cluster)->name = ra_strdup(ralloc, (yyvsp[-2].crSTRING));
+		(yyval.cluster)->name = ra_strdup(ralloc, (yyvsp[-5].crSTRING));
 		(yyval.cluster)->next = NULL;
-		(yyval.cluster)->type = (yyvsp[-1].cluster_file).t;
+		(yyval.cluster)->type = (yyvsp[-4].cluster_file).t;
 		switch ((yyval.cluster)->type) {
 			case FILELOG:
 			case FILELOGIP:
@@ -1926,11 +2033,21 @@ yyreduce:
 				logerr("unknown cluster type %zd!\n", (ssize_t)(yyval.cluster)->type);
 				YYABORT;
 		}
+		if (((yyval.cluster)->file = ra_malloc(ralloc, sizeof(filesink))) == NULL) {
+			logerr("malloc failed for cluster '%s'\n", (yyvsp[-5].crSTRING));
+			YYABORT;
+		}
+		(yyval.cluster)->file->buffer = (yyvsp[-2].cluster_opt_buffer).size < 0 ?
+			SERVER_FILE_BUFSIZ : (size_t)(yyvsp[-2].cluster_opt_buffer).size;
+		(yyval.cluster)->file->dbl = (yyvsp[-2].cluster_opt_buffer).dbl;
+		(yyval.cluster)->file->sync = (yyvsp[-1].cluster_opt_sync);
+		(yyval.cluster)->file->rotatesecs = (yyvsp[0].cluster_opt_rotate).secs;
+		(yyval.cluster)->file->rotatebytes = (size_t)(yyvsp[0].cluster_opt_rotate).bytes;
 		
-		for (w = (yyvsp[0].cluster_paths); w != NULL; w = w->next) {
+		for (w = (yyvsp[-3].cluster_paths); w != NULL; w = w->next) {
 			err = router_add_server(rtr, w->ip, w->port, w->inst,
 					T_LINEMODE, W_PLAIN, NULL, NULL, w->proto,
-					w->saddr, w->hint, (char)(yyvsp[-1].cluster_file).ival, (yyval.cluster));
+					w->saddr, w->hint, (char)(yyvsp[-4].cluster_file).ival, (yyval.cluster));
 			if (err != NULL) {
 				router_yyerror(&yylloc, yyscanner, rtr, ralloc, palloc, err);
 				YYERROR;
@@ -1943,125 +2060,276 @@ yyreduce:
 			YYERROR;
 		}
 	   }
-#line 1947 "conffile.tab.c"
+#line 2064 "conffile.tab.c"
     break;
 
-  case 16: /* cluster_type: cluster_useall cluster_opt_useall  */
-#line 305 "conffile.y"
-                          { (yyval.cluster_type).t = (yyvsp[-1].cluster_useall); (yyval.cluster_type).ival = (yyvsp[0].cluster_opt_useall); }
-#line 1953 "conffile.tab.c"
+  case 16: /* cluster_type: cluster_useall cluster_opt_useall cluster_opt_steal cluster_opt_balanced  */
+#line 362 "conffile.y"
+                          { (yyval.cluster_type).t = (yyvsp[-3].cluster_useall); (yyval.cluster_type).ival = ((yyvsp[0].cluster_opt_balanced) * 4) + ((yyvsp[-1].cluster_opt_steal) * 2) + (yyvsp[-2].cluster_opt_useall); }
+#line 2070 "conffile.tab.c"
     break;
 
   case 17: /* cluster_type: cluster_ch cluster_opt_repl cluster_opt_dynamic  */
-#line 307 "conffile.y"
+#line 364 "conffile.y"
                           { (yyval.cluster_type).t = (yyvsp[-2].cluster_ch); (yyval.cluster_type).ival = ((yyvsp[0].cluster_opt_dynamic) * 2) + ((yyvsp[-1].cluster_opt_repl) * 10); }
-#line 1959 "conffile.tab.c"
+#line 2076 "conffile.tab.c"
     break;
 
   case 18: /* cluster_useall: crFORWARD  */
-#line 310 "conffile.y"
+#line 367 "conffile.y"
                            { (yyval.cluster_useall) = FORWARD; }
-#line 1965 "conffile.tab.c"
+#line 2082 "conffile.tab.c"
     break;
 
   case 19: /* cluster_useall: crANY_OF  */
-#line 311 "conffile.y"
+#line 368 "conffile.y"
                                        { (yyval.cluster_useall) = ANYOF; }
-#line 1971 "conffile.tab.c"
+#line 2088 "conffile.tab.c"
     break;
 
   case 20: /* cluster_useall: crFAILOVER  */
-#line 312 "conffile.y"
+#line 369 "conffile.y"
                                        { (yyval.cluster_useall) = FAILOVER; }
-#line 1977 "conffile.tab.c"
+#line 2094 "conffile.tab.c"
     break;
 
   case 21: /* cluster_opt_useall: %empty  */
-#line 315 "conffile.y"
+#line 372 "conffile.y"
                              { (yyval.cluster_opt_useall) = 0; }
-#line 1983 "conffile.tab.c"
+#line 2100 "conffile.tab.c"
     break;
 
   case 22: /* cluster_opt_useall: crUSEALL  */
-#line 316 "conffile.y"
+#line 373 "conffile.y"
                                              { (yyval.cluster_opt_useall) = 1; }
-#line 1989 "conffile.tab.c"
+#line 2106 "conffile.tab.c"
+    break;
+
+  case 23: /* cluster_opt_steal: %empty  */
+#line 376 "conffile.y"
+                           { (yyval.cluster_opt_steal) = 0; }
+#line 2112 "conffile.tab.c"
     break;
 
-  case 23: /* cluster_ch: crCARBON_CH  */
-#line 319 "conffile.y"
+  case 24: /* cluster_opt_steal: crSTEAL  */
+#line 377 "conffile.y"
+                                           { (yyval.cluster_opt_steal) = 1; }
+#line 2118 "conffile.tab.c"
+    break;
+
+  case 25: /* cluster_opt_balanced: %empty  */
+#line 380 "conffile.y"
+                                 { (yyval.cluster_opt_balanced) = 0; }
+#line 2124 "conffile.tab.c"
+    break;
+
+  case 26: /* cluster_opt_balanced: crBALANCED  */
+#line 381 "conffile.y"
+                                                     { (yyval.cluster_opt_balanced) = 1; }
+#line 2130 "conffile.tab.c"
+    break;
+
+  case 27: /* cluster_ch: crCARBON_CH  */
+#line 384 "conffile.y"
                             { (yyval.cluster_ch) = CARBON_CH; }
-#line 1995 "conffile.tab.c"
+#line 2136 "conffile.tab.c"
     break;
 
-  case 24: /* cluster_ch: crFNV1A_CH  */
-#line 320 "conffile.y"
+  case 28: /* cluster_ch: crFNV1A_CH  */
+#line 385 "conffile.y"
                                     { (yyval.cluster_ch) = FNV1A_CH; }
-#line 2001 "conffile.tab.c"
+#line 2142 "conffile.tab.c"
     break;
 
-  case 25: /* cluster_ch: crJUMP_FNV1A_CH  */
-#line 321 "conffile.y"
+  case 29: /* cluster_ch: crJUMP_FNV1A_CH  */
+#line 386 "conffile.y"
                                     { (yyval.cluster_ch) = JUMP_CH; }
-#line 2007 "conffile.tab.c"
+#line 2148 "conffile.tab.c"
     break;
 
-  case 26: /* cluster_opt_repl: %empty  */
-#line 324 "conffile.y"
+  case 30: /* cluster_opt_repl: %empty  */
+#line 389 "conffile.y"
                                               { (yyval.cluster_opt_repl) = 1; }
-#line 2013 "conffile.tab.c"
+#line 2154 "conffile.tab.c"
     break;
 
-  case 27: /* cluster_opt_repl: crREPLICATION crINTVAL  */
-#line 325 "conffile.y"
+  case 31: /* cluster_opt_repl: crREPLICATION crINTVAL  */
+#line 390 "conffile.y"
                                                               { (yyval.cluster_opt_repl) = (yyvsp[0].crINTVAL); }
-#line 2019 "conffile.tab.c"
+#line 2160 "conffile.tab.c"
     break;
 
-  case 28: /* cluster_opt_dynamic: %empty  */
-#line 328 "conffile.y"
+  case 32: /* cluster_opt_dynamic: %empty  */
+#line 393 "conffile.y"
                                { (yyval.cluster_opt_dynamic) = 0; }
-#line 2025 "conffile.tab.c"
+#line 2166 "conffile.tab.c"
     break;
 
-  case 29: /* cluster_opt_dynamic: crDYNAMIC  */
-#line 329 "conffile.y"
+  case 33: /* cluster_opt_dynamic: crDYNAMIC  */
+#line 394 "conffile.y"
                                                { (yyval.cluster_opt_dynamic) = 1; }
-#line 2031 "conffile.tab.c"
+#line 2172 "conffile.tab.c"
     break;
 
-  case 30: /* cluster_file: crFILE crIP  */
-#line 332 "conffile.y"
+  case 34: /* cluster_file: crFILE crIP  */
+#line 397 "conffile.y"
                           { (yyval.cluster_file).t = FILELOGIP; (yyval.cluster_file).ival = 0; }
-#line 2037 "conffile.tab.c"
+#line 2178 "conffile.tab.c"
     break;
 
-  case 31: /* cluster_file: crFILE  */
-#line 333 "conffile.y"
+  case 35: /* cluster_file: crFILE  */
+#line 398 "conffile.y"
                                       { (yyval.cluster_file).t = FILELOG; (yyval.cluster_file).ival = 0; }
-#line 2043 "conffile.tab.c"
+#line 2184 "conffile.tab.c"
+    break;
+
+  case 36: /* cluster_opt_buffer: %empty  */
+#line 401 "conffile.y"
+                                            { (yyval.cluster_opt_buffer).size = -1; (yyval.cluster_opt_buffer).dbl = 0; }
+#line 2190 "conffile.tab.c"
+    break;
+
+  case 37: /* cluster_opt_buffer: crBUFFER crINTVAL cluster_opt_double  */
+#line 403 "conffile.y"
+                                  {
+					if ((yyvsp[-1].crINTVAL) < 0) {
+						router_yyerror(&yylloc, yyscanner, rtr,
+								ralloc, palloc,
+								"buffer cannot be negative");
+						YYERROR;
+					}
+					if ((yyvsp[-1].crINTVAL) == 0 && (yyvsp[0].cluster_opt_double)) {
+						router_yyerror(&yylloc, yyscanner, rtr,
+								ralloc, palloc,
+								"double needs a buffer larger than 0");
+						YYERROR;
+					}
+					(yyval.cluster_opt_buffer).size = (yyvsp[-1].crINTVAL);
+					(yyval.cluster_opt_buffer).dbl = (yyvsp[0].cluster_opt_double);
+				  }
+#line 2211 "conffile.tab.c"
+    break;
+
+  case 38: /* cluster_opt_double: %empty  */
+#line 420 "conffile.y"
+                              { (yyval.cluster_opt_double) = 0; }
+#line 2217 "conffile.tab.c"
+    break;
+
+  case 39: /* cluster_opt_double: crDOUBLE  */
+#line 421 "conffile.y"
+                                              { (yyval.cluster_opt_double) = 1; }
+#line 2223 "conffile.tab.c"
+    break;
+
+  case 40: /* cluster_opt_sync: %empty  */
+#line 423 "conffile.y"
+                                  { (yyval.cluster_opt_sync) = 0; }
+#line 2229 "conffile.tab.c"
+    break;
+
+  case 41: /* cluster_opt_sync: crSYNC crALWAYS  */
+#line 424 "conffile.y"
+                                                  { (yyval.cluster_opt_sync) = -1; }
+#line 2235 "conffile.tab.c"
+    break;
+
+  case 42: /* cluster_opt_sync: crSYNC crEVERY crINTVAL crSECONDS  */
+#line 426 "conffile.y"
+                                {
+					if ((yyvsp[-1].crINTVAL) < 1) {
+						router_yyerror(&yylloc, yyscanner, rtr,
+								ralloc, palloc,
+								"sync interval must be at least 1 second");
+						YYERROR;
+					}
+					(yyval.cluster_opt_sync) = (yyvsp[-1].crINTVAL);
+				}
+#line 2249 "conffile.tab.c"
+    break;
+
+  case 43: /* cluster_opt_rotate: %empty  */
+#line 436 "conffile.y"
+                              { (yyval.cluster_opt_rotate).secs = 0; (yyval.cluster_opt_rotate).bytes = 0; }
+#line 2255 "conffile.tab.c"
+    break;
+
+  case 44: /* cluster_opt_rotate: crROTATE cluster_opt_rotevery cluster_opt_rotat  */
+#line 438 "conffile.y"
+                                  {
+					if ((yyvsp[-1].cluster_opt_rotevery) == 0 && (yyvsp[0].cluster_opt_rotat) == 0) {
+						router_yyerror(&yylloc, yyscanner, rtr,
+								ralloc, palloc,
+								"rotate needs an interval or a size");
+						YYERROR;
+					}
+					(yyval.cluster_opt_rotate).secs = (yyvsp[-1].cluster_opt_rotevery);
+					(yyval.cluster_opt_rotate).bytes = (yyvsp[0].cluster_opt_rotat);
+				  }
+#line 2270 "conffile.tab.c"
     break;
 
-  case 32: /* cluster_paths: cluster_path cluster_opt_path  */
-#line 336 "conffile.y"
+  case 45: /* cluster_opt_rotevery: %empty  */
+#line 449 "conffile.y"
+                                                    { (yyval.cluster_opt_rotevery) = 0; }
+#line 2276 "conffile.tab.c"
+    break;
+
+  case 46: /* cluster_opt_rotevery: crEVERY crINTVAL crSECONDS  */
+#line 451 "conffile.y"
+                                        {
+						if ((yyvsp[-1].crINTVAL) < 1) {
+							router_yyerror(&yylloc, yyscanner, rtr,
+									ralloc, palloc,
+									"rotate interval must be at least "
+									"1 second");
+							YYERROR;
+						}
+						(yyval.cluster_opt_rotevery) = (yyvsp[-1].crINTVAL);
+					}
+#line 2291 "conffile.tab.c"
+    break;
+
+  case 47: /* cluster_opt_rotat: %empty  */
+#line 462 "conffile.y"
+                                           { (yyval.cluster_opt_rotat) = 0; }
+#line 2297 "conffile.tab.c"
+    break;
+
+  case 48: /* cluster_opt_rotat: crAT crINTVAL crBYTES  */
+#line 464 "conffile.y"
+                                 {
+					if ((yyvsp[-1].crINTVAL) < 1) {
+						router_yyerror(&yylloc, yyscanner, rtr,
+								ralloc, palloc,
+								"rotate size must be at least 1 byte");
+						YYERROR;
+					}
+					(yyval.cluster_opt_rotat) = (yyvsp[-1].crINTVAL);
+				 }
+#line 2311 "conffile.tab.c"
+    break;
+
+  case 49: /* cluster_paths: cluster_path cluster_opt_path  */
+#line 475 "conffile.y"
                                                    { (yyvsp[-1].cluster_path)->next = (yyvsp[0].cluster_opt_path); (yyval.cluster_paths) = (yyvsp[-1].cluster_path); }
-#line 2049 "conffile.tab.c"
+#line 2317 "conffile.tab.c"
     break;
 
-  case 33: /* cluster_opt_path: %empty  */
-#line 338 "conffile.y"
+  case 50: /* cluster_opt_path: %empty  */
+#line 477 "conffile.y"
                                { (yyval.cluster_opt_path) = NULL; }
-#line 2055 "conffile.tab.c"
+#line 2323 "conffile.tab.c"
     break;
 
-  case 34: /* cluster_opt_path: cluster_path  */
-#line 339 "conffile.y"
+  case 51: /* cluster_opt_path: cluster_path  */
+#line 478 "conffile.y"
                                                { (yyval.cluster_opt_path) = (yyvsp[0].cluster_path); }
-#line 2061 "conffile.tab.c"
+#line 2329 "conffile.tab.c"
     break;
 
-  case 35: /* cluster_path: crSTRING  */
-#line 342 "conffile.y"
+  case 52: /* cluster_path: crSTRING  */
+#line 481 "conffile.y"
                         {
 				struct _clhost *ret = ra_malloc(palloc, sizeof(struct _clhost));
 				char *err = router_validate_path(rtr, (yyvsp[0].crSTRING));
@@ -2079,29 +2347,156 @@ yyreduce:
 				ret->next = NULL;
 				(yyval.cluster_path) = ret;
 			}
-#line 2083 "conffile.tab.c"
+#line 2351 "conffile.tab.c"
+    break;
+
+  case 53: /* cluster_opt_rate: %empty  */
+#line 500 "conffile.y"
+                      { (yyval.cluster_opt_rate) = NULL; }
+#line 2357 "conffile.tab.c"
+    break;
+
+  case 54: /* cluster_opt_rate: crRATE crINTVAL cluster_opt_ratebytes cluster_opt_burst cluster_opt_catchup  */
+#line 503 "conffile.y"
+                                {
+					if ((yyvsp[-3].crINTVAL) < 1) {
+						router_yyerror(&yylloc, yyscanner, rtr,
+								ralloc, palloc,
+								"rate must be at least 1 metric per second");
+						YYERROR;
+					}
+					(yyval.cluster_opt_rate) = (yyvsp[0].cluster_opt_catchup);
+					(yyval.cluster_opt_rate)->metrics = (size_t)(yyvsp[-3].crINTVAL);
+					(yyval.cluster_opt_rate)->bytes = (size_t)(yyvsp[-2].cluster_opt_ratebytes);
+					(yyval.cluster_opt_rate)->burst = (size_t)(yyvsp[-1].cluster_opt_burst);
+				}
+#line 2374 "conffile.tab.c"
+    break;
+
+  case 55: /* cluster_opt_ratebytes: %empty  */
+#line 516 "conffile.y"
+                                             { (yyval.cluster_opt_ratebytes) = 0; }
+#line 2380 "conffile.tab.c"
+    break;
+
+  case 56: /* cluster_opt_ratebytes: crBYTES crINTVAL  */
+#line 518 "conffile.y"
+                                         {
+						if ((yyvsp[0].crINTVAL) < 1) {
+							router_yyerror(&yylloc, yyscanner, rtr,
+									ralloc, palloc,
+									"bytes must be at least 1 per second");
+							YYERROR;
+						}
+						(yyval.cluster_opt_ratebytes) = (yyvsp[0].crINTVAL);
+					 }
+#line 2394 "conffile.tab.c"
+    break;
+
+  case 57: /* cluster_opt_burst: %empty  */
+#line 528 "conffile.y"
+                                         { (yyval.cluster_opt_burst) = 0; }
+#line 2400 "conffile.tab.c"
+    break;
+
+  case 58: /* cluster_opt_burst: crBURST crINTVAL  */
+#line 530 "conffile.y"
+                                 {
+					if ((yyvsp[0].crINTVAL) < 1) {
+						router_yyerror(&yylloc, yyscanner, rtr,
+								ralloc, palloc,
+								"burst must be at least 1 metric");
+						YYERROR;
+					}
+					(yyval.cluster_opt_burst) = (yyvsp[0].crINTVAL);
+				 }
+#line 2414 "conffile.tab.c"
+    break;
+
+  case 59: /* cluster_opt_catchup: %empty  */
+#line 541 "conffile.y"
+                                   {
+					if (((yyval.cluster_opt_catchup) = ra_malloc(ralloc, sizeof(ratelimit))) == NULL) {
+						logerr("malloc failed\n");
+						YYABORT;
+					}
+					(yyval.cluster_opt_catchup)->catchup = 0;
+					(yyval.cluster_opt_catchup)->above = 0;
+				   }
+#line 2427 "conffile.tab.c"
+    break;
+
+  case 60: /* cluster_opt_catchup: crCATCHUP crINTVAL crABOVE crINTVAL  */
+#line 550 "conffile.y"
+                                   {
+					if ((yyvsp[-2].crINTVAL) < 1) {
+						router_yyerror(&yylloc, yyscanner, rtr,
+								ralloc, palloc,
+								"catchup must be at least 1 metric per second");
+						YYERROR;
+					}
+					if (((yyval.cluster_opt_catchup) = ra_malloc(ralloc, sizeof(ratelimit))) == NULL) {
+						logerr("malloc failed\n");
+						YYABORT;
+					}
+					(yyval.cluster_opt_catchup)->catchup = (size_t)(yyvsp[-2].crINTVAL);
+					(yyval.cluster_opt_catchup)->above = (size_t)(yyvsp[0].crINTVAL);
+				   }
+#line 2446 "conffile.tab.c"
+    break;
+
+  case 61: /* cluster_opt_expire: %empty  */
+#line 565 "conffile.y"
+                             { (yyval.cluster_opt_expire) = 0; }
+#line 2452 "conffile.tab.c"
     break;
 
-  case 36: /* cluster_hosts: cluster_host cluster_opt_host  */
-#line 361 "conffile.y"
+  case 62: /* cluster_opt_expire: crEXPIRE crAFTER crINTVAL crSECONDS  */
+#line 567 "conffile.y"
+                                  {
+					if ((yyvsp[-1].crINTVAL) < 1) {
+						router_yyerror(&yylloc, yyscanner, rtr,
+								ralloc, palloc,
+								"expire must be at least 1 second");
+						YYERROR;
+					}
+					(yyval.cluster_opt_expire) = (yyvsp[-1].crINTVAL);
+				  }
+#line 2466 "conffile.tab.c"
+    break;
+
+  case 63: /* cluster_opt_nostall: %empty  */
+#line 577 "conffile.y"
+                               { (yyval.cluster_opt_nostall) = 0; }
+#line 2472 "conffile.tab.c"
+    break;
+
+  case 64: /* cluster_opt_nostall: crNOSTALL  */
+#line 578 "conffile.y"
+                                               { (yyval.cluster_opt_nostall) = 1; }
+#line 2478 "conffile.tab.c"
+    break;
+
+  case 65: /* cluster_hosts: cluster_host cluster_opt_host  */
+#line 581 "conffile.y"
                                                    { (yyvsp[-1].cluster_host)->next = (yyvsp[0].cluster_opt_host); (yyval.cluster_hosts) = (yyvsp[-1].cluster_host); }
-#line 2089 "conffile.tab.c"
+#line 2484 "conffile.tab.c"
     break;
 
-  case 37: /* cluster_opt_host: %empty  */
-#line 363 "conffile.y"
+  case 66: /* cluster_opt_host: %empty  */
+#line 583 "conffile.y"
                                 { (yyval.cluster_opt_host) = NULL; }
-#line 2095 "conffile.tab.c"
+#line 2490 "conffile.tab.c"
     break;
 
-  case 38: /* cluster_opt_host: cluster_hosts  */
-#line 364 "conffile.y"
+  case 67: /* cluster_opt_host: cluster_hosts  */
+#line 584 "conffile.y"
                                                 { (yyval.cluster_opt_host) = (yyvsp[0].cluster_hosts); }
-#line 2101 "conffile.tab.c"
+#line 2496 "conffile.tab.c"
     break;
 
-  case 39: /* cluster_host: crSTRING cluster_opt_instance cluster_opt_proto cluster_opt_type cluster_opt_transport  */
-#line 369 "conffile.y"
+  case 68: /* cluster_host: crSTRING cluster_opt_instance cluster_opt_proto cluster_opt_type cluster_opt_transport  */
+#line 589 "conffile.y"
                         {
 			  	struct _clhost *ret = ra_malloc(palloc, sizeof(struct _clhost));
 				char *err = router_validate_address(
@@ -2113,6 +2508,19 @@ yyreduce:
 							ralloc, palloc, err);
 					YYERROR;
 				}
+				if ((yyvsp[-1].cluster_opt_type) == T_PICKLE && (yyvsp[-2].cluster_opt_proto) == CON_UDP) {
+					router_yyerror(&yylloc, yyscanner, rtr,
+							ralloc, palloc,
+							"cannot use UDP transport for pickle type");
+					YYERROR;
+				}
+				if ((yyvsp[0].cluster_opt_transport)->mode != W_PLAIN && (yyvsp[-2].cluster_opt_proto) == CON_UDP) {
+					router_yyerror(&yylloc, yyscanner, rtr,
+							ralloc, palloc,
+							"cannot use UDP transport for "
+							"compressed/encrypted stream");
+					YYERROR;
+				}
 				ret->inst = (yyvsp[-3].cluster_opt_instance);
 				ret->proto = (yyvsp[-2].cluster_opt_proto);
 				ret->type = (yyvsp[-1].cluster_opt_type);
@@ -2120,23 +2528,23 @@ yyreduce:
 				ret->next = NULL;
 				(yyval.cluster_host) = ret;
 			  }
-#line 2124 "conffile.tab.c"
+#line 2532 "conffile.tab.c"
     break;
 
-  case 40: /* cluster_opt_instance: %empty  */
-#line 388 "conffile.y"
+  case 69: /* cluster_opt_instance: %empty  */
+#line 621 "conffile.y"
                                          { (yyval.cluster_opt_instance) = NULL; }
-#line 2130 "conffile.tab.c"
+#line 2538 "conffile.tab.c"
     break;
 
-  case 41: /* cluster_opt_instance: '=' crSTRING  */
-#line 389 "conffile.y"
+  case 70: /* cluster_opt_instance: '=' crSTRING  */
+#line 622 "conffile.y"
                                                              { (yyval.cluster_opt_instance) = (yyvsp[0].crSTRING); }
-#line 2136 "conffile.tab.c"
+#line 2544 "conffile.tab.c"
     break;
 
-  case 42: /* cluster_opt_instance: '=' crINTVAL  */
-#line 391 "conffile.y"
+  case 71: /* cluster_opt_instance: '=' crINTVAL  */
+#line 624 "conffile.y"
                                         {
 						(yyval.cluster_opt_instance) = ra_malloc(palloc, sizeof(char) * 12);
 						if ((yyval.cluster_opt_instance) == NULL) {
@@ -2145,47 +2553,53 @@ yyreduce:
 						}
 						snprintf((yyval.cluster_opt_instance), 12, "%d", (yyvsp[0].crINTVAL));
 					}
-#line 2149 "conffile.tab.c"
+#line 2557 "conffile.tab.c"
     break;
 
-  case 43: /* cluster_opt_proto: %empty  */
-#line 400 "conffile.y"
+  case 72: /* cluster_opt_proto: %empty  */
+#line 633 "conffile.y"
                                  { (yyval.cluster_opt_proto) = CON_TCP; }
-#line 2155 "conffile.tab.c"
+#line 2563 "conffile.tab.c"
     break;
 
-  case 44: /* cluster_opt_proto: crPROTO crUDP  */
-#line 401 "conffile.y"
+  case 73: /* cluster_opt_proto: crPROTO crUDP  */
+#line 634 "conffile.y"
                                                  { (yyval.cluster_opt_proto) = CON_UDP; }
-#line 2161 "conffile.tab.c"
+#line 2569 "conffile.tab.c"
     break;
 
-  case 45: /* cluster_opt_proto: crPROTO crTCP  */
-#line 402 "conffile.y"
+  case 74: /* cluster_opt_proto: crPROTO crTCP  */
+#line 635 "conffile.y"
                                                  { (yyval.cluster_opt_proto) = CON_TCP; }
-#line 2167 "conffile.tab.c"
+#line 2575 "conffile.tab.c"
     break;
 
-  case 46: /* cluster_opt_type: %empty  */
-#line 405 "conffile.y"
+  case 75: /* cluster_opt_type: %empty  */
+#line 638 "conffile.y"
                                       { (yyval.cluster_opt_type) = T_LINEMODE; }
-#line 2173 "conffile.tab.c"
+#line 2581 "conffile.tab.c"
     break;
 
-  case 47: /* cluster_opt_type: crTYPE crLINEMODE  */
-#line 406 "conffile.y"
+  case 76: /* cluster_opt_type: crTYPE crLINEMODE  */
+#line 639 "conffile.y"
                                                       { (yyval.cluster_opt_type) = T_LINEMODE; }
-#line 2179 "conffile.tab.c"
+#line 2587 "conffile.tab.c"
     break;
 
-  case 48: /* cluster_opt_type: crTYPE crSYSLOGMODE  */
-#line 407 "conffile.y"
+  case 77: /* cluster_opt_type: crTYPE crSYSLOGMODE  */
+#line 640 "conffile.y"
                                                       { (yyval.cluster_opt_type) = T_SYSLOGMODE; }
-#line 2185 "conffile.tab.c"
+#line 2593 "conffile.tab.c"
+    break;
+
+  case 78: /* cluster_opt_type: crTYPE crPICKLE  */
+#line 641 "conffile.y"
+                                                      { (yyval.cluster_opt_type) = T_PICKLE; }
+#line 2599 "conffile.tab.c"
     break;
 
-  case 49: /* cluster_opt_transport: %empty  */
-#line 411 "conffile.y"
+  case 79: /* cluster_opt_transport: %empty  */
+#line 645 "conffile.y"
                                          {
 						if (((yyval.cluster_opt_transport) = ra_malloc(palloc,
 								sizeof(struct _rcptr_trsp))) == NULL)
@@ -2197,11 +2611,11 @@ yyreduce:
 						(yyval.cluster_opt_transport)->mtlspemcert = NULL;
 						(yyval.cluster_opt_transport)->mtlspemkey = NULL;
 					 }
-#line 2201 "conffile.tab.c"
+#line 2615 "conffile.tab.c"
     break;
 
-  case 50: /* cluster_opt_transport: cluster_transport_trans cluster_transport_opt_ssl  */
-#line 424 "conffile.y"
+  case 80: /* cluster_opt_transport: cluster_transport_trans cluster_transport_opt_ssl  */
+#line 658 "conffile.y"
                                          {
 					 	if ((yyvsp[0].cluster_transport_opt_ssl)->mode == W_PLAIN) {
 							if (((yyval.cluster_opt_transport) = ra_malloc(palloc,
@@ -2218,17 +2632,17 @@ yyreduce:
 							(yyval.cluster_opt_transport) = (yyvsp[0].cluster_transport_opt_ssl);
 						}
 					 }
-#line 2222 "conffile.tab.c"
+#line 2636 "conffile.tab.c"
     break;
 
-  case 51: /* cluster_transport_trans: crTRANSPORT crPLAIN  */
-#line 441 "conffile.y"
+  case 81: /* cluster_transport_trans: crTRANSPORT crPLAIN  */
+#line 675 "conffile.y"
                                               { (yyval.cluster_transport_trans) = W_PLAIN; }
-#line 2228 "conffile.tab.c"
+#line 2642 "conffile.tab.c"
     break;
 
-  case 52: /* cluster_transport_trans: crTRANSPORT crGZIP  */
-#line 442 "conffile.y"
+  case 82: /* cluster_transport_trans: crTRANSPORT crGZIP  */
+#line 676 "conffile.y"
                                                                   {
 #ifdef HAVE_GZIP
 							(yyval.cluster_transport_trans) = W_GZIP;
@@ -2239,11 +2653,11 @@ yyreduce:
 							YYERROR;
 #endif
 					    }
-#line 2243 "conffile.tab.c"
+#line 2657 "conffile.tab.c"
     break;
 
-  case 53: /* cluster_transport_trans: crTRANSPORT crLZ4  */
-#line 452 "conffile.y"
+  case 83: /* cluster_transport_trans: crTRANSPORT crLZ4  */
+#line 686 "conffile.y"
                                                                    {
 #ifdef HAVE_LZ4
 							(yyval.cluster_transport_trans) = W_LZ4;
@@ -2254,11 +2668,11 @@ yyreduce:
 							YYERROR;
 #endif
 					    }
-#line 2258 "conffile.tab.c"
+#line 2672 "conffile.tab.c"
     break;
 
-  case 54: /* cluster_transport_trans: crTRANSPORT crSNAPPY  */
-#line 462 "conffile.y"
+  case 84: /* cluster_transport_trans: crTRANSPORT crSNAPPY  */
+#line 696 "conffile.y"
                                                                       {
 #ifdef HAVE_SNAPPY
 							(yyval.cluster_transport_trans) = W_SNAPPY;
@@ -2269,11 +2683,26 @@ yyreduce:
 							YYERROR;
 #endif
 					    }
-#line 2273 "conffile.tab.c"
+#line 2687 "conffile.tab.c"
     break;
 
-  case 55: /* cluster_transport_opt_ssl: %empty  */
-#line 474 "conffile.y"
+  case 85: /* cluster_transport_trans: crTRANSPORT crZSTD  */
+#line 706 "conffile.y"
+                                                                    {
+#ifdef HAVE_ZSTD
+							(yyval.cluster_transport_trans) = W_ZSTD;
+#else
+							router_yyerror(&yylloc, yyscanner, rtr,
+								ralloc, palloc,
+								"feature zstd not compiled in");
+							YYERROR;
+#endif
+					    }
+#line 2702 "conffile.tab.c"
+    break;
+
+  case 86: /* cluster_transport_opt_ssl: %empty  */
+#line 718 "conffile.y"
                                                  {
 							if (((yyval.cluster_transport_opt_ssl) = ra_malloc(palloc,
 									sizeof(struct _rcptr_trsp))) == NULL)
@@ -2285,11 +2714,11 @@ yyreduce:
 							(yyval.cluster_transport_opt_ssl)->mtlspemcert = NULL;
 							(yyval.cluster_transport_opt_ssl)->mtlspemkey = NULL;
 						 }
-#line 2289 "conffile.tab.c"
+#line 2718 "conffile.tab.c"
     break;
 
-  case 56: /* cluster_transport_opt_ssl: crSSL  */
-#line 486 "conffile.y"
+  case 87: /* cluster_transport_opt_ssl: crSSL  */
+#line 730 "conffile.y"
                                                  {
 #ifdef HAVE_SSL
 							if (((yyval.cluster_transport_opt_ssl) = ra_malloc(palloc,
@@ -2308,11 +2737,11 @@ yyreduce:
 							YYERROR;
 #endif
 					     }
-#line 2312 "conffile.tab.c"
+#line 2741 "conffile.tab.c"
     break;
 
-  case 57: /* cluster_transport_opt_ssl: crMTLS crSTRING crSTRING  */
-#line 505 "conffile.y"
+  case 88: /* cluster_transport_opt_ssl: crMTLS crSTRING crSTRING  */
+#line 749 "conffile.y"
                                                  {
 #ifdef HAVE_SSL
 							if (((yyval.cluster_transport_opt_ssl) = ra_malloc(palloc,
@@ -2331,11 +2760,11 @@ yyreduce:
 							YYERROR;
 #endif
 					     }
-#line 2335 "conffile.tab.c"
+#line 2764 "conffile.tab.c"
     break;
 
-  case 58: /* match: crMATCH match_exprs match_opt_validate match_opt_route match_opt_send_to match_opt_stop  */
-#line 529 "conffile.y"
+  case 89: /* match: crMATCH match_exprs match_opt_validate match_opt_route match_opt_send_to match_opt_stop  */
+#line 773 "conffile.y"
          {
 	 	/* each expr comes with an allocated route, populate it */
 		struct _maexpr *we;
@@ -2362,6 +2791,8 @@ yyreduce:
 				YYABORT;
 			}
 			d->cl->members.validation->rule = (yyvsp[-3].match_opt_validate)->r;
+			d->cl->members.validation->checks = (yyvsp[-3].match_opt_validate)->checks;
+			d->cl->members.validation->tsdrift = (yyvsp[-3].match_opt_validate)->tsdrift;
 			d->cl->members.validation->action = (yyvsp[-3].match_opt_validate)->drop ? VAL_DROP : VAL_LOG;
 		}
 		/* add destinations to the chain */
@@ -2387,11 +2818,11 @@ yyreduce:
 			}
 		}
 	 }
-#line 2391 "conffile.tab.c"
+#line 2822 "conffile.tab.c"
     break;
 
-  case 59: /* match_exprs: '*'  */
-#line 583 "conffile.y"
+  case 90: /* match_exprs: '*'  */
+#line 829 "conffile.y"
                    {
 			if (((yyval.match_exprs) = ra_malloc(palloc, sizeof(struct _maexpr))) == NULL) {
 				logerr("out of memory\n");
@@ -2403,35 +2834,35 @@ yyreduce:
 			(yyval.match_exprs)->drop = 0;
 			(yyval.match_exprs)->next = NULL;
 		   }
-#line 2407 "conffile.tab.c"
+#line 2838 "conffile.tab.c"
     break;
 
-  case 60: /* match_exprs: match_exprs2  */
-#line 594 "conffile.y"
+  case 91: /* match_exprs: match_exprs2  */
+#line 840 "conffile.y"
                                   { (yyval.match_exprs) = (yyvsp[0].match_exprs2); }
-#line 2413 "conffile.tab.c"
+#line 2844 "conffile.tab.c"
     break;
 
-  case 61: /* match_exprs2: match_expr match_opt_expr  */
-#line 597 "conffile.y"
+  case 92: /* match_exprs2: match_expr match_opt_expr  */
+#line 843 "conffile.y"
                                               { (yyvsp[-1].match_expr)->next = (yyvsp[0].match_opt_expr); (yyval.match_exprs2) = (yyvsp[-1].match_expr); }
-#line 2419 "conffile.tab.c"
+#line 2850 "conffile.tab.c"
     break;
 
-  case 62: /* match_opt_expr: %empty  */
-#line 599 "conffile.y"
+  case 93: /* match_opt_expr: %empty  */
+#line 845 "conffile.y"
                              { (yyval.match_opt_expr) = NULL; }
-#line 2425 "conffile.tab.c"
+#line 2856 "conffile.tab.c"
     break;
 
-  case 63: /* match_opt_expr: match_exprs2  */
-#line 600 "conffile.y"
+  case 94: /* match_opt_expr: match_exprs2  */
+#line 846 "conffile.y"
                                          { (yyval.match_opt_expr) = (yyvsp[0].match_exprs2); }
-#line 2431 "conffile.tab.c"
+#line 2862 "conffile.tab.c"
     break;
 
-  case 64: /* match_expr: crSTRING  */
-#line 604 "conffile.y"
+  case 95: /* match_expr: crSTRING  */
+#line 850 "conffile.y"
                   {
 			char *err;
 			if (((yyval.match_expr) = ra_malloc(palloc, sizeof(struct _maexpr))) == NULL) {
@@ -2448,17 +2879,17 @@ yyreduce:
 			(yyval.match_expr)->drop = 0;
 			(yyval.match_expr)->next = NULL;
 		  }
-#line 2452 "conffile.tab.c"
+#line 2883 "conffile.tab.c"
     break;
 
-  case 65: /* match_opt_validate: %empty  */
-#line 622 "conffile.y"
+  case 96: /* match_opt_validate: %empty  */
+#line 868 "conffile.y"
                     { (yyval.match_opt_validate) = NULL; }
-#line 2458 "conffile.tab.c"
+#line 2889 "conffile.tab.c"
     break;
 
-  case 66: /* match_opt_validate: crVALIDATE crSTRING crELSE match_log_or_drop  */
-#line 624 "conffile.y"
+  case 97: /* match_opt_validate: crVALIDATE crSTRING crELSE match_log_or_drop  */
+#line 870 "conffile.y"
                                   {
 					char *err;
 					if (((yyval.match_opt_validate) = ra_malloc(palloc, sizeof(struct _maexpr))) == NULL) {
@@ -2475,53 +2906,125 @@ yyreduce:
 					(yyval.match_opt_validate)->drop = (yyvsp[0].match_log_or_drop);
 					(yyval.match_opt_validate)->next = NULL;
 				  }
-#line 2479 "conffile.tab.c"
+#line 2910 "conffile.tab.c"
+    break;
+
+  case 98: /* match_opt_validate: crVALIDATE match_validators crELSE match_log_or_drop  */
+#line 888 "conffile.y"
+                                  {
+					if (((yyval.match_opt_validate) = ra_malloc(palloc, sizeof(struct _maexpr))) == NULL) {
+						logerr("out of memory\n");
+						YYABORT;
+					}
+					(yyval.match_opt_validate)->r = NULL;
+					(yyval.match_opt_validate)->checks = (yyvsp[-2].match_validators).checks;
+					(yyval.match_opt_validate)->tsdrift = (yyvsp[-2].match_validators).tsdrift;
+					(yyval.match_opt_validate)->drop = (yyvsp[0].match_log_or_drop);
+					(yyval.match_opt_validate)->next = NULL;
+				  }
+#line 2926 "conffile.tab.c"
     break;
 
-  case 67: /* match_log_or_drop: crLOG  */
-#line 642 "conffile.y"
+  case 99: /* match_validators: match_validator  */
+#line 901 "conffile.y"
+                                     { (yyval.match_validators) = (yyvsp[0].match_validator); }
+#line 2932 "conffile.tab.c"
+    break;
+
+  case 100: /* match_validators: match_validators match_validator  */
+#line 903 "conffile.y"
+                                {
+					(yyval.match_validators).checks = (yyvsp[-1].match_validators).checks | (yyvsp[0].match_validator).checks;
+					(yyval.match_validators).tsdrift = (yyvsp[0].match_validator).tsdrift != 0 ? (yyvsp[0].match_validator).tsdrift : (yyvsp[-1].match_validators).tsdrift;
+				}
+#line 2941 "conffile.tab.c"
+    break;
+
+  case 101: /* match_validator: crNUMERIC  */
+#line 910 "conffile.y"
+                           {
+				(yyval.match_validator).checks = VAL_NUMERIC;
+				(yyval.match_validator).tsdrift = 0;
+			   }
+#line 2950 "conffile.tab.c"
+    break;
+
+  case 102: /* match_validator: crFINITE  */
+#line 915 "conffile.y"
+                           {
+				(yyval.match_validator).checks = VAL_NUMERIC | VAL_FINITE;
+				(yyval.match_validator).tsdrift = 0;
+			   }
+#line 2959 "conffile.tab.c"
+    break;
+
+  case 103: /* match_validator: crTIMESTAMP  */
+#line 920 "conffile.y"
+                           {
+				(yyval.match_validator).checks = VAL_TIMESTAMP;
+				(yyval.match_validator).tsdrift = 0;
+			   }
+#line 2968 "conffile.tab.c"
+    break;
+
+  case 104: /* match_validator: crTIMESTAMP crWITHIN crINTVAL crSECONDS  */
+#line 925 "conffile.y"
+                           {
+				if ((yyvsp[-1].crINTVAL) <= 0) {
+					router_yyerror(&yylloc, yyscanner, rtr,
+						ralloc, palloc, "timestamp drift must be >0 seconds");
+					YYERROR;
+				}
+				(yyval.match_validator).checks = VAL_TIMESTAMP | VAL_TSDRIFT;
+				(yyval.match_validator).tsdrift = (unsigned int)(yyvsp[-1].crINTVAL);
+			   }
+#line 2982 "conffile.tab.c"
+    break;
+
+  case 105: /* match_log_or_drop: crLOG  */
+#line 936 "conffile.y"
                           { (yyval.match_log_or_drop) = 0; }
-#line 2485 "conffile.tab.c"
+#line 2988 "conffile.tab.c"
     break;
 
-  case 68: /* match_log_or_drop: crDROP  */
-#line 643 "conffile.y"
+  case 106: /* match_log_or_drop: crDROP  */
+#line 937 "conffile.y"
                                           { (yyval.match_log_or_drop) = 1; }
-#line 2491 "conffile.tab.c"
+#line 2994 "conffile.tab.c"
     break;
 
-  case 69: /* match_opt_route: %empty  */
-#line 646 "conffile.y"
+  case 107: /* match_opt_route: %empty  */
+#line 940 "conffile.y"
                  { (yyval.match_opt_route) = NULL; }
-#line 2497 "conffile.tab.c"
+#line 3000 "conffile.tab.c"
     break;
 
-  case 70: /* match_opt_route: crROUTE crUSING crSTRING  */
-#line 647 "conffile.y"
+  case 108: /* match_opt_route: crROUTE crUSING crSTRING  */
+#line 941 "conffile.y"
                                                             { (yyval.match_opt_route) = (yyvsp[0].crSTRING); }
-#line 2503 "conffile.tab.c"
+#line 3006 "conffile.tab.c"
     break;
 
-  case 71: /* match_opt_send_to: %empty  */
-#line 650 "conffile.y"
+  case 109: /* match_opt_send_to: %empty  */
+#line 944 "conffile.y"
                    { (yyval.match_opt_send_to) = NULL; }
-#line 2509 "conffile.tab.c"
+#line 3012 "conffile.tab.c"
     break;
 
-  case 72: /* match_opt_send_to: match_send_to  */
-#line 651 "conffile.y"
+  case 110: /* match_opt_send_to: match_send_to  */
+#line 945 "conffile.y"
                                                  { (yyval.match_opt_send_to) = (yyvsp[0].match_send_to); }
-#line 2515 "conffile.tab.c"
+#line 3018 "conffile.tab.c"
     break;
 
-  case 73: /* match_send_to: crSEND crTO match_dsts  */
-#line 654 "conffile.y"
+  case 111: /* match_send_to: crSEND crTO match_dsts  */
+#line 948 "conffile.y"
                                             { (yyval.match_send_to) = (yyvsp[0].match_dsts); }
-#line 2521 "conffile.tab.c"
+#line 3024 "conffile.tab.c"
     break;
 
-  case 74: /* match_dsts: crBLACKHOLE  */
-#line 658 "conffile.y"
+  case 112: /* match_dsts: crBLACKHOLE  */
+#line 952 "conffile.y"
                   {
 			if (((yyval.match_dsts) = ra_malloc(ralloc, sizeof(destinations))) == NULL) {
 				logerr("out of memory\n");
@@ -2531,35 +3034,35 @@ yyreduce:
 				YYABORT;
 			(yyval.match_dsts)->next = NULL;
 		  }
-#line 2535 "conffile.tab.c"
+#line 3038 "conffile.tab.c"
     break;
 
-  case 75: /* match_dsts: match_dsts2  */
-#line 667 "conffile.y"
+  case 113: /* match_dsts: match_dsts2  */
+#line 961 "conffile.y"
                                 { (yyval.match_dsts) = (yyvsp[0].match_dsts2); }
-#line 2541 "conffile.tab.c"
+#line 3044 "conffile.tab.c"
     break;
 
-  case 76: /* match_dsts2: match_dst match_opt_dst  */
-#line 670 "conffile.y"
+  case 114: /* match_dsts2: match_dst match_opt_dst  */
+#line 964 "conffile.y"
                                            { (yyvsp[-1].match_dst)->next = (yyvsp[0].match_opt_dst); (yyval.match_dsts2) = (yyvsp[-1].match_dst); }
-#line 2547 "conffile.tab.c"
+#line 3050 "conffile.tab.c"
     break;
 
-  case 77: /* match_opt_dst: %empty  */
-#line 672 "conffile.y"
+  case 115: /* match_opt_dst: %empty  */
+#line 966 "conffile.y"
                            { (yyval.match_opt_dst) = NULL; }
-#line 2553 "conffile.tab.c"
+#line 3056 "conffile.tab.c"
     break;
 
-  case 78: /* match_opt_dst: match_dsts2  */
-#line 673 "conffile.y"
+  case 116: /* match_opt_dst: match_dsts2  */
+#line 967 "conffile.y"
                                        { (yyval.match_opt_dst) = (yyvsp[0].match_dsts2); }
-#line 2559 "conffile.tab.c"
+#line 3062 "conffile.tab.c"
     break;
 
-  case 79: /* match_dst: crSTRING  */
-#line 677 "conffile.y"
+  case 117: /* match_dst: crSTRING  */
+#line 971 "conffile.y"
                  {
 			char *err;
 			if (((yyval.match_dst) = ra_malloc(ralloc, sizeof(destinations))) == NULL) {
@@ -2573,23 +3076,23 @@ yyreduce:
 			}
 			(yyval.match_dst)->next = NULL;
 		 }
-#line 2577 "conffile.tab.c"
+#line 3080 "conffile.tab.c"
     break;
 
-  case 80: /* match_opt_stop: %empty  */
-#line 692 "conffile.y"
+  case 118: /* match_opt_stop: %empty  */
+#line 986 "conffile.y"
                        { (yyval.match_opt_stop) = 0; }
-#line 2583 "conffile.tab.c"
+#line 3086 "conffile.tab.c"
     break;
 
-  case 81: /* match_opt_stop: crSTOP  */
-#line 693 "conffile.y"
+  case 119: /* match_opt_stop: crSTOP  */
+#line 987 "conffile.y"
                                    { (yyval.match_opt_stop) = 1; }
-#line 2589 "conffile.tab.c"
+#line 3092 "conffile.tab.c"
     break;
 
-  case 82: /* rewrite: crREWRITE crSTRING crINTO crSTRING  */
-#line 699 "conffile.y"
+  case 120: /* rewrite: crREWRITE crSTRING crINTO crSTRING  */
+#line 993 "conffile.y"
            {
 		char *err;
 		route *r = NULL;
@@ -2630,11 +3133,11 @@ yyreduce:
 			YYERROR;
 		}
 	   }
-#line 2634 "conffile.tab.c"
+#line 3137 "conffile.tab.c"
     break;
 
-  case 83: /* aggregate: crAGGREGATE match_exprs2 crEVERY crINTVAL crSECONDS crEXPIRE crAFTER crINTVAL crSECONDS aggregate_opt_timestamp aggregate_computes aggregate_opt_send_to match_opt_stop  */
-#line 749 "conffile.y"
+  case 121: /* aggregate: crAGGREGATE match_exprs2 crEVERY crINTVAL crSECONDS crEXPIRE crAFTER crINTVAL crSECONDS aggregate_opt_timestamp aggregate_computes aggregate_opt_send_to match_opt_stop  */
+#line 1043 "conffile.y"
                  {
 		 	cluster *w;
 			aggregator *a;
@@ -2718,59 +3221,59 @@ yyreduce:
 			if ((yyvsp[-1].aggregate_opt_send_to) != NULL)
 				router_add_stubroute(rtr, AGGRSTUB, w, (yyvsp[-1].aggregate_opt_send_to));
 		 }
-#line 2722 "conffile.tab.c"
+#line 3225 "conffile.tab.c"
     break;
 
-  case 84: /* aggregate_opt_timestamp: %empty  */
-#line 834 "conffile.y"
+  case 122: /* aggregate_opt_timestamp: %empty  */
+#line 1128 "conffile.y"
                          { (yyval.aggregate_opt_timestamp) = TS_END; }
-#line 2728 "conffile.tab.c"
+#line 3231 "conffile.tab.c"
     break;
 
-  case 85: /* aggregate_opt_timestamp: crTIMESTAMP crAT aggregate_ts_when crOF crBUCKET  */
-#line 837 "conffile.y"
+  case 123: /* aggregate_opt_timestamp: crTIMESTAMP crAT aggregate_ts_when crOF crBUCKET  */
+#line 1131 "conffile.y"
                                            { (yyval.aggregate_opt_timestamp) = (yyvsp[-2].aggregate_ts_when); }
-#line 2734 "conffile.tab.c"
+#line 3237 "conffile.tab.c"
     break;
 
-  case 86: /* aggregate_ts_when: crSTART  */
-#line 840 "conffile.y"
+  case 124: /* aggregate_ts_when: crSTART  */
+#line 1134 "conffile.y"
                             { (yyval.aggregate_ts_when) = TS_START; }
-#line 2740 "conffile.tab.c"
+#line 3243 "conffile.tab.c"
     break;
 
-  case 87: /* aggregate_ts_when: crMIDDLE  */
-#line 841 "conffile.y"
+  case 125: /* aggregate_ts_when: crMIDDLE  */
+#line 1135 "conffile.y"
                                             { (yyval.aggregate_ts_when) = TS_MIDDLE; }
-#line 2746 "conffile.tab.c"
+#line 3249 "conffile.tab.c"
     break;
 
-  case 88: /* aggregate_ts_when: crEND  */
-#line 842 "conffile.y"
+  case 126: /* aggregate_ts_when: crEND  */
+#line 1136 "conffile.y"
                                             { (yyval.aggregate_ts_when) = TS_END; }
-#line 2752 "conffile.tab.c"
+#line 3255 "conffile.tab.c"
     break;
 
-  case 89: /* aggregate_computes: aggregate_compute aggregate_opt_compute  */
-#line 846 "conffile.y"
+  case 127: /* aggregate_computes: aggregate_compute aggregate_opt_compute  */
+#line 1140 "conffile.y"
                                   { (yyvsp[-1].aggregate_compute)->next = (yyvsp[0].aggregate_opt_compute); (yyval.aggregate_computes) = (yyvsp[-1].aggregate_compute); }
-#line 2758 "conffile.tab.c"
+#line 3261 "conffile.tab.c"
     break;
 
-  case 90: /* aggregate_opt_compute: %empty  */
-#line 849 "conffile.y"
+  case 128: /* aggregate_opt_compute: %empty  */
+#line 1143 "conffile.y"
                                           { (yyval.aggregate_opt_compute) = NULL; }
-#line 2764 "conffile.tab.c"
+#line 3267 "conffile.tab.c"
     break;
 
-  case 91: /* aggregate_opt_compute: aggregate_computes  */
-#line 850 "conffile.y"
+  case 129: /* aggregate_opt_compute: aggregate_computes  */
+#line 1144 "conffile.y"
                                                               { (yyval.aggregate_opt_compute) = (yyvsp[0].aggregate_computes); }
-#line 2770 "conffile.tab.c"
+#line 3273 "conffile.tab.c"
     break;
 
-  case 92: /* aggregate_compute: crCOMPUTE aggregate_comp_type crWRITE crTO crSTRING  */
-#line 854 "conffile.y"
+  case 130: /* aggregate_compute: crCOMPUTE aggregate_comp_type crWRITE crTO crSTRING  */
+#line 1148 "conffile.y"
                                  {
 					(yyval.aggregate_compute) = ra_malloc(palloc, sizeof(struct _agcomp));
 					if ((yyval.aggregate_compute) == NULL) {
@@ -2782,47 +3285,47 @@ yyreduce:
 					(yyval.aggregate_compute)->metric = (yyvsp[0].crSTRING);
 					(yyval.aggregate_compute)->next = NULL;
 				 }
-#line 2786 "conffile.tab.c"
+#line 3289 "conffile.tab.c"
     break;
 
-  case 93: /* aggregate_comp_type: crSUM  */
-#line 867 "conffile.y"
+  case 131: /* aggregate_comp_type: crSUM  */
+#line 1161 "conffile.y"
                                   { (yyval.aggregate_comp_type).ctype = SUM; }
-#line 2792 "conffile.tab.c"
+#line 3295 "conffile.tab.c"
     break;
 
-  case 94: /* aggregate_comp_type: crCOUNT  */
-#line 868 "conffile.y"
+  case 132: /* aggregate_comp_type: crCOUNT  */
+#line 1162 "conffile.y"
                                                   { (yyval.aggregate_comp_type).ctype = CNT; }
-#line 2798 "conffile.tab.c"
+#line 3301 "conffile.tab.c"
     break;
 
-  case 95: /* aggregate_comp_type: crMAX  */
-#line 869 "conffile.y"
+  case 133: /* aggregate_comp_type: crMAX  */
+#line 1163 "conffile.y"
                                                   { (yyval.aggregate_comp_type).ctype = MAX; }
-#line 2804 "conffile.tab.c"
+#line 3307 "conffile.tab.c"
     break;
 
-  case 96: /* aggregate_comp_type: crMIN  */
-#line 870 "conffile.y"
+  case 134: /* aggregate_comp_type: crMIN  */
+#line 1164 "conffile.y"
                                                   { (yyval.aggregate_comp_type).ctype = MIN; }
-#line 2810 "conffile.tab.c"
+#line 3313 "conffile.tab.c"
     break;
 
-  case 97: /* aggregate_comp_type: crAVERAGE  */
-#line 871 "conffile.y"
+  case 135: /* aggregate_comp_type: crAVERAGE  */
+#line 1165 "conffile.y"
                                                   { (yyval.aggregate_comp_type).ctype = AVG; }
-#line 2816 "conffile.tab.c"
+#line 3319 "conffile.tab.c"
     break;
 
-  case 98: /* aggregate_comp_type: crMEDIAN  */
-#line 872 "conffile.y"
+  case 136: /* aggregate_comp_type: crMEDIAN  */
+#line 1166 "conffile.y"
                                                   { (yyval.aggregate_comp_type).ctype = MEDN; }
-#line 2822 "conffile.tab.c"
+#line 3325 "conffile.tab.c"
     break;
 
-  case 99: /* aggregate_comp_type: crPERCENTILE  */
-#line 874 "conffile.y"
+  case 137: /* aggregate_comp_type: crPERCENTILE  */
+#line 1168 "conffile.y"
                                    {
 				    if ((yyvsp[0].crPERCENTILE) < 1 || (yyvsp[0].crPERCENTILE) > 99) {
 						router_yyerror(&yylloc, yyscanner, rtr, ralloc, palloc,
@@ -2832,35 +3335,35 @@ yyreduce:
 				   	(yyval.aggregate_comp_type).ctype = PCTL;
 					(yyval.aggregate_comp_type).pctl = (unsigned char)(yyvsp[0].crPERCENTILE);
 				   }
-#line 2836 "conffile.tab.c"
+#line 3339 "conffile.tab.c"
     break;
 
-  case 100: /* aggregate_comp_type: crVARIANCE  */
-#line 883 "conffile.y"
+  case 138: /* aggregate_comp_type: crVARIANCE  */
+#line 1177 "conffile.y"
                                                   { (yyval.aggregate_comp_type).ctype = VAR; }
-#line 2842 "conffile.tab.c"
+#line 3345 "conffile.tab.c"
     break;
 
-  case 101: /* aggregate_comp_type: crSTDDEV  */
-#line 884 "conffile.y"
+  case 139: /* aggregate_comp_type: crSTDDEV  */
+#line 1178 "conffile.y"
                                                   { (yyval.aggregate_comp_type).ctype = SDEV; }
-#line 2848 "conffile.tab.c"
+#line 3351 "conffile.tab.c"
     break;
 
-  case 102: /* aggregate_opt_send_to: %empty  */
-#line 887 "conffile.y"
+  case 140: /* aggregate_opt_send_to: %empty  */
+#line 1181 "conffile.y"
                                      { (yyval.aggregate_opt_send_to) = NULL; }
-#line 2854 "conffile.tab.c"
+#line 3357 "conffile.tab.c"
     break;
 
-  case 103: /* aggregate_opt_send_to: match_send_to  */
-#line 888 "conffile.y"
+  case 141: /* aggregate_opt_send_to: match_send_to  */
+#line 1182 "conffile.y"
                                                          { (yyval.aggregate_opt_send_to) = (yyvsp[0].match_send_to); }
-#line 2860 "conffile.tab.c"
+#line 3363 "conffile.tab.c"
     break;
 
-  case 104: /* send: crSEND crSTATISTICS crTO match_dsts match_opt_stop  */
-#line 894 "conffile.y"
+  case 142: /* send: crSEND crSTATISTICS crTO match_dsts match_opt_stop  */
+#line 1188 "conffile.y"
         {
 		char *err = router_set_statistics(rtr, (yyvsp[-1].match_dsts));
 		if (err != NULL) {
@@ -2871,11 +3374,11 @@ yyreduce:
 				"removed in a future version, use 'statistics send to ...' "
 				"instead\n");
 	}
-#line 2875 "conffile.tab.c"
+#line 3378 "conffile.tab.c"
     break;
 
-  case 105: /* statistics: crSTATISTICS statistics_opt_interval statistics_opt_counters statistics_opt_prefix aggregate_opt_send_to match_opt_stop  */
-#line 914 "conffile.y"
+  case 143: /* statistics: crSTATISTICS statistics_opt_interval statistics_opt_counters statistics_opt_prefix aggregate_opt_send_to match_opt_stop  */
+#line 1208 "conffile.y"
                   {
 		  	char *err;
 		  	err = router_set_collectorvals(rtr, (yyvsp[-4].statistics_opt_interval), (yyvsp[-2].statistics_opt_prefix), (yyvsp[-3].statistics_opt_counters));
@@ -2893,17 +3396,17 @@ yyreduce:
 				}
 			}
 		  }
-#line 2897 "conffile.tab.c"
+#line 3400 "conffile.tab.c"
     break;
 
-  case 106: /* statistics_opt_interval: %empty  */
-#line 933 "conffile.y"
+  case 144: /* statistics_opt_interval: %empty  */
+#line 1227 "conffile.y"
                          { (yyval.statistics_opt_interval) = -1; }
-#line 2903 "conffile.tab.c"
+#line 3406 "conffile.tab.c"
     break;
 
-  case 107: /* statistics_opt_interval: crSUBMIT crEVERY crINTVAL crSECONDS  */
-#line 935 "conffile.y"
+  case 145: /* statistics_opt_interval: crSUBMIT crEVERY crINTVAL crSECONDS  */
+#line 1229 "conffile.y"
                                            {
 					   	if ((yyvsp[-1].crINTVAL) <= 0) {
 							router_yyerror(&yylloc, yyscanner, rtr,
@@ -2912,35 +3415,35 @@ yyreduce:
 						}
 						(yyval.statistics_opt_interval) = (yyvsp[-1].crINTVAL);
 					   }
-#line 2916 "conffile.tab.c"
+#line 3419 "conffile.tab.c"
     break;
 
-  case 108: /* statistics_opt_counters: %empty  */
-#line 945 "conffile.y"
+  case 146: /* statistics_opt_counters: %empty  */
+#line 1239 "conffile.y"
                                                                { (yyval.statistics_opt_counters) = CUM; }
-#line 2922 "conffile.tab.c"
+#line 3425 "conffile.tab.c"
     break;
 
-  case 109: /* statistics_opt_counters: crRESET crCOUNTERS crAFTER crINTERVAL  */
-#line 946 "conffile.y"
+  case 147: /* statistics_opt_counters: crRESET crCOUNTERS crAFTER crINTERVAL  */
+#line 1240 "conffile.y"
                                                                                    { (yyval.statistics_opt_counters) = SUB; }
-#line 2928 "conffile.tab.c"
+#line 3431 "conffile.tab.c"
     break;
 
-  case 110: /* statistics_opt_prefix: %empty  */
-#line 949 "conffile.y"
+  case 148: /* statistics_opt_prefix: %empty  */
+#line 1243 "conffile.y"
                                                         { (yyval.statistics_opt_prefix) = NULL; }
-#line 2934 "conffile.tab.c"
+#line 3437 "conffile.tab.c"
     break;
 
-  case 111: /* statistics_opt_prefix: crPREFIX crWITH crSTRING  */
-#line 950 "conffile.y"
+  case 149: /* statistics_opt_prefix: crPREFIX crWITH crSTRING  */
+#line 1244 "conffile.y"
                                                                             { (yyval.statistics_opt_prefix) = (yyvsp[0].crSTRING); }
-#line 2940 "conffile.tab.c"
+#line 3443 "conffile.tab.c"
     break;
 
-  case 112: /* listen: crLISTEN listener  */
-#line 956 "conffile.y"
+  case 150: /* listen: crLISTEN listener  */
+#line 1250 "conffile.y"
           {
 	  	struct _rcptr *walk;
 		char *err;
@@ -2970,19 +3473,30 @@ yyreduce:
 			}
 		}
 	  }
-#line 2974 "conffile.tab.c"
+#line 3477 "conffile.tab.c"
     break;
 
-  case 113: /* listener: crTYPE crLINEMODE transport_mode receptors  */
-#line 988 "conffile.y"
+  case 151: /* listener: crTYPE listener_type transport_mode receptors  */
+#line 1282 "conffile.y"
                 {
 			if (((yyval.listener) = ra_malloc(palloc, sizeof(struct _lsnr))) == NULL) {
 				logerr("malloc failed\n");
 				YYABORT;
 			}
-			(yyval.listener)->type = T_LINEMODE;
+			(yyval.listener)->type = (yyvsp[-2].listener_type);
 			(yyval.listener)->transport = (yyvsp[-1].transport_mode);
 			(yyval.listener)->rcptr = (yyvsp[0].receptors);
+			if ((yyvsp[-2].listener_type) == T_PICKLE) {
+				struct _rcptr *walk;
+
+				for (walk = (yyvsp[0].receptors); walk != NULL; walk = walk->next) {
+					if (walk->ctype == CON_UDP) {
+						router_yyerror(&yylloc, yyscanner, rtr, ralloc, palloc,
+							"cannot use UDP transport for pickle type");
+						YYERROR;
+					}
+				}
+			}
 			if ((yyvsp[-1].transport_mode)->mode != W_PLAIN) {
 				struct _rcptr *walk;
 
@@ -2996,31 +3510,43 @@ yyreduce:
 				}
 			}
 		}
-#line 3000 "conffile.tab.c"
+#line 3514 "conffile.tab.c"
+    break;
+
+  case 152: /* listener_type: crLINEMODE  */
+#line 1316 "conffile.y"
+                           { (yyval.listener_type) = T_LINEMODE; }
+#line 3520 "conffile.tab.c"
+    break;
+
+  case 153: /* listener_type: crPICKLE  */
+#line 1317 "conffile.y"
+                                       { (yyval.listener_type) = T_PICKLE;   }
+#line 3526 "conffile.tab.c"
     break;
 
-  case 114: /* transport_ssl_or_mtls: crSSL  */
-#line 1011 "conffile.y"
+  case 154: /* transport_ssl_or_mtls: crSSL  */
+#line 1320 "conffile.y"
                                { (yyval.transport_ssl_or_mtls) = W_SSL;          }
-#line 3006 "conffile.tab.c"
+#line 3532 "conffile.tab.c"
     break;
 
-  case 115: /* transport_ssl_or_mtls: crMTLS  */
-#line 1012 "conffile.y"
+  case 155: /* transport_ssl_or_mtls: crMTLS  */
+#line 1321 "conffile.y"
                                                    { (yyval.transport_ssl_or_mtls) = W_SSL | W_MTLS; }
-#line 3012 "conffile.tab.c"
+#line 3538 "conffile.tab.c"
     break;
 
-  case 116: /* transport_opt_ssl: %empty  */
-#line 1015 "conffile.y"
+  case 156: /* transport_opt_ssl: %empty  */
+#line 1324 "conffile.y"
                                  {
 				 	(yyval.transport_opt_ssl) = NULL;
 				 }
-#line 3020 "conffile.tab.c"
+#line 3546 "conffile.tab.c"
     break;
 
-  case 117: /* transport_opt_ssl: transport_ssl_or_mtls crSTRING transport_opt_ssl_protos transport_opt_ssl_ciphers transport_opt_ssl_ciphersuites  */
-#line 1022 "conffile.y"
+  case 157: /* transport_opt_ssl: transport_ssl_or_mtls crSTRING transport_opt_ssl_protos transport_opt_ssl_ciphers transport_opt_ssl_ciphersuites  */
+#line 1331 "conffile.y"
                                  {
 #ifdef HAVE_SSL
 					if (((yyval.transport_opt_ssl) = ra_malloc(palloc,
@@ -3041,27 +3567,27 @@ yyreduce:
 					YYERROR;
 #endif
 				 }
-#line 3045 "conffile.tab.c"
+#line 3571 "conffile.tab.c"
     break;
 
-  case 118: /* transport_opt_ssl_protos: %empty  */
-#line 1044 "conffile.y"
+  case 158: /* transport_opt_ssl_protos: %empty  */
+#line 1353 "conffile.y"
                                                 {
 							(yyval.transport_opt_ssl_protos) = NULL;
 						}
-#line 3053 "conffile.tab.c"
+#line 3579 "conffile.tab.c"
     break;
 
-  case 119: /* transport_opt_ssl_protos: transport_ssl_proto transport_opt_ssl_protos  */
-#line 1048 "conffile.y"
+  case 159: /* transport_opt_ssl_protos: transport_ssl_proto transport_opt_ssl_protos  */
+#line 1357 "conffile.y"
                                                 {
 							(yyvsp[-1].transport_ssl_proto)->next = (yyvsp[0].transport_opt_ssl_protos); (yyval.transport_opt_ssl_protos) = (yyvsp[-1].transport_ssl_proto);
 						}
-#line 3061 "conffile.tab.c"
+#line 3587 "conffile.tab.c"
     break;
 
-  case 120: /* transport_ssl_proto: transport_ssl_prototype transport_ssl_protover  */
-#line 1053 "conffile.y"
+  case 160: /* transport_ssl_proto: transport_ssl_prototype transport_ssl_protover  */
+#line 1362 "conffile.y"
                                    {
 						if (((yyval.transport_ssl_proto) = ra_malloc(palloc,
 								sizeof(struct _rcptr_sslprotos))) == NULL)
@@ -3073,77 +3599,77 @@ yyreduce:
 						(yyval.transport_ssl_proto)->prver = (yyvsp[0].transport_ssl_protover);
 						(yyval.transport_ssl_proto)->next = NULL;
 				   }
-#line 3077 "conffile.tab.c"
+#line 3603 "conffile.tab.c"
     break;
 
-  case 121: /* transport_ssl_prototype: crPROTOMIN  */
-#line 1065 "conffile.y"
+  case 161: /* transport_ssl_prototype: crPROTOMIN  */
+#line 1374 "conffile.y"
                                      { (yyval.transport_ssl_prototype) = _rp_PROTOMIN; }
-#line 3083 "conffile.tab.c"
+#line 3609 "conffile.tab.c"
     break;
 
-  case 122: /* transport_ssl_prototype: crPROTOMAX  */
-#line 1066 "conffile.y"
+  case 162: /* transport_ssl_prototype: crPROTOMAX  */
+#line 1375 "conffile.y"
                                                          { (yyval.transport_ssl_prototype) = _rp_PROTOMAX; }
-#line 3089 "conffile.tab.c"
+#line 3615 "conffile.tab.c"
     break;
 
-  case 123: /* transport_ssl_protover: crSSL3  */
-#line 1068 "conffile.y"
+  case 163: /* transport_ssl_protover: crSSL3  */
+#line 1377 "conffile.y"
                                   { (yyval.transport_ssl_protover) = _rp_SSL3;   }
-#line 3095 "conffile.tab.c"
+#line 3621 "conffile.tab.c"
     break;
 
-  case 124: /* transport_ssl_protover: crTLS1_0  */
-#line 1069 "conffile.y"
+  case 164: /* transport_ssl_protover: crTLS1_0  */
+#line 1378 "conffile.y"
                                                       { (yyval.transport_ssl_protover) = _rp_TLS1_0; }
-#line 3101 "conffile.tab.c"
+#line 3627 "conffile.tab.c"
     break;
 
-  case 125: /* transport_ssl_protover: crTLS1_1  */
-#line 1070 "conffile.y"
+  case 165: /* transport_ssl_protover: crTLS1_1  */
+#line 1379 "conffile.y"
                                                       { (yyval.transport_ssl_protover) = _rp_TLS1_1; }
-#line 3107 "conffile.tab.c"
+#line 3633 "conffile.tab.c"
     break;
 
-  case 126: /* transport_ssl_protover: crTLS1_2  */
-#line 1071 "conffile.y"
+  case 166: /* transport_ssl_protover: crTLS1_2  */
+#line 1380 "conffile.y"
                                                       { (yyval.transport_ssl_protover) = _rp_TLS1_2; }
-#line 3113 "conffile.tab.c"
+#line 3639 "conffile.tab.c"
     break;
 
-  case 127: /* transport_ssl_protover: crTLS1_3  */
-#line 1072 "conffile.y"
+  case 167: /* transport_ssl_protover: crTLS1_3  */
+#line 1381 "conffile.y"
                                                       { (yyval.transport_ssl_protover) = _rp_TLS1_3; }
-#line 3119 "conffile.tab.c"
+#line 3645 "conffile.tab.c"
     break;
 
-  case 128: /* transport_opt_ssl_ciphers: %empty  */
-#line 1075 "conffile.y"
+  case 168: /* transport_opt_ssl_ciphers: %empty  */
+#line 1384 "conffile.y"
                                                  { (yyval.transport_opt_ssl_ciphers) = NULL; }
-#line 3125 "conffile.tab.c"
+#line 3651 "conffile.tab.c"
     break;
 
-  case 129: /* transport_opt_ssl_ciphers: crCIPHERS crSTRING  */
-#line 1077 "conffile.y"
+  case 169: /* transport_opt_ssl_ciphers: crCIPHERS crSTRING  */
+#line 1386 "conffile.y"
                                                  { (yyval.transport_opt_ssl_ciphers) = ra_strdup(ralloc, (yyvsp[0].crSTRING)); }
-#line 3131 "conffile.tab.c"
+#line 3657 "conffile.tab.c"
     break;
 
-  case 130: /* transport_opt_ssl_ciphersuites: %empty  */
-#line 1080 "conffile.y"
+  case 170: /* transport_opt_ssl_ciphersuites: %empty  */
+#line 1389 "conffile.y"
                                                           { (yyval.transport_opt_ssl_ciphersuites) = NULL; }
-#line 3137 "conffile.tab.c"
+#line 3663 "conffile.tab.c"
     break;
 
-  case 131: /* transport_opt_ssl_ciphersuites: crCIPHERSUITES crSTRING  */
-#line 1082 "conffile.y"
+  case 171: /* transport_opt_ssl_ciphersuites: crCIPHERSUITES crSTRING  */
+#line 1391 "conffile.y"
                                                           { (yyval.transport_opt_ssl_ciphersuites) = ra_strdup(ralloc, (yyvsp[0].crSTRING)); }
-#line 3143 "conffile.tab.c"
+#line 3669 "conffile.tab.c"
     break;
 
-  case 132: /* transport_mode_trans: crTRANSPORT crPLAIN  */
-#line 1086 "conffile.y"
+  case 172: /* transport_mode_trans: crTRANSPORT crPLAIN  */
+#line 1395 "conffile.y"
                                         {
 						if (((yyval.transport_mode_trans) = ra_malloc(palloc,
 								sizeof(struct _rcptr_trsp))) == NULL)
@@ -3153,11 +3679,11 @@ yyreduce:
 						}
 						(yyval.transport_mode_trans)->mode = W_PLAIN;
 					}
-#line 3157 "conffile.tab.c"
+#line 3683 "conffile.tab.c"
     break;
 
-  case 133: /* transport_mode_trans: crTRANSPORT crGZIP  */
-#line 1096 "conffile.y"
+  case 173: /* transport_mode_trans: crTRANSPORT crGZIP  */
+#line 1405 "conffile.y"
                                         {
 #ifdef HAVE_GZIP
 						if (((yyval.transport_mode_trans) = ra_malloc(palloc,
@@ -3174,11 +3700,11 @@ yyreduce:
 						YYERROR;
 #endif
 					}
-#line 3178 "conffile.tab.c"
+#line 3704 "conffile.tab.c"
     break;
 
-  case 134: /* transport_mode_trans: crTRANSPORT crLZ4  */
-#line 1113 "conffile.y"
+  case 174: /* transport_mode_trans: crTRANSPORT crLZ4  */
+#line 1422 "conffile.y"
                                         {
 #ifdef HAVE_LZ4
 						if (((yyval.transport_mode_trans) = ra_malloc(palloc,
@@ -3195,11 +3721,11 @@ yyreduce:
 						YYERROR;
 #endif
 					}
-#line 3199 "conffile.tab.c"
+#line 3725 "conffile.tab.c"
     break;
 
-  case 135: /* transport_mode_trans: crTRANSPORT crSNAPPY  */
-#line 1130 "conffile.y"
+  case 175: /* transport_mode_trans: crTRANSPORT crSNAPPY  */
+#line 1439 "conffile.y"
                                         {
 #ifdef HAVE_SNAPPY
 						if (((yyval.transport_mode_trans) = ra_malloc(palloc,
@@ -3216,11 +3742,32 @@ yyreduce:
 						YYERROR;
 #endif
 					}
-#line 3220 "conffile.tab.c"
+#line 3746 "conffile.tab.c"
     break;
 
-  case 136: /* transport_mode: %empty  */
-#line 1149 "conffile.y"
+  case 176: /* transport_mode_trans: crTRANSPORT crZSTD  */
+#line 1456 "conffile.y"
+                                        {
+#ifdef HAVE_ZSTD
+						if (((yyval.transport_mode_trans) = ra_malloc(palloc,
+								sizeof(struct _rcptr_trsp))) == NULL)
+						{
+							logerr("malloc failed\n");
+							YYABORT;
+						}
+						(yyval.transport_mode_trans)->mode = W_ZSTD;
+#else
+						router_yyerror(&yylloc, yyscanner, rtr,
+							ralloc, palloc,
+							"feature zstd not compiled in");
+						YYERROR;
+#endif
+					}
+#line 3767 "conffile.tab.c"
+    break;
+
+  case 177: /* transport_mode: %empty  */
+#line 1475 "conffile.y"
                           { 
 				if (((yyval.transport_mode) = ra_malloc(palloc,
 						sizeof(struct _rcptr_trsp))) == NULL)
@@ -3230,11 +3777,11 @@ yyreduce:
 				}
 				(yyval.transport_mode)->mode = W_PLAIN;
 			  }
-#line 3234 "conffile.tab.c"
+#line 3781 "conffile.tab.c"
     break;
 
-  case 137: /* transport_mode: transport_mode_trans transport_opt_ssl  */
-#line 1159 "conffile.y"
+  case 178: /* transport_mode: transport_mode_trans transport_opt_ssl  */
+#line 1485 "conffile.y"
                           {
 			  	if ((yyvsp[0].transport_opt_ssl) == NULL) {
 					(yyval.transport_mode) = (yyvsp[-1].transport_mode_trans);
@@ -3243,29 +3790,29 @@ yyreduce:
 					(yyval.transport_mode)->mode |= (yyvsp[-1].transport_mode_trans)->mode;
 				}
 			  }
-#line 3247 "conffile.tab.c"
+#line 3794 "conffile.tab.c"
     break;
 
-  case 138: /* receptors: receptor opt_receptor  */
-#line 1169 "conffile.y"
+  case 179: /* receptors: receptor opt_receptor  */
+#line 1495 "conffile.y"
                                        { (yyvsp[-1].receptor)->next = (yyvsp[0].opt_receptor); (yyval.receptors) = (yyvsp[-1].receptor); }
-#line 3253 "conffile.tab.c"
+#line 3800 "conffile.tab.c"
     break;
 
-  case 139: /* opt_receptor: %empty  */
-#line 1172 "conffile.y"
+  case 180: /* opt_receptor: %empty  */
+#line 1498 "conffile.y"
                         { (yyval.opt_receptor) = NULL; }
-#line 3259 "conffile.tab.c"
+#line 3806 "conffile.tab.c"
     break;
 
-  case 140: /* opt_receptor: receptors  */
-#line 1173 "conffile.y"
+  case 181: /* opt_receptor: receptors  */
+#line 1499 "conffile.y"
                                     { (yyval.opt_receptor) = (yyvsp[0].receptors);   }
-#line 3265 "conffile.tab.c"
+#line 3812 "conffile.tab.c"
     break;
 
-  case 141: /* receptor: crSTRING crPROTO rcptr_proto  */
-#line 1177 "conffile.y"
+  case 182: /* receptor: crSTRING crPROTO rcptr_proto  */
+#line 1503 "conffile.y"
                 {
 			char *err;
 			void *hint = NULL;
@@ -3302,11 +3849,11 @@ yyreduce:
 			free(hint);
 			(yyval.receptor)->next = NULL;
 		}
-#line 3306 "conffile.tab.c"
+#line 3853 "conffile.tab.c"
     break;
 
-  case 142: /* receptor: crSTRING crPROTO crUNIX  */
-#line 1214 "conffile.y"
+  case 183: /* receptor: crSTRING crPROTO crUNIX  */
+#line 1540 "conffile.y"
                 {
 			char *err;
 
@@ -3326,32 +3873,32 @@ yyreduce:
 			}
 			(yyval.receptor)->next = NULL;
 		}
-#line 3330 "conffile.tab.c"
+#line 3877 "conffile.tab.c"
     break;
 
-  case 143: /* rcptr_proto: crTCP  */
-#line 1235 "conffile.y"
+  case 184: /* rcptr_proto: crTCP  */
+#line 1561 "conffile.y"
                    { (yyval.rcptr_proto) = CON_TCP; }
-#line 3336 "conffile.tab.c"
+#line 3883 "conffile.tab.c"
     break;
 
-  case 144: /* rcptr_proto: crUDP  */
-#line 1236 "conffile.y"
+  case 185: /* rcptr_proto: crUDP  */
+#line 1562 "conffile.y"
                            { (yyval.rcptr_proto) = CON_UDP; }
-#line 3342 "conffile.tab.c"
+#line 3889 "conffile.tab.c"
     break;
 
-  case 145: /* include: crINCLUDE crSTRING  */
-#line 1242 "conffile.y"
+  case 186: /* include: crINCLUDE crSTRING  */
+#line 1568 "conffile.y"
            {
 	   	if (router_readconfig(rtr, (yyvsp[0].crSTRING), 0, 0, 0, 0, 0, 0, 0) == NULL)
 			YYERROR;
 	   }
-#line 3351 "conffile.tab.c"
+#line 3898 "conffile.tab.c"
     break;
 
 
-#line 3355 "conffile.tab.c"
+#line 3902 "conffile.tab.c"
 
       default: break;
     }
@@ -59,6 +59,14 @@ struct _clust {
 	enum clusttype t;
 	int ival;
 };
+struct _fsbuf {
+	int size;
+	char dbl;
+};
+struct _fsrotate {
+	int secs;
+	int bytes;
+};
 struct _clhost {
 	char *ip;
 	unsigned short port;
@@ -73,8 +81,14 @@ struct _clhost {
 struct _maexpr {
 	route *r;
 	char drop;
+	unsigned char checks;
+	unsigned int tsdrift;
 	struct _maexpr *next;
 };
+struct _mavalid {
+	unsigned char checks;
+	unsigned int tsdrift;
+};
 struct _agcomp {
 	enum _aggr_compute_type ctype;
 	unsigned char pctl;
@@ -115,7 +129,7 @@ struct _rcptr_trsp {
 	char *suites;
 };
 
-#line 119 "conffile.tab.h"
+#line 133 "conffile.tab.h"
 
 /* Token kinds.  */
 #ifndef ROUTER_YYTOKENTYPE
@@ -139,77 +153,95 @@ struct _rcptr_trsp {
     crDYNAMIC = 268,               /* crDYNAMIC  */
     crPROTO = 269,                 /* crPROTO  */
     crUSEALL = 270,                /* crUSEALL  */
-    crUDP = 271,                   /* crUDP  */
-    crTCP = 272,                   /* crTCP  */
-    crMATCH = 273,                 /* crMATCH  */
-    crVALIDATE = 274,              /* crVALIDATE  */
-    crELSE = 275,                  /* crELSE  */
-    crLOG = 276,                   /* crLOG  */
-    crDROP = 277,                  /* crDROP  */
-    crROUTE = 278,                 /* crROUTE  */
-    crUSING = 279,                 /* crUSING  */
-    crSEND = 280,                  /* crSEND  */
-    crTO = 281,                    /* crTO  */
-    crBLACKHOLE = 282,             /* crBLACKHOLE  */
-    crSTOP = 283,                  /* crSTOP  */
-    crREWRITE = 284,               /* crREWRITE  */
-    crINTO = 285,                  /* crINTO  */
-    crAGGREGATE = 286,             /* crAGGREGATE  */
-    crEVERY = 287,                 /* crEVERY  */
-    crSECONDS = 288,               /* crSECONDS  */
-    crEXPIRE = 289,                /* crEXPIRE  */
-    crAFTER = 290,                 /* crAFTER  */
-    crTIMESTAMP = 291,             /* crTIMESTAMP  */
-    crAT = 292,                    /* crAT  */
-    crSTART = 293,                 /* crSTART  */
-    crMIDDLE = 294,                /* crMIDDLE  */
-    crEND = 295,                   /* crEND  */
-    crOF = 296,                    /* crOF  */
-    crBUCKET = 297,                /* crBUCKET  */
-    crCOMPUTE = 298,               /* crCOMPUTE  */
-    crSUM = 299,                   /* crSUM  */
-    crCOUNT = 300,                 /* crCOUNT  */
-    crMAX = 301,                   /* crMAX  */
-    crMIN = 302,                   /* crMIN  */
-    crAVERAGE = 303,               /* crAVERAGE  */
-    crMEDIAN = 304,                /* crMEDIAN  */
-    crVARIANCE = 305,              /* crVARIANCE  */
-    crSTDDEV = 306,                /* crSTDDEV  */
-    crPERCENTILE = 307,            /* crPERCENTILE  */
-    crWRITE = 308,                 /* crWRITE  */
-    crSTATISTICS = 309,            /* crSTATISTICS  */
-    crSUBMIT = 310,                /* crSUBMIT  */
-    crRESET = 311,                 /* crRESET  */
-    crCOUNTERS = 312,              /* crCOUNTERS  */
-    crINTERVAL = 313,              /* crINTERVAL  */
-    crPREFIX = 314,                /* crPREFIX  */
-    crWITH = 315,                  /* crWITH  */
-    crLISTEN = 316,                /* crLISTEN  */
-    crTYPE = 317,                  /* crTYPE  */
-    crLINEMODE = 318,              /* crLINEMODE  */
-    crSYSLOGMODE = 319,            /* crSYSLOGMODE  */
-    crTRANSPORT = 320,             /* crTRANSPORT  */
-    crPLAIN = 321,                 /* crPLAIN  */
-    crGZIP = 322,                  /* crGZIP  */
-    crLZ4 = 323,                   /* crLZ4  */
-    crSNAPPY = 324,                /* crSNAPPY  */
-    crSSL = 325,                   /* crSSL  */
-    crMTLS = 326,                  /* crMTLS  */
-    crUNIX = 327,                  /* crUNIX  */
-    crPROTOMIN = 328,              /* crPROTOMIN  */
-    crPROTOMAX = 329,              /* crPROTOMAX  */
-    crSSL3 = 330,                  /* crSSL3  */
-    crTLS1_0 = 331,                /* crTLS1_0  */
-    crTLS1_1 = 332,                /* crTLS1_1  */
-    crTLS1_2 = 333,                /* crTLS1_2  */
-    crTLS1_3 = 334,                /* crTLS1_3  */
-    crCIPHERS = 335,               /* crCIPHERS  */
-    crCIPHERSUITES = 336,          /* crCIPHERSUITES  */
-    crINCLUDE = 337,               /* crINCLUDE  */
-    crCOMMENT = 338,               /* crCOMMENT  */
-    crSTRING = 339,                /* crSTRING  */
-    crUNEXPECTED = 340,            /* crUNEXPECTED  */
-    crINTVAL = 341                 /* crINTVAL  */
+    crSTEAL = 271,                 /* crSTEAL  */
+    crBALANCED = 272,              /* crBALANCED  */
+    crRATE = 273,                  /* crRATE  */
+    crBYTES = 274,                 /* crBYTES  */
+    crBURST = 275,                 /* crBURST  */
+    crCATCHUP = 276,               /* crCATCHUP  */
+    crABOVE = 277,                 /* crABOVE  */
+    crNOSTALL = 278,               /* crNOSTALL  */
+    crUDP = 279,                   /* crUDP  */
+    crTCP = 280,                   /* crTCP  */
+    crBUFFER = 281,                /* crBUFFER  */
+    crDOUBLE = 282,                /* crDOUBLE  */
+    crSYNC = 283,                  /* crSYNC  */
+    crALWAYS = 284,                /* crALWAYS  */
+    crROTATE = 285,                /* crROTATE  */
+    crMATCH = 286,                 /* crMATCH  */
+    crVALIDATE = 287,              /* crVALIDATE  */
+    crELSE = 288,                  /* crELSE  */
+    crLOG = 289,                   /* crLOG  */
+    crDROP = 290,                  /* crDROP  */
+    crROUTE = 291,                 /* crROUTE  */
+    crUSING = 292,                 /* crUSING  */
+    crSEND = 293,                  /* crSEND  */
+    crTO = 294,                    /* crTO  */
+    crBLACKHOLE = 295,             /* crBLACKHOLE  */
+    crSTOP = 296,                  /* crSTOP  */
+    crNUMERIC = 297,               /* crNUMERIC  */
+    crFINITE = 298,                /* crFINITE  */
+    crWITHIN = 299,                /* crWITHIN  */
+    crREWRITE = 300,               /* crREWRITE  */
+    crINTO = 301,                  /* crINTO  */
+    crAGGREGATE = 302,             /* crAGGREGATE  */
+    crEVERY = 303,                 /* crEVERY  */
+    crSECONDS = 304,               /* crSECONDS  */
+    crEXPIRE = 305,                /* crEXPIRE  */
+    crAFTER = 306,                 /* crAFTER  */
+    crTIMESTAMP = 307,             /* crTIMESTAMP  */
+    crAT = 308,                    /* crAT  */
+    crSTART = 309,                 /* crSTART  */
+    crMIDDLE = 310,                /* crMIDDLE  */
+    crEND = 311,                   /* crEND  */
+    crOF = 312,                    /* crOF  */
+    crBUCKET = 313,                /* crBUCKET  */
+    crCOMPUTE = 314,               /* crCOMPUTE  */
+    crSUM = 315,                   /* crSUM  */
+    crCOUNT = 316,                 /* crCOUNT  */
+    crMAX = 317,                   /* crMAX  */
+    crMIN = 318,                   /* crMIN  */
+    crAVERAGE = 319,               /* crAVERAGE  */
+    crMEDIAN = 320,                /* crMEDIAN  */
+    crVARIANCE = 321,              /* crVARIANCE  */
+    crSTDDEV = 322,                /* crSTDDEV  */
+    crPERCENTILE = 323,            /* crPERCENTILE  */
+    crWRITE = 324,                 /* crWRITE  */
+    crSTATISTICS = 325,            /* crSTATISTICS  */
+    crSUBMIT = 326,                /* crSUBMIT  */
+    crRESET = 327,                 /* crRESET  */
+    crCOUNTERS = 328,              /* crCOUNTERS  */
+    crINTERVAL = 329,              /* crINTERVAL  */
+    crPREFIX = 330,                /* crPREFIX  */
+    crWITH = 331,                  /* crWITH  */
+    crLISTEN = 332,                /* crLISTEN  */
+    crTYPE = 333,                  /* crTYPE  */
+    crLINEMODE = 334,              /* crLINEMODE  */
+    crSYSLOGMODE = 335,            /* crSYSLOGMODE  */
+    crPICKLE = 336,                /* crPICKLE  */
+    crTRANSPORT = 337,             /* crTRANSPORT  */
+    crPLAIN = 338,                 /* crPLAIN  */
+    crGZIP = 339,                  /* crGZIP  */
+    crLZ4 = 340,                   /* crLZ4  */
+    crSNAPPY = 341,                /* crSNAPPY  */
+    crZSTD = 342,                  /* crZSTD  */
+    crSSL = 343,                   /* crSSL  */
+    crMTLS = 344,                  /* crMTLS  */
+    crUNIX = 345,                  /* crUNIX  */
+    crPROTOMIN = 346,              /* crPROTOMIN  */
+    crPROTOMAX = 347,              /* crPROTOMAX  */
+    crSSL3 = 348,                  /* crSSL3  */
+    crTLS1_0 = 349,                /* crTLS1_0  */
+    crTLS1_1 = 350,                /* crTLS1_1  */
+    crTLS1_2 = 351,                /* crTLS1_2  */
+    crTLS1_3 = 352,                /* crTLS1_3  */
+    crCIPHERS = 353,               /* crCIPHERS  */
+    crCIPHERSUITES = 354,          /* crCIPHERSUITES  */
+    crINCLUDE = 355,               /* crINCLUDE  */
+    crCOMMENT = 356,               /* crCOMMENT  */
+    crSTRING = 357,                /* crSTRING  */
+    crUNEXPECTED = 358,            /* crUNEXPECTED  */
+    crINTVAL = 359                 /* crINTVAL  */
   };
   typedef enum router_yytokentype router_yytoken_kind_t;
 #endif
@@ -233,6 +265,7 @@ union ROUTER_YYSTYPE
   con_trnsp cluster_transport_trans;       /* cluster_transport_trans  */
   con_trnsp transport_ssl_or_mtls;         /* transport_ssl_or_mtls  */
   con_type cluster_opt_type;               /* cluster_opt_type  */
+  con_type listener_type;                  /* listener_type  */
   destinations * match_opt_send_to;        /* match_opt_send_to  */
   destinations * match_send_to;            /* match_send_to  */
   destinations * match_dsts;               /* match_dsts  */
@@ -248,8 +281,18 @@ union ROUTER_YYSTYPE
   int crPERCENTILE;                        /* crPERCENTILE  */
   int crINTVAL;                            /* crINTVAL  */
   int cluster_opt_useall;                  /* cluster_opt_useall  */
+  int cluster_opt_steal;                   /* cluster_opt_steal  */
+  int cluster_opt_balanced;                /* cluster_opt_balanced  */
   int cluster_opt_repl;                    /* cluster_opt_repl  */
   int cluster_opt_dynamic;                 /* cluster_opt_dynamic  */
+  int cluster_opt_double;                  /* cluster_opt_double  */
+  int cluster_opt_sync;                    /* cluster_opt_sync  */
+  int cluster_opt_rotevery;                /* cluster_opt_rotevery  */
+  int cluster_opt_rotat;                   /* cluster_opt_rotat  */
+  int cluster_opt_ratebytes;               /* cluster_opt_ratebytes  */
+  int cluster_opt_burst;                   /* cluster_opt_burst  */
+  int cluster_opt_expire;                  /* cluster_opt_expire  */
+  int cluster_opt_nostall;                 /* cluster_opt_nostall  */
   int match_log_or_drop;                   /* match_log_or_drop  */
   int match_opt_stop;                      /* match_opt_stop  */
   int statistics_opt_interval;             /* statistics_opt_interval  */
@@ -265,12 +308,18 @@ union ROUTER_YYSTYPE
   struct _clhost * cluster_host;           /* cluster_host  */
   struct _clust cluster_type;              /* cluster_type  */
   struct _clust cluster_file;              /* cluster_file  */
+  struct _fsbuf cluster_opt_buffer;        /* cluster_opt_buffer  */
+  struct _fsrotate cluster_opt_rotate;     /* cluster_opt_rotate  */
   struct _lsnr * listener;                 /* listener  */
   struct _maexpr * match_exprs;            /* match_exprs  */
   struct _maexpr * match_exprs2;           /* match_exprs2  */
   struct _maexpr * match_opt_expr;         /* match_opt_expr  */
   struct _maexpr * match_expr;             /* match_expr  */
   struct _maexpr * match_opt_validate;     /* match_opt_validate  */
+  struct _mavalid match_validators;        /* match_validators  */
+  struct _mavalid match_validator;         /* match_validator  */
+  struct _ratelimit * cluster_opt_rate;    /* cluster_opt_rate  */
+  struct _ratelimit * cluster_opt_catchup; /* cluster_opt_catchup  */
   struct _rcptr * receptors;               /* receptors  */
   struct _rcptr * opt_receptor;            /* opt_receptor  */
   struct _rcptr * receptor;                /* receptor  */
@@ -283,7 +332,7 @@ union ROUTER_YYSTYPE
   struct _rcptr_trsp_ssl * cluster_transport_opt_ssl; /* cluster_transport_opt_ssl  */
   tlsprotover transport_ssl_protover;      /* transport_ssl_protover  */
 
-#line 287 "conffile.tab.h"
+#line 336 "conffile.tab.h"
 
 };
 typedef union ROUTER_YYSTYPE ROUTER_YYSTYPE;
@@ -30,6 +30,14 @@ struct _clust {
 	enum clusttype t;
 	int ival;
 };
+struct _fsbuf {
+	int size;
+	char dbl;
+};
+struct _fsrotate {
+	int secs;
+	int bytes;
+};
 struct _clhost {
 	char *ip;
 	unsigned short port;
@@ -44,8 +52,14 @@ struct _clhost {
 struct _maexpr {
 	route *r;
 	char drop;
+	unsigned char checks;
+	unsigned int tsdrift;
 	struct _maexpr *next;
 };
+struct _mavalid {
+	unsigned char checks;
+	unsigned int tsdrift;
+};
 struct _agcomp {
 	enum _aggr_compute_type ctype;
 	unsigned char pctl;
@@ -96,16 +110,25 @@ struct _rcptr_trsp {
 
 %token crCLUSTER
 %token crFORWARD crANY_OF crFAILOVER crCARBON_CH crFNV1A_CH crJUMP_FNV1A_CH
-	crFILE crIP crREPLICATION crDYNAMIC crPROTO crUSEALL crUDP crTCP
+	crFILE crIP crREPLICATION crDYNAMIC crPROTO crUSEALL crSTEAL crBALANCED
+	crRATE crBYTES crBURST crCATCHUP crABOVE crNOSTALL crUDP crTCP
+	crBUFFER crDOUBLE crSYNC crALWAYS crROTATE
 %type <enum clusttype> cluster_useall cluster_ch
 %type <struct _clust> cluster_type cluster_file
 %type <int> cluster_opt_repl cluster_opt_useall cluster_opt_dynamic
+	cluster_opt_steal cluster_opt_balanced
 %type <con_proto> cluster_opt_proto
-%type <con_type> cluster_opt_type
+%type <con_type> cluster_opt_type listener_type
 %type <char *> cluster_opt_instance
 %type <cluster *> cluster
 %type <struct _clhost *> cluster_host cluster_hosts cluster_opt_host
 	cluster_path cluster_paths cluster_opt_path
+%type <struct _ratelimit *> cluster_opt_rate cluster_opt_catchup
+%type <int> cluster_opt_ratebytes cluster_opt_burst cluster_opt_expire
+	cluster_opt_nostall cluster_opt_double cluster_opt_sync cluster_opt_rotevery
+	cluster_opt_rotat
+%type <struct _fsbuf> cluster_opt_buffer
+%type <struct _fsrotate> cluster_opt_rotate
 %type <con_trnsp> cluster_transport_trans
 %type <struct _rcptr_trsp_ssl *> cluster_opt_transport cluster_transport_opt_ssl
 
@@ -118,6 +141,8 @@ struct _rcptr_trsp {
 %type <char *> match_opt_route
 %type <struct _maexpr *> match_opt_validate match_expr match_opt_expr
 	match_exprs match_exprs2
+%token crNUMERIC crFINITE crWITHIN
+%type <struct _mavalid> match_validator match_validators
 
 %token crREWRITE
 %token crINTO
@@ -141,8 +166,8 @@ struct _rcptr_trsp {
 %type <char *> statistics_opt_prefix
 
 %token crLISTEN
-%token crTYPE crLINEMODE crSYSLOGMODE crTRANSPORT
-%token crPLAIN crGZIP crLZ4 crSNAPPY crSSL crMTLS crUNIX
+%token crTYPE crLINEMODE crSYSLOGMODE crPICKLE crTRANSPORT
+%token crPLAIN crGZIP crLZ4 crSNAPPY crZSTD crSSL crMTLS crUNIX
 %token crPROTOMIN crPROTOMAX
 %token crSSL3 crTLS1_0 crTLS1_1 crTLS1_2 crTLS1_3
 %token crCIPHERS crCIPHERSUITES
@@ -187,6 +212,8 @@ command: cluster
 
 /*** {{{ BEGIN cluster ***/
 cluster: crCLUSTER crSTRING[name] cluster_type[type] cluster_hosts[servers]
+	   cluster_opt_rate[rate] cluster_opt_expire[expire]
+	   cluster_opt_nostall[nostall]
 	   {
 	   	struct _clhost *w;
 		char *err;
@@ -207,6 +234,9 @@ cluster: crCLUSTER crSTRING[name] cluster_type[type] cluster_hosts[servers]
 		$$->name = ra_strdup(ralloc, $name);
 		$$->next = NULL;
 		$$->type = $type.t;
+		$$->rate = $rate;
+		$$->expire = $expire;
+		$$->nostall = $nostall;
 		switch ($$->type) {
 			case CARBON_CH:
 			case FNV1A_CH:
@@ -232,11 +262,26 @@ cluster: crCLUSTER crSTRING[name] cluster_type[type] cluster_hosts[servers]
 				$type.ival = 0;  /* hack, avoid triggering use_all */
 				break;
 			case FORWARD:
-				$$->members.forward = NULL;
-				break;
 			case ANYOF:
 			case FAILOVER:
-				$$->members.anyof = NULL;
+				$$->steal = ($type.ival & 2) != 0;
+				if ($$->steal && $$->type != ANYOF) {
+					router_yyerror(&yylloc, yyscanner, rtr, ralloc, palloc,
+						"steal is only supported for any_of clusters");
+					YYERROR;
+				}
+				$$->balanced = ($type.ival & 4) != 0;
+				if ($$->balanced && $$->type != ANYOF) {
+					router_yyerror(&yylloc, yyscanner, rtr, ralloc, palloc,
+						"balanced is only supported for any_of clusters");
+					YYERROR;
+				}
+				$type.ival &= 1;  /* leave only useall */
+				if ($$->type == FORWARD) {
+					$$->members.forward = NULL;
+				} else {
+					$$->members.anyof = NULL;
+				}
 				break;
 			default:
 				logerr("unknown cluster type %zd!\n", (ssize_t)$$->type);
@@ -261,6 +306,7 @@ cluster: crCLUSTER crSTRING[name] cluster_type[type] cluster_hosts[servers]
 		}
 	   }
 	   | crCLUSTER crSTRING[name] cluster_file[type] cluster_paths[paths]
+	   cluster_opt_buffer[buf] cluster_opt_sync[sync] cluster_opt_rotate[rot]
 	   {
 	   	struct _clhost *w;
 		char *err;
@@ -281,6 +327,16 @@ cluster: crCLUSTER crSTRING[name] cluster_type[type] cluster_hosts[servers]
 				logerr("unknown cluster type %zd!\n", (ssize_t)$$->type);
 				YYABORT;
 		}
+		if (($$->file = ra_malloc(ralloc, sizeof(filesink))) == NULL) {
+			logerr("malloc failed for cluster '%s'\n", $name);
+			YYABORT;
+		}
+		$$->file->buffer = $buf.size < 0 ?
+			SERVER_FILE_BUFSIZ : (size_t)$buf.size;
+		$$->file->dbl = $buf.dbl;
+		$$->file->sync = $sync;
+		$$->file->rotatesecs = $rot.secs;
+		$$->file->rotatebytes = (size_t)$rot.bytes;
 		
 		for (w = $paths; w != NULL; w = w->next) {
 			err = router_add_server(rtr, w->ip, w->port, w->inst,
@@ -302,7 +358,8 @@ cluster: crCLUSTER crSTRING[name] cluster_type[type] cluster_hosts[servers]
 
 cluster_type:
 			  cluster_useall[type] cluster_opt_useall[use]
-			  { $$.t = $type; $$.ival = $use; }
+			  cluster_opt_steal[steal] cluster_opt_balanced[bal]
+			  { $$.t = $type; $$.ival = ($bal * 4) + ($steal * 2) + $use; }
 			| cluster_ch[type] cluster_opt_repl[repl] cluster_opt_dynamic[dyn]
 			  { $$.t = $type; $$.ival = ($dyn * 2) + ($repl * 10); }
 			;
@@ -316,6 +373,14 @@ cluster_opt_useall:          { $$ = 0; }
 				  | crUSEALL { $$ = 1; }
 				  ;
 
+cluster_opt_steal:         { $$ = 0; }
+				 | crSTEAL { $$ = 1; }
+				 ;
+
+cluster_opt_balanced:            { $$ = 0; }
+					| crBALANCED { $$ = 1; }
+					;
+
 cluster_ch: crCARBON_CH     { $$ = CARBON_CH; }
 		  | crFNV1A_CH      { $$ = FNV1A_CH; }
 		  | crJUMP_FNV1A_CH { $$ = JUMP_CH; }
@@ -333,6 +398,80 @@ cluster_file: crFILE crIP { $$.t = FILELOGIP; $$.ival = 0; }
 			| crFILE      { $$.t = FILELOG; $$.ival = 0; }
 			;
 
+cluster_opt_buffer:                         { $$.size = -1; $$.dbl = 0; }
+				  | crBUFFER crINTVAL[size] cluster_opt_double[dbl]
+				  {
+					if ($size < 0) {
+						router_yyerror(&yylloc, yyscanner, rtr,
+								ralloc, palloc,
+								"buffer cannot be negative");
+						YYERROR;
+					}
+					if ($size == 0 && $dbl) {
+						router_yyerror(&yylloc, yyscanner, rtr,
+								ralloc, palloc,
+								"double needs a buffer larger than 0");
+						YYERROR;
+					}
+					$$.size = $size;
+					$$.dbl = $dbl;
+				  }
+				  ;
+cluster_opt_double:           { $$ = 0; }
+				  | crDOUBLE  { $$ = 1; }
+				  ;
+cluster_opt_sync:                 { $$ = 0; }
+				| crSYNC crALWAYS { $$ = -1; }
+				| crSYNC crEVERY crINTVAL[secs] crSECONDS
+				{
+					if ($secs < 1) {
+						router_yyerror(&yylloc, yyscanner, rtr,
+								ralloc, palloc,
+								"sync interval must be at least 1 second");
+						YYERROR;
+					}
+					$$ = $secs;
+				}
+				;
+cluster_opt_rotate:           { $$.secs = 0; $$.bytes = 0; }
+				  | crROTATE cluster_opt_rotevery[secs] cluster_opt_rotat[bytes]
+				  {
+					if ($secs == 0 && $bytes == 0) {
+						router_yyerror(&yylloc, yyscanner, rtr,
+								ralloc, palloc,
+								"rotate needs an interval or a size");
+						YYERROR;
+					}
+					$$.secs = $secs;
+					$$.bytes = $bytes;
+				  }
+				  ;
+cluster_opt_rotevery:                               { $$ = 0; }
+					| crEVERY crINTVAL[secs] crSECONDS
+					{
+						if ($secs < 1) {
+							router_yyerror(&yylloc, yyscanner, rtr,
+									ralloc, palloc,
+									"rotate interval must be at least "
+									"1 second");
+							YYERROR;
+						}
+						$$ = $secs;
+					}
+					;
+cluster_opt_rotat:                         { $$ = 0; }
+				 | crAT crINTVAL[bytes] crBYTES
+				 {
+					if ($bytes < 1) {
+						router_yyerror(&yylloc, yyscanner, rtr,
+								ralloc, palloc,
+								"rotate size must be at least 1 byte");
+						YYERROR;
+					}
+					$$ = $bytes;
+				 }
+				 ;
+
 cluster_paths: cluster_path[l] cluster_opt_path[r] { $l->next = $r; $$ = $l; }
 			 ;
 cluster_opt_path:              { $$ = NULL; }
@@ -358,6 +497,87 @@ cluster_path: crSTRING[path]
 			}
 			;
 
+cluster_opt_rate:     { $$ = NULL; }
+				| crRATE crINTVAL[rate] cluster_opt_ratebytes[bytes]
+				  cluster_opt_burst[burst] cluster_opt_catchup[catchup]
+				{
+					if ($rate < 1) {
+						router_yyerror(&yylloc, yyscanner, rtr,
+								ralloc, palloc,
+								"rate must be at least 1 metric per second");
+						YYERROR;
+					}
+					$$ = $catchup;
+					$$->metrics = (size_t)$rate;
+					$$->bytes = (size_t)$bytes;
+					$$->burst = (size_t)$burst;
+				}
+				;
+cluster_opt_ratebytes:                       { $$ = 0; }
+					 | crBYTES crINTVAL[bytes]
+					 {
+						if ($bytes < 1) {
+							router_yyerror(&yylloc, yyscanner, rtr,
+									ralloc, palloc,
+									"bytes must be at least 1 per second");
+							YYERROR;
+						}
+						$$ = $bytes;
+					 }
+					 ;
+cluster_opt_burst:                       { $$ = 0; }
+				 | crBURST crINTVAL[burst]
+				 {
+					if ($burst < 1) {
+						router_yyerror(&yylloc, yyscanner, rtr,
+								ralloc, palloc,
+								"burst must be at least 1 metric");
+						YYERROR;
+					}
+					$$ = $burst;
+				 }
+				 ;
+cluster_opt_catchup:
+				   {
+					if (($$ = ra_malloc(ralloc, sizeof(ratelimit))) == NULL) {
+						logerr("malloc failed\n");
+						YYABORT;
+					}
+					$$->catchup = 0;
+					$$->above = 0;
+				   }
+				   | crCATCHUP crINTVAL[rate] crABOVE crINTVAL[above]
+				   {
+					if ($rate < 1) {
+						router_yyerror(&yylloc, yyscanner, rtr,
+								ralloc, palloc,
+								"catchup must be at least 1 metric per second");
+						YYERROR;
+					}
+					if (($$ = ra_malloc(ralloc, sizeof(ratelimit))) == NULL) {
+						logerr("malloc failed\n");
+						YYABORT;
+					}
+					$$->catchup = (size_t)$rate;
+					$$->above = (size_t)$above;
+				   }
+				   ;
+cluster_opt_expire:          { $$ = 0; }
+				  | crEXPIRE crAFTER crINTVAL[secs] crSECONDS
+				  {
+					if ($secs < 1) {
+						router_yyerror(&yylloc, yyscanner, rtr,
+								ralloc, palloc,
+								"expire must be at least 1 second");
+						YYERROR;
+					}
+					$$ = $secs;
+				  }
+				  ;
+cluster_opt_nostall:           { $$ = 0; }
+				   | crNOSTALL { $$ = 1; }
+				   ;
+
 cluster_hosts: cluster_host[l] cluster_opt_host[r] { $l->next = $r; $$ = $l; }
 			 ;
 cluster_opt_host:               { $$ = NULL; }
@@ -377,6 +597,19 @@ cluster_host: crSTRING[ip] cluster_opt_instance[inst]
 							ralloc, palloc, err);
 					YYERROR;
 				}
+				if ($type == T_PICKLE && $prot == CON_UDP) {
+					router_yyerror(&yylloc, yyscanner, rtr,
+							ralloc, palloc,
+							"cannot use UDP transport for pickle type");
+					YYERROR;
+				}
+				if ($trnsp->mode != W_PLAIN && $prot == CON_UDP) {
+					router_yyerror(&yylloc, yyscanner, rtr,
+							ralloc, palloc,
+							"cannot use UDP transport for "
+							"compressed/encrypted stream");
+					YYERROR;
+				}
 				ret->inst = $inst;
 				ret->proto = $prot;
 				ret->type = $type;
@@ -405,6 +638,7 @@ cluster_opt_proto:               { $$ = CON_TCP; }
 cluster_opt_type:                     { $$ = T_LINEMODE; }
 				| crTYPE crLINEMODE   { $$ = T_LINEMODE; }
 				| crTYPE crSYSLOGMODE { $$ = T_SYSLOGMODE; }
+				| crTYPE crPICKLE     { $$ = T_PICKLE; }
 				;
 
 cluster_opt_transport:
@@ -467,6 +701,16 @@ cluster_transport_trans: crTRANSPORT crPLAIN  { $$ = W_PLAIN; }
 								ralloc, palloc,
 								"feature snappy not compiled in");
 							YYERROR;
+#endif
+					    }
+					    | crTRANSPORT crZSTD    {
+#ifdef HAVE_ZSTD
+							$$ = W_ZSTD;
+#else
+							router_yyerror(&yylloc, yyscanner, rtr,
+								ralloc, palloc,
+								"feature zstd not compiled in");
+							YYERROR;
 #endif
 					    }
 					    ;
@@ -552,6 +796,8 @@ match: crMATCH match_exprs[exprs] match_opt_validate[val]
 				YYABORT;
 			}
 			d->cl->members.validation->rule = $val->r;
+			d->cl->members.validation->checks = $val->checks;
+			d->cl->members.validation->tsdrift = $val->tsdrift;
 			d->cl->members.validation->action = $val->drop ? VAL_DROP : VAL_LOG;
 		}
 		/* add destinations to the chain */
@@ -637,8 +883,56 @@ match_opt_validate: { $$ = NULL; }
 					$$->drop = $drop;
 					$$->next = NULL;
 				  }
+				  | crVALIDATE match_validators[vals] crELSE
+				    match_log_or_drop[drop]
+				  {
+					if (($$ = ra_malloc(palloc, sizeof(struct _maexpr))) == NULL) {
+						logerr("out of memory\n");
+						YYABORT;
+					}
+					$$->r = NULL;
+					$$->checks = $vals.checks;
+					$$->tsdrift = $vals.tsdrift;
+					$$->drop = $drop;
+					$$->next = NULL;
+				  }
 				  ;
 
+match_validators: match_validator[v] { $$ = $v; }
+				| match_validators[l] match_validator[v]
+				{
+					$$.checks = $l.checks | $v.checks;
+					$$.tsdrift = $v.tsdrift != 0 ? $v.tsdrift : $l.tsdrift;
+				}
+				;
+
+match_validator: crNUMERIC
+			   {
+				$$.checks = VAL_NUMERIC;
+				$$.tsdrift = 0;
+			   }
+			   | crFINITE
+			   {
+				$$.checks = VAL_NUMERIC | VAL_FINITE;
+				$$.tsdrift = 0;
+			   }
+			   | crTIMESTAMP
+			   {
+				$$.checks = VAL_TIMESTAMP;
+				$$.tsdrift = 0;
+			   }
+			   | crTIMESTAMP crWITHIN crINTVAL[secs] crSECONDS
+			   {
+				if ($secs <= 0) {
+					router_yyerror(&yylloc, yyscanner, rtr,
+						ralloc, palloc, "timestamp drift must be >0 seconds");
+					YYERROR;
+				}
+				$$.checks = VAL_TIMESTAMP | VAL_TSDRIFT;
+				$$.tsdrift = (unsigned int)$secs;
+			   }
+			   ;
+
 match_log_or_drop: crLOG  { $$ = 0; }
 				 | crDROP { $$ = 1; }
 				 ;
@@ -984,15 +1278,26 @@ listen: crLISTEN listener[lsnr]
 	  }
 	  ;
 
-listener: crTYPE crLINEMODE transport_mode[mode] receptors[ifaces]
+listener: crTYPE listener_type[type] transport_mode[mode] receptors[ifaces]
 		{
 			if (($$ = ra_malloc(palloc, sizeof(struct _lsnr))) == NULL) {
 				logerr("malloc failed\n");
 				YYABORT;
 			}
-			$$->type = T_LINEMODE;
+			$$->type = $type;
 			$$->transport = $mode;
 			$$->rcptr = $ifaces;
+			if ($type == T_PICKLE) {
+				struct _rcptr *walk;
+
+				for (walk = $ifaces; walk != NULL; walk = walk->next) {
+					if (walk->ctype == CON_UDP) {
+						router_yyerror(&yylloc, yyscanner, rtr, ralloc, palloc,
+							"cannot use UDP transport for pickle type");
+						YYERROR;
+					}
+				}
+			}
 			if ($mode->mode != W_PLAIN) {
 				struct _rcptr *walk;
 
@@ -1008,6 +1313,10 @@ listener: crTYPE crLINEMODE transport_mode[mode] receptors[ifaces]
 		}
 		;
 
+listener_type: crLINEMODE  { $$ = T_LINEMODE; }
+			 | crPICKLE    { $$ = T_PICKLE;   }
+			 ;
+
 transport_ssl_or_mtls: crSSL   { $$ = W_SSL;          }
 					 | crMTLS  { $$ = W_SSL | W_MTLS; }
 					 ;
@@ -1141,6 +1450,23 @@ transport_mode_trans: crTRANSPORT crPLAIN
 							ralloc, palloc,
 							"feature snappy not compiled in");
 						YYERROR;
+#endif
+					}
+			  		| crTRANSPORT crZSTD
+					{
+#ifdef HAVE_ZSTD
+						if (($$ = ra_malloc(palloc,
+								sizeof(struct _rcptr_trsp))) == NULL)
+						{
+							logerr("malloc failed\n");
+							YYABORT;
+						}
+						$$->mode = W_ZSTD;
+#else
+						router_yyerror(&yylloc, yyscanner, rtr,
+							ralloc, palloc,
+							"feature zstd not compiled in");
+						YYERROR;
 #endif
 					}
 				    ;
@@ -596,8 +596,8 @@ static void yynoreturn yy_fatal_error ( const char* msg , yyscan_t yyscanner );
 	yyg->yy_hold_char = *yy_cp; \
 	*yy_cp = '\0'; \
 	yyg->yy_c_buf_p = yy_cp;
-#define YY_NUM_RULES 120
-#define YY_END_OF_BUFFER 121
+#define YY_NUM_RULES 147
+#define YY_END_OF_BUFFER 148
 /* This struct is not used in this scanner,
    but its presence is necessary. */
 struct yy_trans_info
@@ -605,76 +605,91 @@ struct yy_trans_info
 	flex_int32_t yy_verify;
 	flex_int32_t yy_nxt;
 	};
-static const flex_int16_t yy_accept[613] =
+static const flex_int16_t yy_accept[754] =
     {   0,
         0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
         0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-        0,    0,    0,    0,    0,    0,    0,    0,  121,  119,
-      114,  115,  119,  118,  119,  119,  119,  119,  119,  119,
-      119,  119,  119,  119,  119,  119,  119,  119,  119,  119,
-      119,  119,  119,  116,  119,  119,  119,  119,  119,  119,
-      119,  119,  119,  119,  119,  119,  119,  119,  119,  119,
-      119,  119,  119,  119,  119,  119,  119,  119,  119,  119,
-      112,  112,  110,  109,  112,  112,  119,  108,  117,  116,
-       26,  117,  117,  117,  117,  117,  117,  117,  117,  117,
-
-      117,  117,   28,  117,  117,  117,  117,  117,  117,  117,
-      117,  117,  117,  117,  114,  115,    0,  113,    0,    0,
         0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-        0,    0,    0,    0,    0,    0,    0,    0,    0,   36,
-        0,    0,  116,    0,   47,    0,    0,    0,    0,    0,
-        0,    0,    0,    0,   51,    0,    0,    0,    0,    0,
-       69,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+      148,  146,  141,  142,  146,  145,  146,  146,  146,  146,
+      146,  146,  146,  146,  146,  146,  146,  146,  146,  146,
+      146,  146,  146,  146,  146,  143,  146,  146,  146,  146,
+      146,  146,  146,  146,  146,  146,  146,  146,  146,  146,
+      146,  146,  146,  146,  146,  146,  146,  146,  146,  146,
+      146,  146,  139,  139,  137,  136,  139,  139,  146,  135,
+      144,  143,   46,  144,  144,  144,  144,  144,  144,  144,
+
+      144,  144,  144,  144,  144,  144,  144,  144,  144,   48,
+      144,  144,  144,  144,  144,  144,  144,  144,  144,  144,
+      144,  144,  144,  144,  144,  144,  144,  144,  141,  142,
+        0,  140,    0,    0,    0,    0,    0,    0,    0,    0,
         0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-        0,    0,  112,  112,  112,  111,  117,  117,  116,  117,
-      117,  117,   12,  117,  117,  117,  117,  117,  117,  117,
-
-      117,  117,  117,  117,  117,  117,  117,  117,  117,  117,
-      117,  117,  117,  117,  117,  117,  117,  117,  117,  117,
-      117,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-        0,    0,    0,    0,    0,    0,    0,    0,   31,    0,
-        0,    0,    0,    0,    0,    0,   63,    0,   57,    0,
-        0,   50,    0,   59,    0,    0,   61,    0,    0,    0,
-        0,    0,   55,    0,    0,    0,    0,    0,    0,    0,
+        0,    0,    0,   61,    0,    0,  143,    0,   72,    0,
+        0,    0,    0,    0,    0,    0,    0,    0,   76,    0,
+        0,    0,    0,    0,   94,    0,    0,    0,    0,    0,
         0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-        0,  105,    0,    0,  104,    0,    0,  117,  117,  117,
-      117,   22,  117,  117,  117,  117,  117,   24,  117,  117,
+        0,    0,    0,    0,    0,    0,    0,  139,  139,  139,
+
+      138,  144,  144,  143,  144,  144,  144,   23,  144,  144,
+      144,  144,  144,  144,  144,  144,  144,  144,   30,  144,
+      144,  144,  144,  144,  144,  144,  144,  144,  144,  144,
+      144,  144,  144,  144,  144,  144,  144,  144,  144,  144,
+      144,  144,  144,  144,  144,  144,  144,  144,  144,  144,
+      144,  144,  144,  144,  144,  144,  144,  144,  144,  144,
+        0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+        0,    0,    0,    0,    0,    0,    0,   56,    0,    0,
+        0,    0,    0,    0,    0,   88,    0,   82,    0,    0,
+       75,    0,   84,    0,    0,   86,    0,    0,    0,    0,
 
-       15,  117,  117,   14,  117,  117,  117,  117,  117,  117,
-      117,   90,  117,  117,  117,  117,   92,  117,    0,    0,
-        0,    0,    0,    0,   71,    0,    0,    0,    0,   11,
-        0,    0,    0,   32,   30,    0,   35,   38,    0,   40,
+        0,   80,    0,    0,    0,    0,    0,    0,    0,    0,
+        0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+        0,  132,    0,    0,  131,    0,    0,  144,  144,  144,
+      144,  144,  144,  144,  144,  144,  144,  144,  144,  144,
+      144,  144,   41,  144,  144,  144,  144,  144,  144,  144,
+      144,  144,  144,   44,  144,  144,  144,  144,   33,  144,
+      144,   32,  144,  144,  144,  144,  144,  144,  144,  144,
+      116,  144,  144,  144,  144,  119,  144,  144,  144,  144,
+      144,  144,  144,  144,    0,    0,    0,    0,    0,    0,
+       96,    0,    0,    0,    0,   29,    0,    0,    0,   57,
+
+       55,    0,   60,   63,    0,   65,    0,    0,    0,    0,
+        0,    0,    0,    0,    0,    0,    0,    0,   95,    0,
         0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-        0,    0,   70,    0,    0,    0,    0,    0,    0,    0,
-        0,    0,    0,    0,    0,    0,    0,   83,    0,   82,
-        0,    0,    0,   96,    0,   85,  106,  117,  117,  117,
-       21,  117,   25,  117,  117,  117,  117,   38,  117,  117,
-       16,  117,  117,   35,  117,  117,  117,   89,   93,  117,
-
-      117,  117,  117,    0,    0,    0,    0,   27,    0,    0,
-        0,    0,    0,    0,    0,    0,   33,   34,   45,    0,
-        0,    0,   56,    0,    0,    0,    0,    0,    0,    0,
-       48,    0,    0,    0,    0,   68,    0,   79,    0,   75,
-        0,    0,   77,    0,    0,    0,    0,  103,    0,  117,
-      117,  117,  117,   20,   13,  117,  117,  117,  117,  117,
-       33,  117,   42,  117,   88,  103,  117,  117,    0,    0,
-        0,   84,    0,    0,    3,    0,    0,    0,    0,    0,
-        0,   52,    0,   44,    0,   64,   49,    0,    0,    0,
-       67,    0,    0,    0,    0,    0,    0,   81,    0,   74,
-
-        0,    0,    0,   97,   98,   99,  100,  117,  117,  117,
-      117,   23,   18,  117,    5,  117,  117,  117,   91,  117,
-        0,    1,  107,   39,    0,    0,    0,    0,    2,    0,
-       62,   53,   58,   60,    0,   43,   54,    0,    0,    0,
-        0,    0,   76,  102,    0,    0,    0,  117,   10,  117,
-      117,  117,  117,  102,  117,  117,  117,    0,    0,    0,
-        4,    7,    0,    0,    0,   66,    0,   78,   80,    0,
-       86,   95,   94,  117,   17,  117,  117,   29,  117,   95,
-       94,  117,   41,    0,    6,    0,    0,   46,    0,    0,
-       37,  117,   19,  117,   87,   73,    0,   65,   72,    0,
-
-      117,  117,    0,   65,    0,    9,  117,    0,  101,  101,
-        8,    0
+        0,    0,    0,  108,    0,  107,    0,    0,    0,    0,
+      123,    0,  110,  133,  144,  144,  144,  144,  144,  144,
+      144,  144,  144,  144,  144,  144,  144,  144,   40,  144,
+       45,  144,  144,  144,  144,    8,  144,  144,  144,  144,
+      144,   63,   19,  144,  144,   34,  144,   43,  144,   60,
+      144,  144,  144,  115,  120,  144,  144,  144,  144,  118,
+       55,  144,  144,  144,  144,  144,    0,    0,    0,    0,
+
+       47,    0,    0,    0,    0,    0,    0,    0,    0,   58,
+       59,   70,    0,    0,    0,   81,    0,    0,    0,    0,
+        0,    0,    0,   73,    0,    0,    0,    0,   93,    0,
+      104,    0,  100,    0,    0,  102,    0,    0,    0,    0,
+        0,  130,    0,  144,   12,   14,  144,  144,  144,  144,
+       10,    9,  144,  144,  144,   21,  144,  144,  144,  144,
+       39,   31,  144,  144,  144,  144,    6,  144,  144,  144,
+       58,  144,   67,  144,  114,  130,  144,  144,  144,  144,
+      144,  144,  144,    0,    0,    0,  109,    0,    0,    3,
+        0,    0,    0,    0,    0,    0,   77,    0,   69,    0,
+
+       89,   74,    0,    0,    0,   92,    0,    0,    0,    0,
+        0,    0,  106,    0,   99,    0,    0,  112,    0,  124,
+      125,  126,  127,   20,  144,  144,   17,  144,   18,  144,
+       13,  144,  144,   37,  144,   22,  144,   42,   36,  144,
+        5,  144,  144,  144,  117,  144,   51,  144,  144,  144,
+       53,    0,    1,  134,   64,    0,    0,    0,    0,    2,
+        0,   87,   78,   83,   85,    0,   68,   79,    0,    0,
+        0,    0,    0,  101,  129,    0,    0,    0,  144,  144,
+       11,   28,  144,   16,  144,   15,  144,  144,  129,  144,
+      144,  144,   50,   54,  144,    0,    0,    0,    4,   25,
+
+        0,    0,    0,   91,    0,  103,  105,    0,  111,  122,
+      121,    7,  144,   35,  144,  144,   49,  144,  122,  121,
+      144,  144,   66,    0,   24,    0,    0,   71,    0,    0,
+       62,  144,   38,  144,  113,   52,   98,    0,   90,   97,
+        0,  144,  144,    0,   90,    0,   27,  144,    0,  128,
+      128,   26,    0
     } ;
 
 static const YY_CHAR yy_ec[256] =
@@ -711,397 +726,462 @@ static const YY_CHAR yy_ec[256] =
 
 static const YY_CHAR yy_meta[45] =
     {   0,
-        1,    1,    2,    1,    3,    1,    4,    4,    4,    4,
-        4,    4,    4,    4,    4,    1,    1,    5,    4,    4,
-        4,    4,    4,    4,    4,    4,    4,    4,    4,    4,
-        4,    4,    4,    4,    4,    4,    4,    4,    4,    4,
-        4,    4,    4,    4
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    1,    1,    1
     } ;
 
-static const flex_int16_t yy_base[621] =
+static const flex_int16_t yy_base[754] =
     {   0,
-        0,   36,   72,    0,   82,    0,    1,   21,  112,    0,
-       40,   61,  134,    0,  156,    0,  194,  211,  229,    0,
-      266,    0,   11,   63,   17,   72,  299,    0,  963,  964,
-        3,  959,  958,  964,  934,  928,  925,  929,  936,  931,
-       21,  921,  933,  131,  913,  915,  919,  915,  914,   46,
-      913,  909,  912,    0,   90,  905,    0,   49,   65,  918,
-      918,  164,   27,  921,  904,  901,  913,  903,  896,  902,
-      898,  909,   71,  904,  903,  902,  893,  891,  117,  112,
-        0,  112,  924,  964,  174,    0,    0,  964,  908,  330,
-      964,   48,   99,    0,  122,  145,  166,  187,  143,  275,
-
-      273,  183,  907,  190,  162,  111,  270,  191,  267,  278,
-      281,  296,  189,  264,  282,  921,  920,  964,  896,  882,
-      898,  882,  880,  876,  883,  895,  871,  877,  884,  880,
-      870,  873,  876,  873,  869,  879,  865,  870,  868,  964,
-      873,  862,  339,  861,  964,  291,  876,  859,  151,  873,
-      860,  852,  870,  188,  964,  856,  324,  335,  859,  858,
-      964,  853,  860,  867,  848,  846,  860,  845,  858,  844,
-      334,  859,  841,  843,  844,  842,  844,  839,  836,  837,
-      836,  842,    0,  322,  356,  964,  851,  329,  365,  342,
-      257,  310,  850,  348,  350,  353,  345,  352,  354,  367,
-
-      364,  370,  355,  372,  373,  376,  378,  305,  379,  381,
-      384,  382,  385,  380,  387,  391,  392,  398,  399,  403,
-      405,  831,  829,  834,  826,  841,  826,  838,  822,  840,
-      837,  826,  832,  844,  813,  818,  817,  827,  964,  812,
-      826,  813,  814,  812,  821,  808,  964,  813,  964,  807,
-      808,  964,  812,  811,  810,  814,  808,  813,  800,  810,
-      796,  808,  798,  805,  800,  789,  788,  801,  791,  787,
-      798,  796,  796,  785,  795,  785,  789,  788,  790,  775,
-      799,  964,  800,  786,  964,  767,    0,  406,  409,  408,
-      412,  790,  413,  417,  415,  420,  419,  789,  421,  424,
-
-      788,  426,  422,  787,  429,  423,  120,  430,  434,  439,
-      442,  786,  444,  445,  446,  447,  785,  450,  778,  763,
-      761,  775,  771,  769,  964,  768,  761,  760,  759,  964,
-      772,  771,  771,  964,  964,  765,  964,  964,  762,  964,
-      751,  766,  761,  745,  745,  746,  749,  760,  748,  746,
-      753,  743,  964,  737,  750,  753,  735,  751,  746,  741,
-      732,  729,  723,  729,  736,  725,  729,  964,  733,  964,
-      736,  727,  724,  964,  748,  964,  964,  738,  449,  453,
-      737,  454,  736,  456,  457,  460,  458,  735,  462,  469,
-      734,  472,  474,  733,  476,  477,  483,  732,  731,  479,
-
-      482,  484,  486,  722,  723,  723,  712,  964,  706,  706,
-      717,  708,  700,  720,  702,  712,  964,  964,  964,  710,
-      697,  696,  964,  709,  693,  698,  706,  690,  695,  704,
-      964,  686,  689,  686,  690,  964,  685,  964,  697,  964,
-      680,  677,  964,  695,  679,  680,  681,  682,  498,  509,
-      487,  497,  499,  695,  694,  500,  503,  506,  508,  510,
-      693,  511,  692,  512,  691,  517,  516,  518,  688,  671,
-      682,  964,  681,  666,  964,  684,  678,  679,  677,  666,
-      674,  964,  673,  964,  664,  964,  964,  663,  656,  656,
-      964,  649,  671,  668,  651,  652,  667,  964,  649,  964,
-
-      648,  661,  517,  964,  964,  964,  964,  520,  522,  524,
-      532,  665,  664,  521,  663,  533,  538,  540,  662,  539,
-      641,  964,  964,  964,  650,  655,  640,  648,  964,  634,
-      964,  964,  964,  964,  645,  964,  964,  640,  647,  642,
-      632,  637,  964,  628,  642,  623,  631,  543,  645,  545,
-      544,  547,  546,  548,  549,  559,  554,  638,  639,  633,
-      964,  964,  648,  627,  622,  964,  634,  964,  964,  627,
-      964,  964,  964,  560,  636,  558,  561,  635,  567,  627,
-      619,  562,  964,  599,  964,  591,  586,  964,  561,  558,
-      571,  563,  451,  570,  302,  964,  209,  591,  964,  201,
-
-      576,  589,  160,  604,   59,   45,  575,    0,  964,    6,
-      964,  964,  619,  624,  629,  634,  638,  643,  645,  647
+        1,    0,  491,    0,  471,    0,  504,    0,  409,    0,
+      362,    0,  431,    0,  423,    0,   45,    0,  261,    0,
+      374,    0,  532,    0,  112,    0,  499,    0,  463,    0,
+        0,  195,  178,  223,   89,    0,  327,  323,  360,  380,
+      405,  414,  379,  453,  497,  406,  479,  499,  531,  551,
+      569,  418,  574,  572,  580,  469,  552,  577,  282,  415,
+      408,  592,  594,  377,  436,  599,  584,  583,  597,  589,
+      584,  592,  590,  603,  200,  600,  601,  602,  399,  594,
+      361,  244,  177,  510,    0,    0,  221,    0,  133,    0,
+      299,  534,    0,  542,  544,  612,  472,  499,  589,  599,
+
+      553,  597,  602,  461,  554,  533,  543,  559,  600,    0,
+      604,  615,  620,  601,  614,  599,  600,  607,  454,  505,
+      610,  610,  617,  621,  611,  627,  624,  625,    0,    0,
+        0,    0,  628,  616,  634,  620,  620,  618,  627,  641,
+      619,  627,  636,  634,  626,  631,  636,  635,  633,  645,
+      633,  640,  640,    0,  647,  638,    0,  639,    0,  565,
+      656,  641,  466,  657,  646,  640,  660,  561,    0,  648,
+      571,  575,  653,  654,    0,  651,  660,  669,  652,  652,
+      668,  655,  670,  658,  577,  675,  659,  663,  666,  678,
+      667,  671,  668,  667,  670,  671,  679,    0,    0,    0,
+
+        0,    0,  704,    0,  675,  672,  670,    0,  681,  693,
+      575,  676,  677,  677,  684,  694,  684,  692,    0,  688,
+      708,  692,  687,  703,  706,  693,  690,  694,  692,  709,
+      712,  702,  578,  568,  699,  715,  701,  702,  714,  701,
+      701,  708,  711,  719,  709,  717,  732,  716,  728,  715,
+      730,  720,  732,  715,  717,  722,  724,  735,  726,  721,
+      724,  724,  731,  725,  742,  729,  743,  729,  749,  748,
+      739,  747,  761,  732,  739,  740,  752,    0,  739,  755,
+      744,  747,  747,  758,  747,    0,  754,    0,  750,  753,
+        0,  759,  760,  761,  767,  763,  770,  759,  771,  759,
+
+      773,  765,  774,  771,  762,  763,  778,  770,  768,  781,
+      781,  783,  774,  786,  778,  784,  785,  789,  784,  777,
+      803,    0,  806,  794,    0,  777,  337,  780,  797,  802,
+      803,  802,  800,  789,  803,  806,  808,  810,  795,  804,
+      798,  810,    0,  798,  798,  807,  810,  801,  816,  810,
+      822,  809,  809,    0,  825,  811,  825,  817,    0,  816,
+      826,    0,  831,  829,  815,  831,  827,  820,  830,  823,
+        0,  822,  832,  823,  827,    0,  830,  841,  841,  838,
+      843,  834,  845,  843,  847,  834,  834,  850,  848,  848,
+        0,  849,  844,  845,  846,    0,  861,  862,  864,    0,
+
+        0,  860,    0,    0,  859,    0,  850,  867,  864,  850,
+      852,  855,  860,  873,  863,  863,  872,  864,    0,  860,
+      875,  880,  864,  882,  879,  876,  869,  868,  864,  872,
+      881,  872,  878,    0,  884,    0,  889,  882,  884,  882,
+        0,  908,    0,    0,  900,  895,  884,  878,  889,  893,
+      900,  887,  889,  900,  897,  897,  887,  895,    0,  900,
+        0,  913,  903,  902,  902,    0,  909,  900,  906,  905,
+      910,    0,    0,  908,  906,    0,  913,    0,  921,    0,
+      923,  904,  924,    0,    0,  916,  916,  916,  915,    0,
+        0,  915,  918,  922,  919,  929,  932,  935,  937,  928,
+
+        0,  924,  926,  939,  932,  926,  948,  932,  944,    0,
+        0,    0,  944,  933,  934,    0,  949,  935,  942,  952,
+      938,  945,  956,    0,  940,  945,  944,  950,    0,  947,
+        0,  961,    0,  946,  945,    0,  965,  951,  954,  957,
+      968,  961,  548,  990,    0,    0,  958,  974,  970,  962,
+        0,    0,  960,  976,  973,    0,  978,  969,  973,  981,
+        0,    0,  984,  983,  985,  966,    0,  984,  976,  981,
+        0,  993,    0,  978,    0,  983,  973,  982,  994,  991,
+      997,  983,  989, 1003,  988, 1001,    0, 1002,  989,    0,
+     1009, 1005, 1008, 1008,  999, 1009,    0, 1010,    0, 1003,
+
+        0,    0, 1004,  999, 1001,    0,  996, 1020, 1019, 1004,
+     1007, 1024,    0, 1008,    0, 1009, 1024,    0,  586,    0,
+        0,    0,    0,    0, 1024, 1015,    0, 1015,    0, 1029,
+        0, 1029, 1022,    0, 1034,    0, 1018,    0,    0, 1022,
+        0, 1019, 1021,  587,    0, 1025,    0, 1038, 1024, 1042,
+        0, 1025,    0,    0,    0, 1036, 1043, 1030, 1040,    0,
+     1028,    0,    0,    0,    0, 1041,    0,    0, 1038, 1047,
+     1044, 1036, 1043,    0, 1036, 1052, 1035, 1045, 1056, 1049,
+        0,    0, 1057,    0, 1044,    0, 1047, 1060, 1046, 1044,
+     1054, 1052,    0,    0, 1057, 1066, 1069, 1065,    0,    0,
+
+     1082, 1063, 1060,    0, 1074,    0,    0, 1069,    0,    0,
+        0,    0, 1074,    0, 1071, 1062,    0, 1073,    0,    0,
+     1064, 1068,    0, 1067,    0, 1085, 1082,    0, 1070, 1070,
+        0, 1075,    0, 1072,    0,    0,    0, 1092,  540,    0,
+     1088, 1080, 1090, 1093,    0, 1079,    0, 1080, 1091,    0,
+        0,    0, 1119
     } ;
 
-static const flex_int16_t yy_def[621] =
+static const flex_int16_t yy_def[754] =
     {   0,
-      613,  613,  613,    3,    3,    5,    3,    3,    3,    9,
-        3,    3,    9,   13,    3,   15,  614,  614,  612,   19,
-       19,   21,   21,   21,   21,   21,   21,   27,  612,  612,
-      612,  612,  615,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      616,  616,  612,  612,  617,  616,  618,  612,  619,  619,
-      612,  619,  619,  619,  619,  619,  619,  619,  619,  619,
-
-      619,  619,  619,  619,  619,  619,  619,  619,  619,  619,
-      619,  619,  619,  619,  612,  612,  615,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  616,  616,  617,  612,  619,  619,  619,  619,
-      619,  619,  619,  619,  619,  619,  619,  619,  619,  619,
-
-      619,  619,  619,  619,  619,  619,  619,  619,  619,  619,
-      619,  619,  619,  619,  619,  619,  619,  619,  619,  619,
-      619,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  620,  619,  619,  619,
-      619,  619,  619,  619,  619,  619,  619,  619,  619,  619,
-
-      619,  619,  619,  619,  619,  619,  619,  619,  619,  619,
-      619,  619,  619,  619,  619,  619,  619,  619,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  620,  619,  619,
-      619,  619,  619,  619,  619,  619,  619,  619,  619,  619,
-      619,  619,  619,  619,  619,  619,  619,  619,  619,  619,
-
-      619,  619,  619,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  620,
-      619,  619,  619,  619,  619,  619,  619,  619,  619,  619,
-      619,  619,  619,  619,  619,  619,  619,  619,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-
-      612,  612,  612,  612,  612,  612,  612,  619,  619,  619,
-      619,  619,  619,  619,  619,  619,  619,  619,  619,  619,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  619,  619,  619,
-      619,  619,  619,  619,  619,  619,  619,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  619,  619,  619,  619,  619,  619,  619,
-      619,  619,  612,  612,  612,  612,  612,  612,  612,  612,
-      619,  619,  619,  619,  619,  612,  612,  612,  612,  612,
-
-      619,  619,  612,  612,  612,  619,  619,  612,  612,  619,
-      612,    0,  612,  612,  612,  612,  612,  612,  612,  612
+      753,    1,    1,    3,    1,    5,    3,    7,    7,    9,
+        7,   11,    9,   13,   11,   15,    1,   17,    1,   19,
+       19,   21,   21,   23,   23,   25,   25,   27,   23,   29,
+      753,  753,   32,   32,    1,   32,   32,   32,   32,   32,
+       32,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+       32,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+       32,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+       32,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+       32,   32,   32,   83,   34,   32,   35,   83,   32,   32,
+       32,   91,   32,   91,   91,   91,   91,   91,   91,   91,
+
+       91,   91,   91,   91,   91,   91,   91,   91,   91,   91,
+       91,   91,   91,   91,   91,   91,   91,   91,   91,   91,
+       91,   91,   91,   91,   91,   91,   91,   91,   33,   34,
+       35,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+       32,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+       32,   32,   32,   32,   32,   32,   56,   32,   32,   32,
+       32,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+       32,  153,   32,   32,   32,   32,   32,   32,   32,   32,
+       32,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+       32,   32,   32,   32,   32,   32,   32,   83,   84,   87,
+
+       32,   91,   91,   92,   91,   91,   91,   91,   91,   91,
+       91,   91,   91,   91,   91,   91,   91,   91,   91,   91,
+       91,   91,   91,   91,   91,   91,   91,   91,   91,   91,
+       91,   91,   91,   91,   91,   91,   91,   91,   91,   91,
+       91,   91,   91,   91,   91,   91,   91,   91,   91,   91,
+       91,   91,   91,   91,   91,   91,   91,   91,   91,   91,
+       32,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+       32,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+       32,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+       32,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+
+       32,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+       32,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+       32,   32,   32,   32,   32,   32,   32,   91,   91,   91,
+       91,   91,   91,   91,   91,   91,   91,   91,   91,   91,
+       91,   91,   91,   91,   91,   91,   91,   91,   91,   91,
+       91,   91,   91,   91,   91,   91,   91,   91,   91,   91,
+       91,   91,   91,   91,   91,   91,   91,   91,   91,   91,
+       91,   91,   91,   91,   91,   91,   91,   91,   91,   91,
+       91,   91,   91,   91,   32,   32,   32,   32,   32,   32,
+       32,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+
+       32,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+       32,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+       32,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+       32,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+       32,   32,   32,   32,  327,   91,   91,   91,   91,   91,
+       91,   91,   91,   91,   91,   91,   91,   91,   91,   91,
+       91,   91,   91,   91,   91,   91,   91,   91,   91,   91,
+       91,   91,   91,   91,   91,   91,   91,   91,   91,   91,
+       91,   91,   91,   91,   91,   91,   91,   91,   91,   91,
+       91,   91,   91,   91,   91,   91,   32,   32,   32,   32,
+
+       32,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+       32,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+       32,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+       32,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+       32,   32,   32,  445,   91,   91,   91,   91,   91,   91,
+       91,   91,   91,   91,   91,   91,   91,   91,   91,   91,
+       91,   91,   91,   91,   91,   91,   91,   91,   91,   91,
+       91,   91,   91,   91,   91,   91,   91,   91,   91,   91,
+       91,   91,   91,   32,   32,   32,   32,   32,   32,   32,
+       32,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+
+       32,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+       32,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+       32,   32,   32,   91,   91,   91,   91,   91,   91,   91,
+       91,   91,   91,   91,   91,   91,   91,   91,   91,   91,
+       91,   91,   91,   91,   91,   91,   91,   91,   91,   91,
+       91,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+       32,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+       32,   32,   32,   32,   32,   32,   32,   32,   91,   91,
+       91,   91,   91,   91,   91,   91,   91,   91,   91,   91,
+       91,   91,   91,   91,   91,   32,   32,   32,   32,   32,
+
+       32,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+       32,   91,   91,   91,   91,   91,   91,   91,   91,   91,
+       91,   91,   32,   32,   32,   32,   32,   32,   32,   32,
+       91,   91,   91,   91,   91,   91,   32,   32,   32,   32,
+       32,   91,   91,   32,  739,   32,   91,   91,   32,   32,
+       91,   32,  753
     } ;
 
-static const flex_int16_t yy_nxt[1009] =
+static const flex_int16_t yy_nxt[1165] =
     {   0,
-      612,   31,   32,   31,  115,   33,  115,  612,  612,  143,
-      143,  143,  143,  143,  143,   34,  612,  188,   89,   35,
-       30,   36,   30,  188,   89,   30,  611,   37,   53,   30,
-       38,   39,  148,  149,  107,   40,   41,   31,   32,   31,
-       30,   33,   30,  192,  125,   30,   89,   89,   53,   30,
-       89,   34,   89,   89,  160,   35,   89,   36,  126,   30,
-      161,   30,  188,   37,   30,  188,   38,   39,   30,  138,
-       89,   40,   41,   31,   32,   31,   66,   33,  190,   89,
-       30,  150,   30,  139,  152,   30,  107,   34,  153,   30,
-      151,   42,  154,   43,  171,  609,   44,   66,   89,   89,
-
-       45,   30,   89,   30,   46,   47,   30,   89,   89,  172,
-       30,   89,   48,  184,  144,  184,  188,   49,   50,   51,
-       52,   54,   54,   54,   54,   54,   54,  145,  188,  146,
-      211,   55,   56,   57,  181,   58,   30,  188,  178,  188,
-       30,  191,  394,   59,  182,   60,   61,  179,   62,   63,
-      129,   64,   65,   67,   30,   68,  193,   69,  130,  180,
-      188,   70,  188,  131,  132,   30,  199,   30,   71,   72,
-       73,   30,  194,   30,   74,   30,  118,   75,  117,  188,
-       30,  608,  250,  188,   30,  210,   76,  157,  195,  251,
-       77,  117,   78,   79,   80,   82,   83,   82,   84,   85,
-
-      188,  158,  159,  196,  188,  207,  188,  188,  188,   86,
-      256,   87,   82,   83,   82,   84,   85,  197,  213,  208,
-      257,  219,  198,  209,  605,  220,   86,  603,   87,   30,
-       31,   32,   31,   88,   33,   89,   89,   89,   90,   90,
-       90,   90,   90,   90,   34,   91,   89,   89,   89,   92,
-       89,   93,   89,   89,   94,   89,   95,   89,   89,   96,
-       97,   89,   89,   98,   99,  100,  101,  102,   89,   89,
-       89,   89,   89,  103,  188,   89,   89,   89,   89,   89,
-       89,  188,   30,  115,  188,  115,   89,  188,   89,  289,
-      188,   89,  188,   89,  204,  188,   89,   89,  188,  221,
-
-       89,  104,  105,   89,   89,  106,   89,  200,  205,  212,
-      214,  201,  202,  188,  246,  206,  247,  203,  216,  188,
-      108,  215,  188,  184,  109,  184,  217,  188,  305,  110,
-      111,  218,  287,  112,   89,  113,  114,  290,   89,  189,
-      189,  189,  189,  189,  189,  259,  188,  188,  143,  143,
-      143,  143,  143,  143,  261,  274,  260,  262,  118,  188,
-      117,  288,  188,  292,  294,  188,  275,  188,  242,  188,
-      188,  188,  188,  117,  189,  189,  189,  189,  189,  189,
-      291,  188,  188,  293,  188,  295,  297,  188,  296,  188,
-      188,  300,  302,  188,  298,  188,  188,  188,  188,  188,
-
-      312,  188,  188,  299,  188,  309,  301,  311,  188,  188,
-      303,  314,  304,  307,  308,  188,  188,  306,  316,  310,
-      188,  313,  188,  188,  318,  188,  188,  379,  380,  188,
-      188,  315,  188,  317,  188,  382,  188,  188,  188,  188,
-      188,  188,  381,  188,  384,  391,  188,  188,  392,  383,
-      386,  188,  385,  387,  389,  388,  188,  395,  390,  188,
-      393,  188,  188,  188,  188,  397,  188,  188,  188,  396,
-      188,  188,  400,  188,  188,  188,  398,  188,  451,  188,
-      399,  402,  403,  401,  452,  453,  188,  456,  454,  188,
-      455,  188,  457,  188,  188,  458,  188,  461,  462,  188,
-
-      188,  188,  460,  188,  188,  459,  464,  504,  505,  506,
-      507,  465,  287,  508,  188,  466,  188,  188,  467,  463,
-      188,  511,  468,  188,  509,  188,  450,  188,  188,  188,
-      516,  513,  510,  188,  188,  188,  546,  188,  188,  188,
-      515,  188,  514,  549,  547,  512,  550,  517,  518,  188,
-      188,  551,  520,  548,  552,  188,  188,  188,  519,  555,
-      188,  188,  188,  188,  188,  188,  188,  556,  575,  578,
-      553,  188,  557,  574,  554,  188,  188,  188,  188,  188,
-      188,  576,  577,  591,  188,  592,  579,  188,  188,  582,
-      580,  581,  188,  188,  594,  600,  601,  599,  593,  595,
-
-      604,  604,  604,  604,  604,  604,  188,  602,  606,  598,
-      597,  610,  607,  604,  604,  604,  604,  604,  604,   30,
-       30,   30,   30,   30,   81,   81,   81,   81,   81,  117,
-      117,  117,  117,  117,  183,  596,  188,  183,  185,  185,
-      185,  185,  185,  186,  188,  186,  186,  186,  187,  187,
-      378,  378,  188,  188,  590,  589,  588,  587,  586,  585,
-      584,  583,  188,  573,  572,  571,  570,  569,  568,  567,
-      566,  565,  564,  563,  562,  561,  560,  559,  558,  188,
-      188,  188,  188,  545,  544,  543,  542,  541,  540,  539,
-      538,  537,  536,  535,  534,  533,  532,  531,  530,  529,
-
-      528,  527,  526,  525,  524,  523,  522,  521,  188,  188,
-      188,  188,  188,  503,  502,  501,  500,  499,  498,  497,
-      496,  495,  494,  493,  492,  491,  490,  489,  488,  487,
-      486,  485,  484,  483,  482,  481,  480,  479,  478,  477,
-      476,  475,  474,  473,  472,  471,  470,  469,  188,  188,
-      188,  188,  188,  188,  188,  450,  449,  448,  447,  446,
-      445,  444,  443,  442,  441,  440,  439,  438,  437,  436,
-      435,  434,  433,  432,  431,  430,  429,  428,  427,  426,
-      425,  424,  423,  422,  421,  420,  419,  418,  417,  416,
-      415,  414,  413,  412,  411,  410,  409,  408,  407,  406,
-
-      405,  404,  188,  188,  188,  188,  188,  188,  377,  376,
-      375,  374,  373,  372,  371,  370,  369,  368,  367,  366,
-      365,  364,  363,  362,  361,  360,  359,  358,  357,  356,
-      355,  354,  353,  352,  351,  350,  349,  348,  347,  346,
-      345,  344,  343,  342,  341,  340,  339,  338,  337,  336,
-      335,  334,  333,  332,  331,  330,  329,  328,  327,  326,
-      325,  324,  323,  322,  321,  320,  319,  188,  188,  286,
-      285,  284,  283,  282,  281,  280,  279,  278,  277,  276,
-      273,  272,  271,  270,  269,  268,  267,  266,  265,  264,
-      263,  258,  255,  254,  253,  252,  249,  248,  245,  244,
-
-      243,  242,  241,  240,  239,  238,  237,  236,  235,  234,
-      233,  232,  231,  230,  229,  228,  227,  226,  225,  224,
-      223,  222,  118,  116,  188,  188,  116,  177,  176,  175,
-      174,  173,  170,  169,  168,  167,  166,  165,  164,  163,
-      162,  156,  155,  147,  142,  141,  140,  137,  136,  135,
-      134,  133,  128,  127,  124,  123,  122,  121,  120,  119,
-      118,  116,  612,   29,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-
-      612,  612,  612,  612,  612,  612,  612,  612
+       31,   32,   33,   34,   33,   32,   35,   32,   32,   32,
+       32,   32,   32,   32,   32,   32,   36,   32,   32,   32,
+       37,   32,   38,   32,   32,   32,   32,   32,   39,   32,
+       32,   40,   41,   32,   32,   32,   42,   43,   32,   32,
+       32,   32,   32,   32,   32,   83,   84,   85,   84,   86,
+       87,   83,   83,   83,   83,   83,   83,   83,   83,   83,
+       88,   83,   89,   83,   83,   83,   83,   83,   83,   83,
+       83,   83,   83,   83,   83,   83,   83,   83,   83,   83,
+       83,   83,   83,   83,   83,   83,   83,   83,   83,  131,
+      131,  132,  131,  131,  131,  131,  131,  131,  131,  131,
+
+      131,  131,  131,  131,  131,  131,  131,  131,  131,  131,
+      131,  131,  131,  131,  131,  131,  131,  131,  131,  131,
+      131,  131,  131,  131,  131,  131,  131,  131,  131,  131,
+      131,  131,  131,  201,  201,   91,  201,  201,  201,  201,
+      201,  201,  201,  201,  201,  201,  201,  201,  201,  201,
+      201,  201,  201,  201,  201,  201,  201,  201,  201,  201,
+      201,  201,  201,  201,  201,  201,  201,  201,  201,  201,
+      201,  201,  201,  201,  201,  201,  201,  198,  198,  129,
+      198,  129,  198,  198,  198,  198,  198,  198,  198,  198,
+      198,  198,  198,  198,   31,  198,  198,  198,  198,  198,
+
+      198,  198,  198,  198,  198,  198,  198,  198,  198,  198,
+      198,  198,  198,  198,  198,  198,  198,  198,  198,  198,
+      198,  200,  200,  185,  200,  130,  200,  200,  200,  200,
+      200,  200,  200,  200,  200,  200,  200,  200,  186,  200,
+      200,  200,  200,  200,  200,  200,  200,  200,  200,  200,
+      200,  200,  200,  200,  200,  200,  200,  200,  200,  200,
+      200,  200,  200,  200,  200,   90,  196,   91,   91,   91,
+       92,   92,   92,   92,   92,   92,  197,   93,   91,   91,
+       94,   95,   96,   97,   98,   91,   99,   91,  100,   91,
+       91,  101,  102,  103,   91,  104,  105,  106,  107,  108,
+
+       91,   91,   91,   91,  109,  202,  202,  202,  202,  202,
+      202,  202,  202,  202,  162,  163,  203,  202,  202,  202,
+      202,  202,  202,  202,  202,  202,  202,  202,  202,  202,
+      202,  202,  202,  202,  202,  202,  202,  202,  202,  202,
+      202,  202,  202,  445,  445,  445,  445,  445,  445,  445,
+      445,  445,  133,  134,  445,  445,  445,  445,  445,  445,
+      445,  445,  445,  445,  445,  445,  445,  445,  445,  445,
+      445,  445,  445,  445,  445,  445,  445,  445,  445,  445,
+      445,  110,  193,   91,   91,   91,   91,   91,   91,   32,
+       32,  194,  135,   91,   91,   91,   91,   91,   68,   91,
+
+      171,   91,  139,  195,   91,   91,   91,  136,   91,  111,
+      112,   91,   91,  113,  172,  173,  140,   91,   56,   56,
+       56,   56,   56,   56,  137,  143,  190,  166,   57,   58,
+       59,  167,   60,  144,  191,  168,   32,  138,  145,  146,
+       61,  152,   62,   63,   77,   64,   65,  164,   66,   67,
+       69,   32,   70,   78,   71,  153,  165,   79,   72,   80,
+       81,   82,   32,  174,   32,   73,   74,   75,   32,  175,
+       32,   76,   92,   92,   92,   92,   92,   92,  157,  157,
+      157,  157,  157,  157,  249,  141,  123,  124,  224,  250,
+       32,  225,   32,   48,   49,  125,  226,  289,   32,  126,
+
+      127,   50,   32,  128,  290,  214,   51,   52,   53,   54,
+       44,  199,   45,  199,  215,   46,  142,  147,   32,   47,
+      115,   32,   32,   32,  116,   32,   32,   32,   32,  117,
+      118,   55,   32,  119,  148,  120,  121,  251,  216,   91,
+      217,  252,  122,  204,  204,  204,  204,  204,  204,  745,
+      745,  745,  745,  745,  745,  114,  230,  620,  621,  622,
+      623,  149,  205,  209,  235,  231,  206,   91,   91,  232,
+      233,   91,  207,  227,  210,  234,  158,  228,  236,  208,
+      220,  238,  211,  295,  150,  237,  212,  229,  285,  159,
+      286,  160,  298,  296,  300,  239,  221,  301,  313,  333,
+
+      357,  355,  151,  299,  358,  677,  690,  154,  155,  314,
+      334,  356,  156,  678,  691,  161,  169,  170,  176,  177,
+      178,  179,  180,  181,  182,  183,  184,  187,  188,  189,
+      192,  213,  218,  219,  222,  223,  240,  241,  242,  243,
+      244,  245,  246,  247,  248,  253,  254,  255,  256,  257,
+      258,  259,  260,  261,  262,  263,  264,  265,  266,  267,
+      268,  269,  270,  271,  272,  273,  274,  275,  276,  277,
+      278,  279,  280,  281,  282,  283,  284,  287,  288,  291,
+      292,  293,  294,  297,  302,  303,  304,  305,  306,  307,
+      308,  309,  310,  311,  312,  315,  316,  317,  318,  319,
+
+      320,  321,  322,  323,  324,  325,  326,  327,  328,  329,
+      330,  331,  332,  335,  336,  337,  338,  339,  340,  341,
+      342,  343,  344,  345,  346,  347,  348,  349,  350,  351,
+      352,  353,  354,  359,  360,  361,  362,  363,  364,  365,
+      366,  367,  368,  369,  370,  371,  372,  373,  374,  375,
+      376,  377,  378,  379,  380,  381,  382,  383,  384,  385,
+      386,  387,  388,  389,  390,  391,  392,  393,  394,  395,
+      396,  397,  398,  399,  400,  401,  402,  403,  404,  405,
+      406,  407,  408,  409,  410,  411,  412,  413,  414,  415,
+      416,  417,  418,  419,  420,  421,  422,  423,  424,  425,
+
+      426,  427,  428,  429,  430,  431,  432,  433,  434,  435,
+      436,  437,  438,  439,  440,  441,  442,  443,  444,  446,
+      447,  448,  449,  450,  451,  452,  453,  454,  455,  456,
+      457,  458,  459,  460,  461,  462,  463,  464,  465,  466,
+      467,  468,  469,  470,  471,  472,  473,  474,  475,  476,
+      477,  478,  479,  480,  481,  482,  483,  484,  485,  486,
+      487,  488,  489,  490,  491,  492,  493,  494,  495,  496,
+      497,  498,  499,  500,  501,  502,  503,  504,  505,  506,
+      507,  508,  509,  510,  511,  512,  513,  514,  515,  516,
+      517,  518,  519,  520,  521,  522,  523,  524,  525,  526,
+
+      527,  528,  529,  530,  531,  532,  533,  534,  535,  536,
+      537,  538,  539,  540,  541,  542,  543,  544,  545,  546,
+      547,  548,  549,  550,  551,  552,  553,  554,  555,  556,
+      557,  558,  559,  560,  561,  562,  563,  564,  565,  566,
+      567,  568,  569,  570,  571,  572,  573,  574,  575,  576,
+      577,  578,  579,  580,  581,  582,  583,  584,  585,  586,
+      587,  588,  589,  590,  591,  592,  593,  594,  595,  596,
+      597,  598,  599,  600,  601,  602,  603,  604,  605,  606,
+      607,  608,  609,  610,  611,  612,  613,  614,  615,  616,
+      617,  618,  619,  327,  624,  625,  626,  627,  628,  629,
+
+      630,  631,  632,  633,  634,  635,  636,  637,  638,  639,
+      640,  641,  642,  643,  644,  645,  646,  647,  648,  649,
+      650,  651,  652,  653,  654,  655,  656,  657,  658,  659,
+      660,  661,  662,  663,  664,  665,  666,  667,  668,  669,
+      670,  671,  672,  673,  674,  675,  676,  679,  680,  681,
+      682,  683,  684,  685,  686,  687,  688,  689,  692,  693,
+      694,  695,  696,  697,  698,  699,  700,  701,  702,  703,
+      704,  705,  706,  707,  708,  709,  710,  711,  712,  713,
+      714,  715,  716,  717,  718,  719,  720,  721,  722,  723,
+      724,  725,  726,  727,  728,  729,  730,  731,  732,  733,
+
+      734,  735,  736,  737,  738,  739,  740,  741,  742,  743,
+      744,  746,  747,  748,  749,  750,  751,  752,  753,  753,
+      753,  753,  753,  753,  753,  753,  753,  753,  753,  753,
+      753,  753,  753,  753,  753,  753,  753,  753,  753,  753,
+      753,  753,  753,  753,  753,  753,  753,  753,  753,  753,
+      753,  753,  753,  753,  753,  753,  753,  753,  753,  753,
+      753,  753,  753,    0
     } ;
 
-static const flex_int16_t yy_chk[1009] =
+static const flex_int16_t yy_chk[1165] =
     {   0,
-        0,    1,    1,    1,   31,    1,   31,    0,    0,   54,
-       54,   54,   54,   54,   54,    1,    0,   94,   23,    1,
-        7,    1,    7,  610,   25,    7,  608,    1,    7,    7,
-        1,    1,   57,   57,   23,    1,    1,    2,    2,    2,
-        8,    2,    8,   94,   41,    8,   23,   23,    8,    8,
-       23,    2,   25,   25,   63,    2,   25,    2,   41,   11,
-       63,   11,  606,    2,   11,   92,    2,    2,   11,   50,
-       24,    2,    2,    3,    3,    3,   11,    3,   92,   26,
-       12,   58,   12,   50,   59,   12,   24,    3,   59,   12,
-       58,    3,   59,    3,   73,  605,    3,   12,   24,   24,
-
-        3,    5,   24,    5,    5,    5,    5,   26,   26,   73,
-        5,   26,    5,   82,   55,   82,   93,    5,    5,    5,
-        5,    9,    9,    9,    9,    9,    9,   55,  106,   55,
-      106,    9,    9,    9,   80,    9,    9,  307,   79,   95,
-        9,   93,  307,    9,   80,    9,    9,   79,    9,    9,
-       44,    9,    9,   13,   13,   13,   95,   13,   44,   79,
-       99,   13,   96,   44,   44,   13,   99,   13,   13,   13,
-       13,   13,   96,   13,   13,   15,   85,   15,   85,  105,
-       15,  603,  149,   97,   15,  105,   15,   62,   96,  149,
-       15,   85,   15,   15,   15,   17,   17,   17,   17,   17,
-
-      102,   62,   62,   97,   98,  102,  113,  104,  108,   17,
-      154,   17,   18,   18,   18,   18,   18,   98,  108,  102,
-      154,  113,   98,  104,  600,  113,   18,  597,   18,   19,
-       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
-       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    1,    1,    1,    1,   17,   17,   17,   17,   17,
+       17,   17,   17,   17,   17,   17,   17,   17,   17,   17,
+       17,   17,   17,   17,   17,   17,   17,   17,   17,   17,
+       17,   17,   17,   17,   17,   17,   17,   17,   17,   17,
+       17,   17,   17,   17,   17,   17,   17,   17,   17,   35,
+       35,   35,   35,   35,   35,   35,   35,   35,   35,   35,
+
+       35,   35,   35,   35,   35,   35,   35,   35,   35,   35,
+       35,   35,   35,   35,   35,   35,   35,   35,   35,   35,
+       35,   35,   35,   35,   35,   35,   35,   35,   35,   35,
+       35,   35,   35,   89,   89,   25,   89,   89,   89,   89,
+       89,   89,   89,   89,   89,   89,   89,   89,   89,   89,
+       89,   89,   89,   89,   89,   89,   89,   89,   89,   89,
+       89,   89,   89,   89,   89,   89,   89,   89,   89,   89,
+       89,   89,   89,   89,   89,   89,   89,   83,   83,   33,
+       83,   33,   83,   83,   83,   83,   83,   83,   83,   83,
+       83,   83,   83,   83,   32,   83,   83,   83,   83,   83,
+
+       83,   83,   83,   83,   83,   83,   83,   83,   83,   83,
+       83,   83,   83,   83,   83,   83,   83,   83,   83,   83,
+       83,   87,   87,   75,   87,   34,   87,   87,   87,   87,
+       87,   87,   87,   87,   87,   87,   87,   87,   75,   87,
+       87,   87,   87,   87,   87,   87,   87,   87,   87,   87,
+       87,   87,   87,   87,   87,   87,   87,   87,   87,   87,
+       87,   87,   87,   87,   87,   19,   82,   19,   19,   19,
+       19,   19,   19,   19,   19,   19,   82,   19,   19,   19,
        19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
        19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
-       19,   19,   19,   21,  191,   21,   21,   21,   21,   21,
-       21,  114,   21,  115,  109,  115,   21,  107,   21,  191,
-      101,   21,  100,   21,  101,  110,   21,   21,  111,  114,
-
-       21,   21,   21,   21,   21,   21,   27,  100,  101,  107,
-      109,  100,  100,  112,  146,  101,  146,  100,  111,  595,
-       27,  110,  208,  184,   27,  184,  112,  192,  208,   27,
-       27,  112,  188,   27,   27,   27,   27,  192,   27,   90,
-       90,   90,   90,   90,   90,  157,  188,   90,  143,  143,
-      143,  143,  143,  143,  158,  171,  157,  158,  185,  190,
-      185,  190,  197,  195,  197,  194,  171,  195,  158,  198,
-      196,  199,  203,  185,  189,  189,  189,  189,  189,  189,
-      194,  201,  189,  196,  200,  198,  200,  202,  199,  204,
-      205,  203,  205,  206,  201,  207,  209,  214,  210,  212,
-
-      215,  211,  213,  202,  215,  212,  204,  214,  216,  217,
-      206,  217,  207,  210,  211,  218,  219,  209,  219,  213,
-      220,  216,  221,  288,  221,  290,  289,  288,  289,  291,
-      293,  218,  295,  220,  294,  291,  297,  296,  299,  303,
-      306,  300,  290,  302,  294,  303,  305,  308,  305,  293,
-      296,  309,  295,  297,  300,  299,  310,  308,  302,  311,
-      306,  313,  314,  315,  316,  310,  379,  318,  593,  309,
-      380,  382,  314,  384,  385,  387,  311,  386,  379,  389,
-      313,  316,  318,  315,  380,  382,  390,  386,  384,  392,
-      385,  393,  387,  395,  396,  389,  400,  393,  395,  401,
-
-      397,  402,  392,  403,  451,  390,  397,  449,  449,  449,
-      449,  400,  450,  451,  452,  401,  453,  456,  402,  396,
-      457,  456,  403,  458,  452,  459,  450,  460,  462,  464,
-      462,  458,  453,  467,  466,  468,  503,  508,  514,  509,
-      460,  510,  459,  509,  503,  457,  510,  464,  466,  511,
-      516,  511,  468,  508,  514,  517,  520,  518,  467,  518,
-      548,  551,  550,  553,  552,  554,  555,  518,  550,  553,
-      516,  557,  520,  548,  517,  576,  556,  574,  577,  582,
-      592,  551,  552,  574,  579,  576,  554,  594,  591,  557,
-      555,  556,  607,  601,  579,  590,  592,  589,  577,  582,
-
-      598,  598,  598,  598,  598,  598,  602,  594,  601,  587,
-      586,  607,  602,  604,  604,  604,  604,  604,  604,  613,
-      613,  613,  613,  613,  614,  614,  614,  614,  614,  615,
-      615,  615,  615,  615,  616,  584,  581,  616,  617,  617,
-      617,  617,  617,  618,  580,  618,  618,  618,  619,  619,
-      620,  620,  578,  575,  570,  567,  565,  564,  563,  560,
-      559,  558,  549,  547,  546,  545,  544,  542,  541,  540,
-      539,  538,  535,  530,  528,  527,  526,  525,  521,  519,
-      515,  513,  512,  502,  501,  499,  497,  496,  495,  494,
-      493,  492,  490,  489,  488,  485,  483,  481,  480,  479,
-
-      478,  477,  476,  474,  473,  471,  470,  469,  465,  463,
-      461,  455,  454,  448,  447,  446,  445,  444,  442,  441,
-      439,  437,  435,  434,  433,  432,  430,  429,  428,  427,
-      426,  425,  424,  422,  421,  420,  416,  415,  414,  413,
-      412,  411,  410,  409,  407,  406,  405,  404,  399,  398,
-      394,  391,  388,  383,  381,  378,  375,  373,  372,  371,
-      369,  367,  366,  365,  364,  363,  362,  361,  360,  359,
-      358,  357,  356,  355,  354,  352,  351,  350,  349,  348,
-      347,  346,  345,  344,  343,  342,  341,  339,  336,  333,
-      332,  331,  329,  328,  327,  326,  324,  323,  322,  321,
-
-      320,  319,  317,  312,  304,  301,  298,  292,  286,  284,
-      283,  281,  280,  279,  278,  277,  276,  275,  274,  273,
-      272,  271,  270,  269,  268,  267,  266,  265,  264,  263,
-      262,  261,  260,  259,  258,  257,  256,  255,  254,  253,
-      251,  250,  248,  246,  245,  244,  243,  242,  241,  240,
-      238,  237,  236,  235,  234,  233,  232,  231,  230,  229,
-      228,  227,  226,  225,  224,  223,  222,  193,  187,  182,
-      181,  180,  179,  178,  177,  176,  175,  174,  173,  172,
-      170,  169,  168,  167,  166,  165,  164,  163,  162,  160,
-      159,  156,  153,  152,  151,  150,  148,  147,  144,  142,
-
-      141,  139,  138,  137,  136,  135,  134,  133,  132,  131,
-      130,  129,  128,  127,  126,  125,  124,  123,  122,  121,
-      120,  119,  117,  116,  103,   89,   83,   78,   77,   76,
-       75,   74,   72,   71,   70,   69,   68,   67,   66,   65,
-       64,   61,   60,   56,   53,   52,   51,   49,   48,   47,
-       46,   45,   43,   42,   40,   39,   38,   37,   36,   35,
-       33,   32,   29,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-      612,  612,  612,  612,  612,  612,  612,  612,  612,  612,
-
-      612,  612,  612,  612,  612,  612,  612,  612
+
+       19,   19,   19,   19,   19,   91,   91,   91,   91,   91,
+       91,   91,   91,   91,   59,   59,   91,   91,   91,   91,
+       91,   91,   91,   91,   91,   91,   91,   91,   91,   91,
+       91,   91,   91,   91,   91,   91,   91,   91,   91,   91,
+       91,   91,   91,  327,  327,  327,  327,  327,  327,  327,
+      327,  327,   37,   38,  327,  327,  327,  327,  327,  327,
+      327,  327,  327,  327,  327,  327,  327,  327,  327,  327,
+      327,  327,  327,  327,  327,  327,  327,  327,  327,  327,
+      327,   21,   81,   21,   21,   21,   21,   21,   21,   11,
+       21,   81,   39,   21,   21,   21,   21,   21,   11,   21,
+
+       64,   21,   43,   81,   21,   21,   21,   40,   21,   21,
+       21,   21,   21,   21,   64,   64,   43,   21,    9,    9,
+        9,    9,    9,    9,   41,   46,   79,   61,    9,    9,
+        9,   61,    9,   46,   79,   61,    9,   42,   46,   46,
+        9,   52,    9,    9,   15,    9,    9,   60,    9,    9,
+       13,   13,   13,   15,   13,   52,   60,   15,   13,   15,
+       15,   15,   13,   65,   13,   13,   13,   13,   13,   65,
+       13,   13,   29,   29,   29,   29,   29,   29,   56,   56,
+       56,   56,   56,   56,  119,   44,   29,   29,  104,  119,
+        5,  104,    5,    5,    5,   29,  104,  163,    5,   29,
+
+       29,    5,    5,   29,  163,   97,    5,    5,    5,    5,
+        3,   84,    3,   84,   97,    3,   45,   47,    3,    3,
+       27,    3,    3,    7,   27,    7,    3,    3,    7,   27,
+       27,    7,    7,   27,   48,   27,   27,  120,   98,   23,
+       98,  120,   27,   92,   92,   92,   92,   92,   92,  739,
+      739,  739,  739,  739,  739,   23,  106,  543,  543,  543,
+      543,   49,   94,   95,  107,  106,   94,   23,   23,  106,
+      106,   23,   94,  105,   95,  106,   57,  105,  107,   94,
+      101,  108,   95,  168,   50,  107,   95,  105,  160,   57,
+      160,   57,  171,  168,  172,  108,  101,  172,  185,  211,
+
+      234,  233,   51,  171,  234,  619,  644,   53,   54,  185,
+      211,  233,   55,  619,  644,   58,   62,   63,   66,   67,
+       68,   69,   70,   71,   72,   73,   74,   76,   77,   78,
+       80,   96,   99,  100,  102,  103,  109,  111,  112,  113,
+      114,  115,  116,  117,  118,  121,  122,  123,  124,  125,
+      126,  127,  128,  133,  134,  135,  136,  137,  138,  139,
+      140,  141,  142,  143,  144,  145,  146,  147,  148,  149,
+      150,  151,  152,  153,  155,  156,  158,  161,  162,  164,
+      165,  166,  167,  170,  173,  174,  176,  177,  178,  179,
+      180,  181,  182,  183,  184,  186,  187,  188,  189,  190,
+
+      191,  192,  193,  194,  195,  196,  197,  203,  205,  206,
+      207,  209,  210,  212,  213,  214,  215,  216,  217,  218,
+      220,  221,  222,  223,  224,  225,  226,  227,  228,  229,
+      230,  231,  232,  235,  236,  237,  238,  239,  240,  241,
+      242,  243,  244,  245,  246,  247,  248,  249,  250,  251,
+      252,  253,  254,  255,  256,  257,  258,  259,  260,  261,
+      262,  263,  264,  265,  266,  267,  268,  269,  270,  271,
+      272,  273,  274,  275,  276,  277,  279,  280,  281,  282,
+      283,  284,  285,  287,  289,  290,  292,  293,  294,  295,
+      296,  297,  298,  299,  300,  301,  302,  303,  304,  305,
+
+      306,  307,  308,  309,  310,  311,  312,  313,  314,  315,
+      316,  317,  318,  319,  320,  321,  323,  324,  326,  328,
+      329,  330,  331,  332,  333,  334,  335,  336,  337,  338,
+      339,  340,  341,  342,  344,  345,  346,  347,  348,  349,
+      350,  351,  352,  353,  355,  356,  357,  358,  360,  361,
+      363,  364,  365,  366,  367,  368,  369,  370,  372,  373,
+      374,  375,  377,  378,  379,  380,  381,  382,  383,  384,
+      385,  386,  387,  388,  389,  390,  392,  393,  394,  395,
+      397,  398,  399,  402,  405,  407,  408,  409,  410,  411,
+      412,  413,  414,  415,  416,  417,  418,  420,  421,  422,
+
+      423,  424,  425,  426,  427,  428,  429,  430,  431,  432,
+      433,  435,  437,  438,  439,  440,  442,  445,  446,  447,
+      448,  449,  450,  451,  452,  453,  454,  455,  456,  457,
+      458,  460,  462,  463,  464,  465,  467,  468,  469,  470,
+      471,  474,  475,  477,  479,  481,  482,  483,  486,  487,
+      488,  489,  492,  493,  494,  495,  496,  497,  498,  499,
+      500,  502,  503,  504,  505,  506,  507,  508,  509,  513,
+      514,  515,  517,  518,  519,  520,  521,  522,  523,  525,
+      526,  527,  528,  530,  532,  534,  535,  537,  538,  539,
+      540,  541,  542,  544,  547,  548,  549,  550,  553,  554,
+
+      555,  557,  558,  559,  560,  563,  564,  565,  566,  568,
+      569,  570,  572,  574,  576,  577,  578,  579,  580,  581,
+      582,  583,  584,  585,  586,  588,  589,  591,  592,  593,
+      594,  595,  596,  598,  600,  603,  604,  605,  607,  608,
+      609,  610,  611,  612,  614,  616,  617,  625,  626,  628,
+      630,  632,  633,  635,  637,  640,  642,  643,  646,  648,
+      649,  650,  652,  656,  657,  658,  659,  661,  666,  669,
+      670,  671,  672,  673,  675,  676,  677,  678,  679,  680,
+      683,  685,  687,  688,  689,  690,  691,  692,  695,  696,
+      697,  698,  701,  702,  703,  705,  708,  713,  715,  716,
+
+      718,  721,  722,  724,  726,  727,  729,  730,  732,  734,
+      738,  741,  742,  743,  744,  746,  748,  749,  753,  753,
+      753,  753,  753,  753,  753,  753,  753,  753,  753,  753,
+      753,  753,  753,  753,  753,  753,  753,  753,  753,  753,
+      753,  753,  753,  753,  753,  753,  753,  753,  753,  753,
+      753,  753,  753,  753,  753,  753,  753,  753,  753,  753,
+      753,  753,  753,    0
     } ;
 
 /* Table of booleans, true if rule could match eol. */
-static const flex_int32_t yy_rule_can_match_eol[121] =
+static const flex_int32_t yy_rule_can_match_eol[148] =
     {   0,
 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 
     0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 
     0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 
     0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 
     0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1, 0, 1, 0, 0, 0, 0, 
-    0,     };
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 
+    1, 0, 1, 0, 0, 0, 0, 0,     };
 
 /* The intent behind this definition is that it'll catch
  * any uses of REJECT which flex missed.
@@ -1125,10 +1205,10 @@ static const flex_int32_t yy_rule_can_match_eol[121] =
 #define YY_USER_INIT yycolumn = 0; yylineno = 0;
 
 int identstate = 0;
-#line 1128 "conffile.yy.c"
+#line 1208 "conffile.yy.c"
 #define YY_NO_INPUT 1
 
-#line 1131 "conffile.yy.c"
+#line 1211 "conffile.yy.c"
 
 #define INITIAL 0
 #define cl 1
@@ -1144,6 +1224,7 @@ int identstate = 0;
 #define idag 11
 #define idin 12
 #define idli 13
+#define idva 14
 
 #ifndef YY_NO_UNISTD_H
 /* Special case for "unistd.h", since it is non-ANSI. We include it way
@@ -1420,7 +1501,7 @@ YY_DECL
 	char string_buf[1024];
 	char *strbuf = NULL;
 
-#line 1423 "conffile.yy.c"
+#line 1504 "conffile.yy.c"
 
 	while ( /*CONSTCOND*/1 )		/* loops until end-of-file is reached */
 		{
@@ -1447,13 +1528,13 @@ yy_match:
 			while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 				{
 				yy_current_state = (int) yy_def[yy_current_state];
-				if ( yy_current_state >= 613 )
+				if ( yy_current_state >= 754 )
 					yy_c = yy_meta[yy_c];
 				}
 			yy_current_state = yy_nxt[yy_base[yy_current_state] + yy_c];
 			++yy_cp;
 			}
-		while ( yy_base[yy_current_state] != 964 );
+		while ( yy_base[yy_current_state] != 1119 );
 
 yy_find_action:
 		yy_act = yy_accept[yy_current_state];
@@ -1533,663 +1614,808 @@ return crUSEALL;
 case 6:
 YY_RULE_SETUP
 #line 58 "conffile.l"
+return crSTEAL;
+	YY_BREAK
+case 7:
+YY_RULE_SETUP
+#line 59 "conffile.l"
+return crBALANCED;
+	YY_BREAK
+case 8:
+YY_RULE_SETUP
+#line 60 "conffile.l"
+return crRATE;
+	YY_BREAK
+case 9:
+YY_RULE_SETUP
+#line 61 "conffile.l"
+return crBYTES;
+	YY_BREAK
+case 10:
+YY_RULE_SETUP
+#line 62 "conffile.l"
+return crBURST;
+	YY_BREAK
+case 11:
+YY_RULE_SETUP
+#line 63 "conffile.l"
+return crCATCHUP;
+	YY_BREAK
+case 12:
+YY_RULE_SETUP
+#line 64 "conffile.l"
+return crABOVE;
+	YY_BREAK
+case 13:
+YY_RULE_SETUP
+#line 65 "conffile.l"
+return crEXPIRE;
+	YY_BREAK
+case 14:
+YY_RULE_SETUP
+#line 66 "conffile.l"
+return crAFTER;
+	YY_BREAK
+case 15:
+YY_RULE_SETUP
+#line 67 "conffile.l"
+return crSECONDS;
+	YY_BREAK
+case 16:
+YY_RULE_SETUP
+#line 68 "conffile.l"
+return crNOSTALL;
+	YY_BREAK
+case 17:
+YY_RULE_SETUP
+#line 69 "conffile.l"
+return crBUFFER;
+	YY_BREAK
+case 18:
+YY_RULE_SETUP
+#line 70 "conffile.l"
+return crDOUBLE;
+	YY_BREAK
+case 19:
+YY_RULE_SETUP
+#line 71 "conffile.l"
+return crSYNC;
+	YY_BREAK
+case 20:
+YY_RULE_SETUP
+#line 72 "conffile.l"
+return crALWAYS;
+	YY_BREAK
+case 21:
+YY_RULE_SETUP
+#line 73 "conffile.l"
+return crEVERY;
+	YY_BREAK
+case 22:
+YY_RULE_SETUP
+#line 74 "conffile.l"
+return crROTATE;
+	YY_BREAK
+case 23:
+YY_RULE_SETUP
+#line 75 "conffile.l"
+return crAT;
+	YY_BREAK
+case 24:
+YY_RULE_SETUP
+#line 76 "conffile.l"
 {
 						identstate = idcl;
 						BEGIN(idcl);
 						return crCARBON_CH;
 					}
 	YY_BREAK
-case 7:
+case 25:
 YY_RULE_SETUP
-#line 63 "conffile.l"
+#line 81 "conffile.l"
 {
 						identstate = idcl;
 						BEGIN(idcl);
 						return crFNV1A_CH;
 					}
 	YY_BREAK
-case 8:
+case 26:
 YY_RULE_SETUP
-#line 68 "conffile.l"
+#line 86 "conffile.l"
 {
 						identstate = idcl;
 						BEGIN(idcl);
 						return crJUMP_FNV1A_CH;
 					}
 	YY_BREAK
-case 9:
+case 27:
 YY_RULE_SETUP
-#line 73 "conffile.l"
+#line 91 "conffile.l"
 return crREPLICATION;
 	YY_BREAK
-case 10:
+case 28:
 YY_RULE_SETUP
-#line 74 "conffile.l"
+#line 92 "conffile.l"
 return crDYNAMIC;
 	YY_BREAK
-case 11:
+case 29:
 YY_RULE_SETUP
-#line 75 "conffile.l"
+#line 93 "conffile.l"
 {
 						identstate = idcl;
 						BEGIN(idcl);
 						return crFILE;
 					}
 	YY_BREAK
-case 12:
+case 30:
 YY_RULE_SETUP
-#line 80 "conffile.l"
+#line 98 "conffile.l"
 return crIP;
 	YY_BREAK
-case 13:
+case 31:
 YY_RULE_SETUP
-#line 81 "conffile.l"
+#line 99 "conffile.l"
 return crPROTO;
 	YY_BREAK
-case 14:
+case 32:
 YY_RULE_SETUP
-#line 82 "conffile.l"
+#line 100 "conffile.l"
 return crUDP;
 	YY_BREAK
-case 15:
+case 33:
 YY_RULE_SETUP
-#line 83 "conffile.l"
+#line 101 "conffile.l"
 return crTCP;
 	YY_BREAK
-case 16:
+case 34:
 YY_RULE_SETUP
-#line 84 "conffile.l"
+#line 102 "conffile.l"
 return crTYPE;
 	YY_BREAK
-case 17:
+case 35:
 YY_RULE_SETUP
-#line 85 "conffile.l"
+#line 103 "conffile.l"
 return crLINEMODE;
 	YY_BREAK
-case 18:
+case 36:
 YY_RULE_SETUP
-#line 86 "conffile.l"
+#line 104 "conffile.l"
 return crSYSLOGMODE;
 	YY_BREAK
-case 19:
+case 37:
 YY_RULE_SETUP
-#line 87 "conffile.l"
+#line 105 "conffile.l"
+return crPICKLE;
+	YY_BREAK
+case 38:
+YY_RULE_SETUP
+#line 106 "conffile.l"
 return crTRANSPORT;
 	YY_BREAK
-case 20:
+case 39:
 YY_RULE_SETUP
-#line 88 "conffile.l"
+#line 107 "conffile.l"
 return crPLAIN;
 	YY_BREAK
-case 21:
+case 40:
 YY_RULE_SETUP
-#line 89 "conffile.l"
+#line 108 "conffile.l"
 return crGZIP;
 	YY_BREAK
-case 22:
+case 41:
 YY_RULE_SETUP
-#line 90 "conffile.l"
+#line 109 "conffile.l"
 return crLZ4;
 	YY_BREAK
-case 23:
+case 42:
 YY_RULE_SETUP
-#line 91 "conffile.l"
+#line 110 "conffile.l"
 return crSNAPPY;
 	YY_BREAK
-case 24:
+case 43:
 YY_RULE_SETUP
-#line 92 "conffile.l"
+#line 111 "conffile.l"
+return crZSTD;
+	YY_BREAK
+case 44:
+YY_RULE_SETUP
+#line 112 "conffile.l"
 return crSSL;
 	YY_BREAK
-case 25:
+case 45:
 YY_RULE_SETUP
-#line 93 "conffile.l"
+#line 113 "conffile.l"
 return crMTLS;
 	YY_BREAK
-case 26:
+case 46:
 YY_RULE_SETUP
-#line 94 "conffile.l"
+#line 114 "conffile.l"
 return '=';
 	YY_BREAK
-case 27:
+case 47:
 YY_RULE_SETUP
-#line 96 "conffile.l"
+#line 116 "conffile.l"
 {
 						identstate = idma;
 						BEGIN(idma);
 						return crMATCH;
 					}
 	YY_BREAK
-case 28:
+case 48:
 YY_RULE_SETUP
-#line 101 "conffile.l"
+#line 121 "conffile.l"
 return '*';
 	YY_BREAK
-case 29:
+case 49:
 YY_RULE_SETUP
-#line 102 "conffile.l"
+#line 122 "conffile.l"
 {
 						identstate = ma;
-						BEGIN(idma);
+						BEGIN(idva);
 						return crVALIDATE;
 					}
 	YY_BREAK
-case 30:
+case 50:
 YY_RULE_SETUP
-#line 107 "conffile.l"
-return crELSE;
+#line 127 "conffile.l"
+return crNUMERIC;
 	YY_BREAK
-case 31:
+case 51:
 YY_RULE_SETUP
-#line 108 "conffile.l"
+#line 128 "conffile.l"
+return crFINITE;
+	YY_BREAK
+case 52:
+YY_RULE_SETUP
+#line 129 "conffile.l"
+return crTIMESTAMP;
+	YY_BREAK
+case 53:
+YY_RULE_SETUP
+#line 130 "conffile.l"
+return crWITHIN;
+	YY_BREAK
+case 54:
+YY_RULE_SETUP
+#line 131 "conffile.l"
+return crSECONDS;
+	YY_BREAK
+case 55:
+YY_RULE_SETUP
+#line 132 "conffile.l"
+{
+						BEGIN(ma);
+						return crELSE;
+					}
+	YY_BREAK
+case 56:
+YY_RULE_SETUP
+#line 136 "conffile.l"
 return crLOG;
 	YY_BREAK
-case 32:
+case 57:
 YY_RULE_SETUP
-#line 109 "conffile.l"
+#line 137 "conffile.l"
 return crDROP;
 	YY_BREAK
-case 33:
+case 58:
 YY_RULE_SETUP
-#line 110 "conffile.l"
+#line 138 "conffile.l"
 {
 						BEGIN(ma);
 						return crROUTE;
 					}
 	YY_BREAK
-case 34:
+case 59:
 YY_RULE_SETUP
-#line 114 "conffile.l"
+#line 142 "conffile.l"
 {	
 						identstate = ma;
 						BEGIN(idma);
 						return crUSING;
 					}
 	YY_BREAK
-case 35:
+case 60:
 YY_RULE_SETUP
-#line 119 "conffile.l"
+#line 147 "conffile.l"
 {
 						BEGIN(ma);
 						return crSEND;
 					}
 	YY_BREAK
-case 36:
+case 61:
 YY_RULE_SETUP
-#line 123 "conffile.l"
+#line 151 "conffile.l"
 {
 						identstate = idcl;
 						BEGIN(idcl);
 						return crTO;
 					}
 	YY_BREAK
-case 37:
+case 62:
 YY_RULE_SETUP
-#line 128 "conffile.l"
+#line 156 "conffile.l"
 return crBLACKHOLE;
 	YY_BREAK
-case 38:
+case 63:
 YY_RULE_SETUP
-#line 129 "conffile.l"
+#line 157 "conffile.l"
 return crSTOP;
 	YY_BREAK
-case 39:
+case 64:
 YY_RULE_SETUP
-#line 131 "conffile.l"
+#line 159 "conffile.l"
 {
 						identstate = re;
 						BEGIN(idma);
 						return crREWRITE;
 					}
 	YY_BREAK
-case 40:
+case 65:
 YY_RULE_SETUP
-#line 136 "conffile.l"
+#line 164 "conffile.l"
 {
 						identstate = re;
 						BEGIN(idma);
 						return crINTO;
 					}
 	YY_BREAK
-case 41:
+case 66:
 YY_RULE_SETUP
-#line 142 "conffile.l"
+#line 170 "conffile.l"
 {
 						identstate = idag;
 						BEGIN(idag);
 						return crAGGREGATE;
 					}
 	YY_BREAK
-case 42:
+case 67:
 YY_RULE_SETUP
-#line 147 "conffile.l"
+#line 175 "conffile.l"
 {
 						BEGIN(ag);
 						return crEVERY;
 					}
 	YY_BREAK
-case 43:
+case 68:
 YY_RULE_SETUP
-#line 151 "conffile.l"
+#line 179 "conffile.l"
 return crSECONDS;
 	YY_BREAK
-case 44:
+case 69:
 YY_RULE_SETUP
-#line 152 "conffile.l"
+#line 180 "conffile.l"
 return crEXPIRE;
 	YY_BREAK
-case 45:
+case 70:
 YY_RULE_SETUP
-#line 153 "conffile.l"
+#line 181 "conffile.l"
 return crAFTER;
 	YY_BREAK
-case 46:
+case 71:
 YY_RULE_SETUP
-#line 154 "conffile.l"
+#line 182 "conffile.l"
 return crTIMESTAMP;
 	YY_BREAK
-case 47:
+case 72:
 YY_RULE_SETUP
-#line 155 "conffile.l"
+#line 183 "conffile.l"
 return crAT;
 	YY_BREAK
-case 48:
+case 73:
 YY_RULE_SETUP
-#line 156 "conffile.l"
+#line 184 "conffile.l"
 return crSTART;
 	YY_BREAK
-case 49:
+case 74:
 YY_RULE_SETUP
-#line 157 "conffile.l"
+#line 185 "conffile.l"
 return crMIDDLE;
 	YY_BREAK
-case 50:
+case 75:
 YY_RULE_SETUP
-#line 158 "conffile.l"
+#line 186 "conffile.l"
 return crEND;
 	YY_BREAK
-case 51:
+case 76:
 YY_RULE_SETUP
-#line 159 "conffile.l"
+#line 187 "conffile.l"
 return crOF;
 	YY_BREAK
-case 52:
+case 77:
 YY_RULE_SETUP
-#line 160 "conffile.l"
+#line 188 "conffile.l"
 return crBUCKET;
 	YY_BREAK
-case 53:
+case 78:
 YY_RULE_SETUP
-#line 161 "conffile.l"
+#line 189 "conffile.l"
 return crCOMPUTE;
 	YY_BREAK
-case 54:
+case 79:
 YY_RULE_SETUP
-#line 162 "conffile.l"
+#line 190 "conffile.l"
 return crSUM;
 	YY_BREAK
-case 55:
+case 80:
 YY_RULE_SETUP
-#line 163 "conffile.l"
+#line 191 "conffile.l"
 return crSUM;
 	YY_BREAK
-case 56:
+case 81:
 YY_RULE_SETUP
-#line 164 "conffile.l"
+#line 192 "conffile.l"
 return crCOUNT;
 	YY_BREAK
-case 57:
+case 82:
 YY_RULE_SETUP
-#line 165 "conffile.l"
+#line 193 "conffile.l"
 return crCOUNT;
 	YY_BREAK
-case 58:
+case 83:
 YY_RULE_SETUP
-#line 166 "conffile.l"
+#line 194 "conffile.l"
 return crMAX;
 	YY_BREAK
-case 59:
+case 84:
 YY_RULE_SETUP
-#line 167 "conffile.l"
+#line 195 "conffile.l"
 return crMAX;
 	YY_BREAK
-case 60:
+case 85:
 YY_RULE_SETUP
-#line 168 "conffile.l"
+#line 196 "conffile.l"
 return crMIN;
 	YY_BREAK
-case 61:
+case 86:
 YY_RULE_SETUP
-#line 169 "conffile.l"
+#line 197 "conffile.l"
 return crMIN;
 	YY_BREAK
-case 62:
+case 87:
 YY_RULE_SETUP
-#line 170 "conffile.l"
+#line 198 "conffile.l"
 return crAVERAGE;
 	YY_BREAK
-case 63:
+case 88:
 YY_RULE_SETUP
-#line 171 "conffile.l"
+#line 199 "conffile.l"
 return crAVERAGE;
 	YY_BREAK
-case 64:
+case 89:
 YY_RULE_SETUP
-#line 172 "conffile.l"
+#line 200 "conffile.l"
 return crMEDIAN;
 	YY_BREAK
-case 65:
+case 90:
 YY_RULE_SETUP
-#line 173 "conffile.l"
+#line 201 "conffile.l"
 {
 						yylval_param->crINTVAL =
 							atoi(yytext + strlen("percentile"));
 						return crPERCENTILE;
 					}
 	YY_BREAK
-case 66:
+case 91:
 YY_RULE_SETUP
-#line 178 "conffile.l"
+#line 206 "conffile.l"
 return crVARIANCE;
 	YY_BREAK
-case 67:
+case 92:
 YY_RULE_SETUP
-#line 179 "conffile.l"
+#line 207 "conffile.l"
 return crSTDDEV;
 	YY_BREAK
-case 68:
+case 93:
 YY_RULE_SETUP
-#line 180 "conffile.l"
+#line 208 "conffile.l"
 return crWRITE;
 	YY_BREAK
-case 69:
+case 94:
 YY_RULE_SETUP
-#line 181 "conffile.l"
+#line 209 "conffile.l"
 {
 						identstate = ag;
 						BEGIN(idag);
 						return crTO;
 					}
 	YY_BREAK
-case 70:
+case 95:
 YY_RULE_SETUP
-#line 186 "conffile.l"
+#line 214 "conffile.l"
 {
 						/* reuse the match logic for send to ... stop */
 						BEGIN(ma);
 						return crSEND;
 					}
 	YY_BREAK
-case 71:
+case 96:
 YY_RULE_SETUP
-#line 192 "conffile.l"
+#line 220 "conffile.l"
 {
 						BEGIN(se);
 						return crSEND;
 					}
 	YY_BREAK
-case 72:
+case 97:
 YY_RULE_SETUP
-#line 196 "conffile.l"
+#line 224 "conffile.l"
 {
 						/* reuse the match logic for send to ... stop */
 						BEGIN(ma);
 						return crSTATISTICS;
 					}
 	YY_BREAK
-case 73:
+case 98:
 YY_RULE_SETUP
-#line 202 "conffile.l"
+#line 230 "conffile.l"
 {
 						BEGIN(st);
 						return crSTATISTICS;
 					}
 	YY_BREAK
-case 74:
+case 99:
 YY_RULE_SETUP
-#line 206 "conffile.l"
+#line 234 "conffile.l"
 return crSUBMIT;
 	YY_BREAK
-case 75:
+case 100:
 YY_RULE_SETUP
-#line 207 "conffile.l"
+#line 235 "conffile.l"
 return crEVERY;
 	YY_BREAK
-case 76:
+case 101:
 YY_RULE_SETUP
-#line 208 "conffile.l"
+#line 236 "conffile.l"
 return crSECONDS;
 	YY_BREAK
-case 77:
+case 102:
 YY_RULE_SETUP
-#line 209 "conffile.l"
+#line 237 "conffile.l"
 return crRESET;
 	YY_BREAK
-case 78:
+case 103:
 YY_RULE_SETUP
-#line 210 "conffile.l"
+#line 238 "conffile.l"
 return crCOUNTERS;
 	YY_BREAK
-case 79:
+case 104:
 YY_RULE_SETUP
-#line 211 "conffile.l"
+#line 239 "conffile.l"
 return crAFTER;
 	YY_BREAK
-case 80:
+case 105:
 YY_RULE_SETUP
-#line 212 "conffile.l"
+#line 240 "conffile.l"
 return crINTERVAL;
 	YY_BREAK
-case 81:
+case 106:
 YY_RULE_SETUP
-#line 213 "conffile.l"
+#line 241 "conffile.l"
 return crPREFIX;
 	YY_BREAK
-case 82:
+case 107:
 YY_RULE_SETUP
-#line 214 "conffile.l"
+#line 242 "conffile.l"
 {
 						identstate = st;
 						BEGIN(idag);
 						return crWITH;
 					}
 	YY_BREAK
-case 83:
+case 108:
 YY_RULE_SETUP
-#line 219 "conffile.l"
+#line 247 "conffile.l"
 {
 						/* reuse the match logic for send to ... stop */
 						BEGIN(ma);
 						return crSEND;
 					}
 	YY_BREAK
-case 84:
+case 109:
 YY_RULE_SETUP
-#line 225 "conffile.l"
+#line 253 "conffile.l"
 {
 						BEGIN(li);
 						return crLISTEN;
 					}
 	YY_BREAK
-case 85:
+case 110:
 YY_RULE_SETUP
-#line 229 "conffile.l"
+#line 257 "conffile.l"
 return crTYPE;
 	YY_BREAK
-case 86:
+case 111:
 YY_RULE_SETUP
-#line 230 "conffile.l"
+#line 258 "conffile.l"
 {
 						identstate = li;
 						BEGIN(idli);
 						return crLINEMODE;
 					}
 	YY_BREAK
-case 87:
+case 112:
 YY_RULE_SETUP
-#line 235 "conffile.l"
+#line 263 "conffile.l"
+{
+						identstate = li;
+						BEGIN(idli);
+						return crPICKLE;
+					}
+	YY_BREAK
+case 113:
+YY_RULE_SETUP
+#line 268 "conffile.l"
 return crTRANSPORT;
 	YY_BREAK
-case 88:
+case 114:
 YY_RULE_SETUP
-#line 236 "conffile.l"
+#line 269 "conffile.l"
 {
 						BEGIN(idli);
 						return crPLAIN;
 					}
 	YY_BREAK
-case 89:
+case 115:
 YY_RULE_SETUP
-#line 240 "conffile.l"
+#line 273 "conffile.l"
 {
 						BEGIN(idli);
 						return crGZIP;
 					}
 	YY_BREAK
-case 90:
+case 116:
 YY_RULE_SETUP
-#line 244 "conffile.l"
+#line 277 "conffile.l"
 {
 						BEGIN(idli);
 						return crLZ4;
 					}
 	YY_BREAK
-case 91:
+case 117:
 YY_RULE_SETUP
-#line 248 "conffile.l"
+#line 281 "conffile.l"
 {
 						BEGIN(idli);
 						return crSNAPPY;
 					}
 	YY_BREAK
-case 92:
+case 118:
+YY_RULE_SETUP
+#line 285 "conffile.l"
+{
+						BEGIN(idli);
+						return crZSTD;
+					}
+	YY_BREAK
+case 119:
 YY_RULE_SETUP
-#line 252 "conffile.l"
+#line 289 "conffile.l"
 {
 						identstate = idli;
 						BEGIN(idli);
 						return crSSL;
 					}
 	YY_BREAK
-case 93:
+case 120:
 YY_RULE_SETUP
-#line 257 "conffile.l"
+#line 294 "conffile.l"
 {
 						identstate = idli;
 						BEGIN(idli);
 						return crMTLS;
 					}
 	YY_BREAK
-case 94:
+case 121:
 YY_RULE_SETUP
-#line 262 "conffile.l"
+#line 299 "conffile.l"
 {
 						BEGIN(li);
 						return crPROTOMIN;
 					}
 	YY_BREAK
-case 95:
+case 122:
 YY_RULE_SETUP
-#line 266 "conffile.l"
+#line 303 "conffile.l"
 {
 						BEGIN(li);
 						return crPROTOMAX;
 					}
 	YY_BREAK
-case 96:
+case 123:
 YY_RULE_SETUP
-#line 270 "conffile.l"
+#line 307 "conffile.l"
 {
 						BEGIN(idli);
 						return crSSL3;
 					}
 	YY_BREAK
-case 97:
+case 124:
 YY_RULE_SETUP
-#line 274 "conffile.l"
+#line 311 "conffile.l"
 {
 						BEGIN(idli);
 						return crTLS1_0;
 					}
 	YY_BREAK
-case 98:
+case 125:
 YY_RULE_SETUP
-#line 278 "conffile.l"
+#line 315 "conffile.l"
 {
 						BEGIN(idli);
 						return crTLS1_1;
 					}
 	YY_BREAK
-case 99:
+case 126:
 YY_RULE_SETUP
-#line 282 "conffile.l"
+#line 319 "conffile.l"
 {
 						BEGIN(idli);
 						return crTLS1_2;
 					}
 	YY_BREAK
-case 100:
+case 127:
 YY_RULE_SETUP
-#line 286 "conffile.l"
+#line 323 "conffile.l"
 {
 						BEGIN(idli);
 						return crTLS1_3;
 					}
 	YY_BREAK
-case 101:
+case 128:
 YY_RULE_SETUP
-#line 290 "conffile.l"
+#line 327 "conffile.l"
 {
 						BEGIN(idli);
 						return crCIPHERSUITES;
 					}
 	YY_BREAK
-case 102:
+case 129:
 YY_RULE_SETUP
-#line 294 "conffile.l"
+#line 331 "conffile.l"
 {
 						BEGIN(idli);
 						return crCIPHERS;
 					}
 	YY_BREAK
-case 103:
+case 130:
 YY_RULE_SETUP
-#line 298 "conffile.l"
+#line 335 "conffile.l"
 {
 						BEGIN(li);
 						return crPROTO;
 					}
 	YY_BREAK
-case 104:
+case 131:
 YY_RULE_SETUP
-#line 302 "conffile.l"
+#line 339 "conffile.l"
 {
 						identstate = li;
 						BEGIN(idli);
 						return crUDP;
 					}
 	YY_BREAK
-case 105:
+case 132:
 YY_RULE_SETUP
-#line 307 "conffile.l"
+#line 344 "conffile.l"
 {
 						identstate = li;
 						BEGIN(idli);
 						return crTCP;
 					}
 	YY_BREAK
-case 106:
+case 133:
 YY_RULE_SETUP
-#line 312 "conffile.l"
+#line 349 "conffile.l"
 {
 						identstate = li;
 						BEGIN(idli);
 						return crUNIX;
 					}
 	YY_BREAK
-case 107:
+case 134:
 YY_RULE_SETUP
-#line 318 "conffile.l"
+#line 355 "conffile.l"
 {
 						identstate = INITIAL;
 						BEGIN(idin);
@@ -2197,18 +2423,18 @@ YY_RULE_SETUP
 					}
 	YY_BREAK
 /* handle quoted strings */
-case 108:
+case 135:
 YY_RULE_SETUP
-#line 325 "conffile.l"
+#line 362 "conffile.l"
 {
 						strbuf = string_buf;
 						BEGIN(qu);
 					}
 	YY_BREAK
 
-case 109:
+case 136:
 YY_RULE_SETUP
-#line 330 "conffile.l"
+#line 367 "conffile.l"
 {
 						if (strbuf == string_buf) {
 							router_yyerror(llocp, NULL, rtr, ralloc, palloc,
@@ -2221,10 +2447,10 @@ YY_RULE_SETUP
 						return crSTRING;
 					}
 	YY_BREAK
-case 110:
-/* rule 110 can match eol */
+case 137:
+/* rule 137 can match eol */
 YY_RULE_SETUP
-#line 341 "conffile.l"
+#line 378 "conffile.l"
 {
 						router_yyerror(llocp, NULL, rtr, ralloc, palloc,
 								"unterminated string");
@@ -2232,16 +2458,16 @@ YY_RULE_SETUP
 					}
 	YY_BREAK
 case YY_STATE_EOF(qu):
-#line 346 "conffile.l"
+#line 383 "conffile.l"
 {
 						router_yyerror(llocp, NULL, rtr, ralloc, palloc,
 								"unterminated string");
 						yyterminate();
 					}
 	YY_BREAK
-case 111:
+case 138:
 YY_RULE_SETUP
-#line 351 "conffile.l"
+#line 388 "conffile.l"
 {
 						*strbuf++ = yytext[1];
 						if (strbuf == string_buf + sizeof(string_buf)) {
@@ -2251,9 +2477,9 @@ YY_RULE_SETUP
 						}
 					}
 	YY_BREAK
-case 112:
+case 139:
 YY_RULE_SETUP
-#line 359 "conffile.l"
+#line 396 "conffile.l"
 {
 						char *yptr = yytext;
 						while (*yptr) {
@@ -2267,10 +2493,10 @@ YY_RULE_SETUP
 					}
 	YY_BREAK
 
-case 113:
-/* rule 113 can match eol */
+case 140:
+/* rule 140 can match eol */
 YY_RULE_SETUP
-#line 372 "conffile.l"
+#line 409 "conffile.l"
 {
 						/* ignore for now
 						yylval_param->crCOMMENT = ra_strdup(palloc, yytext);
@@ -2280,42 +2506,42 @@ YY_RULE_SETUP
 						;
 					}
 	YY_BREAK
-case 114:
+case 141:
 YY_RULE_SETUP
-#line 381 "conffile.l"
+#line 418 "conffile.l"
 ; /* whitespace */
 	YY_BREAK
-case 115:
-/* rule 115 can match eol */
+case 142:
+/* rule 142 can match eol */
 YY_RULE_SETUP
-#line 382 "conffile.l"
+#line 419 "conffile.l"
 yycolumn = 0;
 	YY_BREAK
-case 116:
+case 143:
 YY_RULE_SETUP
-#line 383 "conffile.l"
+#line 420 "conffile.l"
 {
 						yylval_param->crINTVAL = atoi(yytext);
 						return crINTVAL;
 					}
 	YY_BREAK
-case 117:
+case 144:
 YY_RULE_SETUP
-#line 387 "conffile.l"
+#line 424 "conffile.l"
 {
 						yylval_param->crSTRING = ra_strdup(palloc, yytext);
 						BEGIN(identstate);
 						return crSTRING;
 					}
 	YY_BREAK
-case 118:
+case 145:
 YY_RULE_SETUP
-#line 392 "conffile.l"
+#line 429 "conffile.l"
 { BEGIN(INITIAL); return ';'; }
 	YY_BREAK
-case 119:
+case 146:
 YY_RULE_SETUP
-#line 393 "conffile.l"
+#line 430 "conffile.l"
 {
 						/* feed this back to the parser, it will give a
 						 * nice error message */
@@ -2323,12 +2549,12 @@ YY_RULE_SETUP
 						return crUNEXPECTED;
 					}
 	YY_BREAK
-case 120:
+case 147:
 YY_RULE_SETUP
-#line 400 "conffile.l"
+#line 437 "conffile.l"
 ECHO;
 	YY_BREAK
-#line 2331 "conffile.yy.c"
+#line 2557 "conffile.yy.c"
 case YY_STATE_EOF(INITIAL):
 case YY_STATE_EOF(cl):
 case YY_STATE_EOF(ma):
@@ -2342,6 +2568,7 @@ case YY_STATE_EOF(idma):
 case YY_STATE_EOF(idag):
 case YY_STATE_EOF(idin):
 case YY_STATE_EOF(idli):
+case YY_STATE_EOF(idva):
 	yyterminate();
 
 	case YY_END_OF_BUFFER:
@@ -2639,7 +2866,7 @@ static int yy_get_next_buffer (yyscan_t yyscanner)
 		while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 			{
 			yy_current_state = (int) yy_def[yy_current_state];
-			if ( yy_current_state >= 613 )
+			if ( yy_current_state >= 754 )
 				yy_c = yy_meta[yy_c];
 			}
 		yy_current_state = yy_nxt[yy_base[yy_current_state] + yy_c];
@@ -2668,11 +2895,11 @@ static int yy_get_next_buffer (yyscan_t yyscanner)
 	while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 		{
 		yy_current_state = (int) yy_def[yy_current_state];
-		if ( yy_current_state >= 613 )
+		if ( yy_current_state >= 754 )
 			yy_c = yy_meta[yy_c];
 		}
 	yy_current_state = yy_nxt[yy_base[yy_current_state] + yy_c];
-	yy_is_jam = (yy_current_state == 612);
+	yy_is_jam = (yy_current_state == 753);
 
 	(void)yyg;
 	return yy_is_jam ? 0 : yy_current_state;
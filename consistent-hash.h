@@ -40,5 +40,6 @@ void ch_get_nodes(
 		const char *firstspace);
 void ch_printhashring(ch_ring *ring, FILE *out);
 unsigned short ch_gethashpos(ch_ring *ring, const char *key, const char *end);
+unsigned int jump_bucketpos(unsigned long long int key, int bckcnt);
 
 #endif
@@ -37,6 +37,7 @@
 #include "collector.h"
 #include "dispatcher.h"
 #include "receptor.h"
+#include "pickle.h"
 
 #ifdef HAVE_GZIP
 #include <zlib.h>
@@ -48,6 +49,9 @@
 #ifdef HAVE_SNAPPY
 #include <snappy-c.h>
 #endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
 #ifdef HAVE_SSL
 #include <openssl/ssl.h>
 #include <openssl/err.h>
@@ -85,10 +89,26 @@ typedef struct _z_strm {
 			size_t iloc; /* location for unprocessed input */
 		} lz4;
 #endif
+#ifdef HAVE_ZSTD
+		struct zstd {
+			ZSTD_DCtx *dctx;
+			size_t iloc;   /* location for unprocessed input */
+			char pending;  /* output may be left in the decompressor */
+		} zstd;
+#endif
 #ifdef HAVE_SSL
 		SSL *ssl;
 #endif
 		int sock;
+		/* pickle frames decoded into lines */
+		struct pkl {
+			pickle *dec;
+			char *fbuf;
+			size_t fsize;
+			size_t fill;
+			size_t flen;   /* length of the frame at fbuf, 0 if unknown */
+			char warned;
+		} pkl;
 		/* udp variant (in order to receive info about sender) */
 		struct udp_strm {
 			int sock;
@@ -97,7 +117,7 @@ typedef struct _z_strm {
 			size_t srcaddrlen;
 		} udp;
 	} hdl;
-#if defined(HAVE_GZIP) || defined(HAVE_LZ4) || defined(HAVE_SNAPPY)
+#if defined(HAVE_GZIP) || defined(HAVE_LZ4) || defined(HAVE_SNAPPY) || defined(HAVE_ZSTD)
 	char *ibuf;
 	size_t ipos;
 	size_t isize;
@@ -110,6 +130,7 @@ typedef struct _z_strm {
 #define MAX_LISTENERS 32  /* hopefully enough */
 #define POLL_TIMEOUT  100
 #define IDLE_DISCONNECT_TIME  (10 * 60 * 1000 * 1000)  /* 10 minutes */
+#define CONN_STAGE_SIZE  (4 * CONN_DESTS_SIZE)
 
 /* connection takenby */
 #define C_SETUP -2 /* being setup */
@@ -130,7 +151,7 @@ typedef struct _connection {
 	unsigned char isudp:1;
 	char datawaiting; /* full byte for atomic access */
 	char metric[METRIC_BUFSIZ];
-	destination dests[CONN_DESTS_SIZE];
+	destination dests[CONN_STAGE_SIZE];  /* routed, but not yet queued */
 	size_t destlen;
 	struct timeval lastwork;
 	unsigned int maxsenddelay;
@@ -168,6 +189,7 @@ pthread_rwlock_t listenerslock = PTHREAD_RWLOCK_INITIALIZER;
 pthread_rwlock_t connectionslock = PTHREAD_RWLOCK_INITIALIZER;
 static size_t acceptedconnections = 0;
 static size_t closedconnections = 0;
+static size_t ktlsconnections = 0;
 static unsigned int sockbufsize = 0;
 
 /* connection specific readers and closers */
@@ -496,6 +518,98 @@ snappyclose(z_strm *strm)
 }
 #endif
 
+#ifdef HAVE_ZSTD
+/* zstd wrapped socket */
+static ZSTD_DDict *zstddict = NULL;
+
+static inline ssize_t
+zstdreadbuf(z_strm *strm, void *buf, size_t sze, int rval, int err);
+
+static inline ssize_t
+zstdread(z_strm *strm, void *buf, size_t sze)
+{
+	int ret;
+
+	/* update ibuf */
+	if (strm->hdl.zstd.iloc > 0) {
+		memmove(strm->ibuf, strm->ibuf + strm->hdl.zstd.iloc,
+				strm->ipos - strm->hdl.zstd.iloc);
+		strm->ipos -= strm->hdl.zstd.iloc;
+		strm->hdl.zstd.iloc = 0;
+	} else if (strm->ipos == strm->isize) {
+		logerr("buffer overflow during read of zstd stream\n");
+		errno = EMSGSIZE;
+		return -1;
+	}
+
+	/* read any available data, if it fits */
+	ret = strm->nextstrm->strmread(strm->nextstrm,
+			strm->ibuf + strm->ipos, strm->isize - strm->ipos);
+
+	/* on EOF or no data, only get out when nothing is left to
+	 * decompress */
+	if (ret > 0) {
+		strm->ipos += ret;
+	} else if (strm->ipos == 0 && !strm->hdl.zstd.pending) {
+		return ret;
+	}
+	return zstdreadbuf(strm, buf, sze, ret, errno);
+}
+
+static inline ssize_t
+zstdreadbuf(z_strm *strm, void *buf, size_t sze, int rval, int err)
+{
+	ZSTD_inBuffer in;
+	ZSTD_outBuffer out;
+	size_t ret;
+
+	in.src = strm->ibuf;
+	in.size = strm->ipos;
+	in.pos = strm->hdl.zstd.iloc;
+	if (in.pos == in.size && !strm->hdl.zstd.pending)
+		return 0;  /* input buffer decompressed */
+
+	out.dst = buf;
+	out.size = sze;
+	out.pos = 0;
+	ret = ZSTD_decompressStream(strm->hdl.zstd.dctx, &out, &in);
+	if (ZSTD_isError(ret)) {
+		/* there is no way to find the next block in the stream, so
+		 * drop what we have, which ends the connection */
+		logerr("error reading zstd compressed data, lost %zu bytes "
+				"in input buffer: %s\n",
+				in.size - in.pos, ZSTD_getErrorName(ret));
+		ZSTD_DCtx_reset(strm->hdl.zstd.dctx, ZSTD_reset_session_only);
+		strm->hdl.zstd.iloc = strm->ipos;
+		strm->hdl.zstd.pending = 0;
+		errno = EBADMSG;
+		return -1;
+	}
+	strm->hdl.zstd.iloc = in.pos;
+	/* a full output buffer means there may be more to flush */
+	strm->hdl.zstd.pending = out.pos == out.size;
+
+	if (out.pos == 0) {
+		if (rval == 0)
+			return 0;  /* EOF, nothing more will come */
+		errno = err ? err : EAGAIN;
+		return -1;
+	}
+
+	return (ssize_t)out.pos;
+}
+
+static inline int
+zstdclose(z_strm *strm)
+{
+	int ret = strm->nextstrm->strmclose(strm->nextstrm);
+	ZSTD_freeDCtx(strm->hdl.zstd.dctx);
+	free(strm->ibuf);
+	free(strm);
+	return ret;
+}
+#endif
+
 #ifdef HAVE_SSL
 /* (Open|Libre)SSL wrapped socket */
 static inline ssize_t
@@ -504,6 +618,23 @@ sslread(z_strm *strm, void *buf, size_t sze)
 	return (ssize_t)SSL_read(strm->hdl.ssl, buf, (int)sze);
 }
 
+/* sslread that once the handshake is done, records whether the kernel
+ * took over decryption, and then becomes a normal sslread */
+static ssize_t
+sslktlsread(z_strm *strm, void *buf, size_t sze)
+{
+	ssize_t ret = sslread(strm, buf, sze);
+
+	if (SSL_is_init_finished(strm->hdl.ssl)) {
+#ifdef BIO_get_ktls_recv
+		if (BIO_get_ktls_recv(SSL_get_rbio(strm->hdl.ssl)))
+			__sync_add_and_fetch(&ktlsconnections, 1);
+#endif
+		strm->strmread = &sslread;
+	}
+	return ret;
+}
+
 static inline int
 sslclose(z_strm *strm)
 {
@@ -514,6 +645,151 @@ sslclose(z_strm *strm)
 }
 #endif
 
+/* pickle decoding stream, frames are a 4-byte big-endian length
+ * followed by a pickled list of (path, (timestamp, value)) tuples */
+static ssize_t
+pickledecode(z_strm *strm, char *buf, size_t sze, char *needinput)
+{
+	struct pkl *p = &strm->hdl.pkl;
+	const unsigned char *hdr = (const unsigned char *)p->fbuf;
+	size_t out = 0;
+	size_t written;
+	size_t flen;
+	char *nbuf;
+	int ret;
+
+	*needinput = 0;
+	while (1) {
+		if (p->flen == 0) {
+			if (p->fill < 4) {
+				*needinput = 1;
+				break;
+			}
+			flen = ((size_t)hdr[0] << 24) | ((size_t)hdr[1] << 16) |
+				((size_t)hdr[2] << 8) | (size_t)hdr[3];
+			if (flen > PICKLE_MAX_FRAME) {
+				logerr("dropping connection sending a pickle frame of "
+						"%zu bytes, more than the maximum of %d\n",
+						flen, PICKLE_MAX_FRAME);
+				errno = EMSGSIZE;
+				return -1;
+			}
+			if (flen + 4 > p->fsize) {
+				if ((nbuf = realloc(p->fbuf, flen + 4)) == NULL) {
+					logerr("out of memory during read of pickle stream\n");
+					errno = ENOMEM;
+					return -1;
+				}
+				p->fbuf = nbuf;
+				p->fsize = flen + 4;
+				hdr = (const unsigned char *)p->fbuf;
+			}
+			p->flen = flen + 4;
+		}
+		if (p->fill < p->flen) {
+			*needinput = 1;
+			break;
+		}
+
+		ret = pickle_decode(p->dec, p->fbuf + 4, p->flen - 4,
+				buf + out, sze - out, &written);
+		out += written;
+		if (ret == 0)
+			break;  /* buf is full */
+		if (ret < 0 && !p->warned) {
+			/* once, don't let a broken client flood the log */
+			logerr("dropping malformed pickle frame: %s\n",
+					pickle_error(p->dec));
+			p->warned = 1;
+		}
+
+		/* move on to the next frame */
+		p->fill -= p->flen;
+		memmove(p->fbuf, p->fbuf + p->flen, p->fill);
+		p->flen = 0;
+
+		/* don't hold on to the buffer a large frame needed */
+		if (p->fsize > METRIC_BUFSIZ && p->fill <= METRIC_BUFSIZ &&
+				(nbuf = realloc(p->fbuf, METRIC_BUFSIZ)) != NULL)
+		{
+			p->fbuf = nbuf;
+			p->fsize = METRIC_BUFSIZ;
+			hdr = (const unsigned char *)p->fbuf;
+		}
+	}
+
+	return (ssize_t)out;
+}
+
+static inline ssize_t
+pickleread(z_strm *strm, void *buf, size_t sze)
+{
+	struct pkl *p = &strm->hdl.pkl;
+	ssize_t ret;
+	char needinput;
+
+	/* frames that were read before come first */
+	if ((ret = pickledecode(strm, buf, sze, &needinput)) != 0)
+		return ret;
+	if (!needinput) {
+		/* no room for the next datapoint */
+		errno = EAGAIN;
+		return -1;
+	}
+
+	ret = strm->nextstrm->strmread(strm->nextstrm,
+			p->fbuf + p->fill, p->fsize - p->fill);
+	if (ret <= 0)
+		return ret;
+	p->fill += ret;
+
+	if ((ret = pickledecode(strm, buf, sze, &needinput)) == 0) {
+		/* no complete frame yet */
+		errno = EAGAIN;
+		return -1;
+	}
+	return ret;
+}
+
+static inline ssize_t
+picklereadbuf(z_strm *strm, void *buf, size_t sze, int rval, int err)
+{
+	struct pkl *p = &strm->hdl.pkl;
+	ssize_t ret;
+	char needinput;
+
+	ret = pickledecode(strm, buf, sze, &needinput);
+	if (ret == 0 && needinput && strm->nextstrm->strmreadbuf != NULL) {
+		/* a decompressor may still hold data */
+		ret = strm->nextstrm->strmreadbuf(strm->nextstrm,
+				p->fbuf + p->fill, p->fsize - p->fill, rval, err);
+		if (ret <= 0)
+			return ret;
+		p->fill += ret;
+		ret = pickledecode(strm, buf, sze, &needinput);
+	}
+
+	return ret;
+}
+
+static inline void
+picklefree(z_strm *strm)
+{
+	if (strm->hdl.pkl.dec != NULL)
+		pickle_free(strm->hdl.pkl.dec);
+	if (strm->hdl.pkl.fbuf != NULL)
+		free(strm->hdl.pkl.fbuf);
+	free(strm);
+}
+
+static inline int
+pickleclose(z_strm *strm)
+{
+	int ret = strm->nextstrm->strmclose(strm->nextstrm);
+	picklefree(strm);
+	return ret;
+}
+
 /**
  * Helper function to try and be helpful to the user.  If errno
  * indicates no new fds could be made, checks what the current max open
@@ -666,11 +942,12 @@ dispatch_addconnection(int sock, listener *lsnr)
 	size_t c;
 	struct sockaddr_in6 saddr;
 	socklen_t saddr_len = sizeof(saddr);
-#if defined(HAVE_GZIP) || defined(HAVE_LZ4) || defined(HAVE_SNAPPY)
+#if defined(HAVE_GZIP) || defined(HAVE_LZ4) || defined(HAVE_SNAPPY) || defined(HAVE_ZSTD)
 	int compress_type;
 	char *ibuf;
 #endif
 	char checksize;
+	z_strm *pstrm = NULL;
 
 	pthread_rwlock_rdlock(&connectionslock);
 	for (c = 0; c < connectionslen; c++)
@@ -764,6 +1041,30 @@ dispatch_addconnection(int sock, listener *lsnr)
 		return -1;
 	}
 
+	/* pickle decoder, put on top of the chain at the end */
+	if (lsnr != NULL && lsnr->lsnrtype == T_PICKLE) {
+		if ((pstrm = malloc(sizeof(z_strm))) != NULL) {
+			pstrm->hdl.pkl.dec = pickle_new();
+			pstrm->hdl.pkl.fbuf = malloc(METRIC_BUFSIZ);
+			pstrm->hdl.pkl.fsize = METRIC_BUFSIZ;
+			pstrm->hdl.pkl.fill = 0;
+			pstrm->hdl.pkl.flen = 0;
+			pstrm->hdl.pkl.warned = 0;
+		}
+		if (pstrm == NULL ||
+				pstrm->hdl.pkl.dec == NULL || pstrm->hdl.pkl.fbuf == NULL)
+		{
+			logerr("cannot add new connection: "
+					"out of memory allocating pickle stream\n");
+			if (pstrm != NULL)
+				picklefree(pstrm);
+			free(connections[c].strm);
+			__sync_bool_compare_and_swap(&(connections[c].takenby),
+					C_SETUP, C_FREE);
+			return -1;
+		}
+	}
+
 	/* set socket or SSL connection */
 	connections[c].strm->nextstrm = NULL;
 	connections[c].strm->strmreadbuf = NULL;
@@ -787,6 +1088,8 @@ dispatch_addconnection(int sock, listener *lsnr)
 			logerr("cannot add new connection: %s\n",
 					ERR_reason_error_string(ERR_get_error()));
 			free(connections[c].strm);
+			if (pstrm != NULL)
+				picklefree(pstrm);
 			__sync_bool_compare_and_swap(&(connections[c].takenby),
 					C_SETUP, C_FREE);
 			return -1;
@@ -801,12 +1104,12 @@ dispatch_addconnection(int sock, listener *lsnr)
 						   NULL);
 		}
 
-		connections[c].strm->strmread = &sslread;
+		connections[c].strm->strmread = sslktls ? &sslktlsread : &sslread;
 		connections[c].strm->strmclose = &sslclose;
 #endif
 	}
 
-#if defined(HAVE_GZIP) || defined(HAVE_LZ4) || defined(HAVE_SNAPPY)
+#if defined(HAVE_GZIP) || defined(HAVE_LZ4) || defined(HAVE_SNAPPY) || defined(HAVE_ZSTD)
 	if (lsnr == NULL)
 		compress_type = 0;
 	else
@@ -822,6 +1125,9 @@ dispatch_addconnection(int sock, listener *lsnr)
 #endif
 #ifdef HAVE_SNAPPY
 		compress_type == W_SNAPPY ||
+#endif
+#ifdef HAVE_ZSTD
+		compress_type == W_ZSTD ||
 #endif
 		0)
 	{
@@ -830,6 +1136,8 @@ dispatch_addconnection(int sock, listener *lsnr)
 			logerr("cannot add new connection: "
 					"out of memory allocating stream ibuf\n");
 			free(connections[c].strm);
+			if (pstrm != NULL)
+				picklefree(pstrm);
 			__sync_bool_compare_and_swap(&(connections[c].takenby),
 					C_SETUP, C_FREE);
 			return -1;
@@ -851,6 +1159,8 @@ dispatch_addconnection(int sock, listener *lsnr)
 					"out of memory allocating gzip stream\n");
 			free(ibuf);
 			free(connections[c].strm);
+			if (pstrm != NULL)
+				picklefree(pstrm);
 			__sync_bool_compare_and_swap(&(connections[c].takenby),
 					C_SETUP, C_FREE);
 			return -1;
@@ -869,6 +1179,8 @@ dispatch_addconnection(int sock, listener *lsnr)
 			logerr("cannot init gzip connection\n");
 			free(ibuf);
 			free(connections[c].strm);
+			if (pstrm != NULL)
+				picklefree(pstrm);
 			free(zstrm);
 			__sync_bool_compare_and_swap(&(connections[c].takenby),
 					C_SETUP, C_FREE);
@@ -890,6 +1202,8 @@ dispatch_addconnection(int sock, listener *lsnr)
 					"out of memory allocating lz4 stream\n");
 			free(ibuf);
 			free(connections[c].strm);
+			if (pstrm != NULL)
+				picklefree(pstrm);
 			__sync_bool_compare_and_swap(&(connections[c].takenby),
 					C_SETUP, C_FREE);
 			return -1;
@@ -900,6 +1214,8 @@ dispatch_addconnection(int sock, listener *lsnr)
 			logerr("Failed to create LZ4 decompression context\n");
 			free(ibuf);
 			free(connections[c].strm);
+			if (pstrm != NULL)
+				picklefree(pstrm);
 			free(lzstrm);
 			__sync_bool_compare_and_swap(&(connections[c].takenby),
 					C_SETUP, C_FREE);
@@ -927,6 +1243,8 @@ dispatch_addconnection(int sock, listener *lsnr)
 					C_SETUP, C_FREE);
 			free(ibuf);
 			free(connections[c].strm);
+			if (pstrm != NULL)
+				picklefree(pstrm);
 			__sync_bool_compare_and_swap(&(connections[c].takenby),
 					C_SETUP, C_FREE);
 			return -1;
@@ -943,6 +1261,47 @@ dispatch_addconnection(int sock, listener *lsnr)
 		connections[c].strm = lzstrm;
 	}
 #endif
+#ifdef HAVE_ZSTD
+	else if (compress_type == W_ZSTD) {
+		z_strm *zstdstrm = malloc(sizeof(z_strm));
+		if (zstdstrm == NULL ||
+				(zstdstrm->hdl.zstd.dctx = ZSTD_createDCtx()) == NULL)
+		{
+			logerr("cannot add new connection: "
+					"out of memory allocating zstd stream\n");
+			if (zstdstrm != NULL)
+				free(zstdstrm);
+			free(ibuf);
+			free(connections[c].strm);
+			if (pstrm != NULL)
+				picklefree(pstrm);
+			__sync_bool_compare_and_swap(&(connections[c].takenby),
+					C_SETUP, C_FREE);
+			return -1;
+		}
+		if (zstddict != NULL)
+			ZSTD_DCtx_refDDict(zstdstrm->hdl.zstd.dctx, zstddict);
+		zstdstrm->ibuf = ibuf;
+		zstdstrm->isize = METRIC_BUFSIZ;
+		zstdstrm->ipos = 0;
+		zstdstrm->hdl.zstd.iloc = 0;
+		zstdstrm->hdl.zstd.pending = 0;
+
+		zstdstrm->strmread = &zstdread;
+		zstdstrm->strmreadbuf = &zstdreadbuf;
+		zstdstrm->strmclose = &zstdclose;
+		zstdstrm->nextstrm = connections[c].strm;
+		connections[c].strm = zstdstrm;
+	}
+#endif
+
+	if (pstrm != NULL) {
+		pstrm->strmread = &pickleread;
+		pstrm->strmreadbuf = &picklereadbuf;
+		pstrm->strmclose = &pickleclose;
+		pstrm->nextstrm = connections[c].strm;
+		connections[c].strm = pstrm;
+	}
 
 	connections[c].buflen = 0;
 	connections[c].needmore = 0;
@@ -980,40 +1339,70 @@ dispatch_addconnection_aggr(int sock)
 	return 0;
 }
 
+/**
+ * Queues the metrics staged in conn->dests to their servers.  Routed
+ * metrics are collected until the stage cannot hold the destinations
+ * of another metric, or flush is set, which is done at the end of each
+ * read batch.  The metrics are then handed to each server in a single
+ * vector.  Returns 0 when the stage could not be emptied enough, which
+ * stalls the connection.
+ */
 inline static char
-dispatch_process_dests(connection *conn, dispatcher *self, struct timeval now)
+dispatch_process_dests(connection *conn, dispatcher *self,
+		struct timeval now, char flush)
 {
-	int i;
+	const char *metrics[CONN_STAGE_SIZE];
+	size_t idx[CONN_STAGE_SIZE];
+	char seen[CONN_STAGE_SIZE];
+	size_t i;
+	size_t j;
+	size_t len;
+	size_t sent;
+	server *dest;
 	char force;
 
-	if (conn->destlen > 0) {
-		if (conn->maxsenddelay == 0)
-			conn->maxsenddelay = ((rand() % 750) + 250) * 1000;
-		/* force when aggr (don't stall it) or after timeout */
-		force = conn->isaggr ? 1 :
-			timediff(conn->lastwork, now) > conn->maxsenddelay;
-		for (i = 0; i < conn->destlen; i++) {
+	if (conn->destlen == 0)
+		return 1;
+	if (!flush && CONN_STAGE_SIZE - conn->destlen >= CONN_DESTS_SIZE)
+		return 1;
+
+	if (conn->maxsenddelay == 0)
+		conn->maxsenddelay = ((rand() % 750) + 250) * 1000;
+	/* force when aggr (don't stall it) or after timeout */
+	force = conn->isaggr ? 1 :
+		timediff(conn->lastwork, now) > conn->maxsenddelay;
+	memset(seen, 0, conn->destlen);
+	for (i = 0; i < conn->destlen; i++) {
+		if (seen[i])
+			continue;
+		/* collect everything for this server, keeping the order */
+		dest = conn->dests[i].dest;
+		for (len = 0, j = i; j < conn->destlen; j++) {
+			if (conn->dests[j].dest != dest)
+				continue;
 			tracef("dispatcher %d, connfd %d, metric %s, queueing to %s:%d\n",
-					self->id, conn->sock, conn->dests[i].metric,
-					server_ip(conn->dests[i].dest),
-					server_port(conn->dests[i].dest));
-			if (server_send(conn->dests[i].dest,
-						conn->dests[i].metric, force) == 0)
-				break;
-		}
-		if (i < conn->destlen) {
-			conn->destlen -= i;
-			memmove(&conn->dests[0], &conn->dests[i],
-					(sizeof(destination) * conn->destlen));
-			return 0;
-		} else {
-			/* finally "complete" this metric */
-			conn->destlen = 0;
-			conn->lastwork = now;
+					self->id, conn->sock, conn->dests[j].metric,
+					server_ip(dest), server_port(dest));
+			seen[j] = 1;
+			metrics[len] = conn->dests[j].metric;
+			idx[len++] = j;
 		}
+		sent = server_send_vector(dest, metrics, len, force);
+		for (j = 0; j < sent; j++)
+			conn->dests[idx[j]].dest = NULL;
 	}
-
-	return 1;
+	/* keep what we couldn't queue for a retry */
+	for (i = 0, j = 0; i < conn->destlen; i++)
+		if (conn->dests[i].dest != NULL)
+			conn->dests[j++] = conn->dests[i];
+	conn->destlen = j;
+
+	if (conn->destlen == 0) {
+		/* finally "complete" these metrics */
+		conn->lastwork = now;
+		return 1;
+	}
+	return !flush && CONN_STAGE_SIZE - conn->destlen >= CONN_DESTS_SIZE;
 }
 
 /* Extract received metrics from buffer */
@@ -1032,6 +1421,15 @@ dispatch_received_metrics(connection *conn, dispatcher *self,
 	 * sanitised, however. */
 	char *p, *q, *firstspace, *lastnl;
 	char search_tags;
+	size_t routed;
+	char stalled = 0;
+
+	/* a previous batch may have left the stage too full to route,
+	 * process the buffer next time without reading more first */
+	if (dispatch_process_dests(conn, self, batchstart, 0) == 0) {
+		conn->needmore = 0;
+		return;
+	}
 
 	q = conn->metric;
 	firstspace = NULL;
@@ -1067,11 +1465,12 @@ dispatch_received_metrics(connection *conn, dispatcher *self,
 					self->id, conn->sock, conn->metric);
 			__sync_add_and_fetch(&(self->blackholes),
 					router_route(self->rtr,
-						conn->dests, &conn->destlen, CONN_DESTS_SIZE,
+						conn->dests + conn->destlen, &routed, CONN_DESTS_SIZE,
 						conn->srcaddr,
 						conn->metric, firstspace, self->id - 1));
+			conn->destlen += routed;
 			tracef("dispatcher %d, connfd %d, destinations %zd\n",
-					self->id, conn->sock, conn->destlen);
+					self->id, conn->sock, routed);
 
 			/* restart building new one from the start */
 			q = conn->metric;
@@ -1083,9 +1482,11 @@ dispatch_received_metrics(connection *conn, dispatcher *self,
 			 * 10 minutes (IDLE_DISCONNECT_TIME) */
 			conn->lastwork = batchstart;
 			conn->maxsenddelay = 0;
-			/* send the metric to where it is supposed to go */
-			if (dispatch_process_dests(conn, self, batchstart) == 0)
+			/* stage the metric for where it is supposed to go */
+			if (dispatch_process_dests(conn, self, batchstart, 0) == 0) {
+				stalled = 1;
 				break;
+			}
 		} else if (search_tags != 2 && /* leave tags alone, issue #453 */
 				   (*p == ' ' || *p == '\t' || *p == '.'))
 		{
@@ -1133,6 +1534,9 @@ dispatch_received_metrics(connection *conn, dispatcher *self,
 			*q++ = '_';
 		}
 	}
+	/* push out whatever this batch staged */
+	if (!stalled)
+		dispatch_process_dests(conn, self, batchstart, 1);
 	conn->needmore = q != conn->metric;
 	if (lastnl != NULL) {
 		/* move remaining stuff to the front */
@@ -1180,7 +1584,7 @@ dispatch_connection(connection *conn, dispatcher *self, struct timeval start)
 	int err;
 
 	/* first try to resume any work being blocked */
-	if (dispatch_process_dests(conn, self, start) == 0) {
+	if (dispatch_process_dests(conn, self, start, 1) == 0) {
 		__sync_bool_compare_and_swap(&(conn->takenby), self->id, C_IN);
 		return 0;
 	}
@@ -1575,6 +1979,23 @@ dispatch_set_bufsize(unsigned int nsockbufsize)
 	sockbufsize = nsockbufsize;
 }
 
+#ifdef HAVE_ZSTD
+/**
+ * Sets the dictionary zstd streams from clients were compressed with.
+ * Returns 0 on success, or -1 when the dictionary could not be loaded.
+ */
+int
+dispatch_set_zstd_dict(const void *dict, size_t dictlen)
+{
+	if (zstddict != NULL)
+		ZSTD_freeDDict(zstddict);
+	zstddict = NULL;
+	if (dict != NULL && (zstddict = ZSTD_createDDict(dict, dictlen)) == NULL)
+		return -1;
+	return 0;
+}
+#endif
+
 /**
  * Initialise the listeners array.  This is a one-time allocation that
  * currently never is extended.  This code does no locking, as it
@@ -1802,3 +2223,13 @@ dispatch_get_closed_connections(void)
 {
 	return __sync_add_and_fetch(&(closedconnections), 0);
 }
+
+/**
+ * Returns the number of accepted SSL connections the kernel decrypts
+ * (kTLS) thusfar.
+ */
+inline size_t
+dispatch_get_ktls_connections(void)
+{
+	return __sync_add_and_fetch(&(ktlsconnections), 0);
+}
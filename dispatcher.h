@@ -32,6 +32,9 @@ void dispatch_transplantlistener(listener *olsnr, listener *nlsnr, router *r);
 int dispatch_addconnection(int sock, listener *lsnr);
 int dispatch_addconnection_aggr(int sock);
 void dispatch_set_bufsize(unsigned int sockbufsize);
+#ifdef HAVE_ZSTD
+int dispatch_set_zstd_dict(const void *dict, size_t dictlen);
+#endif
 char dispatch_init_listeners(void);
 dispatcher *dispatch_new_listener(unsigned char id);
 dispatcher *dispatch_new_connection( unsigned char id, router *r,
@@ -51,6 +54,7 @@ size_t dispatch_get_discards_sub(dispatcher *self);
 size_t dispatch_get_sleeps_sub(dispatcher *self);
 size_t dispatch_get_accepted_connections(void);
 size_t dispatch_get_closed_connections(void);
+size_t dispatch_get_ktls_connections(void);
 void dispatch_hold(dispatcher *d);
 void dispatch_schedulereload(dispatcher *d, router *r);
 char dispatch_reloadcomplete(dispatcher *d);
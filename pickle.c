@@ -0,0 +1,731 @@
+/*
+ * Copyright 2013-2025 Fabian Groffen
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <sys/types.h>
+
+#include "relay.h"
+#include "pickle.h"
+
+/* Carbon's pickle protocol sends a list of (path, (timestamp, value))
+ * tuples.  The decoder below understands the subset of Python's pickle
+ * opcodes (protocol 0 up to 5) that Python uses to serialise exactly
+ * that, and rejects anything else.  Values are kept on a small typed
+ * stack.  Strings are kept as offsets into the frame, such that the
+ * path is only copied once, when the datapoint is written out as
+ * "path value timestamp" line. */
+
+#define PICKLE_MAX_STACK  (16 * 1024)
+#define PICKLE_MAX_MEMO   (64 * 1024)
+/* what is kept between frames, enough for the usual batch of 500
+ * datapoints carbon sends */
+#define PICKLE_KEEP_STACK  1024
+#define PICKLE_KEEP_MEMO   4096
+/* longer paths wouldn't fit the dispatcher's buffers */
+#define PICKLE_MAX_PATH   (METRIC_BUFSIZ - 128)
+
+enum pval_kind {
+	PV_UNSET = 0,
+	PV_MARK,
+	PV_LIST,
+	PV_STR,
+	PV_NUM,
+	PV_PAIR,   /* (timestamp, value) */
+	PV_POINT   /* (path, (timestamp, value)) */
+};
+
+typedef struct _pval {
+	unsigned char kind;
+	unsigned char isint;  /* value came in as integer */
+	unsigned char skip;   /* datapoint is valid pickle, but unusable */
+	size_t off;           /* PV_STR, PV_POINT: path in frame,
+	                         PV_MARK: the previous mark, see mark */
+	size_t len;
+	long long int ts;     /* PV_PAIR, PV_POINT */
+	long long int ival;   /* value for PV_NUM, PV_PAIR, PV_POINT */
+	double dval;
+} pval;
+
+struct _pickle {
+	size_t pos;         /* next opcode in the frame */
+	pval *stack;
+	size_t sp;
+	size_t stacksize;
+	size_t mark;        /* topmost PV_MARK on stack + 1, 0 if none */
+	pval *memo;
+	size_t memocnt;
+	size_t memosize;
+	size_t emitted;     /* list items written by the current opcode */
+	const char *err;
+};
+
+/**
+ * Appends metric m as a (path, (timestamp, value)) tuple in pickle
+ * protocol 2 at p, and returns the position after it.  Returns NULL
+ * when m isn't a valid "path value timestamp" line.  The caller
+ * ensures p has room for the path plus PICKLE_METRIC_OVERHEAD bytes.
+ */
+char *
+pickle_metric(char *p, const char *m)
+{
+	size_t len = *(size_t *)m;
+	const char *name = m + sizeof(size_t);
+	const char *sp;
+	char *e;
+	double val;
+	long long int ts;
+	unsigned long long int bits;
+	int i;
+
+	if ((sp = memchr(name, ' ', len)) == NULL)
+		return NULL;
+	val = strtod(sp + 1, &e);
+	if (e == sp + 1 || *e != ' ')
+		return NULL;
+	ts = strtoll(e + 1, &e, 10);
+	if (*e != '\n' && *e != '\0')
+		return NULL;
+
+	/* BINUNICODE: 4-byte little-endian length and the UTF-8 path */
+	len = sp - name;
+	*p++ = 'X';
+	for (i = 0; i < 4; i++)
+		*p++ = (char)((len >> (i * 8)) & 0xFF);
+	memcpy(p, name, len);
+	p += len;
+	if (ts >= -2147483648LL && ts <= 2147483647LL) {
+		/* BININT: 4-byte signed little-endian */
+		*p++ = 'J';
+		for (i = 0; i < 4; i++)
+			*p++ = (char)(((unsigned long long int)ts >> (i * 8)) & 0xFF);
+	} else {
+		/* LONG1: 8 byte two's complement little-endian */
+		*p++ = (char)0x8a;
+		*p++ = 8;
+		for (i = 0; i < 8; i++)
+			*p++ = (char)(((unsigned long long int)ts >> (i * 8)) & 0xFF);
+	}
+	/* BINFLOAT: 8-byte big-endian IEEE double */
+	memcpy(&bits, &val, sizeof(bits));
+	*p++ = 'G';
+	for (i = 7; i >= 0; i--)
+		*p++ = (char)((bits >> (i * 8)) & 0xFF);
+	*p++ = (char)0x86;  /* TUPLE2: (timestamp, value) */
+	*p++ = (char)0x86;  /* TUPLE2: (path, (timestamp, value)) */
+
+	return p;
+}
+
+/**
+ * Allocates a new decoder for pickle frames.
+ */
+pickle *
+pickle_new(void)
+{
+	pickle *ret = malloc(sizeof(pickle));
+
+	if (ret == NULL)
+		return NULL;
+	ret->stack = NULL;
+	ret->stacksize = 0;
+	ret->memo = NULL;
+	ret->memosize = 0;
+	ret->err = NULL;
+	pickle_reset(ret);
+
+	return ret;
+}
+
+/**
+ * Prepares pkl for decoding a new frame.  The stack and memo a large
+ * frame needed are shrunk again, such that a connection doesn't hold
+ * on to them.
+ */
+void
+pickle_reset(pickle *pkl)
+{
+	pval *v;
+
+	if (pkl->stacksize > PICKLE_KEEP_STACK &&
+			(v = realloc(pkl->stack,
+					sizeof(pval) * PICKLE_KEEP_STACK)) != NULL)
+	{
+		pkl->stack = v;
+		pkl->stacksize = PICKLE_KEEP_STACK;
+	}
+	if (pkl->memosize > PICKLE_KEEP_MEMO &&
+			(v = realloc(pkl->memo, sizeof(pval) * PICKLE_KEEP_MEMO)) != NULL)
+	{
+		pkl->memo = v;
+		pkl->memosize = PICKLE_KEEP_MEMO;
+	}
+	pkl->pos = 0;
+	pkl->sp = 0;
+	pkl->mark = 0;
+	pkl->memocnt = 0;
+	pkl->emitted = 0;
+}
+
+static inline unsigned long long int
+pickle_le(const unsigned char *p, int n)
+{
+	unsigned long long int ret = 0;
+
+	while (n-- > 0)
+		ret = (ret << 8) | p[n];
+	return ret;
+}
+
+static inline pval *
+pickle_push(pickle *pkl, unsigned char kind)
+{
+	pval *v;
+
+	if (pkl->sp == pkl->stacksize) {
+		size_t nsize = pkl->stacksize == 0 ? 64 : pkl->stacksize * 2;
+
+		if (nsize > PICKLE_MAX_STACK ||
+				(v = realloc(pkl->stack, sizeof(pval) * nsize)) == NULL)
+			return NULL;
+		pkl->stack = v;
+		pkl->stacksize = nsize;
+	}
+	v = &pkl->stack[pkl->sp++];
+	v->kind = kind;
+	v->isint = 0;
+	v->skip = 0;
+	v->ival = 0;
+	v->dval = 0.0;
+	if (kind == PV_MARK) {
+		v->off = pkl->mark;
+		pkl->mark = pkl->sp;
+	}
+	return v;
+}
+
+/**
+ * Removes the topmost mark and everything above it from the stack.
+ * Marks are chained, such that finding them doesn't require walking
+ * the stack.
+ */
+static inline void
+pickle_popmark(pickle *pkl)
+{
+	pkl->sp = pkl->mark - 1;
+	pkl->mark = pkl->stack[pkl->sp].off;
+}
+
+static const char *
+pickle_memoput(pickle *pkl, unsigned long long int idx)
+{
+	if (pkl->sp == 0 || pkl->stack[pkl->sp - 1].kind == PV_MARK)
+		return "nothing to memoize";
+	if (idx >= PICKLE_MAX_MEMO)
+		return "memo too large";
+	if (idx >= pkl->memosize) {
+		size_t nsize = pkl->memosize == 0 ? 256 : pkl->memosize;
+		pval *nmemo;
+
+		while (nsize <= idx)
+			nsize *= 2;
+		if ((nmemo = realloc(pkl->memo, sizeof(pval) * nsize)) == NULL)
+			return "out of memory";
+		pkl->memo = nmemo;
+		pkl->memosize = nsize;
+	}
+	while (pkl->memocnt <= idx)
+		pkl->memo[pkl->memocnt++].kind = PV_UNSET;
+	pkl->memo[idx] = pkl->stack[pkl->sp - 1];
+	return NULL;
+}
+
+static const char *
+pickle_memoget(pickle *pkl, unsigned long long int idx)
+{
+	pval *v;
+
+	if (idx >= pkl->memocnt || pkl->memo[idx].kind == PV_UNSET)
+		return "memo entry not found";
+	if ((v = pickle_push(pkl, PV_UNSET)) == NULL)
+		return "stack too deep";
+	*v = pkl->memo[idx];
+	return NULL;
+}
+
+/**
+ * Replaces the two topmost values by a tuple of them.  Only
+ * (timestamp, value) and (path, (timestamp, value)) are supported.
+ */
+static const char *
+pickle_tuple2(pickle *pkl)
+{
+	pval *a;
+	pval *b;
+
+	if (pkl->sp < 2)
+		return "stack underflow";
+	a = &pkl->stack[pkl->sp - 2];
+	b = &pkl->stack[pkl->sp - 1];
+	if (a->kind == PV_NUM && b->kind == PV_NUM) {
+		if (a->isint) {
+			a->ts = a->ival;
+		} else if (isfinite(a->dval) &&
+				a->dval > -9.2e18 && a->dval < 9.2e18)
+		{
+			a->ts = (long long int)a->dval;
+		} else {
+			a->skip = 1;
+		}
+		a->kind = PV_PAIR;
+		a->skip |= b->skip;
+		a->isint = b->isint;
+		a->ival = b->ival;
+		a->dval = b->dval;
+	} else if (a->kind == PV_STR && b->kind == PV_PAIR) {
+		a->kind = PV_POINT;
+		a->skip = b->skip || a->len == 0 || a->len > PICKLE_MAX_PATH;
+		a->ts = b->ts;
+		a->isint = b->isint;
+		a->ival = b->ival;
+		a->dval = b->dval;
+	} else {
+		return "unsupported tuple";
+	}
+	pkl->sp--;
+	return NULL;
+}
+
+/**
+ * Writes datapoint v from frame as line to buf.  Returns the length
+ * of the line, or -1 if it doesn't fit in bufsize bytes.
+ */
+static ssize_t
+pickle_emit(const char *frame, pval *v, char *buf, size_t bufsize)
+{
+	char val[40];
+	char ts[24];
+	int vlen;
+	int tlen;
+	size_t i;
+	char c;
+
+	if (v->skip)
+		return 0;
+
+	if (v->isint) {
+		vlen = snprintf(val, sizeof(val), "%lld", v->ival);
+	} else {
+		/* shortest of the two that reads back as the same value */
+		vlen = snprintf(val, sizeof(val), "%.15g", v->dval);
+		if (strtod(val, NULL) != v->dval)
+			vlen = snprintf(val, sizeof(val), "%.17g", v->dval);
+	}
+	tlen = snprintf(ts, sizeof(ts), "%lld", v->ts);
+	if (v->len + 1 + vlen + 1 + tlen + 1 > bufsize)
+		return -1;
+
+	/* the path mustn't break up the line */
+	for (i = 0; i < v->len; i++) {
+		c = frame[v->off + i];
+		if (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\0')
+			c = '_';
+		buf[i] = c;
+	}
+	buf[i++] = ' ';
+	memcpy(buf + i, val, vlen);
+	i += vlen;
+	buf[i++] = ' ';
+	memcpy(buf + i, ts, tlen);
+	i += tlen;
+	buf[i++] = '\n';
+
+	return (ssize_t)i;
+}
+
+/**
+ * Parses the newline terminated argument of a protocol 0 opcode at p,
+ * with at most avail bytes, as number.  Returns the number of bytes
+ * consumed including the newline, or 0 when it isn't a number.
+ */
+static size_t
+pickle_textnum(const char *p, size_t avail, char op, pval *v)
+{
+	char num[64];
+	const char *nl;
+	char *e;
+	size_t len;
+
+	if ((nl = memchr(p, '\n', avail < sizeof(num) ? avail : sizeof(num)))
+			== NULL)
+		return 0;
+	len = nl - p;
+	if (op == 'L' && len > 0 && p[len - 1] == 'L')
+		len--;
+	if (len == 0)
+		return 0;
+	memcpy(num, p, len);
+	num[len] = '\0';
+
+	if (op == 'F') {
+		v->dval = strtod(num, &e);
+		v->isint = 0;
+	} else {
+		/* "01" and "00" are True and False */
+		v->ival = strtoll(num, &e, 10);
+		v->isint = 1;
+	}
+	if (*e != '\0')
+		return 0;
+	return (nl - p) + 1;
+}
+
+/**
+ * Decodes the pickle frame of flen bytes (without length header) and
+ * writes its datapoints as lines to buf.  Decoding continues where the
+ * previous call for the same frame stopped.  Returns 1 when the frame
+ * was decoded completely, 0 when buf is full and pickle_decode needs
+ * to be called again with the same frame, or -1 when the frame is
+ * malformed or uses unsupported constructs, see pickle_error.  The
+ * number of bytes written to buf is stored in written.  Datapoints
+ * from a malformed frame that were already written are not revoked.
+ * After 1 or -1 is returned, pkl is ready for the next frame.
+ */
+int
+pickle_decode(pickle *pkl, const char *frame, size_t flen,
+		char *buf, size_t bufsize, size_t *written)
+{
+	const unsigned char *f = (const unsigned char *)frame;
+	const char *err = NULL;
+	const char *nl;
+	unsigned long long int u;
+	size_t avail;
+	size_t len;
+	size_t out = 0;
+	size_t n;
+	ssize_t m;
+	ssize_t r;
+	pval *v;
+	pval idx;
+	int i;
+
+#define NEED(N) \
+	if (avail < (size_t)(N)) { \
+		err = "truncated frame"; \
+		break; \
+	}
+#define PUSH(K) \
+	if ((v = pickle_push(pkl, K)) == NULL) { \
+		err = "stack too deep"; \
+		break; \
+	}
+
+	while (err == NULL) {
+		if (pkl->pos >= flen) {
+			err = "truncated frame";
+			break;
+		}
+		avail = flen - pkl->pos - 1;  /* bytes following the opcode */
+		switch (f[pkl->pos]) {
+			case 0x80:  /* PROTO */
+				NEED(1);
+				if (f[pkl->pos + 1] > 5) {
+					err = "unsupported protocol";
+					break;
+				}
+				pkl->pos += 2;
+				break;
+			case 0x95:  /* FRAME, just a hint */
+				NEED(8);
+				pkl->pos += 9;
+				break;
+			case '(':  /* MARK */
+				PUSH(PV_MARK);
+				pkl->pos++;
+				break;
+			case ']':  /* EMPTY_LIST */
+				PUSH(PV_LIST);
+				pkl->pos++;
+				break;
+			case 'l':  /* LIST of the items since MARK */
+			case 'e':  /* APPENDS the items since MARK */
+				if ((m = (ssize_t)pkl->mark - 1) < 0) {
+					err = "mark not found";
+					break;
+				}
+				if (f[pkl->pos] == 'e' &&
+						(m == 0 || pkl->stack[m - 1].kind != PV_LIST))
+				{
+					err = "appends to non-list";
+					break;
+				}
+				for (n = m + 1 + pkl->emitted; n < pkl->sp; n++) {
+					if (pkl->stack[n].kind != PV_POINT) {
+						err = "list item is not a datapoint";
+						break;
+					}
+					r = pickle_emit(frame, &pkl->stack[n],
+							buf + out, bufsize - out);
+					if (r < 0) {
+						*written = out;
+						return 0;
+					}
+					out += r;
+					pkl->emitted++;
+				}
+				if (err != NULL)
+					break;
+				pkl->emitted = 0;
+				pickle_popmark(pkl);
+				if (f[pkl->pos] == 'l')
+					PUSH(PV_LIST);
+				pkl->pos++;
+				break;
+			case 'a':  /* APPEND */
+				if (pkl->sp < 2 || pkl->stack[pkl->sp - 2].kind != PV_LIST) {
+					err = "append to non-list";
+					break;
+				}
+				if (pkl->stack[pkl->sp - 1].kind != PV_POINT) {
+					err = "list item is not a datapoint";
+					break;
+				}
+				r = pickle_emit(frame, &pkl->stack[pkl->sp - 1],
+						buf + out, bufsize - out);
+				if (r < 0) {
+					*written = out;
+					return 0;
+				}
+				out += r;
+				pkl->sp--;
+				pkl->pos++;
+				break;
+			case 't':  /* TUPLE of the items since MARK */
+				if ((m = (ssize_t)pkl->mark - 1) < 0) {
+					err = "mark not found";
+					break;
+				}
+				if (pkl->sp - m != 3) {
+					err = "unsupported tuple";
+					break;
+				}
+				pkl->mark = pkl->stack[m].off;
+				pkl->stack[m] = pkl->stack[m + 1];
+				pkl->stack[m + 1] = pkl->stack[m + 2];
+				pkl->sp--;
+				err = pickle_tuple2(pkl);
+				pkl->pos++;
+				break;
+			case 0x86:  /* TUPLE2 */
+				err = pickle_tuple2(pkl);
+				pkl->pos++;
+				break;
+			case 'U':   /* SHORT_BINSTRING */
+			case 'C':   /* SHORT_BINBYTES */
+			case 0x8c:  /* SHORT_BINUNICODE */
+				NEED(1);
+				len = f[pkl->pos + 1];
+				NEED(1 + len);
+				PUSH(PV_STR);
+				v->off = pkl->pos + 2;
+				v->len = len;
+				pkl->pos += 2 + len;
+				break;
+			case 'T':  /* BINSTRING */
+			case 'B':  /* BINBYTES */
+			case 'X':  /* BINUNICODE */
+			case 0x8d:  /* BINUNICODE8 */
+			case 0x8e:  /* BINBYTES8 */
+				i = f[pkl->pos] == 0x8d || f[pkl->pos] == 0x8e ? 8 : 4;
+				NEED(i);
+				u = pickle_le(f + pkl->pos + 1, i);
+				if (u > avail - i) {
+					err = "truncated frame";
+					break;
+				}
+				len = (size_t)u;
+				PUSH(PV_STR);
+				v->off = pkl->pos + 1 + i;
+				v->len = len;
+				pkl->pos += 1 + i + len;
+				break;
+			case 'V':  /* UNICODE, raw-unicode-escaped up to newline */
+			case 'S':  /* STRING, quoted up to newline */
+				if ((nl = memchr(frame + pkl->pos + 1, '\n', avail)) == NULL) {
+					err = "truncated frame";
+					break;
+				}
+				len = nl - (frame + pkl->pos + 1);
+				PUSH(PV_STR);
+				v->off = pkl->pos + 1;
+				v->len = len;
+				if (f[pkl->pos] == 'S') {
+					/* escapes are kept as is, paths shouldn't need them */
+					if (len < 2 || (f[v->off] != '\'' && f[v->off] != '"') ||
+							f[v->off + len - 1] != f[v->off])
+					{
+						err = "invalid string";
+						break;
+					}
+					v->off++;
+					v->len -= 2;
+				}
+				pkl->pos += 1 + len + 1;
+				break;
+			case 'J':  /* BININT, signed */
+				NEED(4);
+				PUSH(PV_NUM);
+				v->ival = (int32_t)pickle_le(f + pkl->pos + 1, 4);
+				v->isint = 1;
+				pkl->pos += 5;
+				break;
+			case 'K':  /* BININT1, unsigned */
+			case 'M':  /* BININT2, unsigned */
+				i = f[pkl->pos] == 'K' ? 1 : 2;
+				NEED(i);
+				PUSH(PV_NUM);
+				v->ival = (long long int)pickle_le(f + pkl->pos + 1, i);
+				v->isint = 1;
+				pkl->pos += 1 + i;
+				break;
+			case 0x8a:  /* LONG1 */
+			case 0x8b:  /* LONG4 */
+				i = f[pkl->pos] == 0x8a ? 1 : 4;
+				NEED(i);
+				u = pickle_le(f + pkl->pos + 1, i);
+				if (u > 8) {
+					err = "integer too large";
+					break;
+				}
+				len = (size_t)u;
+				NEED(i + len);
+				PUSH(PV_NUM);
+				/* two's complement, little-endian */
+				u = pickle_le(f + pkl->pos + 1 + i, (int)len);
+				if (len > 0 && len < 8 && (u >> (len * 8 - 1)) & 1)
+					u |= ~0ULL << (len * 8);
+				v->ival = (long long int)u;
+				v->isint = 1;
+				pkl->pos += 1 + i + len;
+				break;
+			case 'G':  /* BINFLOAT, big-endian */
+				NEED(8);
+				PUSH(PV_NUM);
+				for (u = 0, i = 1; i <= 8; i++)
+					u = (u << 8) | f[pkl->pos + i];
+				memcpy(&v->dval, &u, sizeof(v->dval));
+				pkl->pos += 9;
+				break;
+			case 0x88:  /* NEWTRUE */
+			case 0x89:  /* NEWFALSE */
+				PUSH(PV_NUM);
+				v->ival = f[pkl->pos] == 0x88;
+				v->isint = 1;
+				pkl->pos++;
+				break;
+			case 'N':  /* NONE, carbon cannot store it */
+				PUSH(PV_NUM);
+				v->skip = 1;
+				pkl->pos++;
+				break;
+			case 'I':  /* INT */
+			case 'L':  /* LONG */
+			case 'F':  /* FLOAT */
+				PUSH(PV_NUM);
+				if ((len = pickle_textnum(frame + pkl->pos + 1, avail,
+								(char)f[pkl->pos], v)) == 0)
+				{
+					err = "invalid number";
+					break;
+				}
+				pkl->pos += 1 + len;
+				break;
+			case 'q':  /* BINPUT */
+			case 'r':  /* LONG_BINPUT */
+			case 'h':  /* BINGET */
+			case 'j':  /* LONG_BINGET */
+				i = f[pkl->pos] == 'q' || f[pkl->pos] == 'h' ? 1 : 4;
+				NEED(i);
+				u = pickle_le(f + pkl->pos + 1, i);
+				if (f[pkl->pos] == 'q' || f[pkl->pos] == 'r') {
+					err = pickle_memoput(pkl, u);
+				} else {
+					err = pickle_memoget(pkl, u);
+				}
+				pkl->pos += 1 + i;
+				break;
+			case 0x94:  /* MEMOIZE */
+				err = pickle_memoput(pkl, pkl->memocnt);
+				pkl->pos++;
+				break;
+			case 'p':  /* PUT */
+			case 'g':  /* GET */
+				if ((len = pickle_textnum(frame + pkl->pos + 1, avail,
+								'I', &idx)) == 0 || idx.ival < 0)
+				{
+					err = "invalid memo index";
+					break;
+				}
+				if (f[pkl->pos] == 'p') {
+					err = pickle_memoput(pkl, idx.ival);
+				} else {
+					err = pickle_memoget(pkl, idx.ival);
+				}
+				pkl->pos += 1 + len;
+				break;
+			case '.':  /* STOP */
+				*written = out;
+				pickle_reset(pkl);
+				return 1;
+			default:
+				err = "unsupported opcode";
+				break;
+		}
+	}
+#undef NEED
+#undef PUSH
+
+	*written = out;
+	pkl->err = err;
+	pickle_reset(pkl);
+	return -1;
+}
+
+/**
+ * Returns why the last frame could not be decoded.
+ */
+const char *
+pickle_error(pickle *pkl)
+{
+	return pkl->err == NULL ? "no error" : pkl->err;
+}
+
+/**
+ * Frees pkl and the buffers it holds.
+ */
+void
+pickle_free(pickle *pkl)
+{
+	if (pkl->stack != NULL)
+		free(pkl->stack);
+	if (pkl->memo != NULL)
+		free(pkl->memo);
+	free(pkl);
+}
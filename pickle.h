@@ -0,0 +1,38 @@
+/*
+ * Copyright 2013-2025 Fabian Groffen
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef PICKLE_H
+#define PICKLE_H 1
+
+#include <stdlib.h>
+
+/* carbon's pickle receiver doesn't accept larger frames either */
+#define PICKLE_MAX_FRAME  (1024 * 1024)
+/* room a metric needs in a pickle besides its path */
+#define PICKLE_METRIC_OVERHEAD  32
+
+typedef struct _pickle pickle;
+
+char *pickle_metric(char *p, const char *m);
+pickle *pickle_new(void);
+void pickle_reset(pickle *pkl);
+int pickle_decode(pickle *pkl, const char *frame, size_t flen,
+		char *buf, size_t bufsize, size_t *written);
+const char *pickle_error(pickle *pkl);
+void pickle_free(pickle *pkl);
+
+#endif
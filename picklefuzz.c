@@ -0,0 +1,256 @@
+/*
+ * Copyright 2013-2025 Fabian Groffen
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Fuzzer for the pickle decoder.  Valid frames are generated, decoded
+ * and compared against the lines they were made of.  Next, the frames
+ * are mutated at random, and each decode must terminate and only
+ * produce well-formed "path value timestamp" lines.  Best run from a
+ * build with -fsanitize=address to catch out of bounds access. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "relay.h"
+#include "pickle.h"
+
+#define MAX_POINTS  64
+#define FRAMESIZ    (MAX_POINTS * (256 + PICKLE_METRIC_OVERHEAD) + 64)
+#define OUTSIZ      (FRAMESIZ * 128)
+
+static char frame[FRAMESIZ];
+static char lines[OUTSIZ];
+static char out[OUTSIZ];
+
+/**
+ * Generates a frame with a random number of datapoints, alternating
+ * between APPENDS and APPEND style lists.  The lines encoded are
+ * written to lines.  Returns the length of the frame.
+ */
+static size_t
+fuzz_genframe(size_t *lineslen)
+{
+	char metric[sizeof(size_t) + 512];
+	char *name = metric + sizeof(size_t);
+	char *p = frame;
+	char *l = lines;
+	int points = rand() % MAX_POINTS;
+	int appends = rand() % 2;
+	int i;
+	int j;
+	int len;
+
+	*p++ = (char)0x80;  /* PROTO 2 */
+	*p++ = 2;
+	*p++ = ']';
+	if (appends)
+		*p++ = '(';
+	for (i = 0; i < points; i++) {
+		len = 1 + rand() % 200;
+		for (j = 0; j < len; j++)
+			name[j] = "abcdefghijklmnopqrstuvwxyz0123456789._-"[rand() % 39];
+		if (rand() % 2) {
+			len += snprintf(name + len, sizeof(metric) - sizeof(size_t) - len,
+					" %d %d\n", rand() - RAND_MAX / 2, rand());
+		} else {
+			len += snprintf(name + len, sizeof(metric) - sizeof(size_t) - len,
+					" %.15g %lld\n", (double)rand() / 7.0,
+					(long long int)rand() * 16);
+		}
+		*(size_t *)metric = len;
+		if ((p = pickle_metric(p, metric)) == NULL) {
+			fprintf(stderr, "pickle_metric failed on %s", name);
+			exit(1);
+		}
+		if (!appends)
+			*p++ = 'a';
+		memcpy(l, name, len);
+		l += len;
+	}
+	if (appends)
+		*p++ = 'e';
+	*p++ = '.';
+
+	*lineslen = l - lines;
+	return p - frame;
+}
+
+/**
+ * Decodes frame using output buffers of random size.  Returns the
+ * result of the final pickle_decode call.
+ */
+static int
+fuzz_decode(pickle *pkl, size_t flen, size_t *outlen)
+{
+	size_t written = 1;
+	size_t bufsize;
+	int ret;
+
+	*outlen = 0;
+	do {
+		/* a mutated path can be longer than any small buffer */
+		bufsize = written == 0 ? OUTSIZ : 1 + rand() % 1024;
+		if (bufsize > OUTSIZ - *outlen)
+			bufsize = OUTSIZ - *outlen;
+		ret = pickle_decode(pkl, frame, flen,
+				out + *outlen, bufsize, &written);
+		if (written > bufsize) {
+			fprintf(stderr, "decoder wrote %zu bytes in a buffer of %zu\n",
+					written, bufsize);
+			exit(1);
+		}
+		*outlen += written;
+		if (ret == 0 && *outlen == OUTSIZ) {
+			fprintf(stderr, "decoder produced too much output\n");
+			exit(1);
+		}
+	} while (ret == 0);
+
+	return ret;
+}
+
+/**
+ * Checks that buf only holds lines of three non-empty fields.
+ */
+static void
+fuzz_checklines(const char *buf, size_t len)
+{
+	const char *p = buf;
+	const char *e;
+	int fields;
+	size_t flen;
+
+	while (p < buf + len) {
+		if ((e = memchr(p, '\n', buf + len - p)) == NULL) {
+			fprintf(stderr, "unterminated line: %.*s\n",
+					(int)(buf + len - p), p);
+			exit(1);
+		}
+		fields = 0;
+		flen = 0;
+		for (; p < e; p++) {
+			if (*p == ' ') {
+				if (flen == 0)
+					break;
+				fields++;
+				flen = 0;
+			} else if (*p == '\0' || *p == '\t' || *p == '\r') {
+				break;
+			} else {
+				flen++;
+			}
+		}
+		if (p != e || flen == 0 || fields != 2) {
+			fprintf(stderr, "malformed line: %.*s\n", (int)(e - p), p);
+			exit(1);
+		}
+		p = e + 1;
+	}
+}
+
+static void
+do_usage(char *name, int exitcode)
+{
+	printf("Usage: %s [-n iterations] [-s seed]\n", name);
+	printf("\n");
+	printf("Options:\n");
+	printf("  -n  number of frames to generate, defaults to %d\n", 100000);
+	printf("  -s  random seed, defaults to %d\n", 1);
+
+	exit(exitcode);
+}
+
+int
+main(int argc, char *argv[])
+{
+	pickle *pkl;
+	size_t iterations = 100000;
+	unsigned int seed = 1;
+	size_t it;
+	size_t flen;
+	size_t lineslen;
+	size_t outlen;
+	size_t mutated = 0;
+	size_t rejected = 0;
+	int mutations;
+	int ret;
+	int ch;
+
+	while ((ch = getopt(argc, argv, ":hn:s:")) != -1) {
+		switch (ch) {
+			case 'n':
+				iterations = (size_t)atol(optarg);
+				break;
+			case 's':
+				seed = (unsigned int)atol(optarg);
+				break;
+			case 'h':
+				do_usage(argv[0], 0);
+				break;
+			default:
+				do_usage(argv[0], 1);
+				break;
+		}
+	}
+	srand(seed);
+
+	if ((pkl = pickle_new()) == NULL) {
+		fprintf(stderr, "failed to allocate decoder\n");
+		return 1;
+	}
+
+	for (it = 0; it < iterations; it++) {
+		flen = fuzz_genframe(&lineslen);
+
+		ret = fuzz_decode(pkl, flen, &outlen);
+		if (ret != 1 || outlen != lineslen ||
+				memcmp(out, lines, outlen) != 0)
+		{
+			fprintf(stderr, "iteration %zu: valid frame decoded wrongly "
+					"(%d, %s)\n", it, ret, pickle_error(pkl));
+			return 1;
+		}
+
+		/* flip, overwrite or cut off random bytes */
+		for (mutations = 1 + rand() % 8; mutations > 0; mutations--) {
+			switch (rand() % 4) {
+				case 0:
+					frame[rand() % flen] ^= 1 << (rand() % 8);
+					break;
+				case 1:
+					frame[rand() % flen] = (char)(rand() % 256);
+					break;
+				case 2:
+					frame[rand() % flen] = "(]elat.\x86\x85qhJKMX"[rand() % 15];
+					break;
+				case 3:
+					flen = 1 + rand() % flen;
+					break;
+			}
+		}
+		mutated++;
+		if (fuzz_decode(pkl, flen, &outlen) == -1)
+			rejected++;
+		fuzz_checklines(out, outlen);
+	}
+
+	pickle_free(pkl);
+	printf("%zu valid frames, %zu mutated frames of which %zu rejected\n",
+			iterations, mutated, rejected);
+
+	return 0;
+}
@@ -17,19 +17,103 @@
 
 #include <stdlib.h>
 #include <string.h>
-#include <pthread.h>
+#include <sched.h>
+#include <sys/types.h>
+#include <sys/time.h>
 
 #include "queue.h"
 
+#define CACHELINE_SIZE  64
+
+/* The queue is a bounded ring of cells, each carrying a sequence
+ * number that tells which position (lap) it is valid for.  A cell at
+ * position pos is free for a writer when its seq equals pos, and holds
+ * data for a reader when its seq equals pos + 1.  Writers and readers
+ * claim positions by advancing write respectively read with a CAS,
+ * hence no locks are necessary.  The ring is the requested size rounded
+ * up to a power of two, and is never filled beyond the requested size,
+ * such that the cell in front of the reader is available for putbacks
+ * unless the queue is full.  Because a putback competes with writers
+ * for that cell, cells are reserved with a CAS on their seq before they
+ * are written to.  Putbacks move read backwards, so read can return to
+ * a position a reader saw before, while the cells there changed hands
+ * in the meanwhile.  Each putback therefore bumps the generation that
+ * goes with read, and read is only ever moved with a compare-and-swap
+ * of both.  When stamped is set, each cell also records when it was
+ * filled, such that readers can tell how long entries have been
+ * waiting. */
+typedef struct {
+	size_t seq;
+	const char *p;
+	size_t stamp;  /* enqueue time in microseconds */
+} queue_cell;
+
+typedef struct {
+	size_t pos;
+	size_t gen;    /* number of putbacks */
+} __attribute__((aligned(2 * sizeof(size_t)))) queue_pos;
+
 struct _queue {
-	const char **queue;
+	queue_cell *cells;
+	size_t mask;
 	size_t end;
+	char stamped;
+	char pad0[CACHELINE_SIZE - sizeof(queue_cell *) - 2 * sizeof(size_t)
+		- sizeof(char)];
 	size_t write;
-	size_t read;
-	size_t len;
-	pthread_mutex_t lock;
+	char pad1[CACHELINE_SIZE - sizeof(size_t)];
+	queue_pos read;
+	char pad2[CACHELINE_SIZE - sizeof(queue_pos)];
+	size_t bytes;
+	char pad3[CACHELINE_SIZE - sizeof(size_t)];
 };
 
+#define LOAD(X)      __atomic_load_n(&(X), __ATOMIC_ACQUIRE)
+#define STORE(X, V)  __atomic_store_n(&(X), V, __ATOMIC_RELEASE)
+
+/**
+ * Moves the read position of q from r to nr, and its generation from g
+ * to ng, when neither changed.  Returns whether it did.
+ */
+static inline char
+queue_moveread(queue *q, size_t r, size_t g, size_t nr, size_t ng)
+{
+	queue_pos old = { r, g };
+	queue_pos new = { nr, ng };
+
+	return __atomic_compare_exchange(&q->read, &old, &new, 0,
+			__ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+/* bytes in use by all queues, their cells included */
+static size_t queue_allbytes = 0;
+
+static inline void
+queue_addbytes(queue *q, size_t bytes)
+{
+	__sync_add_and_fetch(&q->bytes, bytes);
+	__sync_add_and_fetch(&queue_allbytes, bytes);
+}
+
+static inline void
+queue_subbytes(queue *q, size_t bytes)
+{
+	__sync_sub_and_fetch(&q->bytes, bytes);
+	__sync_sub_and_fetch(&queue_allbytes, bytes);
+}
+
+/* enqueue time for new entries, unless the queue isn't stamped */
+static inline size_t
+queue_stamp(queue *q)
+{
+	struct timeval tv;
+
+	if (!LOAD(q->stamped))
+		return 0;
+	gettimeofday(&tv, NULL);
+	return (size_t)tv.tv_sec * 1000 * 1000 + tv.tv_usec;
+}
+
 
 /**
  * Allocates a new queue structure with capacity to hold size elements.
@@ -38,21 +122,34 @@ queue *
 queue_new(size_t size)
 {
 	queue *ret = malloc(sizeof(queue));
+	size_t cap;
+	size_t i;
 
 	if (ret == NULL)
 		return NULL;
 
-	ret->queue = malloc(sizeof(char *) * size);
-	if (ret->queue == NULL) {
+	/* a single cell cannot tell a filled cell from a free one */
+	for (cap = 2; cap < size; cap <<= 1)
+		;
+	ret->cells = malloc(sizeof(queue_cell) * cap);
+	if (ret->cells == NULL) {
 		free(ret);
 		return NULL;
 	}
 
-	memset(ret->queue, 0, sizeof(char *) * size);
+	for (i = 0; i < cap; i++) {
+		ret->cells[i].seq = i;
+		ret->cells[i].p = NULL;
+		ret->cells[i].stamp = 0;
+	}
+	ret->mask = cap - 1;
 	ret->end = size;
-	ret->read = ret->write = 0;
-	ret->len = 0;
-	pthread_mutex_init(&ret->lock, NULL);
+	ret->read.pos = ret->write = 0;
+	ret->read.gen = 0;
+	ret->bytes = 0;
+	ret->stamped = 0;
+	__sync_add_and_fetch(&queue_allbytes,
+			sizeof(queue) + sizeof(queue_cell) * cap);
 
 	return ret;
 }
@@ -70,12 +167,121 @@ queue_destroy(queue *q)
 	/* drain queue not to leak the memory consumed by pending metrics */
 	while ((p = queue_dequeue(q)) != NULL)
 		free((char *)p);
-	q->len = 0;
-	pthread_mutex_destroy(&q->lock);
-	free(q->queue);
+	__sync_sub_and_fetch(&queue_allbytes,
+			sizeof(queue) + sizeof(queue_cell) * (q->mask + 1));
+	free(q->cells);
 	free(q);
 }
 
+/**
+ * Claims at most len consecutive filled cells for reading.  Returns the
+ * number of cells claimed, and the position of the first in pos.
+ */
+static size_t
+queue_claim(queue *q, size_t *pos, size_t len)
+{
+	size_t r;
+	size_t g;
+	size_t n;
+
+	g = LOAD(q->read.gen);
+	r = LOAD(q->read.pos);
+	while (1) {
+		for (n = 0; n < len; n++)
+			if (LOAD(q->cells[(r + n) & q->mask].seq) != r + n + 1)
+				break;
+		if (n == 0) {
+			/* empty, or another reader moved on in the meanwhile */
+			if (LOAD(q->read.gen) == g && LOAD(q->read.pos) == r)
+				return 0;
+		} else if (queue_moveread(q, r, g, r + n, g)) {
+			break;
+		}
+		g = LOAD(q->read.gen);
+		r = LOAD(q->read.pos);
+	}
+
+	*pos = r;
+	return n;
+}
+
+/**
+ * Returns the data of the claimed cell at pos, and makes the cell
+ * available to the writer of the next lap.  When stamp is not NULL,
+ * the enqueue time of the data is stored in it.
+ */
+static inline const char *
+queue_release(queue *q, size_t pos, size_t *stamp)
+{
+	queue_cell *c = &q->cells[pos & q->mask];
+	const char *ret = c->p;
+
+	if (stamp != NULL)
+		*stamp = c->stamp;
+
+	STORE(c->seq, pos + q->mask + 1);
+	return ret;
+}
+
+/**
+ * Drops the oldest entry from the queue.  When that isn't possible
+ * because the oldest cell is still being filled, yields the CPU such
+ * that the writer (or putback) holding it can complete.
+ */
+static inline void
+queue_dropoldest(queue *q)
+{
+	size_t pos;
+	const char *p;
+
+	if (queue_claim(q, &pos, 1) == 1) {
+		p = queue_release(q, pos, NULL);
+		queue_subbytes(q, QUEUE_ENTRY_BYTES(p));
+		free((char *)p);
+	} else {
+		sched_yield();
+	}
+}
+
+/**
+ * Enqueues p with the given enqueue time, see queue_enqueue.
+ */
+static void
+queue_enqueue_stamp(queue *q, const char *p, size_t stamp)
+{
+	queue_cell *c;
+	size_t w;
+	size_t seq;
+
+	queue_addbytes(q, QUEUE_ENTRY_BYTES(p));
+	while (1) {
+		w = LOAD(q->write);
+		seq = LOAD(q->cells[w & q->mask].seq);
+		if ((ssize_t)(seq - w) > 0)
+			continue;  /* another writer claimed this cell, reload */
+		if ((ssize_t)(w - LOAD(q->read.pos)) >= (ssize_t)q->end) {
+			/* queue is full, make space by dropping the oldest entry */
+			queue_dropoldest(q);
+		} else if (seq == w) {
+			if (__sync_bool_compare_and_swap(&q->write, w, w + 1))
+				break;
+		} else {
+			/* the reader of the previous lap hasn't released the
+			 * cell yet, which it will do right away */
+			sched_yield();
+		}
+	}
+
+	/* a putback may have reserved the cell in the meanwhile, in which
+	 * case it will be the oldest entry once it is filled */
+	c = &q->cells[w & q->mask];
+	while (!__sync_bool_compare_and_swap(&c->seq, w, w - 1))
+		queue_dropoldest(q);
+	c->p = p;
+	c->stamp = stamp;
+	STORE(c->seq, w + 1);
+}
+
 /**
  * Enqueues the string pointed to by p at queue q.  If the queue is
  * full, the oldest entry is dropped.  For this reason, enqueuing will
@@ -85,38 +291,68 @@ queue_destroy(queue *q)
 void
 queue_enqueue(queue *q, const char *p)
 {
-	char *tofree = NULL;
-
-	/* queue normal:
-	 * |=====-----------------------------|  4
-	 * ^    ^
-	 * r    w
-	 * queue wrap:
-	 * |===---------------------------====|  6
-	 *    ^                           ^
-	 *    w                           r
-	 * queue full
-	 * |==================================| 23
-	 *          ^
-	 *         w+r
-	 */
-	pthread_mutex_lock(&q->lock);
-	if (q->len == q->end) {
-		if (q->read == q->end)
-			q->read = 0;
-		tofree = (char *)(q->queue[q->read]);
-		q->read++;
-		q->len--;
+	queue_enqueue_stamp(q, p, queue_stamp(q));
+}
+
+/**
+ * Enqueues the len strings from p at queue q.  When the queue has
+ * space for all of them, their positions are claimed at once, else
+ * they are enqueued one by one, dropping the oldest entries like
+ * queue_enqueue does.
+ */
+void
+queue_enqueue_vector(queue *q, const char **p, size_t len)
+{
+	queue_enqueue_vector_stamps(q, p, NULL, len);
+}
+
+/**
+ * Like queue_enqueue_vector, but gives the entries the enqueue times
+ * from stamps, as returned by queue_dequeue_vector_stamps, such that
+ * entries moved from another queue keep their age.  When stamps is
+ * NULL, the entries get the current time, if the queue is stamped.
+ */
+void
+queue_enqueue_vector_stamps(queue *q, const char **p,
+		const size_t *stamps, size_t len)
+{
+	queue_cell *c;
+	size_t w;
+	size_t i;
+	size_t bytes;
+	size_t now = stamps == NULL ? queue_stamp(q) : 0;
+
+	while (len > 0 && len <= q->end) {
+		w = LOAD(q->write);
+		if ((ssize_t)(w + len - LOAD(q->read.pos)) > (ssize_t)q->end)
+			break;
+		for (i = 0; i < len; i++)
+			if (LOAD(q->cells[(w + i) & q->mask].seq) != w + i)
+				break;
+		if (i < len) {
+			if ((ssize_t)(LOAD(q->cells[(w + i) & q->mask].seq) - (w + i)) > 0)
+				continue;  /* another writer claimed cells, reload */
+			break;
+		}
+		if (!__sync_bool_compare_and_swap(&q->write, w, w + len))
+			continue;
+
+		for (i = 0, bytes = 0; i < len; i++)
+			bytes += QUEUE_ENTRY_BYTES(p[i]);
+		queue_addbytes(q, bytes);
+		for (i = 0; i < len; i++) {
+			c = &q->cells[(w + i) & q->mask];
+			while (!__sync_bool_compare_and_swap(&c->seq, w + i, w + i - 1))
+				queue_dropoldest(q);
+			c->p = p[i];
+			c->stamp = stamps == NULL ? now : stamps[i];
+			STORE(c->seq, w + i + 1);
+		}
+		return;
 	}
-	if (q->write == q->end)
-		q->write = 0;
-	q->queue[q->write] = p;
-	q->write++;
-	q->len++;
-	pthread_mutex_unlock(&q->lock);
 
-	if (tofree != NULL)
-		free(tofree);
+	for (i = 0; i < len; i++)
+		queue_enqueue_stamp(q, p[i], stamps == NULL ? now : stamps[i]);
 }
 
 /**
@@ -126,46 +362,52 @@ queue_enqueue(queue *q, const char *p)
 const char *
 queue_dequeue(queue *q)
 {
+	size_t pos;
 	const char *ret;
-	pthread_mutex_lock(&q->lock);
-	if (q->len == 0) {
-		pthread_mutex_unlock(&q->lock);
+
+	if (queue_claim(q, &pos, 1) == 0)
 		return NULL;
-	}
-	if (q->read == q->end)
-		q->read = 0;
-	ret = q->queue[q->read++];
-	q->len--;
-	pthread_mutex_unlock(&q->lock);
+	ret = queue_release(q, pos, NULL);
+	queue_subbytes(q, QUEUE_ENTRY_BYTES(ret));
 	return ret;
 }
 
 /**
- * Returns at most len elements from the queue.  Attempts to use a
- * single lock to read a vector of elements from the queue to minimise
- * effects of locking.  Returns the number of elements stored in ret.
+ * Returns at most len elements from the queue.  Attempts to claim a
+ * vector of elements from the queue at once to minimise contention on
+ * the read position.  Returns the number of elements stored in ret.
  * The caller is responsible for freeing elements from ret, as well as
  * making sure it is large enough to store len elements.
  */
 size_t
 queue_dequeue_vector(const char **ret, queue *q, size_t len)
 {
+	return queue_dequeue_vector_stamps(ret, NULL, q, len);
+}
+
+/**
+ * Like queue_dequeue_vector, but also stores the time each element was
+ * enqueued, in microseconds since the epoch, in stamps, unless it is
+ * NULL.  Elements that were put back carry the time of the putback,
+ * unless queue_putback_vector_stamps was given their original times.
+ * When the queue isn't stamped, the times are 0.
+ */
+size_t
+queue_dequeue_vector_stamps(const char **ret, size_t *stamps,
+		queue *q, size_t len)
+{
+	size_t pos;
 	size_t i;
+	size_t bytes = 0;
 
-	pthread_mutex_lock(&q->lock);
-	if (q->len == 0) {
-		pthread_mutex_unlock(&q->lock);
-		return 0;
-	}
-	if (len > q->len)
-		len = q->len;
+	len = queue_claim(q, &pos, len);
 	for (i = 0; i < len; i++) {
-		if (q->read == q->end)
-			q->read = 0;
-		ret[i] = q->queue[q->read++];
+		ret[i] = queue_release(q, pos + i,
+				stamps == NULL ? NULL : &stamps[i]);
+		bytes += QUEUE_ENTRY_BYTES(ret[i]);
 	}
-	q->len -= len;
-	pthread_mutex_unlock(&q->lock);
+	if (bytes > 0)
+		queue_subbytes(q, bytes);
 
 	return len;
 }
@@ -180,22 +422,122 @@ queue_dequeue_vector(const char **ret, queue *q, size_t len)
 char
 queue_putback(queue *q, const char *p)
 {
-	pthread_mutex_lock(&q->lock);
-	if (q->len == q->end) {
-		pthread_mutex_unlock(&q->lock);
-		return 0;
+	queue_cell *c;
+	size_t r;
+	size_t g;
+
+	while (1) {
+		g = LOAD(q->read.gen);
+		r = LOAD(q->read.pos);
+		if (LOAD(q->write) - r >= q->end)
+			return 0;
+		/* reserve the cell in front of the reader, this makes it look
+		 * occupied to writers wrapping around and empty to readers */
+		c = &q->cells[(r - 1) & q->mask];
+		if (!__sync_bool_compare_and_swap(&c->seq, r + q->mask, r - 1)) {
+			if (LOAD(q->read.pos) == r && LOAD(c->seq) != r - 1)
+				return 0;  /* a writer already took it */
+			sched_yield();
+			continue;
+		}
+		if (queue_moveread(q, r, g, r - 1, g + 1))
+			break;
+		/* a reader moved on, release the cell again */
+		STORE(c->seq, r + q->mask);
 	}
 
-	if (q->read == 0)
-		q->read = q->end;
-	q->read--;
-	q->queue[q->read] = p;
-	q->len++;
-	pthread_mutex_unlock(&q->lock);
+	queue_addbytes(q, QUEUE_ENTRY_BYTES(p));
+	c->p = p;
+	c->stamp = queue_stamp(q);
+	STORE(c->seq, r);
 
 	return 1;
 }
 
+/**
+ * Puts the first len entries from p at the front of the queue, in the
+ * order they are in p, as far as there is space available in the
+ * queue.  All cells are reserved before the read position is moved
+ * back over them at once, such that readers see either none or all of
+ * the entries.  Returns the number of entries put back, which are the
+ * leading ones from p, the caller remains responsible for the rest.
+ */
+size_t
+queue_putback_vector(queue *q, const char **p, size_t len)
+{
+	return queue_putback_vector_stamps(q, p, NULL, len);
+}
+
+/**
+ * Like queue_putback_vector, but restores the enqueue times from
+ * stamps, as returned by queue_dequeue_vector_stamps, such that put
+ * back entries keep their age.  When stamps is NULL, the entries get
+ * the current time, if the queue is stamped.
+ */
+size_t
+queue_putback_vector_stamps(queue *q, const char **p,
+		const size_t *stamps, size_t len)
+{
+	queue_cell *c;
+	size_t r;
+	size_t g;
+	size_t n;
+	size_t i;
+	size_t used;
+	size_t bytes;
+	size_t now;
+
+	while (1) {
+		g = LOAD(q->read.gen);
+		r = LOAD(q->read.pos);
+		used = LOAD(q->write) - r;
+		if (used >= q->end)
+			return 0;
+		n = q->end - used < len ? q->end - used : len;
+		/* reserve the cells in front of the reader, see queue_putback */
+		for (i = 1; i <= n; i++) {
+			c = &q->cells[(r - i) & q->mask];
+			if (!__sync_bool_compare_and_swap(&c->seq,
+						r - i + q->mask + 1, r - i))
+				break;
+		}
+		if (i <= n) {
+			if (LOAD(q->read.pos) == r && LOAD(c->seq) != r - i) {
+				/* a writer took this cell, settle for what we got */
+				if ((n = i - 1) == 0)
+					return 0;
+			} else {
+				/* a reader moved on, or another putback is busy,
+				 * release the cells again and retry */
+				while (--i > 0)
+					STORE(q->cells[(r - i) & q->mask].seq,
+							r - i + q->mask + 1);
+				sched_yield();
+				continue;
+			}
+		}
+		if (queue_moveread(q, r, g, r - n, g + 1))
+			break;
+		/* a reader moved on, release the cells again */
+		for (i = 1; i <= n; i++)
+			STORE(q->cells[(r - i) & q->mask].seq, r - i + q->mask + 1);
+	}
+
+	for (i = 0, bytes = 0; i < n; i++)
+		bytes += QUEUE_ENTRY_BYTES(p[i]);
+	queue_addbytes(q, bytes);
+	now = stamps == NULL ? queue_stamp(q) : 0;
+	r -= n;
+	for (i = 0; i < n; i++) {
+		c = &q->cells[(r + i) & q->mask];
+		c->p = p[i];
+		c->stamp = stamps == NULL ? now : stamps[i];
+		STORE(c->seq, r + i + 1);
+	}
+
+	return n;
+}
+
 /**
  * Returns the (approximate) size of entries waiting to be read in the
  * queue.  The returned value cannot be taken accurate with multiple
@@ -205,11 +547,12 @@ queue_putback(queue *q, const char *p)
 inline size_t
 queue_len(queue *q)
 {
-	size_t len;
-	pthread_mutex_lock(&q->lock);
-	len = q->len;
-	pthread_mutex_unlock(&q->lock);
-	return len;
+	size_t r = LOAD(q->read.pos);
+	size_t w = LOAD(q->write);
+
+	if ((ssize_t)(w - r) <= 0)
+		return 0;
+	return w - r > q->end ? q->end : w - r;
 }
 
 /**
@@ -222,6 +565,17 @@ queue_free(queue *q)
 	return q->end - queue_len(q);
 }
 
+/**
+ * Sets whether the queue records when entries are enqueued, which
+ * costs a call to gettimeofday() for each enqueue.  Entries enqueued
+ * while the queue isn't stamped carry a time of 0.
+ */
+void
+queue_set_stamped(queue *q, char stamped)
+{
+	STORE(q->stamped, stamped);
+}
+
 /**
  * Returns the size of the queue.
  */
@@ -230,3 +584,23 @@ queue_size(queue *q)
 {
 	return q->end;
 }
+
+/**
+ * Returns the (approximate) number of bytes held by the entries in the
+ * queue.
+ */
+inline size_t
+queue_bytes(queue *q)
+{
+	return LOAD(q->bytes);
+}
+
+/**
+ * Returns the (approximate) number of bytes held by all queues, that
+ * is their cells and the entries in them.
+ */
+inline size_t
+queue_totbytes(void)
+{
+	return LOAD(queue_allbytes);
+}
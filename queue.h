@@ -22,14 +22,29 @@
 
 typedef struct _queue queue;
 
+/* memory taken by an entry, a length followed by the string, in an
+ * allocation that malloc prefixes with its bookkeeping and rounds up */
+#define QUEUE_ENTRY_BYTES(P)  (3 * sizeof(size_t) + *(size_t *)(P))
+
 queue* queue_new(size_t size);
 void queue_destroy(queue *q);
 void queue_enqueue(queue *q, const char *p);
+void queue_enqueue_vector(queue *q, const char **p, size_t len);
+void queue_enqueue_vector_stamps(queue *q, const char **p,
+		const size_t *stamps, size_t len);
 const char *queue_dequeue(queue *q);
 size_t queue_dequeue_vector(const char **ret, queue *q, size_t len);
+size_t queue_dequeue_vector_stamps(const char **ret, size_t *stamps,
+		queue *q, size_t len);
 char queue_putback(queue *q, const char *p);
+size_t queue_putback_vector(queue *q, const char **p, size_t len);
+size_t queue_putback_vector_stamps(queue *q, const char **p,
+		const size_t *stamps, size_t len);
 size_t queue_len(queue *q);
 size_t queue_free(queue *q);
+void queue_set_stamped(queue *q, char stamped);
 size_t queue_size(queue *q);
+size_t queue_bytes(queue *q);
+size_t queue_totbytes(void);
 
 #endif
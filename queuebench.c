@@ -0,0 +1,171 @@
+/*
+ * Copyright 2013-2025 Fabian Groffen
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Contention benchmark for the server queue.  A number of producer
+ * threads (like dispatchers) enqueue into a single queue, while one
+ * consumer (like a server) drains it in batches. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include "queue.h"
+
+#define MAX_PRODUCERS  64
+
+static queue *q;
+static size_t permetrics;
+static size_t batchsize = 2500;
+static char producing;
+
+static void *
+bench_producer(void *d)
+{
+	size_t i;
+	char *p;
+
+	(void)d;
+	for (i = 0; i < permetrics; i++) {
+		if ((p = malloc(sizeof(size_t) + 32)) == NULL)
+			break;
+		*(size_t *)p = 32;
+		queue_enqueue(q, p);
+	}
+
+	return NULL;
+}
+
+static void *
+bench_consumer(void *d)
+{
+	size_t *consumed = (size_t *)d;
+	const char **batch;
+	size_t len;
+	size_t i;
+
+	if ((batch = malloc(sizeof(char *) * batchsize)) == NULL)
+		return NULL;
+
+	while (1) {
+		len = queue_dequeue_vector(batch, q, batchsize);
+		for (i = 0; i < len; i++)
+			free((char *)batch[i]);
+		*consumed += len;
+		if (len == 0) {
+			if (__sync_bool_compare_and_swap(&producing, 0, 0) &&
+					queue_len(q) == 0)
+				break;
+			usleep(100);
+		}
+	}
+
+	free(batch);
+	return NULL;
+}
+
+static void
+do_usage(char *name, int exitcode)
+{
+	printf("Usage: %s [-n metrics] [-q queuesize] [-b batchsize] "
+			"[-p producers]\n", name);
+	printf("\n");
+	printf("Options:\n");
+	printf("  -n  number of metrics to enqueue per run, defaults to %d\n",
+			10000000);
+	printf("  -q  queue size, defaults to %d\n", 25000);
+	printf("  -b  consumer batch size, defaults to %zu\n", batchsize);
+	printf("  -p  maximum number of producers, defaults to %d\n",
+			MAX_PRODUCERS);
+
+	exit(exitcode);
+}
+
+int
+main(int argc, char *argv[])
+{
+	pthread_t producers[MAX_PRODUCERS];
+	pthread_t consumer;
+	size_t metrics = 10000000;
+	size_t queuesize = 25000;
+	int maxproducers = MAX_PRODUCERS;
+	int nproducers;
+	int i;
+	int ch;
+	size_t consumed;
+	struct timeval start, stop;
+	double secs;
+
+	while ((ch = getopt(argc, argv, ":hn:q:b:p:")) != -1) {
+		switch (ch) {
+			case 'n':
+				metrics = (size_t)atol(optarg);
+				break;
+			case 'q':
+				queuesize = (size_t)atol(optarg);
+				break;
+			case 'b':
+				batchsize = (size_t)atol(optarg);
+				break;
+			case 'p':
+				maxproducers = atoi(optarg);
+				if (maxproducers > MAX_PRODUCERS)
+					maxproducers = MAX_PRODUCERS;
+				break;
+			case 'h':
+				do_usage(argv[0], 0);
+				break;
+			default:
+				do_usage(argv[0], 1);
+				break;
+		}
+	}
+	if (metrics == 0 || queuesize == 0 || batchsize == 0 || maxproducers <= 0)
+		do_usage(argv[0], 1);
+
+	printf("%9s %12s %12s %12s\n",
+			"producers", "metrics/s", "consumed", "dropped");
+	for (nproducers = 1; nproducers <= maxproducers; nproducers *= 2) {
+		if ((q = queue_new(queuesize)) == NULL) {
+			fprintf(stderr, "failed to allocate queue\n");
+			return 1;
+		}
+		permetrics = metrics / nproducers;
+		consumed = 0;
+		producing = 1;
+
+		gettimeofday(&start, NULL);
+		pthread_create(&consumer, NULL, bench_consumer, &consumed);
+		for (i = 0; i < nproducers; i++)
+			pthread_create(&producers[i], NULL, bench_producer, NULL);
+		for (i = 0; i < nproducers; i++)
+			pthread_join(producers[i], NULL);
+		__sync_and_and_fetch(&producing, 0);
+		pthread_join(consumer, NULL);
+		gettimeofday(&stop, NULL);
+
+		secs = (double)(stop.tv_sec - start.tv_sec) +
+			(double)(stop.tv_usec - start.tv_usec) / 1000000.0;
+		printf("%9d %12.0f %12zu %12zu\n",
+				nproducers, (double)(permetrics * nproducers) / secs,
+				consumed, permetrics * nproducers - consumed);
+		queue_destroy(q);
+	}
+
+	return 0;
+}
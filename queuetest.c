@@ -0,0 +1,263 @@
+/*
+ * Copyright 2013-2025 Fabian Groffen
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Tests for the server queue under contention.  Producers overfill a
+ * small queue, such that they keep dropping the oldest entries, while
+ * a consumer puts back part of what it takes, like a server whose
+ * write failed, and a second one steals from it.  Every entry must be
+ * taken intact and at most once, in the order each producer enqueued
+ * them, and nobody may get stuck. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "queue.h"
+
+#define PRODUCERS  4
+#define ENTRIES    200000  /* per producer */
+#define BATCH      16
+#define MAGIC      0x5eedf00dUL
+
+typedef struct {
+	size_t len;
+	size_t producer;
+	size_t seq;
+	size_t check;
+} entry;
+
+typedef struct {
+	char putback;           /* put back part of each batch */
+	unsigned int seed;
+	size_t last[PRODUCERS]; /* seq + 1 of the last entry taken */
+	size_t taken;
+	size_t errors;
+} consumer;
+
+static queue *q;
+static size_t throttle;  /* producers wait while this many are queued */
+static char *seen[PRODUCERS];
+static size_t producing;
+static char verbose = 0;
+
+static void *
+test_producer(void *d)
+{
+	size_t id = (size_t)d;
+	entry *e;
+	size_t i;
+
+	for (i = 0; i < ENTRIES; i++) {
+		if ((e = malloc(sizeof(entry))) == NULL)
+			break;
+		e->len = sizeof(entry) - sizeof(size_t);
+		e->producer = id;
+		e->seq = i;
+		e->check = id ^ i ^ MAGIC;
+		while (throttle > 0 && queue_len(q) >= throttle)
+			sched_yield();
+		queue_enqueue(q, (char *)e);
+	}
+	__sync_sub_and_fetch(&producing, 1);
+
+	return NULL;
+}
+
+/**
+ * Checks the entry e that consumer c took, and frees it.
+ */
+static void
+test_take(consumer *c, const entry *e)
+{
+	if (e->producer >= PRODUCERS || e->seq >= ENTRIES ||
+			e->check != (e->producer ^ e->seq ^ MAGIC))
+	{
+		if (verbose)
+			fprintf(stderr, "damaged entry %p\n", (void *)e);
+		c->errors++;
+	} else {
+		if (__sync_lock_test_and_set(&seen[e->producer][e->seq], 1) != 0) {
+			if (verbose)
+				fprintf(stderr, "entry %zu:%zu taken twice\n",
+						e->producer, e->seq);
+			c->errors++;
+		}
+		if (e->seq < c->last[e->producer]) {
+			if (verbose)
+				fprintf(stderr, "entry %zu:%zu taken after %zu\n",
+						e->producer, e->seq, c->last[e->producer] - 1);
+			c->errors++;
+		}
+		c->last[e->producer] = e->seq + 1;
+	}
+	c->taken++;
+	free((void *)e);
+}
+
+static void *
+test_consumer(void *d)
+{
+	consumer *c = (consumer *)d;
+	const char *batch[BATCH];
+	size_t stamps[BATCH];
+	size_t len;
+	size_t keep;
+	size_t back;
+	size_t i;
+
+	while (1) {
+		len = queue_dequeue_vector_stamps(batch, stamps, q, BATCH);
+		if (len == 0) {
+			if (__sync_add_and_fetch(&producing, 0) == 0 &&
+					queue_len(q) == 0)
+				break;
+			sched_yield();
+			continue;
+		}
+		keep = len;
+		if (c->putback && (keep = rand_r(&c->seed) % (len + 1)) < len) {
+			/* as if writing failed halfway the batch */
+			back = queue_putback_vector_stamps(q, batch + keep,
+					stamps + keep, len - keep);
+			for (i = keep + back; i < len; i++)
+				free((void *)batch[i]);
+		}
+		for (i = 0; i < keep; i++)
+			test_take(c, (const entry *)batch[i]);
+	}
+
+	return NULL;
+}
+
+/**
+ * Runs producers and consumers on a queue of size entries, and checks
+ * what the consumers got.  With putback, one of the consumers puts
+ * back part of each batch, and the producers overfill the queue, else
+ * they hold off while it is half full, and nothing may be lost.
+ */
+static int
+test_run(size_t size, char putback)
+{
+	pthread_t producers[PRODUCERS];
+	pthread_t consumers[2];
+	consumer c[2];
+	size_t i;
+	int errors = 0;
+
+	if ((q = queue_new(size)) == NULL) {
+		fprintf(stderr, "%s: cannot allocate queue\n", __func__);
+		return 1;
+	}
+	for (i = 0; i < PRODUCERS; i++)
+		memset(seen[i], 0, ENTRIES);
+	memset(c, 0, sizeof(c));
+	c[0].putback = putback;
+	c[0].seed = (unsigned int)size;
+
+	throttle = putback ? 0 : size / 2;
+	producing = PRODUCERS;
+	for (i = 0; i < 2; i++)
+		pthread_create(&consumers[i], NULL, test_consumer, &c[i]);
+	for (i = 0; i < PRODUCERS; i++)
+		pthread_create(&producers[i], NULL, test_producer, (void *)i);
+	for (i = 0; i < PRODUCERS; i++)
+		pthread_join(producers[i], NULL);
+	for (i = 0; i < 2; i++)
+		pthread_join(consumers[i], NULL);
+
+	if (c[0].errors + c[1].errors > 0) {
+		fprintf(stderr, "%s: queue of %zu: %zu bad entries\n",
+				__func__, size, c[0].errors + c[1].errors);
+		errors++;
+	}
+	if (c[0].taken + c[1].taken == 0 ||
+			(!putback && c[0].taken + c[1].taken != PRODUCERS * ENTRIES))
+	{
+		fprintf(stderr, "%s: queue of %zu: %zu and %zu entries taken\n",
+				__func__, size, c[0].taken, c[1].taken);
+		errors++;
+	}
+	if (queue_len(q) != 0 || queue_bytes(q) != 0) {
+		fprintf(stderr, "%s: queue of %zu: %zu entries, %zu bytes left\n",
+				__func__, size, queue_len(q), queue_bytes(q));
+		errors++;
+	}
+	if (verbose)
+		fprintf(stderr, "queue of %zu: %zu and %zu of %d entries taken\n",
+				size, c[0].taken, c[1].taken, PRODUCERS * ENTRIES);
+	queue_destroy(q);
+
+	return errors > 0;
+}
+
+static void
+do_usage(char *name, int exitcode)
+{
+	printf("Usage: %s [-v]\n", name);
+	printf("\n");
+	printf("Options:\n");
+	printf("  -v  print what goes wrong, and how much was taken\n");
+
+	exit(exitcode);
+}
+
+int
+main(int argc, char *argv[])
+{
+	int failed = 0;
+	int ch;
+	size_t i;
+
+	while ((ch = getopt(argc, argv, ":hv")) != -1) {
+		switch (ch) {
+			case 'v':
+				verbose = 1;
+				break;
+			case 'h':
+				do_usage(argv[0], 0);
+				break;
+			default:
+				do_usage(argv[0], 1);
+				break;
+		}
+	}
+
+	for (i = 0; i < PRODUCERS; i++) {
+		if ((seen[i] = malloc(ENTRIES)) == NULL) {
+			fprintf(stderr, "out of memory\n");
+			return 1;
+		}
+	}
+
+	/* a stuck queue never returns */
+	alarm(120);
+
+	/* sized a power of two, the ring is filled up to the last cell */
+	failed += test_run(64, 1);
+	failed += test_run(100, 1);
+	failed += test_run(64, 0);
+	failed += test_run(100, 0);
+
+	for (i = 0; i < PRODUCERS; i++)
+		free(seen[i]);
+
+	printf("queue: %d of %d tests failing\n", failed, 4);
+
+	return failed == 0 ? 0 : 1;
+}
@@ -158,6 +158,12 @@ ssllisten(listener *lsnr)
 				lsnr->pemcert, err);
 		return 1;
 	}
+#ifdef SSL_OP_ENABLE_KTLS
+	/* OpenSSL falls back to doing the crypto itself when the kernel
+	 * lacks TLS support or the negotiated cipher */
+	if (sslktls)
+		SSL_CTX_set_options(lsnr->ctx, SSL_OP_ENABLE_KTLS);
+#endif
 	if (lsnr->transport & W_MTLS && sslCA != NULL) {  /* issue #444 */
 		if (SSL_CTX_load_verify_locations(lsnr->ctx,
 										  sslCAisdir ? NULL : sslCA,
@@ -44,6 +44,10 @@
 #include "conffile.h"
 #include "posixregex.h"
 
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
 unsigned char keep_running = 1;
 int pending_signal = -1;
 char relay_hostname[256];
@@ -52,9 +56,27 @@ char noexpire = 0;
 #ifdef HAVE_SSL
 char *sslCA = NULL;
 char sslCAisdir = 0;
+char sslktls = 0;
 #endif
 
 static char *config = NULL;
+static char *profilefile = NULL;
+static char *spooldir = NULL;
+static int spoolsize = 1024;
+static int membudget = 0;
+static char membudget_stall = 0;
+static int sendercnt = 0;
+static int compressorcnt = 0;
+static int maxflush = 0;
+static int maxconns = 1;
+static int udpsize = SERVER_UDP_SIZE;
+static char sslkeepalive = 0;
+#ifdef HAVE_ZSTD
+static int zstdlevel = ZSTD_CLEVEL_DEFAULT;
+static char *zstddictfile = NULL;
+static char *zstddict = NULL;
+static size_t zstddictlen = 0;
+#endif
 static int batchsize = 2500;
 static int queuesize = 25000;
 static int maxstalls = 4;
@@ -355,7 +377,7 @@ static void
 do_version(void)
 {
 	printf("carbon-c-relay v" VERSION " (" GIT_VERSION ")\n");
-#if defined(HAVE_GZIP) || defined(HAVE_LZ4) || defined(HAVE_SNAPPY) || defined(HAVE_SSL)
+#if defined(HAVE_GZIP) || defined(HAVE_LZ4) || defined(HAVE_SNAPPY) || defined(HAVE_ZSTD) || defined(HAVE_SSL)
 	printf("enabled support for:");
 #endif
 #ifdef HAVE_GZIP
@@ -367,6 +389,9 @@ do_version(void)
 #ifdef HAVE_SNAPPY
 	printf(" snappy");
 #endif
+#ifdef HAVE_ZSTD
+	printf(" zstd");
+#endif
 #ifdef HAVE_SSL
 	printf(" ssl");
 #endif
@@ -402,9 +427,31 @@ do_usage(char *name, int exitcode)
 	printf("  -b  server send batch size, defaults to %d\n", batchsize);
 	printf("  -q  server queue size, defaults to %d\n", queuesize);
 	printf("  -L  server max stalls, defaults to %d\n", maxstalls);
+	printf("  -Q  spill metrics that don't fit the server queue to <dir>\n");
+	printf("  -Z  max size in MiB of spilled metrics per server, "
+			"defaults to %d\n", spoolsize);
+	printf("  -X  max size in MiB of metrics queued for all servers, "
+			"defaults to unlimited\n");
+	printf("  -Y  drop or stall when -X is reached, defaults to drop\n");
+	printf("  -W  use <senders> threads for plain TCP servers, defaults to\n");
+	printf("      one thread per server\n");
+	printf("  -N  use up to <conns> connections per TCP server, defaults to 1\n");
+	printf("  -u  max bytes of metrics packed in a datagram to UDP servers,\n");
+	printf("      defaults to %d\n", SERVER_UDP_SIZE);
+	printf("  -F  max milliseconds compressed server streams may hold data\n");
+	printf("      before flushing, defaults to flushing when idle\n");
+	printf("  -j  use <compressors> threads to compress gzip and lz4 server\n");
+	printf("      streams, defaults to compressing on each server's thread\n");
+#ifdef HAVE_ZSTD
+	printf("  -z  compression level for zstd server streams, defaults to %d\n",
+			ZSTD_CLEVEL_DEFAULT);
+	printf("  -y  prime zstd streams with the dictionary from <file>\n");
+#endif
 #ifdef HAVE_SSL
 	printf("  -C  use CA <cert> to verify outgoing SSL connections or\n");
 	printf("      incoming mTLS connections\n");
+	printf("  -K  keep idle SSL server connections open to avoid handshakes\n");
+	printf("  -k  let the kernel encrypt SSL connections where supported (kTLS)\n");
 #endif
 	printf("  -B  connection listen backlog, defaults to 32\n");
 	printf("  -U  socket receive buffer size, max/min/default values depend on OS\n");
@@ -423,6 +470,9 @@ do_usage(char *name, int exitcode)
 	       "      statistics, report drop counts and queue pressure to log\n");
 	printf("  -S  implies submission mode, print iostat-like statistics\n");
 	printf("  -t  config test mode: prints rule matches from input on stdin\n");
+	printf("  -r  route profile: in test mode, route all metrics from <file>\n"
+	       "      using <workers> threads and report on rule matches and\n"
+	       "      destination distribution, nothing is sent\n");
 	printf("  -H  hostname: override hostname (used in statistics)\n");
 	printf("  -D  daemonise: detach and run in background\n");
 	printf("  -P  pidfile: write a pid to a specified pidfile\n");
@@ -437,6 +487,7 @@ main(int argc, char * const argv[])
 {
 	char id;
 	int ch;
+	int err;
 	size_t numaggregators;
 	char *allowed_chars = NULL;
 	char *pidfile = NULL;
@@ -452,7 +503,7 @@ main(int argc, char * const argv[])
 		snprintf(relay_hostname, sizeof(relay_hostname), "127.0.0.1");
 
 	while ((ch = getopt(argc, argv,
-					":hvdsStf:l:p:w:b:q:L:C:T:c:m:M:H:B:U:EDP:O:")) != -1)
+					":hvdsStr:f:l:p:w:b:q:L:Q:Z:X:Y:W:N:u:F:j:z:y:C:KkT:c:m:M:H:B:U:EDP:O:")) != -1)
 	{
 		switch (ch) {
 			case 'v':
@@ -482,6 +533,9 @@ main(int argc, char * const argv[])
 					mode |= MODE_TEST;
 				}
 				break;
+			case 'r':
+				profilefile = optarg;
+				break;
 			case 'f':
 				config = optarg;
 				break;
@@ -526,9 +580,105 @@ main(int argc, char * const argv[])
 					do_usage(argv[0], 1);
 				}
 				break;
+			case 'Q':
+				spooldir = optarg;
+				break;
+			case 'Z':
+				spoolsize = atoi(optarg);
+				if (spoolsize <= 0) {
+					fprintf(stderr, "error: spool size needs to be a number >0\n");
+					do_usage(argv[0], 1);
+				}
+				break;
+			case 'X':
+				membudget = atoi(optarg);
+				if (membudget <= 0) {
+					fprintf(stderr, "error: memory budget needs to be "
+							"a number >0\n");
+					do_usage(argv[0], 1);
+				}
+				break;
+			case 'Y':
+				if (strcmp(optarg, "drop") == 0) {
+					membudget_stall = 0;
+				} else if (strcmp(optarg, "stall") == 0) {
+					membudget_stall = 1;
+				} else {
+					fprintf(stderr, "error: memory budget policy needs to "
+							"be drop or stall\n");
+					do_usage(argv[0], 1);
+				}
+				break;
+			case 'W':
+				sendercnt = atoi(optarg);
+				if (sendercnt <= 0) {
+					fprintf(stderr, "error: senders needs to be a number >0\n");
+					do_usage(argv[0], 1);
+				}
+				break;
+			case 'N':
+				maxconns = atoi(optarg);
+				if (maxconns <= 0 || maxconns > SERVER_MAX_CONNS) {
+					fprintf(stderr, "error: connections needs to be a number "
+							"between 1 and %d\n", SERVER_MAX_CONNS);
+					do_usage(argv[0], 1);
+				}
+				break;
+			case 'u':
+				udpsize = atoi(optarg);
+				if (udpsize <= 0 || udpsize > SERVER_UDP_MAXSIZE) {
+					fprintf(stderr, "error: datagram size needs to be a "
+							"number between 1 and %d\n", SERVER_UDP_MAXSIZE);
+					do_usage(argv[0], 1);
+				}
+				break;
+			case 'F':
+				maxflush = atoi(optarg);
+				if (maxflush <= 0) {
+					fprintf(stderr, "error: max flush latency needs to be "
+							"a number >0\n");
+					do_usage(argv[0], 1);
+				}
+				break;
+			case 'j':
+				compressorcnt = atoi(optarg);
+				if (compressorcnt <= 0) {
+					fprintf(stderr, "error: compressors needs to be a "
+							"number >0\n");
+					do_usage(argv[0], 1);
+				}
+				break;
+			case 'z':
+#ifdef HAVE_ZSTD
+				zstdlevel = atoi(optarg);
+				if (zstdlevel == 0 || zstdlevel < ZSTD_minCLevel() ||
+						zstdlevel > ZSTD_maxCLevel())
+				{
+					fprintf(stderr, "error: zstd level needs to be a number "
+							"between %d and %d, except 0\n",
+							ZSTD_minCLevel(), ZSTD_maxCLevel());
+					do_usage(argv[0], 1);
+				}
+#endif
+				break;
+			case 'y':
+#ifdef HAVE_ZSTD
+				zstddictfile = optarg;
+#endif
+				break;
 			case 'C':
 #ifdef HAVE_SSL
 				sslCA = optarg;
+#endif
+				break;
+			case 'K':
+#ifdef HAVE_SSL
+				sslkeepalive = 1;
+#endif
+				break;
+			case 'k':
+#ifdef HAVE_SSL
+				sslktls = 1;
 #endif
 				break;
 			case 'T': {
@@ -647,6 +797,10 @@ main(int argc, char * const argv[])
 	}
 	if (optind == 1 || config == NULL)
 		do_usage(argv[0], 1);
+	if (profilefile != NULL && !(mode & MODE_TEST)) {
+		fprintf(stderr, "error: route profiling requires test mode (-t)\n");
+		do_usage(argv[0], 1);
+	}
 
 
 	/* seed randomiser for dispatcher and aggregator "splay" */
@@ -733,6 +887,31 @@ main(int argc, char * const argv[])
 	}
 #endif
 
+#ifdef HAVE_ZSTD
+	/* load the dictionary now, it must be the same on both ends */
+	if (zstddictfile != NULL) {
+		FILE *f;
+		struct stat st;
+
+		if ((f = fopen(zstddictfile, "r")) == NULL ||
+				fstat(fileno(f), &st) == -1)
+		{
+			fprintf(stderr, "failed to open zstd dictionary '%s': %s\n",
+					zstddictfile, strerror(errno));
+			exit(1);
+		}
+		zstddictlen = (size_t)st.st_size;
+		if ((zstddict = malloc(zstddictlen + 1)) == NULL ||
+				fread(zstddict, 1, zstddictlen, f) != zstddictlen)
+		{
+			fprintf(stderr, "failed to read zstd dictionary '%s'\n",
+					zstddictfile);
+			exit(1);
+		}
+		fclose(f);
+	}
+#endif
+
 	if (mode & MODE_DAEMON) {
 		pid_t p;
 
@@ -843,12 +1022,43 @@ main(int argc, char * const argv[])
 		fprintf(relay_stdout, "    send batch size = %d\n", batchsize);
 		fprintf(relay_stdout, "    server queue size = %d\n", queuesize);
 		fprintf(relay_stdout, "    server max stalls = %d\n", maxstalls);
+		if (spooldir != NULL)
+			fprintf(relay_stdout, "    server spool = %s (%dMiB)\n",
+					spooldir, spoolsize);
+		if (membudget > 0)
+			fprintf(relay_stdout, "    server queue memory budget = %dMiB (%s)\n",
+					membudget, membudget_stall ? "stall" : "drop");
+		if (sendercnt > 0)
+			fprintf(relay_stdout, "    server senders = %d\n", sendercnt);
+		if (maxconns > 1)
+			fprintf(relay_stdout, "    server max connections = %d\n",
+					maxconns);
+		if (udpsize != SERVER_UDP_SIZE)
+			fprintf(relay_stdout, "    server datagram size = %d\n",
+					udpsize);
+		if (maxflush > 0)
+			fprintf(relay_stdout, "    server max flush latency = %dms\n",
+					maxflush);
+		if (compressorcnt > 0)
+			fprintf(relay_stdout, "    server compressors = %d\n",
+					compressorcnt);
+#ifdef HAVE_ZSTD
+		if (zstdlevel != ZSTD_CLEVEL_DEFAULT)
+			fprintf(relay_stdout, "    server zstd level = %d\n", zstdlevel);
+		if (zstddictfile != NULL)
+			fprintf(relay_stdout, "    zstd dictionary = %s (%zu bytes)\n",
+					zstddictfile, zstddictlen);
+#endif
 		fprintf(relay_stdout, "    listen backlog = %u\n", listenbacklog);
 		if (sockbufsize > 0)
 			fprintf(relay_stdout, "    socket bufsize = %u\n", sockbufsize);
 #ifdef HAVE_SSL
 		if (sslCA != NULL)
 			fprintf(relay_stdout, "    tls/ssl CA = %s\n", sslCA);
+		if (sslkeepalive)
+			fprintf(relay_stdout, "    keep idle tls/ssl connections = yes\n");
+		if (sslktls)
+			fprintf(relay_stdout, "    kernel tls offload = yes\n");
 #endif
 		fprintf(relay_stdout, "    server connection IO timeout = %dms\n",
 				iotimeout);
@@ -921,6 +1131,8 @@ main(int argc, char * const argv[])
 		char *p;
 
 		fflush(relay_stdout);
+		if (profilefile != NULL)
+			exit(router_profile(rtr, profilefile, workercnt));
 		while (fgets(metricbuf, sizeof(metricbuf), stdin) != NULL) {
 			if ((p = strchr(metricbuf, '\n')) != NULL)
 				*p = '\0';
@@ -961,6 +1173,27 @@ main(int argc, char * const argv[])
 	}
 
 	dispatch_set_bufsize(sockbufsize);
+	if (spooldir != NULL)
+		server_set_spool(spooldir, (size_t)spoolsize * 1024 * 1024);
+	server_set_membudget((size_t)membudget * 1024 * 1024, membudget_stall);
+	server_set_maxflush((unsigned int)maxflush);
+	server_set_maxconns(maxconns);
+	server_set_udpsize((size_t)udpsize);
+	server_set_sslkeepalive(sslkeepalive);
+#ifdef HAVE_ZSTD
+	if (server_set_zstd(zstdlevel, zstddict, zstddictlen) != 0 ||
+			dispatch_set_zstd_dict(zstddict, zstddictlen) != 0)
+	{
+		exit_err("failed to load zstd dictionary '%s'\n", zstddictfile);
+	}
+	free(zstddict);
+#endif
+	if ((err = server_set_compressors(compressorcnt)) != 0) {
+		exit_err("failed to start compressor threads: %s\n", strerror(err));
+	}
+	if ((err = server_set_pool(sendercnt)) != 0) {
+		exit_err("failed to start sender threads: %s\n", strerror(err));
+	}
 	if (dispatch_init_listeners() != 0) {
 		exit_err("failed to allocate listeners\n");
 	}
@@ -1079,6 +1312,7 @@ main(int argc, char * const argv[])
 
 	router_shutdown(rtr);
 	router_free(rtr);
+	server_stop_pool();
 	logout("stopped servers\n");
 
 	if (pidfile != NULL)
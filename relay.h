@@ -44,6 +44,7 @@ extern char relay_hostname[];
 extern char noexpire;
 extern char *sslCA;
 extern char sslCAisdir;
+extern char sslktls;
 
 enum logdst { LOGOUT, LOGERR };
 
@@ -56,7 +57,8 @@ typedef enum {
 } con_proto;
 typedef enum {
 	T_LINEMODE   = 1,
-	T_SYSLOGMODE = 2
+	T_SYSLOGMODE = 2,
+	T_PICKLE     = 3
 } con_type;
 typedef enum {
 	W_PLAIN  = 1,
@@ -68,6 +70,9 @@ typedef enum {
 #endif
 #ifdef HAVE_SNAPPY
 	W_SNAPPY = 4,
+#endif
+#ifdef HAVE_ZSTD
+	W_ZSTD   = 5,
 #endif
 	W_SSL    = 1 << 16,  /* used as bit-flag */
 	W_MTLS   = 1 << 17   /* used as bit-flag */
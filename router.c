@@ -21,9 +21,14 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <string.h>
+#include <strings.h>
 #include <ctype.h>
+#include <math.h>
+#include <float.h>
 #include <glob.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <pthread.h>
 #include <netdb.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -95,14 +100,16 @@ const char *con_proto_str[] = {
 const char *con_type_str[] = {
 	/* 0 */ "<unset>",
 	/* 1 */ "linemode",
-	/* 2 */ "syslog"
+	/* 2 */ "syslog",
+	/* 3 */ "pickle"
 };
 const char *con_trnsp_str[] = {
 	/* 0 */ "<unset>",
 	/* 1 */ "plain",
 	/* 2 */ "gzip",
 	/* 3 */ "lz4",
-	/* 4 */ "snappy"
+	/* 4 */ "snappy",
+	/* 5 */ "zstd"
 };
 
 /**
@@ -754,6 +761,17 @@ router_add_server(
 		}
 		if (inst != NULL)
 			server_set_instance(newserver, inst);
+		if (cl->rate != NULL)
+			server_set_rate(newserver, cl->rate->metrics, cl->rate->bytes,
+					cl->rate->burst, cl->rate->catchup, cl->rate->above);
+		if (cl->expire > 0)
+			server_set_expire(newserver, cl->expire);
+		if (cl->nostall)
+			server_set_nostall(newserver);
+		if (cl->file != NULL)
+			server_set_file(newserver, cl->file->buffer, cl->file->dbl,
+					cl->file->sync, cl->file->rotatesecs,
+					cl->file->rotatebytes);
 
 		if (cl->type == CARBON_CH ||
 				cl->type == FNV1A_CH ||
@@ -895,6 +913,8 @@ router_add_cluster(router *r, cluster *cl)
 					cl->members.anyof->count);
 			if (cl->type == FAILOVER)
 				server_set_failover(w->server);
+			if (cl->steal)
+				server_set_steal(w->server);
 		}
 	} else if (cl->type == CARBON_CH ||
 			cl->type == FNV1A_CH ||
@@ -1949,6 +1969,32 @@ router_tlsprotostr(tlsprotover protover)
 }
 #endif
 
+/**
+ * Writes the configuration representation of validation v into buf.
+ */
+static const char *
+router_validate_str(const validate *v, char *buf, size_t bufsize)
+{
+	size_t len = 0;
+
+	if (v->rule != NULL)
+		return v->rule->pattern;
+
+	buf[0] = '\0';
+	if (v->checks & VAL_FINITE)
+		len += snprintf(buf + len, bufsize - len, "finite");
+	else if (v->checks & VAL_NUMERIC)
+		len += snprintf(buf + len, bufsize - len, "numeric");
+	if (v->checks & VAL_TIMESTAMP)
+		len += snprintf(buf + len, bufsize - len, "%stimestamp",
+				len == 0 ? "" : " ");
+	if (v->checks & VAL_TSDRIFT)
+		len += snprintf(buf + len, bufsize - len, " within %u seconds",
+				v->tsdrift);
+
+	return buf;
+}
+
 /**
  * Mere debugging function to check if the configuration is picked up
  * alright.  If all is set to false, aggregation rules won't be printed.
@@ -1982,8 +2028,8 @@ router_printconfig(router *rtr, FILE *f, char pmode)
 		listener *walk;
 		fprintf(f, "listen\n");
 		for (walk = rtr->listeners; walk != NULL; walk = walk->next) {
-			if (walk->lsnrtype == T_LINEMODE) {
-				fprintf(f, "    type linemode");
+			if (walk->lsnrtype == T_LINEMODE || walk->lsnrtype == T_PICKLE) {
+				fprintf(f, "    type %s", con_type_str[walk->lsnrtype]);
 				if ((walk->transport & 0xFFFF) != W_PLAIN)
 					fprintf(f, " transport %s",
 							con_trnsp_str[walk->transport & 0xFFFF]);
@@ -2077,8 +2123,25 @@ router_printconfig(router *rtr, FILE *f, char pmode)
 			for (s = c->members.forward; s != NULL; s = s->next)
 				fprintf(f, "        %s\n",
 						router_quoteident(serverip(s->server)));
+			if (c->file->buffer != SERVER_FILE_BUFSIZ || c->file->dbl)
+				fprintf(f, "    buffer %zu%s\n", c->file->buffer,
+						c->file->dbl ? " double" : "");
+			if (c->file->sync < 0)
+				fprintf(f, "    sync always\n");
+			else if (c->file->sync > 0)
+				fprintf(f, "    sync every %d seconds\n", c->file->sync);
+			if (c->file->rotatesecs > 0 || c->file->rotatebytes > 0) {
+				fprintf(f, "    rotate");
+				if (c->file->rotatesecs > 0)
+					fprintf(f, " every %d seconds", c->file->rotatesecs);
+				if (c->file->rotatebytes > 0)
+					fprintf(f, " at %zu bytes", c->file->rotatebytes);
+				fprintf(f, "\n");
+			}
 		} else if (c->type == ANYOF || c->type == FAILOVER) {
-			fprintf(f, "    %s\n", c->type == ANYOF ? "any_of" : "failover");
+			fprintf(f, "    %s%s%s\n", c->type == ANYOF ? "any_of" : "failover",
+					c->steal ? " steal" : "",
+					c->balanced ? " balanced" : "");
 			for (s = c->members.anyof->list; s != NULL; s = s->next)
 				fprintf(f, "        %s:%d%s" PTYPEFMT PTRNSPFMT "\n",
 						serverip(s->server), server_port(s->server),
@@ -2100,6 +2163,21 @@ router_printconfig(router *rtr, FILE *f, char pmode)
 							server_instance(s->server) : "",
 						PPROTO, PTYPE, PTRNSP);
 		}
+		if (c->rate != NULL) {
+			fprintf(f, "    rate %zu", c->rate->metrics);
+			if (c->rate->bytes > 0)
+				fprintf(f, " bytes %zu", c->rate->bytes);
+			if (c->rate->burst > 0)
+				fprintf(f, " burst %zu", c->rate->burst);
+			if (c->rate->catchup > 0)
+				fprintf(f, " catchup %zu above %zu",
+						c->rate->catchup, c->rate->above);
+			fprintf(f, "\n");
+		}
+		if (c->expire > 0)
+			fprintf(f, "    expire after %d seconds\n", c->expire);
+		if (c->nostall)
+			fprintf(f, "    nostall\n");
 		fprintf(f, "    ;\n");
 		if (pmode & PMODE_HASH) {
 			if (c->type == CARBON_CH ||
@@ -2245,8 +2323,11 @@ router_printconfig(router *rtr, FILE *f, char pmode)
 			d = or->dests;
 			if (d->cl->type == VALIDATION) {
 				validate *v = d->cl->members.validation;
+				char vbuf[64];
 				fprintf(f, "    validate %s else %s\n",
-						router_quoteident(v->rule->pattern),
+						v->rule == NULL ?
+							router_validate_str(v, vbuf, sizeof(vbuf)) :
+							router_quoteident(v->rule->pattern),
 						v->action == VAL_LOG ? "log" : "drop");
 				/* hide this pseudo target */
 				d = d->next;
@@ -2427,7 +2508,9 @@ router_contains_listener(router *rtr, listener *lsnr)
 		} else {
 			snprintf(hnbufr, sizeof(hnbufr), "unknown right");
 		}
-		if (lsnr->transport == rwalk->transport && lsnr->ctype == rwalk->ctype)
+		if (lsnr->lsnrtype == rwalk->lsnrtype &&
+				lsnr->transport == rwalk->transport &&
+				lsnr->ctype == rwalk->ctype)
 		{
 			if (lsnr->ctype == CON_UNIX) {
 				if (strcmp(lsnr->ip, rwalk->ip) == 0) {
@@ -2622,6 +2705,149 @@ router_metric_matches(
 	return ret;
 }
 
+/**
+ * router_metric_matches, but keeping track of how often and how long
+ * the rule was tried, for route profiling.
+ */
+static char
+router_metric_matches_prof(
+		const route *r,
+		char *metric,
+		char *firstspace,
+		regmatch_t *pmatch,
+		int dispatcher_id)
+{
+	routeprof *p = &r->prof[dispatcher_id];
+	struct timespec start;
+	struct timespec stop;
+	char ret;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	ret = router_metric_matches(r, metric, firstspace, pmatch, dispatcher_id);
+	clock_gettime(CLOCK_MONOTONIC, &stop);
+
+	p->evals++;
+	p->matches += ret;
+	p->nsec += (stop.tv_sec - start.tv_sec) * 1000 * 1000 * 1000 +
+		(stop.tv_nsec - start.tv_nsec);
+
+	return ret;
+}
+
+/**
+ * Hand-written scanner for the data part of a metric (value and
+ * timestamp) performing the builtin checks from v.  This avoids the
+ * regex engine for the most common validation policies.  Returns 1 when
+ * all checks pass, 0 otherwise.
+ */
+static char
+router_validate_builtin(const validate *v, const char *data)
+{
+	const char *p = data;
+	const char *s;
+	char digits;
+	int mag;
+	int exp;
+	char expneg;
+	long long ts;
+	time_t now;
+
+	if (v->checks & VAL_NUMERIC) {
+		if (*p == '+' || *p == '-')
+			p++;
+		if (*p == 'i' || *p == 'I' || *p == 'n' || *p == 'N') {
+			if (strncasecmp(p, "infinity", 8) == 0) {
+				p += 8;
+			} else if (strncasecmp(p, "inf", 3) == 0 ||
+					strncasecmp(p, "nan", 3) == 0)
+			{
+				p += 3;
+			} else {
+				return 0;
+			}
+			if (v->checks & VAL_FINITE)
+				return 0;
+		} else {
+			digits = 0;
+			while (*p == '0') {
+				digits = 1;
+				p++;
+			}
+			/* number of significant digits before the dot */
+			for (mag = 0; *p >= '0' && *p <= '9'; p++, mag++)
+				digits = 1;
+			if (*p == '.') {
+				p++;
+				for ( ; *p >= '0' && *p <= '9'; p++)
+					digits = 1;
+			}
+			if (!digits)
+				return 0;
+			exp = 0;
+			if (*p == 'e' || *p == 'E') {
+				p++;
+				expneg = *p == '-';
+				if (*p == '+' || *p == '-')
+					p++;
+				if (*p < '0' || *p > '9')
+					return 0;
+				for ( ; *p >= '0' && *p <= '9'; p++)
+					if (exp < 100000)
+						exp = exp * 10 + (*p - '0');
+				if (expneg)
+					exp = -exp;
+			}
+			/* only numbers close to the limits of a double need the
+			 * real conversion to tell whether they overflow */
+			if (v->checks & VAL_FINITE && mag - 1 + exp >= DBL_MAX_10_EXP &&
+					!isfinite(strtod(data, NULL)))
+				return 0;
+		}
+		if (*p != ' ' && *p != '\n' && *p != '\0')
+			return 0;
+	} else {
+		for ( ; *p != ' ' && *p != '\n' && *p != '\0'; p++)
+			;
+	}
+
+	if (v->checks & VAL_TIMESTAMP) {
+		if (*p++ != ' ')
+			return 0;
+		ts = 0;
+		for (s = p; *p >= '0' && *p <= '9'; p++)
+			if (p - s < 18)
+				ts = ts * 10 + (*p - '0');
+		if (p == s || (*p != '\n' && *p != '\0'))
+			return 0;
+		if (v->checks & VAL_TSDRIFT) {
+			now = time(NULL);
+			if (p - s >= 18 ||
+					ts > (long long)now + v->tsdrift ||
+					ts < (long long)now - v->tsdrift)
+				return 0;
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * Returns whether the data part of a metric passes validation v.  The
+ * data is expected to be terminated by end.
+ */
+static inline char
+router_validate_data(
+		const validate *v,
+		char *data,
+		char *end,
+		regmatch_t *pmatch,
+		int dispatcher_id)
+{
+	if (v->rule == NULL)
+		return router_validate_builtin(v, data);
+	return router_metric_matches(v->rule, data, end, pmatch, dispatcher_id);
+}
+
 size_t
 router_rewrite_metric(
 		char (*newmetric)[METRIC_BUFSIZ],
@@ -2853,6 +3079,23 @@ router_format_syslog(
 	return out;
 }
 
+/**
+ * Returns whether any_of member alt should take a metric that hashes
+ * to s.  A failed s is always replaced by a live alt, otherwise alt
+ * must hold less than half of what s has queued, plus a margin of
+ * 1/64th of the queue of s to ignore the ups and downs of batches.
+ */
+static inline char
+anyof_lighter(server *alt, server *s)
+{
+	if (server_failed(alt))
+		return 0;
+	if (server_failed(s))
+		return 1;
+	return server_get_queue_len(alt) * 2 + server_get_queue_size(s) / 64 <
+		server_get_queue_len(s);
+}
+
 static char
 router_route_intern(
 		char *blackholed,
@@ -2916,12 +3159,17 @@ router_route_intern(
 						firstspace,
 						w->dests->cl->members.routes,
 						dispatcher_id);
-		} else if (router_metric_matches(w, metric, firstspace,
+		} else if (w->prof == NULL ?
+				router_metric_matches(w, metric, firstspace,
+					pmatch, dispatcher_id) :
+				router_metric_matches_prof(w, metric, firstspace,
 					pmatch, dispatcher_id))
 		{
 			stop = w->stop;
 			/* rule matches, send to destination(s) */
 			for (d = w->dests; d != NULL; d = d->next) {
+				if (d->cl->prof != NULL)
+					d->cl->prof[dispatcher_id].matches++;
 #define produce_metric(RET) \
 				len = sizeof(newmetric); \
 				if (server_type(RET.dest) == T_SYSLOGMODE) { \
@@ -2973,7 +3221,10 @@ router_route_intern(
 						server         *s;
 						unsigned int    hash;
 						unsigned int    pos;
+						unsigned int    alt;
+						unsigned int    first;
 						unsigned short  i;
+						unsigned short  cnt = d->cl->members.anyof->count;
 						
 						failif(retsize, *curlen + 1);
 
@@ -2988,20 +3239,32 @@ router_route_intern(
 						/* find first non-failed server from here, but
 						 * be careful not to dump everything onto the
 						 * next neighbour */
-						pos   = hash % d->cl->members.anyof->count;
+						pos   = first = hash % cnt;
+						if (d->cl->balanced && cnt > 1) {
+							/* power of two choices: the hash also
+							 * names a second member, which is only
+							 * used when it is clearly less loaded,
+							 * such that metrics stick to the first
+							 * while the load is even */
+							alt = (pos + 1 + (hash >> 16) % (cnt - 1)) % cnt;
+							if (anyof_lighter(
+										d->cl->members.anyof->servers[alt],
+										d->cl->members.anyof->servers[pos]))
+								pos = alt;
+						}
 						hash += rand();
-						for (i = 0; i < d->cl->members.anyof->count; i++) {
+						for (i = 0; i < cnt; i++) {
 							s = d->cl->members.anyof->servers[pos];
 							if (!server_failed(s)) {
 								ret[*curlen].dest = s;
 								break;
 							}
-							pos = (hash + i + 1) % d->cl->members.anyof->count;
+							pos = (hash + i + 1) % cnt;
 						}
 						if (ret[*curlen].dest == NULL) {
 							/* all failed, take original matching server */
 							ret[*curlen].dest =
-								d->cl->members.anyof->servers[hash];
+								d->cl->members.anyof->servers[first];
 						}
 
 						produce_metric(ret[*curlen]);
@@ -3124,8 +3387,8 @@ router_route_intern(
 						/* test whether data matches, if not, either log
 						 * or drop and stop */
 						char *lastchr = firstspace + strlen(firstspace) - 1;
-						if (router_metric_matches(
-									w->dests->cl->members.validation->rule,
+						if (router_validate_data(
+									w->dests->cl->members.validation,
 									firstspace + 1,
 									lastchr,
 									pmatch,
@@ -3454,12 +3717,15 @@ router_test_intern(char *metric, char *firstspace, route *routes)
 					}	break;
 					case VALIDATION: {
 						char *lastspc = firstspace + strlen(firstspace);
+						char vbuf[64];
 						fprintf(stdout, "    validate\n        %s -> %s\n",
-								d->cl->members.validation->rule->pattern,
+								router_validate_str(
+									d->cl->members.validation,
+									vbuf, sizeof(vbuf)),
 								firstspace + 1);
 						
-						if (router_metric_matches(
-									d->cl->members.validation->rule,
+						if (router_validate_data(
+									d->cl->members.validation,
 									firstspace + 1,
 									lastspc,
 									pmatch,
@@ -3504,3 +3770,443 @@ router_test(router *rtr, char *metric)
 	}
 	fflush(stdout);
 }
+
+typedef struct {
+	router *rtr;
+	int id;
+	const char *start;
+	const char *end;
+	server **srvrs;     /* sorted on address for lookups */
+	size_t srvrcnt;
+	size_t *srvrdests;  /* number of metrics per server in srvrs */
+	size_t metrics;
+	size_t blackholed;
+	size_t skipped;
+} profilejob;
+
+static int
+router_profile_srvrcmp(const void *l, const void *r)
+{
+	const server *ls = *(server * const *)l;
+	const server *rs = *(server * const *)r;
+
+	return ls < rs ? -1 : ls > rs ? 1 : 0;
+}
+
+/**
+ * Routes all metrics in the slice assigned to this job, and counts
+ * where they went.  The metrics are dropped after routing.
+ */
+static void *
+router_profile_worker(void *arg)
+{
+	profilejob *job = (profilejob *)arg;
+	destination dests[CONN_DESTS_SIZE];
+	size_t destlen;
+	char metric[METRIC_BUFSIZ];
+	const char *p;
+	const char *nl;
+	const char *sp;
+	server **srvr;
+	size_t len;
+	size_t i;
+
+	memset(dests, 0, sizeof(dests));
+	for (p = job->start; p < job->end; p = nl + 1) {
+		if ((nl = memchr(p, '\n', job->end - p)) == NULL)
+			nl = job->end;
+		len = nl - p;
+		if (len > 0 && p[len - 1] == '\r')
+			len--;
+		/* we need room for the newline the dispatcher would add */
+		if (len == 0 || len > sizeof(metric) - 2 ||
+				(sp = memchr(p, ' ', len)) == NULL || sp == p)
+		{
+			job->skipped++;
+			continue;
+		}
+		memcpy(metric, p, len);
+		metric[len++] = '\n';
+		metric[len] = '\0';
+
+		job->metrics++;
+		job->blackholed += router_route(job->rtr,
+				dests, &destlen, CONN_DESTS_SIZE,
+				"127.0.0.1", metric, metric + (sp - p), job->id);
+		for (i = 0; i < destlen; i++) {
+			srvr = bsearch(&dests[i].dest, job->srvrs, job->srvrcnt,
+					sizeof(server *), router_profile_srvrcmp);
+			if (srvr != NULL)
+				job->srvrdests[srvr - job->srvrs]++;
+			free((void *)dests[i].metric);
+			dests[i].metric = NULL;
+			dests[i].dest = NULL;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Allocates the per worker counters for the given routes, and the
+ * clusters they point to.
+ */
+static char
+router_profile_alloc(router *rtr, route *routes, char workercnt)
+{
+	route *w;
+	destinations *d;
+
+	for (w = routes; w != NULL; w = w->next) {
+		if (w->prof == NULL &&
+				(w->prof = ra_malloc(rtr->a,
+									 sizeof(routeprof) * workercnt)) == NULL)
+			return 1;
+		for (d = w->dests; d != NULL; d = d->next) {
+			if (d->cl->prof == NULL &&
+					(d->cl->prof = ra_malloc(rtr->a,
+							sizeof(routeprof) * workercnt)) == NULL)
+				return 1;
+			if ((d->cl->type == GROUP ||
+						d->cl->type == AGGRSTUB ||
+						d->cl->type == STATSTUB) &&
+					router_profile_alloc(rtr,
+						d->cl->members.routes, workercnt) != 0)
+				return 1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Sums the per worker counters of p into ret.
+ */
+static void
+router_profile_sum(routeprof *ret, routeprof *p, char workercnt)
+{
+	int i;
+
+	memset(ret, 0, sizeof(*ret));
+	if (p == NULL)
+		return;
+	for (i = 0; i < workercnt; i++) {
+		ret->evals += p[i].evals;
+		ret->matches += p[i].matches;
+		ret->nsec += p[i].nsec;
+	}
+}
+
+static const char *
+router_profile_target(cluster *cl)
+{
+	switch (cl->type) {
+		case AGGREGATION:
+			return "aggregation";
+		case REWRITE:
+			return "rewrite";
+		case VALIDATION:
+			return "validation";
+		case AGGRSTUB:
+		case STATSTUB:
+			return "stub";
+		default:
+			return cl->name;
+	}
+}
+
+/**
+ * Prints the match counts for all rules, and collects the rules that
+ * were evaluated in rules for the slowest rule overview.
+ */
+static void
+router_profile_routes(
+		route *routes,
+		char workercnt,
+		route **rules,
+		size_t *rulecnt)
+{
+	route *w;
+	destinations *d;
+	routeprof sum;
+
+	for (w = routes; w != NULL; w = w->next) {
+		if (w->dests->cl->type == GROUP ||
+				w->dests->cl->type == AGGRSTUB ||
+				w->dests->cl->type == STATSTUB)
+		{
+			/* optimiser groups and stubs are an implementation
+			 * detail, just report the rules inside them */
+			router_profile_routes(w->dests->cl->members.routes,
+					workercnt, rules, rulecnt);
+			continue;
+		}
+		router_profile_sum(&sum, w->prof, workercnt);
+		fprintf(stdout, "    %s%s ->",
+				w->matchtype == MATCHALL ? "*" : w->pattern,
+				w->matchtype == REGEX ? " (regex)" : "");
+		for (d = w->dests; d != NULL; d = d->next)
+			fprintf(stdout, " %s", router_profile_target(d->cl));
+		fprintf(stdout, "\n        %zu matches out of %zu tries (%.1f%%), "
+				"%.1f ns/try\n",
+				sum.matches, sum.evals,
+				sum.evals == 0 ? 0.0 : sum.matches * 100.0 / sum.evals,
+				sum.evals == 0 ? 0.0 : (double)sum.nsec / sum.evals);
+		if (sum.evals > 0)
+			rules[(*rulecnt)++] = w;
+	}
+}
+
+static size_t
+router_profile_countroutes(route *routes)
+{
+	route *w;
+	size_t ret = 0;
+
+	for (w = routes; w != NULL; w = w->next) {
+		if (w->dests->cl->type == GROUP ||
+				w->dests->cl->type == AGGRSTUB ||
+				w->dests->cl->type == STATSTUB)
+			ret += router_profile_countroutes(w->dests->cl->members.routes);
+		ret++;
+	}
+
+	return ret;
+}
+
+static char router_profile_workercnt;
+
+static int
+router_profile_rulecmp(const void *l, const void *r)
+{
+	routeprof ls;
+	routeprof rs;
+	double la;
+	double ra;
+
+	router_profile_sum(&ls, (*(route * const *)l)->prof,
+			router_profile_workercnt);
+	router_profile_sum(&rs, (*(route * const *)r)->prof,
+			router_profile_workercnt);
+	la = (double)ls.nsec / ls.evals;
+	ra = (double)rs.nsec / rs.evals;
+
+	return la > ra ? -1 : la < ra ? 1 : 0;
+}
+
+/**
+ * Routes all metrics from the file at path using workercnt threads,
+ * without sending anything, and reports the throughput, how often each
+ * rule matched, how metrics were distributed over the clusters and
+ * their servers, and which rules are the most expensive to evaluate.
+ * Useful to validate configuration changes and hash balance against
+ * a sample of production traffic.  Returns 0 on success.
+ */
+char
+router_profile(router *rtr, const char *path, char workercnt)
+{
+	int fd;
+	struct stat st;
+	char *data;
+	const char *p;
+	server **srvrs;
+	size_t srvrcnt;
+	profilejob *jobs;
+	pthread_t *tids;
+	struct timespec start;
+	struct timespec stop;
+	double secs;
+	size_t metrics = 0;
+	size_t blackholed = 0;
+	size_t skipped = 0;
+	route **rules;
+	size_t rulecnt;
+	cluster *c;
+	servers *s;
+	routeprof sum;
+	size_t i;
+	int id;
+
+	if ((fd = open(path, O_RDONLY)) < 0) {
+		logerr("failed to open '%s': %s\n", path, strerror(errno));
+		return 1;
+	}
+	if (fstat(fd, &st) != 0) {
+		logerr("failed to stat '%s': %s\n", path, strerror(errno));
+		close(fd);
+		return 1;
+	}
+	if (st.st_size == 0) {
+		data = NULL;
+	} else if ((data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+					fd, 0)) == MAP_FAILED)
+	{
+		logerr("failed to mmap '%s': %s\n", path, strerror(errno));
+		close(fd);
+		return 1;
+	}
+	close(fd);
+	if (data != NULL)
+		(void)madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+	if (router_profile_alloc(rtr, rtr->routes, workercnt) != 0 ||
+			(srvrs = router_getservers(rtr)) == NULL)
+	{
+		logerr("out of memory allocating profile counters\n");
+		if (data != NULL)
+			munmap(data, st.st_size);
+		return 1;
+	}
+	for (srvrcnt = 0; srvrs[srvrcnt] != NULL; srvrcnt++)
+		;
+	qsort(srvrs, srvrcnt, sizeof(server *), router_profile_srvrcmp);
+
+	jobs = malloc(sizeof(profilejob) * workercnt);
+	tids = malloc(sizeof(pthread_t) * workercnt);
+	if (jobs == NULL || tids == NULL) {
+		logerr("out of memory allocating profile workers\n");
+		free(jobs);
+		free(tids);
+		free(srvrs);
+		if (data != NULL)
+			munmap(data, st.st_size);
+		return 1;
+	}
+
+	/* give each worker an equal part of the file, rounded up to the
+	 * next newline */
+	p = data;
+	for (id = 0; id < workercnt; id++) {
+		profilejob *job = &jobs[id];
+
+		job->rtr = rtr;
+		job->id = id;
+		job->start = p;
+		if (id == workercnt - 1) {
+			p = data + st.st_size;
+		} else {
+			p = data + (st.st_size / workercnt) * (id + 1);
+			if (p < job->start)
+				p = job->start;
+			while (p < data + st.st_size && *p++ != '\n')
+				;
+		}
+		job->end = p;
+		job->srvrs = srvrs;
+		job->srvrcnt = srvrcnt;
+		job->srvrdests = calloc(srvrcnt + 1, sizeof(size_t));
+		job->metrics = 0;
+		job->blackholed = 0;
+		job->skipped = 0;
+		if (job->srvrdests == NULL) {
+			logerr("out of memory allocating profile workers\n");
+			exit(1);
+		}
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (id = 0; id < workercnt; id++) {
+		if (pthread_create(&tids[id], NULL,
+					router_profile_worker, &jobs[id]) != 0)
+		{
+			logerr("failed to start profile worker %d\n", id + 1);
+			exit(1);
+		}
+	}
+	for (id = 0; id < workercnt; id++) {
+		pthread_join(tids[id], NULL);
+		metrics += jobs[id].metrics;
+		blackholed += jobs[id].blackholed;
+		skipped += jobs[id].skipped;
+		if (id > 0)
+			for (i = 0; i < srvrcnt; i++)
+				jobs[0].srvrdests[i] += jobs[id].srvrdests[i];
+	}
+	clock_gettime(CLOCK_MONOTONIC, &stop);
+	secs = (stop.tv_sec - start.tv_sec) +
+		(stop.tv_nsec - start.tv_nsec) / (1000.0 * 1000.0 * 1000.0);
+
+	fprintf(stdout, "routed %zu metrics from %s in %.3fs using %d "
+			"workers: %.0f metrics/s\n",
+			metrics, path, secs, workercnt,
+			secs > 0.0 ? metrics / secs : 0.0);
+	fprintf(stdout, "    %zu metrics blackholed, %zu invalid lines skipped\n",
+			blackholed, skipped);
+
+	fprintf(stdout, "\nrule matches:\n");
+	rulecnt = 0;
+	rules = malloc(sizeof(route *) *
+			(router_profile_countroutes(rtr->routes) + 1));
+	if (rules == NULL) {
+		logerr("out of memory allocating profile report\n");
+		exit(1);
+	}
+	router_profile_routes(rtr->routes, workercnt, rules, &rulecnt);
+
+	fprintf(stdout, "\ndestinations:\n");
+	for (c = rtr->clusters; c != NULL; c = c->next) {
+		switch (c->type) {
+			case FORWARD:
+			case FILELOG:
+			case FILELOGIP:
+				s = c->members.forward;
+				break;
+			case ANYOF:
+			case FAILOVER:
+				s = c->members.anyof->list;
+				break;
+			case CARBON_CH:
+			case FNV1A_CH:
+			case JUMP_CH:
+				s = c->members.ch->servers;
+				break;
+			default:
+				s = NULL;
+				break;
+		}
+		if (s == NULL)
+			continue;
+		router_profile_sum(&sum, c->prof, workercnt);
+		fprintf(stdout, "    cluster %s: %zu metrics\n",
+				c->name, sum.matches);
+		for ( ; s != NULL; s = s->next) {
+			server **srvr = bsearch(&s->server, srvrs, srvrcnt,
+					sizeof(server *), router_profile_srvrcmp);
+			size_t cnt = srvr == NULL ? 0 : jobs[0].srvrdests[srvr - srvrs];
+
+			if (server_ctype(s->server) == CON_FILE) {
+				fprintf(stdout, "        %s", server_ip(s->server));
+			} else {
+				fprintf(stdout, "        %s:%u",
+						server_ip(s->server), server_port(s->server));
+			}
+			if (server_instance(s->server) != NULL)
+				fprintf(stdout, "=%s", server_instance(s->server));
+			fprintf(stdout, ": %zu (%.1f%%)\n", cnt,
+					sum.matches == 0 ? 0.0 : cnt * 100.0 / sum.matches);
+		}
+	}
+
+	fprintf(stdout, "\nslowest rules:\n");
+	router_profile_workercnt = workercnt;
+	qsort(rules, rulecnt, sizeof(route *), router_profile_rulecmp);
+	for (i = 0; i < rulecnt && i < 10; i++) {
+		router_profile_sum(&sum, rules[i]->prof, workercnt);
+		fprintf(stdout, "    %10.1f ns/try  %s%s\n",
+				(double)sum.nsec / sum.evals,
+				rules[i]->matchtype == MATCHALL ? "*" : rules[i]->pattern,
+				rules[i]->matchtype == REGEX ? " (regex)" : "");
+	}
+	fflush(stdout);
+
+	for (id = 0; id < workercnt; id++)
+		free(jobs[id].srvrdests);
+	free(jobs);
+	free(tids);
+	free(rules);
+	free(srvrs);
+	if (data != NULL)
+		munmap(data, st.st_size);
+
+	return 0;
+}
@@ -111,6 +111,7 @@ size_t router_rewrite_metric(char (*newmetric)[METRIC_BUFSIZ], char **newfirstsp
 void router_printconfig(router *r, FILE *f, char mode);
 char router_route(router *r, destination ret[], size_t *retcnt, size_t retsize, char *srcaddr, char *metric, char *firstspace, int dispatcher_id);
 void router_test(router *r, char *metric_path);
+char router_profile(router *r, const char *path, char workercnt);
 listener *router_get_listeners(router *r);
 server **router_getservers(router *r);
 aggregator *router_getaggregators(router *r);
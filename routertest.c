@@ -0,0 +1,249 @@
+/*
+ * Copyright 2013-2025 Fabian Groffen
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Tests for the routing of balanced any_of clusters.  While the members
+ * are evenly loaded, metrics must stick to the member their hash names,
+ * and move to the alternate member when the queue of the first runs
+ * deep, or when it failed.  The relay test suite cannot get at
+ * queue depths, hence this drives the router directly. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "relay.h"
+#include "router.h"
+#include "server.h"
+
+#define METRICS  64
+
+char relay_hostname[256] = "routertest";
+unsigned char mode = 0;
+char noexpire = 0;
+#ifdef HAVE_SSL
+char *sslCA = NULL;
+char sslCAisdir = 0;
+char sslktls = 0;
+#endif
+
+static char conf[] = "/tmp/routertest.XXXXXX";
+static char verbose = 0;
+
+/* connecting to the members fails, which is expected here */
+int
+relaylog(enum logdst dest, const char *fmt, ...)
+{
+	va_list ap;
+	int ret = 0;
+
+	(void)dest;
+	if (verbose) {
+		va_start(ap, fmt);
+		ret = vfprintf(stderr, fmt, ap);
+		va_end(ap);
+	}
+	return ret;
+}
+
+#define fail(args...) { \
+	fprintf(stderr, "%s: ", __func__); \
+	fprintf(stderr, args); \
+	fprintf(stderr, "\n"); \
+	return 1; \
+}
+
+/**
+ * Routes metric i, and returns the member it was sent to.  When queue
+ * is set, the metric is queued at that member, else it is released.
+ */
+static server *
+test_route(router *rtr, size_t i, char queue)
+{
+	destination dests[CONN_DESTS_SIZE];
+	char metric[64];
+	char *firstspace;
+	size_t cnt = 0;
+
+	snprintf(metric, sizeof(metric), "balanced.foo.bar.%zu 1 349830001\n", i);
+	firstspace = strchr(metric, ' ');
+	router_route(rtr, dests, &cnt, CONN_DESTS_SIZE, "127.0.0.1",
+			metric, firstspace, 0);
+	if (cnt != 1)
+		return NULL;
+	if (!queue || !server_send(dests[0].dest, dests[0].metric, 1))
+		free((char *)dests[0].metric);
+	return dests[0].dest;
+}
+
+/**
+ * Routes all metrics without any load, which must send each of them to
+ * the same member every time.  Both members must get some.
+ */
+static int
+test_even(router *rtr, server *members[2])
+{
+	server *first[METRICS];
+	size_t cnt[2] = { 0, 0 };
+	size_t i;
+
+	for (i = 0; i < METRICS; i++) {
+		first[i] = test_route(rtr, i, 0);
+		if (first[i] != members[0] && first[i] != members[1])
+			fail("metric %zu not routed to a member", i);
+		cnt[first[i] == members[1]]++;
+		/* no load, so the same place every time */
+		if (test_route(rtr, i, 0) != first[i])
+			fail("metric %zu moved without load", i);
+	}
+	if (cnt[0] == 0 || cnt[1] == 0)
+		fail("%zu and %zu metrics per member", cnt[0], cnt[1]);
+	return 0;
+}
+
+/**
+ * Gives the first member a backlog, as if it were slow.  All metrics
+ * must go to the second member then, including those the hash sends
+ * to the first.
+ */
+static int
+test_deep(router *rtr, server *members[2])
+{
+	char *m;
+	size_t len;
+	size_t i;
+
+	for (i = 0; i < 2 * METRICS; i++) {
+		len = strlen("balanced.backlog 1 349830001\n");
+		if ((m = malloc(sizeof(len) + len)) == NULL)
+			fail("out of memory");
+		*(size_t *)m = len;
+		memcpy(m + sizeof(len), "balanced.backlog 1 349830001\n", len);
+		if (!server_send(members[0], m, 1))
+			fail("cannot queue at %s:%u",
+					server_ip(members[0]), server_port(members[0]));
+	}
+	for (i = 0; i < METRICS; i++)
+		if (test_route(rtr, i, 0) != members[1])
+			fail("metric %zu not moved away from the backlog", i);
+	return 0;
+}
+
+/**
+ * Lets the second member fail, after which all metrics must go to the
+ * first, despite its backlog.
+ */
+static int
+test_failed(router *rtr, server *members[2])
+{
+	size_t i;
+
+	/* the member only connects when it has something to send */
+	for (i = 0; i < 8; i++)
+		if (test_route(rtr, i, 1) != members[1])
+			fail("metric %zu not moved away from the backlog", i);
+	if (server_start(members[1]) != 0)
+		fail("cannot start %s:%u",
+				server_ip(members[1]), server_port(members[1]));
+	for (i = 0; i < 100 && !server_failed(members[1]); i++)
+		usleep(100 * 1000);
+	if (!server_failed(members[1]))
+		fail("%s:%u did not fail",
+				server_ip(members[1]), server_port(members[1]));
+	for (i = 0; i < METRICS; i++)
+		if (test_route(rtr, i, 0) != members[0])
+			fail("metric %zu routed to the failed member", i);
+	return 0;
+}
+
+static void
+do_usage(char *name, int exitcode)
+{
+	printf("Usage: %s [-v]\n", name);
+	printf("\n");
+	printf("Options:\n");
+	printf("  -v  print what the router logs\n");
+
+	exit(exitcode);
+}
+
+int
+main(int argc, char *argv[])
+{
+	router *rtr;
+	server **srvrs;
+	server *members[2];
+	FILE *f;
+	int fd;
+	int failed = 0;
+	int ch;
+
+	while ((ch = getopt(argc, argv, ":hv")) != -1) {
+		switch (ch) {
+			case 'v':
+				verbose = 1;
+				break;
+			case 'h':
+				do_usage(argv[0], 0);
+				break;
+			default:
+				do_usage(argv[0], 1);
+				break;
+		}
+	}
+
+	/* nothing listens on these ports */
+	if ((fd = mkstemp(conf)) < 0 || (f = fdopen(fd, "w")) == NULL) {
+		fprintf(stderr, "failed to create %s\n", conf);
+		return 1;
+	}
+	fprintf(f, "cluster balance\n"
+			"    any_of balanced\n"
+			"        127.0.0.1:1\n"
+			"        127.0.0.1:2\n"
+			"    ;\n"
+			"match * send to balance stop;\n");
+	fclose(f);
+
+	rtr = router_readconfig(NULL, conf, 1, 1024, 64, 4, 600, 0, 2003);
+	unlink(conf);
+	if (rtr == NULL) {
+		fprintf(stderr, "failed to read configuration\n");
+		return 1;
+	}
+	if ((srvrs = router_getservers(rtr)) == NULL ||
+			srvrs[0] == NULL || srvrs[1] == NULL || srvrs[2] != NULL)
+	{
+		fprintf(stderr, "expected two servers\n");
+		return 1;
+	}
+	members[0] = server_port(srvrs[0]) == 1 ? srvrs[0] : srvrs[1];
+	members[1] = server_port(srvrs[0]) == 1 ? srvrs[1] : srvrs[0];
+	free(srvrs);
+
+	/* each step relies on the state the previous one left behind */
+	if ((failed = test_even(rtr, members)) == 0 &&
+			(failed = test_deep(rtr, members)) == 0)
+		failed = test_failed(rtr, members);
+
+	router_shutdown(rtr);
+	router_free(rtr);
+
+	printf("balanced: %s\n", failed == 0 ? "all tests passing" : "failing");
+
+	return failed == 0 ? 0 : 1;
+}
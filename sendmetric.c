@@ -45,6 +45,10 @@
 #include <snappy-c.h>
 #endif
 
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
 #ifdef HAVE_SSL
 #include <openssl/ssl.h>
 #include <openssl/err.h>
@@ -114,6 +118,12 @@ typedef struct _z_strm {
 			size_t cbuflen;
 			int error;
 		} sn;
+#endif
+#ifdef HAVE_ZSTD
+		struct {
+			ZSTD_CCtx *cctx;
+			size_t error;
+		} zs;
 #endif
 	} hdl;
 	char *obuf;
@@ -671,6 +681,122 @@ z_strm *snappynew(size_t bufsize) {
 }
 #endif
 
+#ifdef HAVE_ZSTD
+/* zstd wrapped socket */
+static inline int zstdflush(z_strm *strm);
+
+static inline ssize_t
+zstdwrite(z_strm *strm, const void *buf, size_t sze)
+{
+	/* ensure we have space available */
+	if (strm->obuflen + sze > strm->obufsize)
+		if (zstdflush(strm) != 0)
+			return -1;
+
+	/* append metric to buf */
+	memcpy(strm->obuf + strm->obuflen, buf, sze);
+	strm->obuflen += sze;
+
+	return sze;
+}
+
+static inline int
+zstdflush(z_strm *strm)
+{
+	char cbuf[8192];
+	ZSTD_inBuffer in = { strm->obuf, strm->obuflen, 0 };
+	ZSTD_outBuffer out;
+	char *cbufp;
+	int oret;
+
+	if (strm->obuflen == 0)
+		return 0;
+
+	do {
+		out.dst = cbuf;
+		out.size = sizeof(cbuf);
+		out.pos = 0;
+		strm->hdl.zs.error = ZSTD_compressStream2(strm->hdl.zs.cctx,
+				&out, &in, ZSTD_e_flush);
+		if (ZSTD_isError(strm->hdl.zs.error))
+			return -1;
+		for (cbufp = cbuf; out.pos > 0; ) {
+			oret = strm->nextstrm->strmwrite(strm->nextstrm,
+					cbufp, out.pos);
+			if (oret < 0)
+				return -1;  /* failure is failure */
+
+			/* update counters to possibly retry the remaining bit */
+			cbufp += oret;
+			out.pos -= oret;
+		}
+	} while (strm->hdl.zs.error != 0);
+
+	if (debug)
+		fprintf(stderr, "zstdflush: %lu bytes\n", strm->obuflen);
+	strm->obuflen = 0;
+	if (strm->mode == F_NOAUTO)
+		return 0;
+
+	/* flush whatever we wrote */
+	if (strm->nextstrm->strmflush(strm->nextstrm) == -1)
+		return -1;
+
+	return 0;
+}
+
+static inline int
+zstdclose(z_strm *strm)
+{
+	int ret = strm->nextstrm->strmclose(strm->nextstrm);
+	ZSTD_freeCCtx(strm->hdl.zs.cctx);
+	free(strm->obuf);
+	return ret;
+}
+
+static inline const char *
+zstderror(z_strm *strm, int rval)
+{
+	if (ZSTD_isError(strm->hdl.zs.error)) {
+		return ZSTD_getErrorName(strm->hdl.zs.error);
+	} else {
+		return strm->nextstrm->strmerror(strm->nextstrm, rval);
+	}
+}
+
+z_strm *zstdnew(size_t bufsize) {
+	z_strm *strm = malloc(sizeof(z_strm));
+	if (strm == NULL) {
+		return NULL;
+	}
+	strm->obuf = malloc(bufsize);
+	if (strm->obuf == NULL) {
+		free(strm);
+		return NULL;
+	}
+	if ((strm->hdl.zs.cctx = ZSTD_createCCtx()) == NULL) {
+		free(strm->obuf);
+		free(strm);
+		return NULL;
+	}
+#ifdef HAVE_SSL
+	strm->ctx = NULL;
+#endif
+
+	strm->obuflen = 0;
+	strm->obufsize = bufsize;
+
+	strm->hdl.zs.error = 0;
+
+	strm->strmwrite = zstdwrite;
+	strm->strmflush = zstdflush;
+	strm->strmclose = zstdclose;
+	strm->strmerror = zstderror;
+
+	return strm;
+}
+#endif
+
 #ifdef HAVE_SSL
 /* (Open|Libre)SSL wrapped socket */
 static inline int
@@ -906,6 +1032,7 @@ int sslsetup(z_strm *strm, size_t bufsize, int sock, const char *hostname)
 #define C_GZIP   1
 #define C_LZ4	 2
 #define C_SNAPPY 3
+#define C_ZSTD   4
 
 #define F_NONE   0
 #define F_IMMEDIATE 1
@@ -940,6 +1067,9 @@ void do_usage(char *name, int exitcode)
 #endif
 #ifdef HAVE_SNAPPY
         printf(" snappy\n");
+#endif
+#ifdef HAVE_ZSTD
+        printf(" zstd\n");
 #endif
         printf("\n");
 #endif
@@ -1005,6 +1135,11 @@ void get_options(int argc, char *argv[], struct conf *c) {
 				if (strcmp(optarg, "snappy") == 0)
 					c->compress = C_SNAPPY;
 				else
+#endif
+#ifdef HAVE_ZSTD
+				if (strcmp(optarg, "zstd") == 0)
+					c->compress = C_ZSTD;
+				else
 #endif
 					do_usage(argv[0], 1);
 				break;
@@ -1224,6 +1359,18 @@ int main(int argc, char *argv[]) {
 		zstrm->nextstrm = strm;
 		strm = zstrm;
 	}
+#endif
+#ifdef HAVE_ZSTD
+	if (c.compress == C_ZSTD) {
+		z_strm *zstrm = zstdnew(c.bsize);
+		if (zstrm == NULL) {
+			close(fd);
+			fprintf(stderr, "zstd stream alloc error. %s\n", strerror(errno));
+			GO_EXIT(-1);
+		}
+		zstrm->nextstrm = strm;
+		strm = zstrm;
+	}
 #endif
 	if (strm->nextstrm != NULL && c.flush_mode == F_NOAUTO)
 		strm->mode = F_NOAUTO;
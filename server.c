@@ -15,17 +15,23 @@
  */
 
 
+/* sendmmsg() is a GNU extension with glibc */
+#define _GNU_SOURCE 1
+
 #include <stdio.h>
 #include <unistd.h>
 #include <string.h>
+#include <limits.h>
 #include <fcntl.h>
 #include <pthread.h>
 #include <poll.h>
 #include <errno.h>
+#include <time.h>
 #include <sys/time.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <netdb.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
@@ -38,6 +44,10 @@
 #include "dispatcher.h"
 #include "collector.h"
 #include "server.h"
+#include "spool.h"
+#include "pickle.h"
+#include "consistent-hash.h"
+#include "fnv1a.h"
 
 #ifdef HAVE_GZIP
 #include <zlib.h>
@@ -49,6 +59,9 @@
 #ifdef HAVE_SNAPPY
 #include <snappy-c.h>
 #endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
 #ifdef HAVE_SSL
 #include <openssl/ssl.h>
 #include <openssl/err.h>
@@ -56,20 +69,50 @@
 
 #define FAIL_WAIT_TIME          6  /* 6 * 250ms = 1.5s */
 #define DISCONNECT_WAIT_TIME   12  /* 12 * 250ms = 3s */
+#define BREAKER_FAILS           5  /* failed connects that open the breaker */
+#define BACKOFF_MIN_MS        500  /* first delay after the breaker opened */
+#define BACKOFF_MAX_MS      30000
 #define LEN_CRITICAL(Q)        (queue_free(Q) < self->bsize)
 
+#ifndef IOV_MAX
+# define IOV_MAX             1024
+#endif
+#define IOV_BATCH              (IOV_MAX < 1024 ? IOV_MAX : 1024)
+#define LAT_BUCKETS           128  /* up to 2^32us, 4 buckets per octave */
+#define LANE_CHUNK            256  /* metrics hashed onto lanes at once */
+#define LANE_ADAPT_TIME      1000  /* ms between connection count updates */
+#define PICKLE_BUFSIZ  (PICKLE_MAX_FRAME / 4)
+#define UDP_MMSG_BATCH         64  /* datagrams per sendmmsg() */
+#define FILE_BUFALIGN        4096  /* alignment of file write buffers */
+
+#if defined(_POSIX_SYNCHRONIZED_IO) && _POSIX_SYNCHRONIZED_IO > 0
+#define file_sync(FD)  fdatasync(FD)
+#else
+#define file_sync(FD)  fsync(FD)
+#endif
+
 typedef struct _z_strm {
 	ssize_t (*strmwrite)(struct _z_strm *, const void *, size_t);
+	ssize_t (*strmwritev)(struct _z_strm *, const struct iovec *, int);
 	int (*strmflush)(struct _z_strm *);
 	int (*strmclose)(struct _z_strm *);
 	const char *(*strmerror)(struct _z_strm *, int);     /* get last err str */
 	struct _z_strm *nextstrm;                            /* set when chained */
-#if defined(HAVE_LZ4) || defined(HAVE_SNAPPY) || defined(HAVE_GZIP)
+	struct _filebuf *fbuf;                               /* CON_FILE only */
+#if defined(HAVE_LZ4) || defined(HAVE_SNAPPY) || defined(HAVE_GZIP) || defined(HAVE_ZSTD)
 	char obuf[METRIC_BUFSIZ];
 	int obuflen;
 #endif
+#if defined(HAVE_GZIP) || defined(HAVE_LZ4)
+	struct _zjob **jobs;      /* buffers handed to the compressors */
+	int jobhead;
+	int jobcnt;
+	struct _zjob *jobprev;    /* last job submitted, NULL at stream start */
+#endif
 #ifdef HAVE_SSL
 	SSL_CTX *ctx;
+	SSL_SESSION *sess;  /* last session, to resume on reconnect */
+	char sslfailed;     /* a write failed, don't shut down cleanly */
 #endif
 	union {
 #ifdef HAVE_GZIP
@@ -81,6 +124,9 @@ typedef struct _z_strm {
 			size_t cbuflen;
 		} z;
 #endif
+#ifdef HAVE_ZSTD
+		ZSTD_CCtx *zstd;
+#endif
 #ifdef HAVE_SSL
 		SSL *ssl;
 #endif
@@ -88,6 +134,26 @@ typedef struct _z_strm {
 	} hdl;
 } z_strm;
 
+#if defined(HAVE_GZIP) || defined(HAVE_LZ4)
+#define GZIP_WINDOW         32768  /* deflate history carried between jobs */
+
+typedef struct _zjob {
+	con_trnsp transport;
+	char ibuf[METRIC_BUFSIZ];
+	size_t ilen;
+#ifdef HAVE_GZIP
+	char dict[GZIP_WINDOW];   /* tail of the previous buffer */
+	size_t dictlen;
+#endif
+	char *cbuf;
+	size_t cbufsize;
+	size_t clen;              /* set to the header length, if any */
+	char failed;
+	char done;          /* full byte for atomic access */
+	struct _zjob *next;
+} zjob;
+#endif
+
 struct _server {
 	const char *ip;
 	unsigned short port;
@@ -102,6 +168,8 @@ struct _server {
 	unsigned int sockbufsize;
 	unsigned char maxstalls:SERVER_STALL_BITS;
 	const char **batch;
+	size_t *stamps;     /* enqueue times of the metrics in batch */
+	char *pickle;       /* frame buffer for T_PICKLE */
 	con_type type;
 	con_trnsp transport;
 	char *mtlspemcert;
@@ -112,6 +180,8 @@ struct _server {
 	size_t secondariescnt;
 	unsigned char reresolve:1;
 	unsigned char failover:1;
+	unsigned char steal:1;    /* take over work from busy secondaries */
+	unsigned char nostall:1;  /* drop what doesn't fit, never stall */
 	char failure;       /* full byte for atomic access */
 	char running;       /* full byte for atomic access */
 	char keep_running;  /* full byte for atomic access */
@@ -125,8 +195,98 @@ struct _server {
 	size_t prevdropped;
 	size_t prevstalls;
 	size_t prevticks;
+	size_t stallsince;        /* start of the current stall, or 0 */
+	size_t stallticks;        /* time clients were held up by us */
+	size_t prevstallticks;
+	spool *spool;
+	size_t spilled;
+	size_t replayed;
+	size_t prevspilled;
+	size_t prevreplayed;
+	size_t datagrams;
+	size_t senderrors;
+	size_t prevdatagrams;
+	size_t prevsenderrors;
+	size_t sslfull;           /* full TLS handshakes */
+	size_t sslresumed;        /* abbreviated (resumed) TLS handshakes */
+	size_t prevsslfull;
+	size_t prevsslresumed;
+	size_t ktls;              /* connections encrypted by the kernel */
+	size_t prevktls;
+	size_t stolen;            /* metrics taken over from secondaries */
+	size_t prevstolen;
+	char breaker;             /* circuit breaker state, see BREAKER_* */
+	size_t connfails;         /* consecutive failed connects */
+	size_t backoffms;         /* delay between connects while open */
+	size_t breakeropens;      /* times the breaker opened */
+	size_t prevbreakeropens;
+	size_t breakerprobes;     /* connects tried while half-open */
+	size_t prevbreakerprobes;
+	size_t ratemetrics;       /* metrics per second, 0 for unlimited */
+	size_t ratebytes;         /* bytes per second, 0 for unlimited */
+	size_t rateburst;         /* size of the metrics bucket */
+	size_t catchuprate;       /* ratemetrics while the queue is long */
+	size_t catchupabove;
+	double tokens;            /* metrics that may be sent now */
+	double btokens;           /* bytes that may be sent now */
+	size_t ratems;            /* last refill of the buckets */
+	size_t expireus;          /* max time queued, 0 for ever */
+	size_t expired;           /* metrics dropped for being too old */
+	size_t prevexpired;
+	struct _server_pool *pool;
+	const char **pending;     /* unsent part of batch, pool only */
+	size_t pendoff;           /* bytes of *pending already sent */
+	struct addrinfo *cwalk;   /* address being connected to */
+	char connecting;
+	char resolving;           /* 1 while being resolved, 2 once done */
+	char blocked;             /* waiting for the socket to drain */
+	char woken;               /* full byte for atomic access */
+	size_t retryms;           /* when to reconnect after failure */
+	size_t lastms;            /* last connect or write */
+	size_t nextms;            /* when to step again unless woken */
+	struct _server *resolvenext;
+	pthread_mutex_t wakelock;
+	pthread_cond_t wakecond;
+	char sleeping;      /* full byte for atomic access */
+	size_t lathist[LAT_BUCKETS];      /* enqueue to write latencies */
+	size_t prevlathist[LAT_BUCKETS];
+	struct _server *parent;   /* set for extra connections (lanes) */
+	struct _server **lanes;   /* extra connections to this destination */
+	int lanecnt;
+	int conns;                /* connections in use, incl. this one */
+	size_t ctlnext;           /* when to update conns next */
+	size_t ctlqueued;
+	size_t ctlticks;
+	size_t ctlmetrics;
+	size_t ctlcost;           /* lowest ns per written metric seen */
+	unsigned char ctlidle;
+	size_t holduntil;         /* when to give up waiting for holdmarks */
+	size_t holdmark;          /* progress to reach before lanes resume */
+	size_t batchmark;         /* progress once the current batch is out */
+	char held;          /* full byte for atomic access */
 };
 
+static char *spooldir = NULL;
+static size_t spoolsize = 0;
+static size_t membudget = 0;
+static char membudget_stall = 0;
+static unsigned int maxflush = 0;
+static int maxconns = 1;
+static size_t udpsize = SERVER_UDP_SIZE;
+static char sslkeepalive = 0;
+#ifdef HAVE_ZSTD
+static int zstdlevel = ZSTD_CLEVEL_DEFAULT;
+static ZSTD_CDict *zstddict = NULL;
+#endif
+#if defined(HAVE_GZIP) || defined(HAVE_LZ4)
+static int compressors = 0;
+static pthread_mutex_t zpoollock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t zpoolcond = PTHREAD_COND_INITIALIZER;  /* new jobs */
+static pthread_cond_t zdonecond = PTHREAD_COND_INITIALIZER;  /* jobs done */
+static zjob *zpoolhead = NULL;
+static zjob *zpooltail = NULL;
+#endif
+
 
 /* connection specific writers and closers */
 
@@ -137,6 +297,12 @@ sockwrite(z_strm *strm, const void *buf, size_t sze)
 	return write(strm->hdl.sock, buf, sze);
 }
 
+static inline ssize_t
+sockwritev(z_strm *strm, const struct iovec *iov, int iovcnt)
+{
+	return writev(strm->hdl.sock, iov, iovcnt);
+}
+
 static inline int
 sockflush(z_strm *strm)
 {
@@ -159,6 +325,630 @@ sockerror(z_strm *strm, int rval)
 	return strerror(errno);
 }
 
+/* buffered file, metrics are collected in large page aligned buffers
+ * which are written in one go, optionally by a writer thread such that
+ * the next buffer can be filled while the previous one is written */
+typedef struct _filebuf {
+	const char *path;
+	size_t size;              /* of each buffer, 0 to write unbuffered */
+	char dbl;                 /* let a writer thread write full buffers */
+	int sync;                 /* secs between syncs, -1 always, 0 never */
+	int rotatesecs;           /* start a new file every so many seconds */
+	size_t rotatebytes;       /* start a new file when this big */
+	char *buf[2];
+	int cur;                  /* buffer being filled */
+	size_t len;               /* bytes in buf[cur] */
+	size_t written;           /* size of the current file */
+	time_t opened;            /* when the current file was opened */
+	time_t lastsync;
+	char dirty;               /* written since the last sync */
+	char failing;             /* no write succeeded since one failed */
+	int fd;
+	pthread_t tid;            /* writer thread, when started */
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	char *wbuf;               /* buffer handed to the writer, or NULL */
+	size_t wlen;
+	int werr;                 /* errno of a failed write, wbuf is kept */
+	char stop;
+} filebuf;
+
+/**
+ * Syncs the file of fb to disk when the policy says so.  With force,
+ * any unsynced data is synced if a policy is set at all.
+ */
+static void
+filebuf_sync(filebuf *fb, char force)
+{
+	time_t now;
+
+	if (!fb->dirty || fb->sync == 0)
+		return;
+	now = time(NULL);
+	if (!force && fb->sync > 0 && now < fb->lastsync + fb->sync)
+		return;
+	if (file_sync(fb->fd) != 0)
+		logerr("failed to sync file '%s': %s\n", fb->path, strerror(errno));
+	fb->lastsync = now;
+	fb->dirty = 0;
+}
+
+/**
+ * Writes the *len bytes in buf to the file of fb.  Returns 0 when all
+ * was written, -1 otherwise, with errno set.  On failure, what wasn't
+ * written is moved to the start of buf, and *len set to its size, such
+ * that it can be written again once the file is reopened.  Only the
+ * first of a series of failures is logged.
+ */
+static int
+filebuf_out(filebuf *fb, char *buf, size_t *len)
+{
+	ssize_t slen;
+	size_t done = 0;
+	int err;
+
+	while (done < *len) {
+		if ((slen = write(fb->fd, buf + done, *len - done)) < 0) {
+			if (errno == EINTR)
+				continue;
+			err = errno;
+			if (done > 0) {
+				memmove(buf, buf + done, *len - done);
+				*len -= done;
+			}
+			if (!fb->failing)
+				logerr("failed to write %zu bytes to file '%s': %s\n",
+						*len, fb->path, strerror(err));
+			fb->failing = 1;
+			errno = err;
+			return -1;
+		}
+		done += slen;
+		fb->dirty = 1;
+	}
+	fb->failing = 0;
+	filebuf_sync(fb, 0);
+	return 0;
+}
+
+/**
+ * Writer thread, writes the buffers handed to it and, when syncing
+ * every so many seconds, syncs the file once the time has come.  A
+ * buffer that failed to write is kept, and written again by the
+ * writer started after the file is reopened.
+ */
+static void *
+filebuf_writer(void *d)
+{
+	filebuf *fb = (filebuf *)d;
+	struct timespec ts;
+	int err;
+
+	pthread_mutex_lock(&fb->lock);
+	while (1) {
+		if (fb->wbuf != NULL && fb->werr == 0) {
+			pthread_mutex_unlock(&fb->lock);
+			err = filebuf_out(fb, fb->wbuf, &fb->wlen) == 0 ? 0 : errno;
+			pthread_mutex_lock(&fb->lock);
+			fb->werr = err;
+			if (err == 0)
+				fb->wbuf = NULL;
+			pthread_cond_broadcast(&fb->cond);
+			continue;
+		}
+		if (fb->stop)
+			break;
+		if (fb->dirty && fb->sync > 0) {
+			ts.tv_sec = fb->lastsync + fb->sync;
+			ts.tv_nsec = 0;
+			if (pthread_cond_timedwait(&fb->cond, &fb->lock, &ts) == ETIMEDOUT)
+			{
+				pthread_mutex_unlock(&fb->lock);
+				filebuf_sync(fb, 0);
+				pthread_mutex_lock(&fb->lock);
+			}
+		} else {
+			pthread_cond_wait(&fb->cond, &fb->lock);
+		}
+	}
+	pthread_mutex_unlock(&fb->lock);
+
+	return NULL;
+}
+
+/**
+ * Writes out the buffer being filled, or hands it to the writer thread
+ * after it finished the previous one.  Returns 0 on success, -1 when
+ * this or the previous write failed.  The data of a failed write stays
+ * in its buffer, and no new data is taken until the file is reopened.
+ */
+static int
+filebuf_push(filebuf *fb)
+{
+	int err = 0;
+
+	if (fb->tid == 0) {
+		if (fb->len > 0 &&
+				filebuf_out(fb, fb->buf[fb->cur], &fb->len) != 0)
+			err = errno;
+		else
+			fb->len = 0;
+	} else {
+		pthread_mutex_lock(&fb->lock);
+		while (fb->wbuf != NULL && fb->werr == 0)
+			pthread_cond_wait(&fb->cond, &fb->lock);
+		err = fb->werr;
+		if (err == 0 && fb->len > 0) {
+			fb->wbuf = fb->buf[fb->cur];
+			fb->wlen = fb->len;
+			fb->cur ^= 1;
+			fb->len = 0;
+			pthread_cond_broadcast(&fb->cond);
+		}
+		pthread_mutex_unlock(&fb->lock);
+	}
+
+	if (err != 0) {
+		errno = err;
+		return -1;
+	}
+	return 0;
+}
+
+static ssize_t
+filewritev(z_strm *strm, const struct iovec *iov, int iovcnt)
+{
+	filebuf *fb = strm->fbuf;
+	ssize_t ret = 0;
+	int i;
+
+	if (fb->size == 0) {
+		if ((ret = writev(strm->hdl.sock, iov, iovcnt)) > 0) {
+			fb->written += ret;
+			fb->dirty = 1;
+			filebuf_sync(fb, 0);
+		}
+		return ret;
+	}
+
+	/* take nothing new while what was kept from a failed write still
+	 * cannot be written, such that the batch is put back */
+	if (fb->failing && filebuf_push(fb) != 0)
+		return -1;
+
+	/* metrics never exceed the buffer, see server_set_file; what was
+	 * taken before a failing push is kept, so report it as written */
+	for (i = 0; i < iovcnt; i++) {
+		if (fb->len + iov[i].iov_len > fb->size && filebuf_push(fb) != 0) {
+			if (ret > 0)
+				break;
+			return -1;
+		}
+		memcpy(fb->buf[fb->cur] + fb->len, iov[i].iov_base, iov[i].iov_len);
+		fb->len += iov[i].iov_len;
+		ret += iov[i].iov_len;
+	}
+	fb->written += ret;
+
+	return ret;
+}
+
+static ssize_t
+filewrite(z_strm *strm, const void *buf, size_t sze)
+{
+	struct iovec iov;
+
+	iov.iov_base = (void *)buf;
+	iov.iov_len = sze;
+	return filewritev(strm, &iov, 1);
+}
+
+static int
+fileflush(z_strm *strm)
+{
+	filebuf *fb = strm->fbuf;
+
+	if (fb->len > 0 && filebuf_push(fb) != 0)
+		return -1;
+	/* the writer thread keeps track of syncing itself */
+	if (fb->tid == 0)
+		filebuf_sync(fb, 0);
+	return 0;
+}
+
+static int
+fileclose(z_strm *strm)
+{
+	filebuf *fb = strm->fbuf;
+
+	filebuf_push(fb);
+	if (fb->tid != 0) {
+		pthread_mutex_lock(&fb->lock);
+		fb->stop = 1;
+		pthread_cond_broadcast(&fb->cond);
+		pthread_mutex_unlock(&fb->lock);
+		pthread_join(fb->tid, NULL);
+		fb->tid = 0;
+	}
+	filebuf_sync(fb, 1);
+	return close(strm->hdl.sock);
+}
+
+/**
+ * Prepares the buffers of strm for writing to the just opened fd.
+ * When buffers cannot be allocated, the file is written unbuffered.
+ */
+static void
+filebuf_open(z_strm *strm, int fd)
+{
+	filebuf *fb = strm->fbuf;
+	struct stat st;
+
+	fb->fd = fd;
+	fb->written = fstat(fd, &st) == 0 ? (size_t)st.st_size : 0;
+	fb->opened = fb->lastsync = time(NULL);
+	fb->dirty = 0;
+	if (fb->size > 0 && fb->buf[0] == NULL) {
+		if (posix_memalign((void **)&fb->buf[0], FILE_BUFALIGN, fb->size) != 0)
+			fb->buf[0] = NULL;
+		if (fb->buf[0] != NULL && fb->dbl &&
+				posix_memalign((void **)&fb->buf[1],
+					FILE_BUFALIGN, fb->size) != 0)
+			fb->buf[1] = NULL;
+		if (fb->buf[0] == NULL || (fb->dbl && fb->buf[1] == NULL)) {
+			logerr("failed to allocate buffers for file '%s', "
+					"writing unbuffered\n", fb->path);
+			free(fb->buf[0]);
+			fb->buf[0] = NULL;
+			fb->size = 0;
+		}
+	}
+	if (fb->dbl && fb->size > 0) {
+		/* a buffer kept from a failed write is written first */
+		fb->stop = 0;
+		fb->werr = 0;
+		if (pthread_create(&fb->tid, NULL, filebuf_writer, fb) != 0) {
+			logerr("failed to start writer for file '%s', "
+					"writing from the server thread\n", fb->path);
+			fb->tid = 0;
+		}
+	}
+}
+
+static filebuf *
+filebuf_new(const char *path)
+{
+	filebuf *fb;
+
+	if ((fb = malloc(sizeof(filebuf))) == NULL)
+		return NULL;
+	fb->path = path;
+	fb->size = SERVER_FILE_BUFSIZ;
+	fb->dbl = 0;
+	fb->sync = 0;
+	fb->rotatesecs = 0;
+	fb->rotatebytes = 0;
+	fb->buf[0] = NULL;
+	fb->buf[1] = NULL;
+	fb->cur = 0;
+	fb->len = 0;
+	fb->written = 0;
+	fb->opened = 0;
+	fb->lastsync = 0;
+	fb->dirty = 0;
+	fb->failing = 0;
+	fb->fd = -1;
+	fb->tid = 0;
+	pthread_mutex_init(&fb->lock, NULL);
+	pthread_cond_init(&fb->cond, NULL);
+	fb->wbuf = NULL;
+	fb->wlen = 0;
+	fb->werr = 0;
+	fb->stop = 0;
+
+	return fb;
+}
+
+/**
+ * Drops the data kept in the buffers of fb, for when it can no longer
+ * be written.  Returns the number of metrics dropped.
+ */
+static size_t
+filebuf_discard(filebuf *fb)
+{
+	size_t cnt = 0;
+	size_t i;
+
+	if (fb->wbuf != NULL)
+		for (i = 0; i < fb->wlen; i++)
+			cnt += fb->wbuf[i] == '\n';
+	for (i = 0; i < fb->len; i++)
+		cnt += fb->buf[fb->cur][i] == '\n';
+	fb->wbuf = NULL;
+	fb->werr = 0;
+	fb->len = 0;
+
+	return cnt;
+}
+
+static void
+filebuf_free(filebuf *fb)
+{
+	pthread_cond_destroy(&fb->cond);
+	pthread_mutex_destroy(&fb->lock);
+	if (fb->buf[0] != NULL)
+		free(fb->buf[0]);
+	if (fb->buf[1] != NULL)
+		free(fb->buf[1]);
+	free(fb);
+}
+
+/**
+ * Returns whether the current file of fb should make way for a new one.
+ * Files are renamed when their period ends, which starts at multiples
+ * of the rotation interval, or when they reached their size.  Empty
+ * files are left alone.
+ */
+static char
+filebuf_rotate_due(filebuf *fb)
+{
+	if (fb->written == 0)
+		return 0;
+	if (fb->rotatebytes > 0 && fb->written >= fb->rotatebytes)
+		return 1;
+	return fb->rotatesecs > 0 && time(NULL) >=
+		(fb->opened / fb->rotatesecs + 1) * fb->rotatesecs;
+}
+
+#if defined(HAVE_GZIP) || defined(HAVE_LZ4)
+/* compression offload, when compressors are set (-j) gzip and lz4
+ * streams hand each full buffer to a pool of compressor threads, and
+ * write the results in the order they were submitted.  For lz4 each
+ * buffer is a frame of its own already.  For gzip, buffers are
+ * compressed like pigz does: as raw deflate blocks ending in a sync
+ * flush, primed with the tail of the previous buffer, such that the
+ * concatenation of the blocks continues a single gzip stream which
+ * any receiver can decode */
+
+/**
+ * Compressor thread, takes jobs off the shared queue until the relay
+ * exits.
+ */
+static void *
+zpool_compressor(void *d)
+{
+	zjob *job;
+#ifdef HAVE_GZIP
+	z_stream gz;
+	char gzok;
+
+	gz.zalloc = Z_NULL;
+	gz.zfree = Z_NULL;
+	gz.opaque = Z_NULL;
+	gzok = deflateInit2(&gz, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+			-15, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+#endif
+	(void)d;
+
+	pthread_mutex_lock(&zpoollock);
+	while (1) {
+		while (zpoolhead == NULL)
+			pthread_cond_wait(&zpoolcond, &zpoollock);
+		job = zpoolhead;
+		if ((zpoolhead = job->next) == NULL)
+			zpooltail = NULL;
+		pthread_mutex_unlock(&zpoollock);
+
+		job->failed = 1;
+#ifdef HAVE_GZIP
+		if (job->transport == W_GZIP && gzok) {
+			deflateReset(&gz);
+			if (job->dictlen > 0)
+				deflateSetDictionary(&gz,
+						(Bytef *)job->dict, (uInt)job->dictlen);
+			gz.next_in = (Bytef *)job->ibuf;
+			gz.avail_in = (uInt)job->ilen;
+			gz.next_out = (Bytef *)job->cbuf + job->clen;
+			gz.avail_out = (uInt)(job->cbufsize - job->clen);
+			if (deflate(&gz, Z_SYNC_FLUSH) == Z_OK &&
+					gz.avail_in == 0 && gz.avail_out > 0)
+			{
+				job->clen = job->cbufsize - gz.avail_out;
+				job->failed = 0;
+			}
+		}
+#endif
+#ifdef HAVE_LZ4
+		if (job->transport == W_LZ4) {
+			size_t ret = LZ4F_compressFrame(job->cbuf, job->cbufsize,
+					job->ibuf, job->ilen, NULL);
+			if (!LZ4F_isError(ret)) {
+				job->clen = ret;
+				job->failed = 0;
+			}
+		}
+#endif
+
+		pthread_mutex_lock(&zpoollock);
+		job->done = 1;
+		pthread_cond_broadcast(&zdonecond);
+	}
+
+	return NULL;
+}
+
+/**
+ * Writes the output of the jobs of strm to its next stream, in order,
+ * waiting for jobs still being compressed until at most keep jobs are
+ * left in flight.  Returns 0 on success, -1 when a job failed or the
+ * write did.
+ */
+static int
+zpool_drain(z_strm *strm, int keep)
+{
+	zjob *job;
+	char *cbufp;
+	size_t cbuflen;
+	ssize_t oret;
+	int ret = 0;
+
+	while (strm->jobcnt > 0) {
+		job = strm->jobs[strm->jobhead];
+		if (!__sync_bool_compare_and_swap(&(job->done), 1, 1)) {
+			if (strm->jobcnt <= keep)
+				break;
+			pthread_mutex_lock(&zpoollock);
+			while (!job->done)
+				pthread_cond_wait(&zdonecond, &zpoollock);
+			pthread_mutex_unlock(&zpoollock);
+		}
+		strm->jobhead = (strm->jobhead + 1) % compressors;
+		strm->jobcnt--;
+
+		/* after a failure the stream is broken, only collect the
+		 * remaining jobs */
+		if (job->failed)
+			ret = -1;
+		if (ret != 0)
+			continue;
+		cbufp = job->cbuf;
+		cbuflen = job->clen;
+		while (cbuflen > 0) {
+			oret = strm->nextstrm->strmwrite(strm->nextstrm,
+					cbufp, cbuflen);
+			if (oret < 0) {
+				ret = -1;
+				break;
+			}
+			cbufp += oret;
+			cbuflen -= oret;
+		}
+	}
+
+	return ret;
+}
+
+/**
+ * Waits for the jobs of strm and releases them, for when the server
+ * goes away.
+ */
+static void
+zpool_free(z_strm *strm)
+{
+	int i;
+
+	if (strm->jobs == NULL)
+		return;
+	pthread_mutex_lock(&zpoollock);
+	while (strm->jobcnt > 0) {
+		while (!strm->jobs[strm->jobhead]->done)
+			pthread_cond_wait(&zdonecond, &zpoollock);
+		strm->jobhead = (strm->jobhead + 1) % compressors;
+		strm->jobcnt--;
+	}
+	pthread_mutex_unlock(&zpoollock);
+	for (i = 0; i < compressors; i++) {
+		if (strm->jobs[i] == NULL)
+			continue;
+		free(strm->jobs[i]->cbuf);
+		free(strm->jobs[i]);
+	}
+	free(strm->jobs);
+	strm->jobs = NULL;
+}
+/**
+ * Hands the buffered data of strm to the compressors.  Only blocks when
+ * all jobs of strm are in flight, until the oldest one is written.
+ * Returns 0 on success, -1 on failure.
+ */
+static int
+zpool_submit(z_strm *strm, con_trnsp transport)
+{
+	zjob *job;
+	int i;
+
+	if (strm->obuflen == 0)
+		return 0;
+
+	if (strm->jobs == NULL) {
+		if ((strm->jobs = calloc(compressors, sizeof(zjob *))) == NULL)
+			return -1;
+		for (i = 0; i < compressors; i++) {
+			if ((job = strm->jobs[i] = calloc(1, sizeof(zjob))) == NULL) {
+				zpool_free(strm);
+				return -1;
+			}
+			job->transport = transport;
+#ifdef HAVE_GZIP
+			if (transport == W_GZIP)
+				job->cbufsize = compressBound(METRIC_BUFSIZ) + 64;
+#endif
+#ifdef HAVE_LZ4
+			if (transport == W_LZ4)
+				job->cbufsize = LZ4F_compressFrameBound(METRIC_BUFSIZ, NULL);
+#endif
+			if ((job->cbuf = malloc(job->cbufsize)) == NULL) {
+				zpool_free(strm);
+				return -1;
+			}
+		}
+		strm->jobhead = 0;
+		strm->jobcnt = 0;
+	}
+
+	/* write what is done, and make room for this job if necessary */
+	if (zpool_drain(strm, compressors - 1) != 0)
+		return -1;
+
+	job = strm->jobs[(strm->jobhead + strm->jobcnt) % compressors];
+	job->clen = 0;
+#ifdef HAVE_GZIP
+	if (transport == W_GZIP) {
+		if (strm->jobprev == NULL) {
+			/* the stream starts with the header deflateInit2 would
+			 * produce for 15 + 16 window bits, it goes out with the
+			 * first block since a receiver that reads just the
+			 * header has nothing to inflate */
+			static const char gzhdr[10] =
+				{ 0x1f, (char)0x8b, 8, 0, 0, 0, 0, 0, 0, 3 };
+
+			memcpy(job->cbuf, gzhdr, sizeof(gzhdr));
+			job->clen = sizeof(gzhdr);
+			job->dictlen = 0;
+		} else {
+			/* the previous job is only reused after this one, so its
+			 * input is still there, with a single compressor it is
+			 * this job, hence take the dictionary first */
+			job->dictlen = strm->jobprev->ilen < GZIP_WINDOW ?
+				strm->jobprev->ilen : GZIP_WINDOW;
+			memcpy(job->dict, strm->jobprev->ibuf +
+					strm->jobprev->ilen - job->dictlen, job->dictlen);
+		}
+	}
+#endif
+	memcpy(job->ibuf, strm->obuf, strm->obuflen);
+	job->ilen = strm->obuflen;
+	strm->obuflen = 0;
+	strm->jobprev = job;
+	job->done = 0;
+	job->next = NULL;
+	strm->jobcnt++;
+
+	pthread_mutex_lock(&zpoollock);
+	if (zpooltail == NULL) {
+		zpoolhead = job;
+	} else {
+		zpooltail->next = job;
+	}
+	zpooltail = job;
+	pthread_cond_signal(&zpoolcond);
+	pthread_mutex_unlock(&zpoollock);
+
+	return 0;
+}
+
+#endif
+
 #ifdef HAVE_GZIP
 /* gzip wrapped socket */
 static inline int gzipflush(z_strm *strm);
@@ -168,7 +958,8 @@ gzipwrite(z_strm *strm, const void *buf, size_t sze)
 {
 	/* ensure we have space available */
 	if (strm->obuflen + sze > METRIC_BUFSIZ)
-		if (gzipflush(strm) != 0)
+		if ((compressors > 0 ?
+					zpool_submit(strm, W_GZIP) : gzipflush(strm)) != 0)
 			return -1;
 
 	/* append metric to buf */
@@ -187,6 +978,13 @@ gzipflush(z_strm *strm)
 	char *cbufp;
 	int oret;
 
+	if (compressors > 0) {
+		if (zpool_submit(strm, W_GZIP) != 0 || zpool_drain(strm, 0) != 0)
+			return -1;
+		strm->nextstrm->strmflush(strm->nextstrm);
+		return 0;
+	}
+
 	strm->hdl.gz->next_in = (Bytef *)strm->obuf;
 	strm->hdl.gz->avail_in = strm->obuflen;
 	strm->hdl.gz->next_out = (Bytef *)cbuf;
@@ -239,9 +1037,18 @@ gzipflush(z_strm *strm)
 static inline int
 gzipclose(z_strm *strm)
 {
-	int ret = strm->nextstrm->strmclose(strm->nextstrm);
-	deflateEnd(strm->hdl.gz);
-	free(strm->hdl.gz);
+	int ret;
+
+	if (compressors > 0) {
+		/* the stream is done, but its jobs may still be running */
+		zpool_drain(strm, 0);
+		strm->jobprev = NULL;
+	}
+	ret = strm->nextstrm->strmclose(strm->nextstrm);
+	if (strm->hdl.gz != NULL) {
+		deflateEnd(strm->hdl.gz);
+		free(strm->hdl.gz);
+	}
 	return ret;
 }
 
@@ -281,7 +1088,10 @@ lzwrite(z_strm *strm, const void *buf, size_t sze)
 
 		/* if output buffer is full & still have bytes to write, flush now */
 
-		if (strm->obuflen == METRIC_BUFSIZ && towrite > 0 && lzflush(strm) != 0) {
+		if (strm->obuflen == METRIC_BUFSIZ && towrite > 0 &&
+				(compressors > 0 ?
+				 zpool_submit(strm, W_LZ4) : lzflush(strm)) != 0)
+		{
 			logerr("Failed to flush LZ4 data to make space\n");
 			return -1;
 		}
@@ -296,6 +1106,13 @@ lzflush(z_strm *strm)
 	int oret;
 	size_t ret;
 
+	if (compressors > 0) {
+		if (zpool_submit(strm, W_LZ4) != 0 || zpool_drain(strm, 0) != 0)
+			return -1;
+		strm->nextstrm->strmflush(strm->nextstrm);
+		return 0;
+	}
+
 	/* anything to do? */
 
 	if (strm->obuflen == 0)
@@ -403,30 +1220,151 @@ snappyerror(z_strm *strm, int rval)
 }
 #endif
 
-#ifdef HAVE_SSL
-/* (Open|Libre)SSL wrapped socket */
+#ifdef HAVE_ZSTD
+/* zstd wrapped socket, each connection is a single frame that is
+ * flushed block by block, so all of its history aids compression */
+static inline int zstdflush(z_strm *strm);
+
 static inline ssize_t
-sslwrite(z_strm *strm, const void *buf, size_t sze)
+zstdwrite(z_strm *strm, const void *buf, size_t sze)
 {
-	return (ssize_t)SSL_write(strm->hdl.ssl, buf, (int)sze);
-}
+	/* ensure we have space available */
+	if (strm->obuflen + sze > METRIC_BUFSIZ)
+		if (zstdflush(strm) != 0)
+			return -1;
 
-static inline int
-sslflush(z_strm *strm)
-{
-	/* noop */
-	(void)strm;
-	return 0;
+	/* append metric to buf */
+	memcpy(strm->obuf + strm->obuflen, buf, sze);
+	strm->obuflen += sze;
+
+	return sze;
 }
 
 static inline int
-sslclose(z_strm *strm)
+zstdflush(z_strm *strm)
 {
-	int sock = SSL_get_fd(strm->hdl.ssl);
-	SSL_free(strm->hdl.ssl);
-	return close(sock);
-}
-
+	char cbuf[METRIC_BUFSIZ];
+	ZSTD_inBuffer in;
+	ZSTD_outBuffer out;
+	size_t rem;
+	char *cbufp;
+	ssize_t oret;
+
+	if (strm->obuflen == 0)
+		return 0;
+
+	in.src = strm->obuf;
+	in.size = strm->obuflen;
+	in.pos = 0;
+	/* reset the write position, from this point it will always need to
+	 * restart */
+	strm->obuflen = 0;
+
+	do {
+		out.dst = cbuf;
+		out.size = sizeof(cbuf);
+		out.pos = 0;
+		rem = ZSTD_compressStream2(strm->hdl.zstd, &out, &in, ZSTD_e_flush);
+		if (ZSTD_isError(rem)) {
+			logerr("failed to compress %zu bytes using zstd: %s\n",
+					in.size, ZSTD_getErrorName(rem));
+			return -1;
+		}
+		for (cbufp = cbuf; out.pos > 0; ) {
+			oret = strm->nextstrm->strmwrite(strm->nextstrm,
+					cbufp, out.pos);
+			if (oret < 0)
+				return -1;  /* failure is failure */
+
+			/* update counters to possibly retry the remaining bit */
+			cbufp += oret;
+			out.pos -= oret;
+		}
+	} while (rem != 0);
+	/* flush whatever we wrote */
+	strm->nextstrm->strmflush(strm->nextstrm);
+
+	return 0;
+}
+
+static inline int
+zstdclose(z_strm *strm)
+{
+	zstdflush(strm);
+	return strm->nextstrm->strmclose(strm->nextstrm);
+}
+
+static inline const char *
+zstderror(z_strm *strm, int rval)
+{
+	return strm->nextstrm->strmerror(strm->nextstrm, rval);
+}
+#endif
+
+#ifdef HAVE_SSL
+/* (Open|Libre)SSL wrapped socket */
+static inline ssize_t
+sslwrite(z_strm *strm, const void *buf, size_t sze)
+{
+	ssize_t ret = (ssize_t)SSL_write(strm->hdl.ssl, buf, (int)sze);
+	if (ret <= 0)
+		strm->sslfailed = 1;
+	return ret;
+}
+
+#ifdef BIO_get_ktls_send
+/* once the kernel encrypts (kTLS), the socket can be written directly */
+static inline ssize_t
+sslktlswritev(z_strm *strm, const struct iovec *iov, int iovcnt)
+{
+	ssize_t ret = writev(SSL_get_fd(strm->hdl.ssl), iov, iovcnt);
+	if (ret < 0)
+		strm->sslfailed = 1;
+	return ret;
+}
+#endif
+
+static inline int
+sslflush(z_strm *strm)
+{
+	/* noop */
+	(void)strm;
+	return 0;
+}
+
+static inline int
+sslclose(z_strm *strm)
+{
+	int sock = SSL_get_fd(strm->hdl.ssl);
+	char c;
+
+	/* TLSv1.3 sends session tickets after the handshake, since we
+	 * never read from the connection, pick them up now such that the
+	 * next connection can resume, but don't wait for them; a session
+	 * freed without close_notify is considered bad, and won't resume.
+	 * After a failed write the connection is broken, or in the middle
+	 * of a record, so don't touch it anymore */
+	if (SSL_is_init_finished(strm->hdl.ssl) && !strm->sslfailed) {
+		(void) fcntl(sock, F_SETFL, fcntl(sock, F_GETFL) | O_NONBLOCK);
+		(void) SSL_read(strm->hdl.ssl, &c, sizeof(c));
+		(void) SSL_shutdown(strm->hdl.ssl);
+	}
+	SSL_free(strm->hdl.ssl);
+	return close(sock);
+}
+
+/* called by (Open|Libre)SSL for each new session (ticket) received */
+static int
+sslnewsession(SSL *ssl, SSL_SESSION *sess)
+{
+	z_strm *strm = (z_strm *)SSL_get_app_data(ssl);
+
+	if (strm->sess != NULL)
+		SSL_SESSION_free(strm->sess);
+	strm->sess = sess;
+	return 1;  /* we keep the reference */
+}
+
 static char _sslerror_buf[256];
 static inline const char *
 sslerror(z_strm *strm, int rval)
@@ -478,1290 +1416,4306 @@ sslerror(z_strm *strm, int rval)
 #endif
 
 /**
- * Reads from the queue and sends items to the remote server.  This
- * function is designed to be a thread.  Data sending is attempted to be
- * batched, but sent one by one to reduce loss on sending failure.
- * A connection with the server is maintained for as long as there is
- * data to be written.  As soon as there is none, the connection is
- * dropped if a timeout of DISCONNECT_WAIT_TIME exceeds.
+ * Closes the connection after a failed write, and puts back the
+ * metrics from the NULL-terminated batch starting at metric that
+ * weren't (completely) sent.  Metrics that don't fit the queue any
+ * more are dropped.
  */
-static void *
-server_queuereader(void *d)
+static void
+server_putback_batch(server *self, const char **metric, ssize_t slen)
 {
-	server *self = (server *)d;
 	size_t len;
-	ssize_t slen;
-	const char **metric = self->batch;
-	struct timeval start, stop;
-	struct timeval timeout;
-	queue *squeue;
-	char idle = 0;
-	size_t *secpos = NULL;
-	unsigned char cnt;
-	const char *p;
 
-	*metric = NULL;
+	if (self->ctype != CON_UDP &&
+			__sync_fetch_and_add(&(self->failure), 1) == 0)
+		logerr("failed to write() to %s:%u: %s\n",
+				self->ip, self->port,
+				(slen < 0 ?
+				 self->strm->strmerror(self->strm, slen) :
+				 "incomplete write"));
+	self->strm->strmclose(self->strm);
+	self->fd = -1;
+	/* put back stuff we couldn't process, metric is part of batch */
+	for (len = 0; metric[len] != NULL; len++)
+		;
+	metric += queue_putback_vector_stamps(self->queue, metric,
+			self->stamps + (metric - self->batch), len);
+	for (; *metric != NULL; metric++) {
+		if (mode & MODE_DEBUG)
+			logerr("server %s:%u: dropping metric: %s",
+					self->ip, self->port,
+					*metric + sizeof(size_t));
+		free((char *)*metric);
+		__sync_add_and_fetch(&(self->dropped), 1);
+	}
+}
 
-	self->running = 1;
-	while (1) {
-		/* close connection when we're asked to reopen */
-		if (__sync_bool_compare_and_swap(&(self->reopen_con), 1, 0)) {
-			self->strm->strmclose(self->strm);
-			self->fd = -1;
+/**
+ * Writes the NULL-terminated batch at *metric to the stream using
+ * vectored writes, such that a full batch takes only a few system
+ * calls.  A short write is resumed from the exact byte where it
+ * stopped.  Metrics are freed and accounted for as soon as they are
+ * completely written, advancing *metric.  When the stream fails,
+ * *metric points to the first metric not (completely) written, and
+ * the result of the failing write is returned.
+ */
+static ssize_t
+server_writev_batch(server *self, const char ***metric)
+{
+	struct iovec iov[IOV_BATCH];
+	const char **m;
+	int iovcnt;
+	int i;
+	ssize_t slen = 0;
+	size_t len;
+	unsigned char cnt;
+
+	while (**metric != NULL) {
+		for (iovcnt = 0, m = *metric;
+				*m != NULL && iovcnt < IOV_BATCH;
+				iovcnt++, m++)
+		{
+			iov[iovcnt].iov_base = (char *)*m + sizeof(size_t);
+			iov[iovcnt].iov_len = *(size_t *)(*m);
 		}
-		if (queue_len(self->queue) == 0) {
-			/* if we're idling, close the TCP connection, this allows us
-			 * to reduce connections, while keeping the connection alive
-			 * if we're writing a lot */
-			gettimeofday(&start, NULL);
-			if (self->ctype == CON_TCP && self->fd >= 0 &&
-					idle++ > DISCONNECT_WAIT_TIME)
+
+		for (i = 0, cnt = 0; i < iovcnt; ) {
+			slen = self->strm->strmwritev(self->strm, &iov[i], iovcnt - i);
+			if (slen <= 0) {
+				/* retry interrupted writes a limited number of times,
+				 * anything else means the stream is broken */
+				if (slen < 0 && errno == EINTR && ++cnt < 10)
+					continue;
+				return slen;
+			}
+			cnt = 0;
+
+			/* release everything that was sent completely */
+			for (len = (size_t)slen;
+					i < iovcnt && len >= iov[i].iov_len;
+					i++)
 			{
-				self->strm->strmclose(self->strm);
-				self->fd = -1;
+				len -= iov[i].iov_len;
+				free((char *)**metric);
+				(*metric)++;
+				__sync_add_and_fetch(&(self->metrics), 1);
 			}
-			if (idle == 1)
-				/* ensure blocks are pushed out as soon as we're idling,
-				 * this allows compressors to benefit from a larger
-				 * stream of data to gain better compression */
-				self->strm->strmflush(self->strm);
-			gettimeofday(&stop, NULL);
-			__sync_add_and_fetch(&(self->ticks), timediff(start, stop));
-			if (__sync_bool_compare_and_swap(&(self->keep_running), 0, 0))
-				break;
-			/* nothing to do, so slow down for a bit */
-			usleep((200 + (rand() % 100)) * 1000);  /* 200ms - 300ms */
-			/* if we are in failure mode, keep checking if we can
-			 * connect, this avoids unnecessary queue moves */
-			if (__sync_bool_compare_and_swap(&(self->failure), 0, 0))
-				/* it makes no sense to try and do something, so skip */
-				continue;
-		} else if (self->secondariescnt > 0 &&
-				(__sync_add_and_fetch(&(self->failure), 0) >= FAIL_WAIT_TIME ||
-				 (!self->failover && LEN_CRITICAL(self->queue))))
-		{
-			size_t i;
+			if (i < iovcnt) {
+				iov[i].iov_base = (char *)iov[i].iov_base + len;
+				iov[i].iov_len -= len;
+			}
+		}
+	}
 
-			gettimeofday(&start, NULL);
-			if (self->secondariescnt > 0) {
-				if (secpos == NULL) {
-					secpos = malloc(sizeof(size_t) * self->secondariescnt);
-					if (secpos == NULL) {
-						logerr("server: failed to allocate memory "
-								"for secpos\n");
-						gettimeofday(&stop, NULL);
-						__sync_add_and_fetch(&(self->ticks),
-								timediff(start, stop));
-						continue;
-					}
-					for (i = 0; i < self->secondariescnt; i++)
-						secpos[i] = i;
-				}
-				if (!self->failover) {
-					/* randomise the failover list such that in the
-					 * grand scheme of things we don't punish the first
-					 * working server in the list to deal with all
-					 * traffic meant for a now failing server */
-					for (i = 0; i < self->secondariescnt; i++) {
-						size_t n = rand() % (self->secondariescnt - i);
-						if (n != i) {
-							size_t t = secpos[n];
-							secpos[n] = secpos[i];
-							secpos[i] = t;
-						}
-					}
-				}
+	return slen;
+}
+
+#ifdef HAVE_SENDMMSG
+#define UDP_MSG(M, N)  (&(M)[N].msg_hdr)
+#else
+#define UDP_MSG(M, N)  (&(M)[N])
+#endif
+
+/**
+ * Writes the NULL-terminated batch at *metric to the UDP socket.  As
+ * many metrics as fit in udpsize bytes are packed into a datagram,
+ * and many datagrams are handed to the kernel at once with sendmmsg()
+ * where available.  Metrics are freed and accounted for once their
+ * datagram is sent, advancing *metric.  When the socket fails, *metric
+ * points to the first metric not sent, and -1 is returned.
+ */
+static ssize_t
+server_udp_batch(server *self, const char ***metric)
+{
+	struct iovec iov[IOV_BATCH];
+#ifdef HAVE_SENDMMSG
+	struct mmsghdr msgs[UDP_MMSG_BATCH];
+#else
+	struct msghdr msgs[UDP_MMSG_BATCH];
+#endif
+	size_t mcnt[UDP_MMSG_BATCH];  /* metrics in each datagram */
+	struct msghdr *msg;
+	const char **m;
+	int iovcnt;
+	int msgcnt;
+	int sent;
+	int i;
+	int k;
+	size_t j;
+	size_t dlen;
+	size_t len;
+	unsigned char cnt = 0;
+
+	while (**metric != NULL) {
+		/* pack the metrics into datagrams, without copying them */
+		iovcnt = 0;
+		for (msgcnt = 0, m = *metric;
+				*m != NULL && iovcnt < IOV_BATCH && msgcnt < UDP_MMSG_BATCH;
+				msgcnt++)
+		{
+			msg = UDP_MSG(msgs, msgcnt);
+			memset(msg, 0, sizeof(*msg));
+			msg->msg_iov = &iov[iovcnt];
+			for (mcnt[msgcnt] = 0, dlen = 0;
+					*m != NULL && iovcnt < IOV_BATCH;
+					m++, iovcnt++, mcnt[msgcnt]++)
+			{
+				len = *(size_t *)(*m);
+				if (mcnt[msgcnt] > 0 && dlen + len > udpsize)
+					break;
+				iov[iovcnt].iov_base = (char *)*m + sizeof(size_t);
+				iov[iovcnt].iov_len = len;
+				dlen += len;
 			}
+			msg->msg_iovlen = mcnt[msgcnt];
+		}
 
-			/* offload data from our queue to our secondaries
-			 * when doing so, observe the following:
-			 * - avoid nodes that are in failure mode
-			 * - avoid nodes which queues are >= critical_len
-			 * when no nodes remain given the above
-			 * - send to nodes which queue size < critical_len
-			 * where there are no such nodes
-			 * - do nothing (we will overflow, since we can't send
-			 *   anywhere) */
-			*metric = NULL;
-			squeue = NULL;
-			for (i = 0; i < self->secondariescnt; i++) {
-				/* both conditions below make sure we skip ourself */
-				if (__sync_add_and_fetch(
-							&(self->secondaries[secpos[i]]->failure), 0))
-					continue;
-				squeue = self->secondaries[secpos[i]]->queue;
-				if (!self->failover && LEN_CRITICAL(squeue)) {
-					squeue = NULL;
+		for (i = 0; i < msgcnt; i += sent) {
+#ifdef HAVE_SENDMMSG
+			sent = sendmmsg(self->fd, &msgs[i], msgcnt - i, 0);
+#else
+			sent = sendmsg(self->fd, &msgs[i], 0) < 0 ? -1 : 1;
+#endif
+			if (sent < 0) {
+				if (errno == EINTR && ++cnt < 10) {
+					sent = 0;
 					continue;
 				}
-				if (*metric == NULL) {
-					/* send up to batch size of our queue to this queue */
-					len = queue_dequeue_vector(
-							self->batch, self->queue, self->bsize);
-					self->batch[len] = NULL;
-					metric = self->batch;
+				__sync_add_and_fetch(&(self->senderrors), 1);
+				if (errno != EMSGSIZE)
+					return -1;
+				/* the network won't carry this datagram, don't let it
+				 * block the ones that follow */
+				for (j = 0; j < mcnt[i]; j++) {
+					free((char *)**metric);
+					(*metric)++;
 				}
+				__sync_add_and_fetch(&(self->dropped), mcnt[i]);
+				sent = 1;
+				continue;
+			}
+			cnt = 0;
 
-				for (; *metric != NULL; metric++)
-					if (!queue_putback(squeue, *metric))
-						break;
-				/* try to put back stuff that didn't fit */
-				for (; *metric != NULL; metric++)
-					if (!queue_putback(self->queue, *metric))
-						break;
+			for (k = i; k < i + sent; k++) {
+				for (j = 0; j < mcnt[k]; j++) {
+					free((char *)**metric);
+					(*metric)++;
+				}
+				__sync_add_and_fetch(&(self->metrics), mcnt[k]);
 			}
-			for (; *metric != NULL; metric++) {
+			__sync_add_and_fetch(&(self->datagrams), sent);
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Writes the NULL-terminated batch at *metric to the stream as pickle
+ * frames, the way carbon-cache's pickle receiver expects them: a
+ * 4-byte big-endian length followed by a pickled list of tuples.
+ * Metrics are freed and accounted for once their frame is written
+ * completely, advancing *metric.  When the stream fails, *metric
+ * points to the first metric of the frame that failed, and the result
+ * of the failing write is returned.  Metrics that cannot be pickled
+ * are dropped and freed right away, and removed from the batch.
+ */
+static ssize_t
+server_pickle_batch(server *self, const char ***metric)
+{
+	const char **m;
+	const char **done;
+	char *p;
+	char *q;
+	char *end;
+	size_t len;
+	size_t cnt;
+	size_t i;
+	ssize_t slen = 0;
+	unsigned char tries;
+
+	if (self->pickle == NULL &&
+			(self->pickle = malloc(PICKLE_BUFSIZ)) == NULL)
+	{
+		errno = ENOMEM;
+		return -1;
+	}
+	/* leave room for APPENDS and STOP */
+	end = self->pickle + PICKLE_BUFSIZ - 2;
+
+	while (**metric != NULL) {
+		p = self->pickle + 4;
+		*p++ = (char)0x80;  /* PROTO 2 */
+		*p++ = 2;
+		*p++ = ']';  /* EMPTY_LIST */
+		*p++ = '(';  /* MARK */
+		for (m = *metric, cnt = 0; *m != NULL; m++) {
+			if (p + *(size_t *)(*m) + PICKLE_METRIC_OVERHEAD > end)
+				break;
+			if ((q = pickle_metric(p, *m)) == NULL) {
 				if (mode & MODE_DEBUG)
-					logerr("dropping metric: %s", *metric);
-				free((char *)*metric);
+					logerr("server %s:%u: dropping unpicklable "
+							"metric: %s", self->ip, self->port,
+							*m + sizeof(size_t));
 				__sync_add_and_fetch(&(self->dropped), 1);
+				/* take it out of the batch, so it isn't put back and
+				 * dropped again when writing the frame fails: move
+				 * what was pickled so far (and its stamps) up into its
+				 * slot */
+				free((char *)*m);
+				i = *metric - self->batch;
+				memmove(*metric + 1, *metric, (m - *metric) * sizeof(*m));
+				memmove(self->stamps + i + 1, self->stamps + i,
+						(m - *metric) * sizeof(*self->stamps));
+				(*metric)++;
+				continue;
 			}
-			gettimeofday(&stop, NULL);
-			__sync_add_and_fetch(&(self->ticks),
-					timediff(start, stop));
-			if (squeue == NULL) {
-				/* we couldn't do anything, take it easy for a bit */
-				if (__sync_add_and_fetch(&(self->failure), 0) > 1) {
-					/* This is a compound because I can't seem to figure
-					 * out how to atomically just "set" a variable.
-					 * It's not bad when in the middle there is a ++,
-					 * all that counts is that afterwards its > 0. */
-					__sync_and_and_fetch(&(self->failure), 0);
-					__sync_add_and_fetch(&(self->failure), 1);
+			p = q;
+			cnt++;
+		}
+		*p++ = 'e';  /* APPENDS */
+		*p++ = '.';  /* STOP */
+		len = p - self->pickle - 4;
+		self->pickle[0] = (char)((len >> 24) & 0xFF);
+		self->pickle[1] = (char)((len >> 16) & 0xFF);
+		self->pickle[2] = (char)((len >> 8) & 0xFF);
+		self->pickle[3] = (char)(len & 0xFF);
+
+		if (cnt > 0) {
+			for (q = self->pickle, len = p - q, tries = 0; len > 0; ) {
+				slen = self->strm->strmwrite(self->strm, q, len);
+				if (slen <= 0) {
+					/* retry interrupted writes a limited number of
+					 * times, anything else means the stream is broken */
+					if (slen < 0 && errno == EINTR && ++tries < 10)
+						continue;
+					return slen;
 				}
-				if (__sync_bool_compare_and_swap(&(self->keep_running), 0, 0))
-					break;
-				usleep((200 + (rand() % 100)) * 1000);  /* 200ms - 300ms */
+				tries = 0;
+				q += slen;
+				len -= slen;
 			}
-		} else if (__sync_add_and_fetch(&(self->failure), 0) > 0) {
-			if (__sync_bool_compare_and_swap(&(self->keep_running), 0, 0))
-				break;
-			usleep((200 + (rand() % 100)) * 1000);  /* 200ms - 300ms */
-			/* avoid overflowing */
-			if (__sync_add_and_fetch(&(self->failure), 0) > FAIL_WAIT_TIME)
-				__sync_sub_and_fetch(&(self->failure), 1);
 		}
 
-		/* at this point we've got work to do, if we're instructed to
-		 * shut down, however, try to get everything out of the door
-		 * (until we fail, see top of this loop) */
+		for (done = *metric; done != m; done++)
+			free((char *)*done);
+		*metric = m;
+		__sync_add_and_fetch(&(self->metrics), cnt);
+	}
 
-		gettimeofday(&start, NULL);
+	return slen;
+}
+
+/**
+ * Returns which of conns connections metric m should be sent over.
+ * Metrics are spread by the hash of their name, such that all values
+ * for a metric travel over the same connection, and hence stay in
+ * order.  The hash is mixed first, because jump_fnv1a_ch clusters
+ * pick the server using the very same hash, which would make all
+ * metrics of a server end up on the same connection.
+ */
+static inline int
+server_lane_index(const char *m, int conns)
+{
+	unsigned long long int hash;
+	const char *p;
+	const char *end;
+
+	m += sizeof(size_t);
+	if ((end = memchr(m, ' ', *(size_t *)(m - sizeof(size_t)))) == NULL)
+		end = m + *(size_t *)(m - sizeof(size_t));
+	fnv1a_64(hash, p, m, end);
+	/* xorshift, like ch_get_nodes does for jump_fnv1a_ch */
+	hash ^= hash >> 12;
+	hash ^= hash << 25;
+	hash ^= hash >> 27;
+	hash *= 2685821657736338717ULL;
+	return (int)jump_bucketpos(hash, conns);
+}
+
+/**
+ * Returns the server whose connection metric m should be sent over.
+ */
+static inline server *
+server_lane(server *s, const char *m)
+{
+	int conns = __sync_add_and_fetch(&(s->conns), 0);
+	int n;
+
+	if (conns <= 1 || (n = server_lane_index(m, conns)) == 0)
+		return s;
+	return s->lanes[n - 1];
+}
+
+/**
+ * Moves up to cnt metrics from the on-disk spool back into the queue,
+ * as far as the memory budget allows.  Metrics are only spooled once
+ * the queue is full, and keep going to the spool for as long as it
+ * holds data, hence appending to the queue retains the order in which
+ * the metrics were received.
+ */
+static void
+server_replay(server *self, size_t cnt)
+{
+	char buf[METRIC_BUFSIZ];
+	size_t len;
+	char *m;
+
+	for (; cnt > 0; cnt--) {
+		/* leave on disk what does not fit in the memory budget */
+		if (membudget > 0 && queue_totbytes() >= membudget)
+			break;
+		if ((len = spool_read(self->spool, buf, sizeof(buf))) == 0)
+			break;
+		if ((m = malloc(sizeof(len) + len)) == NULL) {
+			__sync_add_and_fetch(&(self->dropped), 1);
+			continue;
+		}
+		*((size_t *)m) = len;
+		memcpy(m + sizeof(len), buf, len);
+		queue_enqueue(server_lane(self, m)->queue, m);
+		__sync_add_and_fetch(&(self->replayed), len);
+	}
+}
+
+#define LANE(S, L)  ((L) == 0 ? (S) : (S)->lanes[(L) - 1])
+
+static inline void server_wakeup(server *s);
+
+/**
+ * Returns the number of metrics lane l has dealt with since start.
+ */
+static inline size_t
+server_lane_progress(server *l)
+{
+	return __sync_add_and_fetch(&(l->metrics), 0) +
+		__sync_add_and_fetch(&(l->dropped), 0);
+}
+
+/**
+ * Changes the number of connections in use from prevconns to conns.
+ * Because that moves metric names to other connections, the
+ * connections that receive names are held until the connections that
+ * lost them have written what they had queued at this point, else
+ * values for the same metric could overtake each other.
+ */
+static void
+server_lanes_switch(server *self, int prevconns, int conns, size_t now)
+{
+	/* growing moves names from all lanes in use to the new ones,
+	 * shrinking moves the names of the dropped lanes to the others */
+	int lo = conns > prevconns ? 0 : conns;
+	int l;
+
+	for (l = 0; l <= self->lanecnt; l++) {
+		server *t = LANE(self, l);
+		t->holdmark = 0;
+		if (l >= lo && l < prevconns) {
+			size_t progress = server_lane_progress(t);
+			size_t batchmark = __sync_add_and_fetch(&(t->batchmark), 0);
+			t->holdmark = (batchmark > progress ? batchmark : progress) +
+				queue_len(t->queue);
+		} else if (l < conns) {
+			__sync_bool_compare_and_swap(&(t->held), 0, 1);
+		}
+	}
+	self->holduntil = now + 5 * LANE_ADAPT_TIME;
+
+	if (mode & MODE_DEBUG)
+		logerr("server %s:%u: using %d connections\n",
+				self->ip, self->port, conns);
+	/* we're the only one changing conns */
+	__sync_add_and_fetch(&(self->conns), conns - prevconns);
+}
+
+/**
+ * Resumes held lanes once all lanes that lost metric names reached
+ * their holdmark, or waiting took too long, e.g. because metrics were
+ * dropped from a full queue.  Returns whether lanes are still held.
+ */
+static char
+server_lanes_release(server *self, size_t now)
+{
+	int l;
+
+	if (now < self->holduntil) {
+		for (l = 0; l <= self->lanecnt; l++) {
+			server *t = LANE(self, l);
+			if (server_lane_progress(t) < t->holdmark)
+				return 1;
+		}
+	}
+
+	for (l = 0; l <= self->lanecnt; l++) {
+		server *t = LANE(self, l);
+		if (__sync_bool_compare_and_swap(&(t->held), 1, 0))
+			server_wakeup(t);
+	}
+	self->holduntil = 0;
+	self->ctlnext = now + LANE_ADAPT_TIME;
+	return 0;
+}
+
+/**
+ * Adapts the number of connections used by a server with lanes.  When
+ * a backlog builds up, another connection is taken into use, unless
+ * writing became much slower since the last increase, which suggests
+ * the destination cannot keep up, in which case the number of
+ * connections is halved.  While the queues are kept up with, unused
+ * connections are given up by halving as well.
+ */
+static void
+server_lanes_adapt(server *self)
+{
+	struct timeval tv;
+	size_t now;
+	size_t queued;
+	size_t ticks;
+	size_t metrics;
+	size_t cost;
+	int prevconns;
+	int conns;
+	int i;
+
+	if (self->lanecnt == 0)
+		return;
+	gettimeofday(&tv, NULL);
+	now = (size_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+	if (self->holduntil != 0 && server_lanes_release(self, now))
+		return;
+	if (now < self->ctlnext)
+		return;
+	self->ctlnext = now + LANE_ADAPT_TIME;
+
+	queued = queue_len(self->queue);
+	for (i = 0; i < self->lanecnt; i++)
+		queued += queue_len(self->lanes[i]->queue);
+	ticks = server_get_ticks(self);
+	metrics = server_get_metrics(self);
+	/* wall time spent per written metric, in ns */
+	cost = metrics > self->ctlmetrics ?
+		(ticks - self->ctlticks) * 1000 / (metrics - self->ctlmetrics) : 0;
+	self->ctlticks = ticks;
+	self->ctlmetrics = metrics;
+
+	conns = prevconns = __sync_add_and_fetch(&(self->conns), 0);
+	if (queued > self->bsize && queued >= self->ctlqueued) {
+		self->ctlidle = 0;
+		if (conns > 1 && self->ctlcost > 0 && cost > 2 * self->ctlcost) {
+			conns /= 2;
+		} else if (conns <= self->lanecnt) {
+			conns++;
+		}
+	} else if (queued < self->bsize) {
+		/* give up connections after 10 periods of keeping up */
+		if (++self->ctlidle >= 10 && conns > 1) {
+			conns /= 2;
+			self->ctlidle = 0;
+		}
+	} else {
+		self->ctlidle = 0;
+	}
+	self->ctlqueued = queued;
+	if (cost > 0) {
+		/* let the lowest cost slowly drift up, such that a destination
+		 * that became slower for good doesn't keep us at one connection */
+		if (self->ctlcost == 0 || cost < self->ctlcost) {
+			self->ctlcost = cost;
+		} else {
+			self->ctlcost += self->ctlcost / 16;
+		}
+	}
+
+	if (conns != prevconns)
+		server_lanes_switch(self, prevconns, conns, now);
+}
+
+/**
+ * Waits at most ms milliseconds for metrics to arrive in the queue.
+ * server_send_vector wakes us up as soon as it queues something.
+ */
+static void
+server_wait(server *self, unsigned int ms)
+{
+	struct timespec ts;
+
+	/* cond_timedwait takes the realtime clock, which is not subject to
+	 * the faked gettimeofday of relaytest */
+	clock_gettime(CLOCK_REALTIME, &ts);
+	ts.tv_sec += ms / 1000;
+	ts.tv_nsec += (long)(ms % 1000) * 1000 * 1000;
+	if (ts.tv_nsec >= 1000 * 1000 * 1000) {
+		ts.tv_sec++;
+		ts.tv_nsec -= 1000 * 1000 * 1000;
+	}
+
+	pthread_mutex_lock(&self->wakelock);
+	/* announce we're going to sleep before checking the queue, such
+	 * that an enqueue either is seen here, or sees us sleeping */
+	__sync_bool_compare_and_swap(&(self->sleeping), 0, 1);
+	if (queue_len(self->queue) == 0 &&
+			__sync_bool_compare_and_swap(&(self->keep_running), 1, 1))
+		pthread_cond_timedwait(&self->wakecond, &self->wakelock, &ts);
+	__sync_bool_compare_and_swap(&(self->sleeping), 1, 0);
+	pthread_mutex_unlock(&self->wakelock);
+}
+
+/**
+ * Returns the latency histogram bucket for us microseconds.  Below 4us
+ * buckets are exact, above each power of two is split in four.
+ */
+static inline size_t
+server_latency_bucket(size_t us)
+{
+	size_t msb;
+	size_t b;
+
+	if (us < 4)
+		return us;
+	for (msb = 2; (us >> (msb + 1)) != 0; msb++)
+		;
+	b = (msb - 1) * 4 + ((us >> (msb - 2)) & 3);
+	return b < LAT_BUCKETS ? b : LAT_BUCKETS - 1;
+}
+
+/**
+ * Returns the largest latency in microseconds that falls in bucket b.
+ */
+static inline size_t
+server_latency_value(size_t b)
+{
+	size_t msb;
+
+	if (b < 4)
+		return b;
+	msb = b / 4 + 1;
+	return ((5 + b % 4) << (msb - 2)) - 1;
+}
+
+/**
+ * Records the time between enqueue and write for the metrics of batch
+ * from position from up to to, which were written at stop.
+ */
+static void
+server_latency_add(server *self, size_t from, size_t to,
+		struct timeval *stop)
+{
+	size_t now = (size_t)stop->tv_sec * 1000 * 1000 + stop->tv_usec;
+	size_t i;
+
+	for (i = from; i < to; i++)
+		if (self->stamps[i] != 0)  /* queued while not stamped */
+			__sync_add_and_fetch(&(self->lathist[server_latency_bucket(
+							now > self->stamps[i] ?
+							now - self->stamps[i] : 0)]), 1);
+}
+
+/**
+ * Records a failed attempt to connect, and schedules the next one.
+ * Until BREAKER_FAILS attempts in a row failed, the next one is made
+ * within 200-300ms, like always.  Then the breaker opens, and the delay
+ * doubles with each failed probe, up to BACKOFF_MAX_MS.  Half of the
+ * delay is random, such that servers that went away together don't
+ * all come knocking at the same time.
+ */
+static void
+server_backoff(server *self, size_t now)
+{
+	self->connfails++;
+	if (self->breaker == BREAKER_CLOSED && self->connfails < BREAKER_FAILS) {
+		self->retryms = now + 200 + (rand() % 100);
+		return;
+	}
+	if (self->breaker == BREAKER_CLOSED) {
+		logerr("server %s:%u: %zu connects failed, backing off\n",
+				self->ip, self->port, self->connfails);
+		__sync_add_and_fetch(&(self->breakeropens), 1);
+		self->backoffms = BACKOFF_MIN_MS;
+	} else if (self->backoffms < BACKOFF_MAX_MS / 2) {
+		self->backoffms *= 2;
+	} else {
+		self->backoffms = BACKOFF_MAX_MS;
+	}
+	self->breaker = BREAKER_OPEN;
+	self->retryms = now + self->backoffms / 2 +
+		(rand() % (self->backoffms / 2 + 1));
+}
+
+/**
+ * Called when an attempt to connect is about to be made.  An open
+ * breaker goes half-open: the attempt probes whether the server is
+ * back.
+ */
+static void
+server_breaker_probe(server *self)
+{
+	if (self->breaker != BREAKER_OPEN)
+		return;
+	self->breaker = BREAKER_HALFOPEN;
+	__sync_add_and_fetch(&(self->breakerprobes), 1);
+}
+
+/**
+ * Records a successful connect, which closes the breaker.
+ */
+static void
+server_breaker_close(server *self)
+{
+	self->connfails = 0;
+	self->backoffms = 0;
+	self->retryms = 0;
+	self->breaker = BREAKER_CLOSED;
+}
+
+/**
+ * Refills the token buckets of the rate limit, and returns how many
+ * metrics may be sent now, at most a batch.  To avoid trickling out
+ * metrics one by one, nothing may be sent until a batch, or the burst
+ * if that is smaller, is available.  In that case 0 is returned, and
+ * waitms, if not NULL, is set to the time it takes to get there.  The
+ * byte bucket can go negative, since the size of metrics is only known
+ * once they are dequeued, which postpones the next batch.
+ */
+static size_t
+server_pace(server *self, size_t *waitms)
+{
+	struct timeval tv;
+	size_t now;
+	double rate = (double)self->ratemetrics;
+	double want;
+	double wait = 0.0;
+
+	gettimeofday(&tv, NULL);
+	now = (size_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+
+	/* drain a backlog at a different pace */
+	if (self->catchuprate > 0 &&
+			queue_len(self->queue) > self->catchupabove)
+		rate = (double)self->catchuprate;
+
+	if (now > self->ratems) {
+		self->tokens += rate * (now - self->ratems) / 1000.0;
+		if (self->tokens > (double)self->rateburst)
+			self->tokens = (double)self->rateburst;
+		if (self->ratebytes > 0) {
+			self->btokens +=
+				(double)self->ratebytes * (now - self->ratems) / 1000.0;
+			/* allow bytes for as many metrics as the burst allows */
+			if (self->btokens > (double)self->ratebytes *
+					self->rateburst / self->ratemetrics)
+				self->btokens = (double)self->ratebytes *
+					self->rateburst / self->ratemetrics;
+		}
+		self->ratems = now;
+	}
+
+	want = (double)(self->bsize < self->rateburst ?
+			self->bsize : self->rateburst);
+	if (self->tokens < want)
+		wait = (want - self->tokens) / rate;
+	if (self->ratebytes > 0 && self->btokens < 0.0 &&
+			-self->btokens / self->ratebytes > wait)
+		wait = -self->btokens / self->ratebytes;
+	if (wait > 0.0) {
+		if (waitms != NULL)
+			*waitms = (size_t)(wait * 1000.0) + 1;
+		return 0;
+	}
+
+	return self->tokens < (double)self->bsize ?
+		(size_t)self->tokens : self->bsize;
+}
+
+/**
+ * Takes the len metrics in batch from the token buckets.
+ */
+static void
+server_pace_spend(server *self, const char **batch, size_t len)
+{
+	size_t i;
+
+	self->tokens -= (double)len;
+	if (self->ratebytes > 0)
+		for (i = 0; i < len; i++)
+			self->btokens -= (double)*(size_t *)batch[i];
+}
+
+/**
+ * Drops the metrics from the batch of len metrics that have been queued
+ * for longer than allowed, without writing them.  The order of the
+ * remaining metrics is kept.  Returns the number of metrics left.
+ */
+static size_t
+server_expire(server *self, size_t len)
+{
+	struct timeval tv;
+	size_t cutoff;
+	size_t i;
+	size_t j;
+
+	gettimeofday(&tv, NULL);
+	cutoff = (size_t)tv.tv_sec * 1000 * 1000 + tv.tv_usec;
+	if (cutoff < self->expireus)
+		return len;
+	cutoff -= self->expireus;
+
+	for (i = 0, j = 0; i < len; i++) {
+		/* a stamp of 0 means the metric was queued while its queue
+		 * wasn't stamped, we cannot tell its age then */
+		if (self->stamps[i] != 0 && self->stamps[i] < cutoff) {
+			if (mode & MODE_DEBUG)
+				logerr("server %s:%u: expiring metric: %s",
+						self->ip, self->port,
+						self->batch[i] + sizeof(size_t));
+			free((char *)self->batch[i]);
+			continue;
+		}
+		self->batch[j] = self->batch[i];
+		self->stamps[j] = self->stamps[i];
+		j++;
+	}
+	if (j < len)
+		__sync_add_and_fetch(&(self->expired), len - j);
+
+	return j;
+}
+
+/**
+ * Drops metrics that are too old from the front of the queue while we
+ * cannot send, such that they don't take the room of fresh ones.  The
+ * metrics that are young enough go back to where they came from.
+ */
+static void
+server_expire_queue(server *self)
+{
+	size_t len;
+
+	do {
+		len = queue_dequeue_vector_stamps(self->batch, self->stamps,
+				self->queue, self->bsize);
+		if (len == 0)
+			return;
+	} while ((len = server_expire(self, len)) == 0);
+	queue_putback_vector_stamps(self->queue, self->batch, self->stamps, len);
+}
+
+/**
+ * Closes the file of this server when it is due for rotation, and moves
+ * it aside, such that the next write opens a new file.  The old file
+ * gets the time it was opened appended to its name.
+ */
+static void
+server_file_rotate(server *self)
+{
+	filebuf *fb = self->strm->fbuf;
+	char path[1024];
+	struct tm tm;
+	size_t len;
+	int i;
+
+	if (self->fd < 0 || !filebuf_rotate_due(fb))
+		return;
+
+	/* leave room for the timestamp and a sequence number */
+	if ((len = strlen(self->ip)) + 24 > sizeof(path))
+		return;
+	self->strm->strmclose(self->strm);
+	self->fd = -1;
+
+	localtime_r(&fb->opened, &tm);
+	len = snprintf(path, sizeof(path), "%s.", self->ip);
+	len += strftime(path + len, sizeof(path) - len, "%Y%m%d-%H%M%S", &tm);
+	for (i = 1; access(path, F_OK) == 0 && i < 1000; i++)
+		snprintf(path + len, sizeof(path) - len, ".%d", i);
+	if (rename(self->ip, path) != 0)
+		logerr("failed to rotate file '%s' to '%s': %s\n",
+				self->ip, path, strerror(errno));
+}
+
+/**
+ * Moves part of the queue of the secondary with the largest backlog to
+ * our own queue, which is empty.  Only secondaries with more than a
+ * batch waiting are considered, since they cannot write that in one go
+ * anyway.  The metrics are taken from the front of their queue, for
+ * the queue does not allow to take them from the end.  Returns the
+ * number of metrics taken over.
+ */
+static size_t
+server_steal(server *self)
+{
+	server *busiest = NULL;
+	size_t maxlen = self->bsize;
+	size_t qlen;
+	size_t len;
+	size_t moved;
+	size_t i;
+
+	for (i = 0; i < self->secondariescnt; i++) {
+		if (self->secondaries[i] == self)
+			continue;
+		if ((qlen = queue_len(self->secondaries[i]->queue)) > maxlen) {
+			maxlen = qlen;
+			busiest = self->secondaries[i];
+		}
+	}
+	if (busiest == NULL)
+		return 0;
+
+	/* even out the backlogs, but no more than a batch at a time */
+	len = maxlen / 2 < self->bsize ? maxlen / 2 : self->bsize;
+	len = queue_dequeue_vector_stamps(self->batch, self->stamps,
+			busiest->queue, len);
+	moved = queue_putback_vector_stamps(self->queue,
+			self->batch, self->stamps, len);
+	if (moved < len) {
+		/* we got busy ourselves in the meanwhile, return the rest */
+		i = moved + queue_putback_vector_stamps(busiest->queue,
+				&self->batch[moved], &self->stamps[moved], len - moved);
+		for (; i < len; i++) {
+			free((char *)self->batch[i]);
+			__sync_add_and_fetch(&(busiest->dropped), 1);
+		}
+	}
+	__sync_add_and_fetch(&(self->stolen), moved);
+
+	return moved;
+}
+
+/**
+ * Reads from the queue and sends items to the remote server.  This
+ * function is designed to be a thread.  Data sending is attempted to be
+ * batched.  Plain streams write a batch using vectored writes, other
+ * streams send metrics one by one to reduce loss on sending failure.
+ * A connection with the server is maintained for as long as there is
+ * data to be written.  As soon as there is none, the connection is
+ * dropped if a timeout of DISCONNECT_WAIT_TIME exceeds.
+ */
+static void *
+server_queuereader(void *d)
+{
+	server *self = (server *)d;
+	size_t len;
+	ssize_t slen;
+	const char **metric = self->batch;
+	struct timeval start, stop;
+	struct timeval timeout;
+	struct timeval lastflush;
+	queue *squeue;
+	char idle = 0;
+	char attempted = 0;  /* connect tried, outcome not yet known */
+	size_t *secpos = NULL;
+	unsigned char cnt;
+	const char *p;
+
+	*metric = NULL;
+	gettimeofday(&lastflush, NULL);
+
+	self->running = 1;
+	while (1) {
+		/* close connection when we're asked to reopen */
+		if (__sync_bool_compare_and_swap(&(self->reopen_con), 1, 0)) {
+			self->strm->strmclose(self->strm);
+			self->fd = -1;
+		}
+		server_lanes_adapt(self);
+		if (__sync_bool_compare_and_swap(&(self->held), 1, 1) &&
+				__sync_bool_compare_and_swap(&(self->keep_running), 1, 1))
+		{
+			/* let the other connections write the values they still
+			 * have for the metric names we took over first */
+			usleep((20 + (rand() % 30)) * 1000);  /* 20ms - 50ms */
+			continue;
+		}
+		if (self->spool != NULL && spool_len(self->spool) > 0 &&
+				(len = queue_len(self->queue)) < self->bsize)
+			server_replay(self, self->bsize - len);
+		if (queue_len(self->queue) == 0) {
+			/* if we're idling, close the TCP connection, this allows us
+			 * to reduce connections, while keeping the connection alive
+			 * if we're writing a lot */
+			gettimeofday(&start, NULL);
+			if (self->ctype == CON_TCP && self->fd >= 0 &&
+					!(sslkeepalive && (self->transport & W_SSL)) &&
+					idle++ > DISCONNECT_WAIT_TIME)
+			{
+				self->strm->strmclose(self->strm);
+				self->fd = -1;
+			}
+			if (idle == 1) {
+				/* ensure blocks are pushed out as soon as we're idling,
+				 * this allows compressors to benefit from a larger
+				 * stream of data to gain better compression */
+				self->strm->strmflush(self->strm);
+				lastflush = start;
+			} else if (self->ctype == CON_FILE && self->fd >= 0) {
+				/* files may still have a sync pending */
+				self->strm->strmflush(self->strm);
+			}
+			if (self->ctype == CON_FILE)
+				server_file_rotate(self);
+			gettimeofday(&stop, NULL);
+			__sync_add_and_fetch(&(self->ticks), timediff(start, stop));
+			if (__sync_bool_compare_and_swap(&(self->keep_running), 0, 0))
+				break;
+			/* help out a busy member of our cluster, if we can */
+			if (self->steal &&
+					__sync_bool_compare_and_swap(&(self->failure), 0, 0) &&
+					server_steal(self) > 0)
+				continue;
+			/* nothing to do, so wait for a bit, or until we get
+			 * something to send */
+			server_wait(self, 200 + (rand() % 100));  /* 200ms - 300ms */
+			/* if we are in failure mode, keep checking if we can
+			 * connect, this avoids unnecessary queue moves */
+			if (__sync_bool_compare_and_swap(&(self->failure), 0, 0))
+				/* it makes no sense to try and do something, so skip */
+				continue;
+		} else if (self->secondariescnt > 0 &&
+				(__sync_add_and_fetch(&(self->failure), 0) >= FAIL_WAIT_TIME ||
+				 (!self->failover && LEN_CRITICAL(self->queue))))
+		{
+			size_t i;
+			size_t moved;
+
+			gettimeofday(&start, NULL);
+			if (self->secondariescnt > 0) {
+				if (secpos == NULL) {
+					secpos = malloc(sizeof(size_t) * self->secondariescnt);
+					if (secpos == NULL) {
+						logerr("server: failed to allocate memory "
+								"for secpos\n");
+						gettimeofday(&stop, NULL);
+						__sync_add_and_fetch(&(self->ticks),
+								timediff(start, stop));
+						continue;
+					}
+					for (i = 0; i < self->secondariescnt; i++)
+						secpos[i] = i;
+				}
+				if (!self->failover) {
+					/* randomise the failover list such that in the
+					 * grand scheme of things we don't punish the first
+					 * working server in the list to deal with all
+					 * traffic meant for a now failing server */
+					for (i = 0; i < self->secondariescnt; i++) {
+						size_t n = rand() % (self->secondariescnt - i);
+						if (n != i) {
+							size_t t = secpos[n];
+							secpos[n] = secpos[i];
+							secpos[i] = t;
+						}
+					}
+				}
+			}
+
+			/* offload data from our queue to our secondaries
+			 * when doing so, observe the following:
+			 * - avoid nodes that are in failure mode
+			 * - avoid nodes which queues are >= critical_len
+			 * when no nodes remain given the above
+			 * - send to nodes which queue size < critical_len
+			 * where there are no such nodes
+			 * - do nothing (we will overflow, since we can't send
+			 *   anywhere) */
+			*metric = NULL;
+			squeue = NULL;
+			for (i = 0; i < self->secondariescnt; i++) {
+				/* both conditions below make sure we skip ourself */
+				if (__sync_add_and_fetch(
+							&(self->secondaries[secpos[i]]->failure), 0))
+					continue;
+				squeue = self->secondaries[secpos[i]]->queue;
+				if (!self->failover && LEN_CRITICAL(squeue)) {
+					squeue = NULL;
+					continue;
+				}
+				if (*metric == NULL) {
+					/* send up to batch size of our queue to this queue */
+					len = queue_dequeue_vector_stamps(self->batch,
+							self->stamps, self->queue, self->bsize);
+					self->batch[len] = NULL;
+					metric = self->batch;
+				}
+
+				/* move what fits in one go, and try to put back what
+				 * didn't fit, keeping the order and age of the metrics */
+				for (len = 0; metric[len] != NULL; len++)
+					;
+				moved = queue_putback_vector_stamps(squeue, metric,
+						self->stamps + (metric - self->batch), len);
+				metric += moved;
+				metric += queue_putback_vector_stamps(self->queue, metric,
+						self->stamps + (metric - self->batch), len - moved);
+			}
+			for (; *metric != NULL; metric++) {
+				if (mode & MODE_DEBUG)
+					logerr("dropping metric: %s", *metric);
+				free((char *)*metric);
+				__sync_add_and_fetch(&(self->dropped), 1);
+			}
+			gettimeofday(&stop, NULL);
+			__sync_add_and_fetch(&(self->ticks),
+					timediff(start, stop));
+			if (squeue == NULL) {
+				/* we couldn't do anything, take it easy for a bit */
+				if (__sync_add_and_fetch(&(self->failure), 0) > 1) {
+					/* This is a compound because I can't seem to figure
+					 * out how to atomically just "set" a variable.
+					 * It's not bad when in the middle there is a ++,
+					 * all that counts is that afterwards its > 0. */
+					__sync_and_and_fetch(&(self->failure), 0);
+					__sync_add_and_fetch(&(self->failure), 1);
+				}
+				if (__sync_bool_compare_and_swap(&(self->keep_running), 0, 0))
+					break;
+				usleep((200 + (rand() % 100)) * 1000);  /* 200ms - 300ms */
+			}
+		} else if (__sync_add_and_fetch(&(self->failure), 0) > 0) {
+			if (__sync_bool_compare_and_swap(&(self->keep_running), 0, 0))
+				break;
+			usleep((200 + (rand() % 100)) * 1000);  /* 200ms - 300ms */
+			/* avoid overflowing */
+			if (__sync_add_and_fetch(&(self->failure), 0) > FAIL_WAIT_TIME)
+				__sync_sub_and_fetch(&(self->failure), 1);
+		}
+
+		/* at this point we've got work to do, if we're instructed to
+		 * shut down, however, try to get everything out of the door
+		 * (until we fail, see top of this loop) */
+
+		gettimeofday(&start, NULL);
 
 		/* try to connect */
 		if (self->fd < 0) {
+			size_t now = (size_t)start.tv_sec * 1000 + start.tv_usec / 1000;
+
+			/* the previous attempt didn't get us a connection */
+			if (attempted)
+				server_backoff(self, now);
+			attempted = 0;
+			if (now < self->retryms) {
+				/* don't even try while backing off */
+				if (self->expireus > 0)
+					server_expire_queue(self);
+				usleep((self->retryms - now < 100 ?
+							self->retryms - now : 100) * 1000);
+				continue;
+			}
+			server_breaker_probe(self);
+			attempted = 1;
+
 			if (self->reresolve) {  /* can only be CON_UDP/CON_TCP */
 				struct addrinfo *saddr;
 				char sport[8];
 
-				/* re-lookup the address info, if it fails, stay with
-				 * whatever we have such that resolution errors incurred
-				 * after starting the relay won't make it fail */
-				if (self->saddr)
-					freeaddrinfo(self->saddr);
-				snprintf(sport, sizeof(sport), "%u", self->port);
-				if (getaddrinfo(self->ip, sport, self->hint, &saddr) == 0) {
-					self->saddr = saddr;
-				} else {
-					if (__sync_fetch_and_add(&(self->failure), 1) == 0)
-						logerr("failed to resolve %s:%u, server unavailable\n",
-								self->ip, self->port);
-					self->saddr = NULL;
-					/* this will break out below */
-				}
+				/* re-lookup the address info, if it fails, stay with
+				 * whatever we have such that resolution errors incurred
+				 * after starting the relay won't make it fail */
+				if (self->saddr)
+					freeaddrinfo(self->saddr);
+				snprintf(sport, sizeof(sport), "%u", self->port);
+				if (getaddrinfo(self->ip, sport, self->hint, &saddr) == 0) {
+					self->saddr = saddr;
+				} else {
+					if (__sync_fetch_and_add(&(self->failure), 1) == 0)
+						logerr("failed to resolve %s:%u, server unavailable\n",
+								self->ip, self->port);
+					self->saddr = NULL;
+					/* this will break out below */
+				}
+			}
+
+			if (self->ctype == CON_PIPE) {
+				int intconn[2];
+				if (pipe(intconn) < 0) {
+					if (__sync_fetch_and_add(&(self->failure), 1) == 0)
+						logerr("failed to create pipe: %s\n", strerror(errno));
+					continue;
+				}
+				dispatch_addconnection(intconn[0], NULL);
+				self->fd = intconn[1];
+			} else if (self->ctype == CON_FILE) {
+				if ((self->fd = open(self->ip,
+								O_WRONLY | O_APPEND | O_CREAT,
+								S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH)) < 0)
+				{
+					if (__sync_fetch_and_add(&(self->failure), 1) == 0)
+						logerr("failed to open file '%s': %s\n",
+								self->ip, strerror(errno));
+					continue;
+				}
+				filebuf_open(self->strm, self->fd);
+			} else if (self->ctype == CON_UDP) {
+				struct addrinfo *walk;
+
+				for (walk = self->saddr; walk != NULL; walk = walk->ai_next) {
+					if ((self->fd = socket(walk->ai_family,
+									walk->ai_socktype,
+									walk->ai_protocol)) < 0)
+					{
+						if (walk->ai_next == NULL &&
+								__sync_fetch_and_add(&(self->failure), 1) == 0)
+							logerr("failed to create udp socket: %s\n",
+									strerror(errno));
+						continue;
+					}
+					if (connect(self->fd, walk->ai_addr, walk->ai_addrlen) < 0)
+					{
+						if (walk->ai_next == NULL &&
+								__sync_fetch_and_add(&(self->failure), 1) == 0)
+							logerr("failed to connect udp socket: %s\n",
+									strerror(errno));
+						close(self->fd);
+						self->fd = -1;
+						continue;
+					}
+
+					/* we made it up here, so this connection is usable */
+					break;
+				}
+				/* if this didn't resolve to anything, treat as failure */
+				if (self->saddr == NULL)
+					__sync_add_and_fetch(&(self->failure), 1);
+				/* if all addrinfos failed, try again later */
+				if (self->fd < 0)
+					continue;
+			} else {  /* CON_TCP */
+				int ret;
+				int args;
+				struct addrinfo *walk;
+
+				for (walk = self->saddr; walk != NULL; walk = walk->ai_next) {
+					if ((self->fd = socket(walk->ai_family,
+									walk->ai_socktype,
+									walk->ai_protocol)) < 0)
+					{
+						if (walk->ai_next == NULL &&
+								__sync_fetch_and_add(&(self->failure), 1) == 0)
+							logerr("failed to create socket: %s\n",
+									strerror(errno));
+						continue;
+					}
+
+					/* put socket in non-blocking mode such that we can
+					 * poll() (time-out) on the connect() call */
+					args = fcntl(self->fd, F_GETFL, NULL);
+					if (fcntl(self->fd, F_SETFL, args | O_NONBLOCK) < 0) {
+						logerr("failed to set socket non-blocking mode: %s\n",
+								strerror(errno));
+						close(self->fd);
+						self->fd = -1;
+						continue;
+					}
+					ret = connect(self->fd, walk->ai_addr, walk->ai_addrlen);
+
+					if (ret < 0 && errno == EINPROGRESS) {
+						/* wait for connection to succeed if the OS thinks
+						 * it can succeed */
+						struct pollfd ufds[1];
+						ufds[0].fd = self->fd;
+						ufds[0].events = POLLIN | POLLOUT;
+						ret = poll(ufds, 1, self->iotimeout + (rand() % 100));
+						if (ret == 0) {
+							/* time limit expired */
+							if (walk->ai_next == NULL &&
+									__sync_fetch_and_add(
+										&(self->failure), 1) == 0)
+								logerr("failed to connect() to "
+										"%s:%u: Operation timed out\n",
+										self->ip, self->port);
+							close(self->fd);
+							self->fd = -1;
+							continue;
+						} else if (ret < 0) {
+							/* some select error occurred */
+							if (walk->ai_next &&
+									__sync_fetch_and_add(
+										&(self->failure), 1) == 0)
+								logerr("failed to poll() for %s:%u: %s\n",
+										self->ip, self->port, strerror(errno));
+							close(self->fd);
+							self->fd = -1;
+							continue;
+						} else {
+							if (ufds[0].revents & POLLHUP) {
+								if (walk->ai_next == NULL &&
+										__sync_fetch_and_add(
+											&(self->failure), 1) == 0)
+									logerr("failed to connect() for %s:%u: "
+											"Connection refused\n",
+											self->ip, self->port);
+								close(self->fd);
+								self->fd = -1;
+								continue;
+							}
+						}
+					} else if (ret < 0) {
+						if (walk->ai_next == NULL &&
+								__sync_fetch_and_add(&(self->failure), 1) == 0)
+						{
+							logerr("failed to connect() to %s:%u: %s\n",
+									self->ip, self->port, strerror(errno));
+							dispatch_check_rlimit_and_warn();
+						}
+						close(self->fd);
+						self->fd = -1;
+						continue;
+					}
+
+					/* make socket blocking again */
+					if (fcntl(self->fd, F_SETFL, args) < 0) {
+						logerr("failed to remove socket non-blocking "
+								"mode: %s\n", strerror(errno));
+						close(self->fd);
+						self->fd = -1;
+						continue;
+					}
+
+					/* disable Nagle's algorithm, issue #208 */
+					args = 1;
+					if (setsockopt(self->fd, IPPROTO_TCP, TCP_NODELAY,
+								&args, sizeof(args)) != 0)
+						; /* ignore */
+
+#ifdef TCP_USER_TIMEOUT
+					/* break out of connections when no ACK is being
+					 * received for +- 10 seconds instead of
+					 * retransmitting for +- 15 minutes available on
+					 * linux >= 2.6.37
+					 * the 10 seconds is in line with the SO_SNDTIMEO
+					 * set on the socket below */
+					args = 10000 + (rand() % 300);
+					if (setsockopt(self->fd, IPPROTO_TCP, TCP_USER_TIMEOUT,
+								&args, sizeof(args)) != 0)
+						; /* ignore */
+#endif
+
+					/* if we reached up here, we're good to go, so don't
+					 * continue with the other addrinfos */
+					break;
+				}
+				/* if this didn't resolve to anything, treat as failure */
+				if (self->saddr == NULL)
+					__sync_add_and_fetch(&(self->failure), 1);
+				/* all available addrinfos failed on us */
+				if (self->fd < 0)
+					continue;
+			}
+
+			/* ensure we will break out of connections being stuck more
+			 * quickly than the kernel would give up */
+			timeout.tv_sec = 10;
+			timeout.tv_usec = (rand() % 300) * 1000;
+			if (setsockopt(self->fd, SOL_SOCKET, SO_SNDTIMEO,
+						&timeout, sizeof(timeout)) != 0)
+				; /* ignore */
+			if (self->sockbufsize > 0)
+				if (setsockopt(self->fd, SOL_SOCKET, SO_SNDBUF,
+							&self->sockbufsize, sizeof(self->sockbufsize)) != 0)
+					; /* ignore */
+#ifdef SO_NOSIGPIPE
+			if (self->ctype == CON_TCP || self->ctype == CON_UDP) {
+				int enable = 1;
+				if (setsockopt(self->fd, SOL_SOCKET, SO_NOSIGPIPE,
+							(void *)&enable, sizeof(enable)) != 0)
+					logout("warning: failed to ignore SIGPIPE on socket: %s\n",
+							strerror(errno));
+			}
+#endif
+
+#ifdef HAVE_GZIP
+			if ((self->transport & 0xFFFF) == W_GZIP && compressors > 0) {
+				/* the compressors bring their own deflate state */
+				self->strm->hdl.gz = NULL;
+				self->strm->jobprev = NULL;
+				self->strm->obuflen = 0;
+			} else if ((self->transport & 0xFFFF) == W_GZIP) {
+				self->strm->hdl.gz = malloc(sizeof(z_stream));
+				if (self->strm->hdl.gz != NULL) {
+					self->strm->hdl.gz->zalloc = Z_NULL;
+					self->strm->hdl.gz->zfree = Z_NULL;
+					self->strm->hdl.gz->opaque = Z_NULL;
+					self->strm->hdl.gz->next_in = Z_NULL;
+				}
+				if (self->strm->hdl.gz == NULL ||
+						deflateInit2(self->strm->hdl.gz,
+							Z_DEFAULT_COMPRESSION,
+							Z_DEFLATED,
+							15 + 16,
+							8,
+							Z_DEFAULT_STRATEGY) != Z_OK)
+				{
+					logerr("failed to open gzip stream: out of memory\n");
+					close(self->fd);
+					self->fd = -1;
+					continue;
+				}
+				self->strm->obuflen = 0;
+			}
+#endif
+#ifdef HAVE_LZ4
+			if ((self->transport & 0xFFFF) == W_LZ4) {
+				self->strm->obuflen = 0;
+
+				/* get the maximum size that should ever be required and allocate for it */
+
+				self->strm->hdl.z.cbuflen = LZ4F_compressFrameBound(sizeof(self->strm->obuf), NULL);
+				if ((self->strm->hdl.z.cbuf = malloc(self->strm->hdl.z.cbuflen)) == NULL) {
+					logerr("Failed to allocate %lu bytes for compressed LZ4 data\n", self->strm->hdl.z.cbuflen);
+					close(self->fd);
+					self->fd = -1;
+					continue;
+				}
+			}
+#endif
+#ifdef HAVE_SNAPPY
+			if ((self->transport & 0xFFFF) == W_SNAPPY) {
+				self->strm->obuflen = 0;
+			}
+#endif
+#ifdef HAVE_ZSTD
+			if ((self->transport & 0xFFFF) == W_ZSTD) {
+				/* start a new frame, level and dictionary are kept */
+				ZSTD_CCtx_reset(self->strm->hdl.zstd,
+						ZSTD_reset_session_only);
+				self->strm->obuflen = 0;
+			}
+#endif
+
+#ifdef HAVE_SSL
+			if (self->transport & W_SSL) {
+				int rv;
+				z_strm *sstrm;
+
+				if ((self->transport & 0xFFFF) == W_PLAIN) {
+ 					/* just SSL, nothing else */
+					sstrm = self->strm;
+				} else {
+					sstrm = self->strm->nextstrm;
+				}
+
+				sstrm->hdl.ssl = SSL_new(sstrm->ctx);
+				sstrm->sslfailed = 0;
+				SSL_set_tlsext_host_name(sstrm->hdl.ssl, self->ip);
+				SSL_set_app_data(sstrm->hdl.ssl, sstrm);
+				/* try to resume the previous session to avoid the
+				 * cost of a full handshake */
+				if (sstrm->sess != NULL)
+					SSL_set_session(sstrm->hdl.ssl, sstrm->sess);
+				if (SSL_set_fd(sstrm->hdl.ssl, self->fd) == 0) {
+					logerr("failed to SSL_set_fd: %s\n",
+							ERR_reason_error_string(ERR_get_error()));
+					sstrm->strmclose(sstrm);
+					self->fd = -1;
+					continue;
+				}
+				if (self->transport & W_MTLS) {
+					int ret;
+
+					/* issue #444 */
+					ret = SSL_use_certificate_chain_file(sstrm->hdl.ssl, self->mtlspemcert);
+					if (ret == 1) {
+						ret = SSL_use_PrivateKey_file(sstrm->hdl.ssl,
+													  self->mtlspemkey,
+													  SSL_FILETYPE_PEM);
+					}
+
+					if (ret != 1) {
+						logerr("failed to enable mTLS: %s\n",
+							   sslerror(sstrm, ret));
+						sstrm->strmclose(sstrm);
+						self->fd = -1;
+						continue;
+					}
+				}
+				if ((rv = SSL_connect(sstrm->hdl.ssl)) != 1) {
+					logerr("failed to connect ssl stream: %s\n",
+							sslerror(sstrm, rv));
+					sstrm->strmclose(sstrm);
+					self->fd = -1;
+					/* don't insist on a session that may be the cause */
+					if (sstrm->sess != NULL) {
+						SSL_SESSION_free(sstrm->sess);
+						sstrm->sess = NULL;
+					}
+					continue;
+				}
+				if ((rv = SSL_get_verify_result(sstrm->hdl.ssl)) != X509_V_OK) {
+					logerr("failed to verify ssl certificate: %s\n",
+							sslerror(sstrm, rv));
+					sstrm->strmclose(sstrm);
+					self->fd = -1;
+					continue;
+				}
+				if (SSL_session_reused(sstrm->hdl.ssl)) {
+					__sync_add_and_fetch(&(self->sslresumed), 1);
+				} else {
+					__sync_add_and_fetch(&(self->sslfull), 1);
+				}
+#ifdef BIO_get_ktls_send
+				/* if the kernel took over, batches can bypass SSL_write,
+				 * OpenSSL falls back to userspace when it didn't */
+				if (BIO_get_ktls_send(SSL_get_wbio(sstrm->hdl.ssl))) {
+					__sync_add_and_fetch(&(self->ktls), 1);
+					sstrm->strmwritev = &sslktlswritev;
+				} else
+#endif
+				{
+					sstrm->strmwritev = NULL;
+				}
+			} else
+#endif
+			{
+				z_strm *pstrm;
+
+				if (self->transport == W_PLAIN) { /* just plain socket */
+					pstrm = self->strm;
+				} else {
+					pstrm = self->strm->nextstrm;
+				}
+				pstrm->hdl.sock = self->fd;
+			}
+			attempted = 0;
+			server_breaker_close(self);
+		}
+
+		/* send up to batch size, or what the rate limit allows */
+		len = self->bsize;
+		if (self->ratemetrics > 0) {
+			size_t waitms;
+
+			if ((len = server_pace(self, &waitms)) == 0) {
+				if (__sync_bool_compare_and_swap(&(self->keep_running), 0, 0))
+					logerr("shutting down %s:%u: pacing %zu metrics\n",
+							self->ip, self->port, queue_len(self->queue));
+				usleep((waitms < 250 ? waitms : 250) * 1000);
+				continue;
+			}
+		}
+		len = queue_dequeue_vector_stamps(self->batch, self->stamps,
+				self->queue, len);
+		if (self->expireus > 0 && len > 0 &&
+				(len = server_expire(self, len)) == 0)
+			continue;  /* all of it was too old, try the next batch */
+		if (self->ratemetrics > 0)
+			server_pace_spend(self, self->batch, len);
+		self->batch[len] = NULL;
+		metric = self->batch;
+		self->batchmark = server_lane_progress(self) + len;
+
+		if (len != 0 &&
+				__sync_bool_compare_and_swap(&(self->keep_running), 0, 0))
+		{
+			/* be noisy during shutdown so we can track any slowing down
+			 * servers, possibly preventing us to shut down */
+			logerr("shutting down %s:%u: waiting for %zu metrics\n",
+					self->ip, self->port, len + queue_len(self->queue));
+		}
+
+		if (len == 0 && __sync_add_and_fetch(&(self->failure), 0)) {
+			/* if we don't have anything to send, we have at least a
+			 * connection succeed, so assume the server is up again,
+			 * this is in particular important for recovering this
+			 * node by probes, to avoid starvation of this server since
+			 * its queue is possibly being offloaded to secondaries */
+			if (self->ctype != CON_UDP)
+				logerr("server %s:%u: OK after probe\n", self->ip, self->port);
+			__sync_and_and_fetch(&(self->failure), 0);
+		}
+
+		if (self->type == T_PICKLE) {
+			if (*metric != NULL) {
+				slen = server_pickle_batch(self, &metric);
+				if (*metric != NULL) {
+					server_putback_batch(self, metric, slen);
+				} else if (!__sync_bool_compare_and_swap(
+							&(self->failure), 0, 0))
+				{
+					logerr("server %s:%u: OK\n", self->ip, self->port);
+					__sync_and_and_fetch(&(self->failure), 0);
+				}
+			}
+		} else if (self->ctype == CON_UDP && self->transport == W_PLAIN) {
+			/* packing writes to the socket directly, so it cannot pass
+			 * through a compressing or encrypting stream */
+			if (*metric != NULL) {
+				if (server_udp_batch(self, &metric) < 0)
+					server_putback_batch(self, metric, -1);
+				else
+					__sync_and_and_fetch(&(self->failure), 0);
+			}
+		} else if (self->strm->strmwritev != NULL) {
+			/* plain (or kernel encrypted) streams: gather the batch so
+			 * it can be written using as few system calls as possible */
+			if (*metric != NULL) {
+				slen = server_writev_batch(self, &metric);
+				if (*metric != NULL) {
+					server_putback_batch(self, metric, slen);
+				} else if (!__sync_bool_compare_and_swap(
+							&(self->failure), 0, 0))
+				{
+					logerr("server %s:%u: OK\n", self->ip, self->port);
+					__sync_and_and_fetch(&(self->failure), 0);
+				}
+			}
+		} else {
+			for (; *metric != NULL; metric++) {
+				len = *(size_t *)(*metric);
+				/* Write to the stream, this may not succeed completely due
+				 * to flow control and whatnot, which the docs suggest need
+				 * resuming to complete.  So, use a loop, but to avoid
+				 * getting endlessly stuck on this, only try a limited
+				 * number of times for a single metric. */
+				for (cnt = 0, p = *metric + sizeof(size_t); cnt < 10; cnt++) {
+					if ((slen = self->strm->strmwrite(self->strm, p, len)) != len) {
+						if (slen >= 0) {
+							p += slen;
+							len -= slen;
+						} else if (errno != EINTR) {
+							break;
+						}
+						/* allow the remote to catch up */
+						usleep((50 + (rand() % 150)) * 1000);  /* 50ms - 200ms */
+					} else {
+						break;
+					}
+				}
+				if (slen != len) {
+					/* not fully sent (after tries), or failure
+					 * close connection regardless so we don't get
+					 * synchonisation problems */
+					server_putback_batch(self, metric, slen);
+					break;
+				} else if (!__sync_bool_compare_and_swap(&(self->failure), 0, 0)) {
+					if (self->ctype != CON_UDP)
+						logerr("server %s:%u: OK\n", self->ip, self->port);
+					__sync_and_and_fetch(&(self->failure), 0);
+				}
+				free((char *)*metric);
+				__sync_add_and_fetch(&(self->metrics), 1);
+			}
+		}
+
+		if (self->ctype == CON_FILE)
+			server_file_rotate(self);
+
+		gettimeofday(&stop, NULL);
+		server_latency_add(self, 0, metric - self->batch, &stop);
+
+		/* don't let compressors hold on to data for longer than
+		 * allowed when we never get to idle */
+		if (maxflush > 0 && self->fd >= 0 &&
+				timediff(lastflush, stop) >= (size_t)maxflush * 1000)
+		{
+			self->strm->strmflush(self->strm);
+			lastflush = stop;
+		}
+
+		gettimeofday(&stop, NULL);
+		__sync_add_and_fetch(&(self->ticks), timediff(start, stop));
+
+		idle = 0;
+	}
+	__sync_and_and_fetch(&(self->running), 0);
+
+	if (self->fd >= 0)
+		self->strm->strmclose(self->strm);
+	if (self->ctype == CON_FILE &&
+			(len = filebuf_discard(self->strm->fbuf)) > 0)
+	{
+		logerr("server %s:%u: dropping %zu metrics that could not be "
+				"written\n", self->ip, self->port, len);
+		__sync_add_and_fetch(&(self->dropped), len);
+	}
+	if (secpos != NULL)
+		free(secpos);
+	return NULL;
+}
+
+/* Plain TCP servers that don't need any of the features above, such as
+ * compression, SSL or offloading to secondaries, can be handled by a
+ * pool of sender threads instead of a thread each.  A sender thread
+ * takes care of many servers using non-blocking sockets, and only
+ * waits in poll() for sockets to become writable, or for a wakeup
+ * from server_send_vector.  It only steps the servers that poll()
+ * flagged, that were woken, or whose timer is due.  Since
+ * getaddrinfo() may block, each pool has a resolver thread that looks
+ * up addresses for the sender. */
+typedef struct _server_pool {
+	pthread_t tid;
+	pthread_t rtid;     /* resolver */
+	int wakefd[2];      /* self-pipe to interrupt poll() */
+	char wakeup;        /* full byte for atomic access */
+	char keep_running;  /* full byte for atomic access */
+	pthread_mutex_t lock;
+	pthread_cond_t resolvecond;
+	server *resolvehead;
+	server *resolvetail;
+	server **srvs;
+	size_t srvscnt;
+	size_t srvssize;
+} server_pool;
+
+static server_pool *pools = NULL;
+static int poolcnt = 0;
+static int poolnext = 0;
+
+#define POOL_TICK  250  /* ms, interval for retries and idle checks */
+
+static inline size_t
+server_pool_ms(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return (size_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+/**
+ * Interrupts the poll() of the sender thread of pool, unless a wakeup
+ * is pending already.
+ */
+static inline void
+server_pool_wake(server_pool *pool)
+{
+	if (__sync_bool_compare_and_swap(&(pool->wakeup), 0, 1))
+		if (write(pool->wakefd[1], "", 1) < 0)
+			;  /* pipe full, a wakeup is pending anyway */
+}
+
+static void
+server_pool_close(server *self)
+{
+	if (self->fd >= 0)
+		close(self->fd);
+	self->fd = -1;
+	self->connecting = 0;
+	self->blocked = 0;
+}
+
+/**
+ * Puts back the metrics of the batch that weren't (completely) sent.
+ * Metrics that don't fit the queue any more are dropped.
+ */
+static void
+server_pool_putback(server *self)
+{
+	size_t len;
+
+	if (self->pending == NULL)
+		return;
+	for (len = 0; self->pending[len] != NULL; len++)
+		;
+	self->pending += queue_putback_vector_stamps(self->queue, self->pending,
+			self->stamps + (self->pending - self->batch), len);
+	for (; *self->pending != NULL; self->pending++) {
+		if (mode & MODE_DEBUG)
+			logerr("server %s:%u: dropping metric: %s",
+					self->ip, self->port,
+					*self->pending + sizeof(size_t));
+		free((char *)*self->pending);
+		__sync_add_and_fetch(&(self->dropped), 1);
+	}
+	self->pending = NULL;
+	self->pendoff = 0;
+}
+
+/**
+ * Flags the server failed, and schedules the next attempt to connect.
+ */
+static void
+server_pool_fail(server *self, const char *op, const char *err, size_t now)
+{
+	if (__sync_fetch_and_add(&(self->failure), 1) == 0)
+		logerr("failed to %s() to %s:%u: %s\n",
+				op, self->ip, self->port, err);
+	/* avoid overflowing */
+	if (__sync_add_and_fetch(&(self->failure), 0) > FAIL_WAIT_TIME)
+		__sync_sub_and_fetch(&(self->failure), 1);
+	server_pool_close(self);
+	server_pool_putback(self);
+	self->cwalk = NULL;
+	server_backoff(self, now);
+}
+
+/**
+ * Attempts to connect to the address at cwalk, moving on to the next
+ * address when that fails immediately.  When no attempt is in
+ * progress, the addresses are (re)resolved first.  Since that can
+ * block, it is left to server_pool_resolver, and the connect is
+ * attempted once the server is stepped after that finished.
+ * Called holding the pool lock.
+ */
+static void
+server_pool_connect(server *self, size_t now)
+{
+	server_pool *pool = self->pool;
+	int err = 0;
+	int args;
+
+	if (self->cwalk == NULL) {
+		if (self->reresolve) {
+			self->resolving = 1;
+			self->resolvenext = NULL;
+			if (pool->resolvetail == NULL) {
+				pool->resolvehead = self;
+			} else {
+				pool->resolvetail->resolvenext = self;
+			}
+			pool->resolvetail = self;
+			pthread_cond_signal(&pool->resolvecond);
+			return;
+		}
+		self->cwalk = self->saddr;
+	}
+
+	for (; self->cwalk != NULL; self->cwalk = self->cwalk->ai_next) {
+		struct addrinfo *walk = self->cwalk;
+
+		if ((self->fd = socket(walk->ai_family,
+						walk->ai_socktype, walk->ai_protocol)) < 0)
+		{
+			err = errno;
+			continue;
+		}
+		args = fcntl(self->fd, F_GETFL, NULL);
+		if (fcntl(self->fd, F_SETFL, args | O_NONBLOCK) < 0) {
+			err = errno;
+			server_pool_close(self);
+			continue;
+		}
+
+		/* disable Nagle's algorithm, issue #208 */
+		args = 1;
+		if (setsockopt(self->fd, IPPROTO_TCP, TCP_NODELAY,
+					&args, sizeof(args)) != 0)
+			; /* ignore */
+#ifdef TCP_USER_TIMEOUT
+		args = 10000 + (rand() % 300);
+		if (setsockopt(self->fd, IPPROTO_TCP, TCP_USER_TIMEOUT,
+					&args, sizeof(args)) != 0)
+			; /* ignore */
+#endif
+		if (self->sockbufsize > 0)
+			if (setsockopt(self->fd, SOL_SOCKET, SO_SNDBUF,
+						&self->sockbufsize, sizeof(self->sockbufsize)) != 0)
+				; /* ignore */
+#ifdef SO_NOSIGPIPE
+		args = 1;
+		if (setsockopt(self->fd, SOL_SOCKET, SO_NOSIGPIPE,
+					(void *)&args, sizeof(args)) != 0)
+			; /* ignore */
+#endif
+
+		self->lastms = now;
+		if (connect(self->fd, walk->ai_addr, walk->ai_addrlen) == 0) {
+			self->cwalk = NULL;
+			self->strm->hdl.sock = self->fd;
+			server_breaker_close(self);
+			return;
+		}
+		if (errno == EINPROGRESS) {
+			/* server_pool_connected finishes this */
+			self->connecting = 1;
+			return;
+		}
+		err = errno;
+		server_pool_close(self);
+	}
+
+	server_pool_fail(self, "connect",
+			err == 0 ? "no address" : strerror(err), now);
+	if (err == EMFILE)
+		dispatch_check_rlimit_and_warn();
+}
+
+/**
+ * Resolver thread of a pool, looks up the addresses of the servers
+ * server_pool_connect hands it, and wakes the sender for each of them
+ * when done.  A server cannot go away while it is being resolved,
+ * since server_pool_step doesn't stop it before that finished.
+ */
+static void *
+server_pool_resolver(void *d)
+{
+	server_pool *pool = (server_pool *)d;
+	struct addrinfo *saddr;
+	char sport[8];
+	server *s;
+
+	pthread_mutex_lock(&pool->lock);
+	while (__sync_bool_compare_and_swap(&(pool->keep_running), 1, 1)) {
+		if ((s = pool->resolvehead) == NULL) {
+			pthread_cond_wait(&pool->resolvecond, &pool->lock);
+			continue;
+		}
+		if ((pool->resolvehead = s->resolvenext) == NULL)
+			pool->resolvetail = NULL;
+		pthread_mutex_unlock(&pool->lock);
+
+		snprintf(sport, sizeof(sport), "%u", s->port);
+		if (getaddrinfo(s->ip, sport, s->hint, &saddr) != 0)
+			saddr = NULL;
+
+		pthread_mutex_lock(&pool->lock);
+		if (s->saddr)
+			freeaddrinfo(s->saddr);
+		s->saddr = saddr;
+		s->resolving = 2;
+		__sync_bool_compare_and_swap(&(s->woken), 0, 1);
+		server_pool_wake(pool);
+	}
+	pthread_mutex_unlock(&pool->lock);
+
+	return NULL;
+}
+
+/**
+ * Completes a connect that was in progress, after poll() flagged the
+ * socket.
+ */
+static void
+server_pool_connected(server *self, size_t now)
+{
+	int err = 0;
+	socklen_t len = sizeof(err);
+
+	if (getsockopt(self->fd, SOL_SOCKET, SO_ERROR, &err, &len) != 0)
+		err = errno;
+	if (err == 0) {
+		self->connecting = 0;
+		self->cwalk = NULL;
+		self->strm->hdl.sock = self->fd;
+		server_breaker_close(self);
+		return;
+	}
+
+	server_pool_close(self);
+	if ((self->cwalk = self->cwalk->ai_next) == NULL)
+		server_pool_fail(self, "connect", strerror(err), now);
+	/* else the next address is tried on the next step */
+}
+
+/**
+ * Writes as much of the pending batch as the socket takes without
+ * blocking.  Metrics are freed and accounted for as soon as they are
+ * completely written.
+ */
+static void
+server_pool_write(server *self, size_t now)
+{
+	struct iovec iov[IOV_BATCH];
+	struct timeval tv;
+	const char **m;
+	int iovcnt;
+	ssize_t slen;
+	size_t total;
+	size_t len;
+	size_t done;
+
+	while (*self->pending != NULL) {
+		total = 0;
+		for (iovcnt = 0, m = self->pending;
+				*m != NULL && iovcnt < IOV_BATCH;
+				iovcnt++, m++)
+		{
+			iov[iovcnt].iov_base = (char *)*m + sizeof(size_t);
+			iov[iovcnt].iov_len = *(size_t *)(*m);
+			total += iov[iovcnt].iov_len;
+		}
+		iov[0].iov_base = (char *)iov[0].iov_base + self->pendoff;
+		iov[0].iov_len -= self->pendoff;
+		total -= self->pendoff;
+
+		slen = writev(self->fd, iov, iovcnt);
+		gettimeofday(&tv, NULL);
+		if (slen < 0) {
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				self->blocked = 1;
+				return;
+			}
+			server_pool_fail(self, "write", strerror(errno), now);
+			return;
+		}
+		self->lastms = now;
+
+		/* release everything that was sent completely */
+		done = self->pending - self->batch;
+		for (len = (size_t)slen; *self->pending != NULL; ) {
+			size_t mlen = *(size_t *)(*self->pending) - self->pendoff;
+			if (len < mlen) {
+				self->pendoff += len;
+				break;
+			}
+			len -= mlen;
+			free((char *)*self->pending);
+			self->pending++;
+			self->pendoff = 0;
+			__sync_add_and_fetch(&(self->metrics), 1);
+		}
+		server_latency_add(self, done, self->pending - self->batch, &tv);
+
+		if ((size_t)slen < total) {
+			/* socket buffer is full, wait for it to drain */
+			self->blocked = 1;
+			return;
+		}
+	}
+
+	self->pending = NULL;
+	if (!__sync_bool_compare_and_swap(&(self->failure), 0, 0)) {
+		logerr("server %s:%u: OK\n", self->ip, self->port);
+		__sync_and_and_fetch(&(self->failure), 0);
+	}
+}
+
+/**
+ * Makes sure the server is stepped again at ms at the latest.
+ */
+static inline void
+server_pool_due(server *self, size_t ms)
+{
+	if (ms < self->nextms)
+		self->nextms = ms;
+}
+
+/**
+ * Performs whatever work can be done for this server without
+ * blocking, like the body of the server_queuereader loop, and sets
+ * nextms to when it needs to be stepped again, unless it is woken or
+ * its socket is flagged by poll() before that.  That is right away
+ * when more metrics can be written.
+ */
+static void
+server_pool_step(server *self, size_t now)
+{
+	struct timeval start, stop;
+	size_t len;
+	size_t waitms = POOL_TICK;
+
+	if (!__sync_bool_compare_and_swap(&(self->running), 1, 1))
+		return;
+
+	/* the interval for retries and checks, unless something is due
+	 * sooner, or there's nothing to check */
+	self->nextms = now + POOL_TICK;
+
+	if (self->resolving == 1)
+		return;  /* server_pool_resolver wakes us */
+	if (self->resolving == 2) {
+		self->resolving = 0;
+		if (self->saddr == NULL) {
+			server_pool_fail(self, "resolve", "unknown host", now);
+		} else {
+			self->cwalk = self->saddr;
+		}
+	}
+
+	if (__sync_bool_compare_and_swap(&(self->reopen_con), 1, 0)) {
+		server_pool_close(self);
+		self->cwalk = NULL;
+	}
+	if (self->connecting) {
+		if (now - self->lastms <= self->iotimeout) {
+			server_pool_due(self, self->lastms + self->iotimeout + 1);
+			return;
+		}
+		server_pool_close(self);
+		if ((self->cwalk = self->cwalk->ai_next) == NULL)
+			server_pool_fail(self, "connect", "Operation timed out", now);
+	}
+	if (self->blocked)
+		return;
+
+	server_lanes_adapt(self);
+	if (__sync_bool_compare_and_swap(&(self->held), 1, 1) &&
+			__sync_bool_compare_and_swap(&(self->keep_running), 1, 1))
+		return;  /* see server_queuereader */
+	if (self->pending == NULL) {
+		if (self->spool != NULL && spool_len(self->spool) > 0 &&
+				(len = queue_len(self->queue)) < self->bsize)
+			server_replay(self, self->bsize - len);
+		len = self->ratemetrics > 0 ?
+			server_pace(self, &waitms) : self->bsize;
+		if (len == 0 && queue_len(self->queue) > 0)
+			server_pool_due(self, now + waitms);
+		if (len > 0) {
+			size_t want = len;
+
+			/* skip over whole batches that are too old */
+			do {
+				len = queue_dequeue_vector_stamps(self->batch,
+						self->stamps, self->queue, want);
+			} while (self->expireus > 0 && len > 0 &&
+					(len = server_expire(self, len)) == 0);
+		}
+		if (len > 0) {
+			if (self->ratemetrics > 0)
+				server_pace_spend(self, self->batch, len);
+			self->batchmark = server_lane_progress(self) + len;
+			self->batch[len] = NULL;
+			self->pending = self->batch;
+			self->pendoff = 0;
+			if (__sync_bool_compare_and_swap(&(self->keep_running), 0, 0))
+				logerr("shutting down %s:%u: waiting for %zu metrics\n",
+						self->ip, self->port, len + queue_len(self->queue));
+		}
+	}
+
+	if (self->pending == NULL) {
+		/* close idle connections, like server_queuereader does */
+		if (self->fd >= 0 &&
+				now - self->lastms > DISCONNECT_WAIT_TIME * POOL_TICK)
+			server_pool_close(self);
+		if (__sync_bool_compare_and_swap(&(self->keep_running), 0, 0)) {
+			server_pool_close(self);
+			__sync_and_and_fetch(&(self->running), 0);
+		}
+		/* only the idle timeout is left to wait for, until new metrics
+		 * wake us, unless lanes or the spool need looking after */
+		if (queue_len(self->queue) == 0 && self->spool == NULL &&
+				self->lanecnt == 0)
+			self->nextms = self->fd >= 0 ?
+				self->lastms + DISCONNECT_WAIT_TIME * POOL_TICK + 1 :
+				(size_t)-1;
+		return;
+	}
+
+	if (__sync_bool_compare_and_swap(&(self->keep_running), 0, 0) &&
+			__sync_add_and_fetch(&(self->failure), 0))
+	{
+		/* don't hold up shutdown for a server that is down */
+		server_pool_putback(self);
+		server_pool_close(self);
+		__sync_and_and_fetch(&(self->running), 0);
+		return;
+	}
+
+	gettimeofday(&start, NULL);
+	if (self->fd < 0 && now >= self->retryms) {
+		server_breaker_probe(self);
+		server_pool_connect(self, now);
+	} else if (self->fd < 0) {
+		server_pool_due(self, self->retryms);
+		if (self->expireus > 0) {
+			/* the pending batch lives in the buffer server_expire_queue
+			 * uses, so return it to the queue first */
+			server_pool_putback(self);
+			server_expire_queue(self);
+		}
+	}
+	if (self->fd >= 0 && !self->connecting)
+		server_pool_write(self, now);
+	gettimeofday(&stop, NULL);
+	__sync_add_and_fetch(&(self->ticks), timediff(start, stop));
+
+	if (self->fd >= 0 && !self->connecting && !self->blocked &&
+			queue_len(self->queue) > 0)
+	{
+		self->nextms = now;
+	} else if (self->connecting) {
+		server_pool_due(self, self->lastms + self->iotimeout + 1);
+	}
+}
+
+/**
+ * Sender thread, handling all servers of a pool.
+ */
+static void *
+server_pool_loop(void *d)
+{
+	server_pool *pool = (server_pool *)d;
+	struct pollfd *ufds = NULL;
+	server **polled = NULL;
+	size_t ufdssize = 0;
+	size_t nfds;
+	size_t now;
+	size_t due;
+	size_t i;
+	server *s;
+	char buf[64];
+
+	while (__sync_bool_compare_and_swap(&(pool->keep_running), 1, 1)) {
+		now = server_pool_ms();
+		nfds = 1;
+		due = now + POOL_TICK;
+
+		pthread_mutex_lock(&pool->lock);
+		if (ufdssize < pool->srvscnt + 1) {
+			struct pollfd *nufds;
+			server **npolled;
+
+			ufdssize = pool->srvssize + 1;
+			nufds = realloc(ufds, sizeof(struct pollfd) * ufdssize);
+			npolled = realloc(polled, sizeof(server *) * ufdssize);
+			if (nufds == NULL || npolled == NULL) {
+				logerr("sender: failed to allocate memory for poll\n");
+				exit(1);
+			}
+			ufds = nufds;
+			polled = npolled;
+		}
+		for (i = 0; i < pool->srvscnt; i++) {
+			s = pool->srvs[i];
+			if (__sync_bool_compare_and_swap(&(s->woken), 1, 0) ||
+					now >= s->nextms)
+				server_pool_step(s, now);
+			if (s->nextms < due)
+				due = s->nextms;
+			if (s->fd >= 0 && (s->connecting || s->blocked)) {
+				ufds[nfds].fd = s->fd;
+				ufds[nfds].events = POLLOUT;
+				ufds[nfds].revents = 0;
+				polled[nfds] = s;
+				nfds++;
+			}
+		}
+		pthread_mutex_unlock(&pool->lock);
+
+		ufds[0].fd = pool->wakefd[0];
+		ufds[0].events = POLLIN;
+		ufds[0].revents = 0;
+		/* don't wait when some server has more to write already */
+		if (poll(ufds, nfds, due > now ? (int)(due - now) : 0) < 0 &&
+				errno != EINTR)
+			logerr("sender: failed to poll(): %s\n", strerror(errno));
+
+		/* clear the wakeup before stepping through the servers, such
+		 * that enqueues from here on trigger a new one */
+		__sync_and_and_fetch(&(pool->wakeup), 0);
+		if (ufds[0].revents & POLLIN)
+			while (read(pool->wakefd[0], buf, sizeof(buf)) > 0)
+				;
+
+		/* servers in polled cannot go away, since that requires the
+		 * step above to have stopped them */
+		now = server_pool_ms();
+		for (i = 1; i < nfds; i++) {
+			if (ufds[i].revents == 0)
+				continue;
+			s = polled[i];
+			if (s->connecting) {
+				server_pool_connected(s, now);
+			} else {
+				s->blocked = 0;
+			}
+			s->nextms = now;
+		}
+	}
+
+	free(ufds);
+	free(polled);
+
+	return NULL;
+}
+
+/**
+ * Hands plain TCP servers started from here on to threads sender
+ * threads, instead of starting a thread for each of them.  Returns 0
+ * on success, or an errno value when the threads could not be started.
+ */
+int
+server_set_pool(int threads)
+{
+	int i;
+	int err;
+
+	if (pools != NULL || threads <= 0)
+		return 0;
+	if ((pools = calloc(threads, sizeof(server_pool))) == NULL)
+		return ENOMEM;
+	for (i = 0; i < threads; i++) {
+		server_pool *pool = &pools[i];
+
+		if (pipe(pool->wakefd) < 0)
+			return errno;
+		fcntl(pool->wakefd[0], F_SETFL,
+				fcntl(pool->wakefd[0], F_GETFL, NULL) | O_NONBLOCK);
+		fcntl(pool->wakefd[1], F_SETFL,
+				fcntl(pool->wakefd[1], F_GETFL, NULL) | O_NONBLOCK);
+		pthread_mutex_init(&pool->lock, NULL);
+		pthread_cond_init(&pool->resolvecond, NULL);
+		pool->keep_running = 1;
+		if ((err = pthread_create(&pool->tid, NULL,
+						&server_pool_loop, pool)) != 0)
+			return err;
+		if ((err = pthread_create(&pool->rtid, NULL,
+						&server_pool_resolver, pool)) != 0)
+		{
+			__sync_and_and_fetch(&(pool->keep_running), 0);
+			server_pool_wake(pool);
+			pthread_join(pool->tid, NULL);
+			return err;
+		}
+		poolcnt++;
+	}
+
+	return 0;
+}
+
+/**
+ * Stops the sender threads started by server_set_pool.  All servers
+ * must have been freed before.
+ */
+void
+server_stop_pool(void)
+{
+	int i;
+
+	for (i = 0; i < poolcnt; i++) {
+		server_pool *pool = &pools[i];
+
+		__sync_and_and_fetch(&(pool->keep_running), 0);
+		server_pool_wake(pool);
+		pthread_join(pool->tid, NULL);
+		pthread_mutex_lock(&pool->lock);
+		pthread_cond_signal(&pool->resolvecond);
+		pthread_mutex_unlock(&pool->lock);
+		pthread_join(pool->rtid, NULL);
+		close(pool->wakefd[0]);
+		close(pool->wakefd[1]);
+		pthread_cond_destroy(&pool->resolvecond);
+		pthread_mutex_destroy(&pool->lock);
+		free(pool->srvs);
+	}
+	free(pools);
+	pools = NULL;
+	poolcnt = 0;
+}
+
+/**
+ * Adds the server to one of the pools, in a round-robin fashion.
+ * Returns 0 on success, or an errno value.
+ */
+static int
+server_pool_add(server *s)
+{
+	server_pool *pool = &pools[poolnext++ % poolcnt];
+
+	pthread_mutex_lock(&pool->lock);
+	if (pool->srvscnt == pool->srvssize) {
+		server **nsrvs = realloc(pool->srvs,
+				sizeof(server *) * (pool->srvssize + 16));
+		if (nsrvs == NULL) {
+			pthread_mutex_unlock(&pool->lock);
+			return ENOMEM;
+		}
+		pool->srvs = nsrvs;
+		pool->srvssize += 16;
+	}
+	s->pool = pool;
+	s->running = 1;
+	pool->srvs[pool->srvscnt++] = s;
+	pthread_mutex_unlock(&pool->lock);
+
+	server_pool_wake(pool);
+	return 0;
+}
+
+/**
+ * Removes the (stopped) server from its pool.
+ */
+static void
+server_pool_remove(server *s)
+{
+	server_pool *pool = s->pool;
+	size_t i;
+
+	pthread_mutex_lock(&pool->lock);
+	for (i = 0; i < pool->srvscnt; i++) {
+		if (pool->srvs[i] == s) {
+			pool->srvs[i] = pool->srvs[--pool->srvscnt];
+			break;
+		}
+	}
+	pthread_mutex_unlock(&pool->lock);
+	s->pool = NULL;
+}
+
+/**
+ * Allocate a new (outbound) server.  Effectively this means a thread
+ * that reads from the queue and sends this as good as it can to the ip
+ * address and port associated.
+ */
+server *
+server_new(
+		const char *ip,
+		unsigned short port,
+		con_type type,
+		con_trnsp transport,
+		char *mtlspemcert,
+		char *mtlspemkey,
+		con_proto ctype,
+		struct addrinfo *saddr,
+		struct addrinfo *hint,
+		size_t qsize,
+		size_t bsize,
+		int maxstalls,
+		unsigned short iotimeout,
+		unsigned int sockbufsize)
+{
+	server *ret;
+
+	if ((ret = malloc(sizeof(server))) == NULL)
+		return NULL;
+
+	ret->type = type;
+	ret->transport = transport;
+	ret->mtlspemcert = mtlspemcert == NULL ? NULL : strdup(mtlspemcert);
+	ret->mtlspemkey = mtlspemkey == NULL ? NULL : strdup(mtlspemkey);
+	ret->ctype = ctype;
+	ret->tid = 0;
+	ret->secondaries = NULL;
+	ret->secondariescnt = 0;
+	ret->ip = strdup(ip);
+	if (ret->ip == NULL) {
+		if (ret->mtlspemcert != NULL)
+			free(ret->mtlspemcert);
+		if (ret->mtlspemkey != NULL)
+			free(ret->mtlspemkey);
+		free(ret);
+		return NULL;
+	}
+	ret->port = port;
+	ret->instance = NULL;
+	ret->bsize = bsize;
+	ret->iotimeout = iotimeout < 250 ? 600 : iotimeout;
+	ret->sockbufsize = sockbufsize;
+	ret->maxstalls = maxstalls;
+	/* the enqueue times of the metrics in batch follow batch itself */
+	if ((ret->batch = malloc((sizeof(char *) + sizeof(size_t)) *
+					(bsize + 1))) == NULL)
+	{
+		if (ret->mtlspemcert != NULL)
+			free(ret->mtlspemcert);
+		if (ret->mtlspemkey != NULL)
+			free(ret->mtlspemkey);
+		free((char *)ret->ip);
+		free(ret);
+		return NULL;
+	}
+	ret->fd = -1;
+	if ((ret->strm = malloc(sizeof(z_strm))) == NULL) {
+		if (ret->mtlspemcert != NULL)
+			free(ret->mtlspemcert);
+		if (ret->mtlspemkey != NULL)
+			free(ret->mtlspemkey);
+		free((char *)ret->ip);
+		free(ret->batch);
+		free(ret);
+		return NULL;
+	}
+	ret->strm->nextstrm = NULL;
+
+	/* setup normal or SSL-wrapped socket first */
+#ifdef HAVE_SSL
+	if (transport & W_SSL) {
+		/* create an auto-negotiate context */
+		const SSL_METHOD *m = SSLv23_client_method();
+		ret->strm->ctx = SSL_CTX_new(m);
+
+		if (sslCA != NULL) {
+			if (ret->strm->ctx == NULL ||
+				SSL_CTX_load_verify_locations(ret->strm->ctx,
+											   sslCAisdir ? NULL : sslCA,
+											   sslCAisdir ? sslCA : NULL) == 0)
+			{
+				char *err = ERR_error_string(ERR_get_error(), NULL);
+				logerr("failed to load SSL verify locations from %s for "
+						"%s:%d: %s\n", sslCA, ret->ip, ret->port, err);
+				if (ret->mtlspemcert != NULL)
+					free(ret->mtlspemcert);
+				if (ret->mtlspemkey != NULL)
+					free(ret->mtlspemkey);
+				free((char *)ret->ip);
+				free(ret->batch);
+				SSL_CTX_free(ret->strm->ctx);
+				free(ret->strm);
+				free(ret);
+				return NULL;
+			}
+		}
+		SSL_CTX_set_verify(ret->strm->ctx, SSL_VERIFY_PEER, NULL);
+		/* keep the sessions ourselves, see sslnewsession */
+		SSL_CTX_set_session_cache_mode(ret->strm->ctx,
+				SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+		SSL_CTX_sess_set_new_cb(ret->strm->ctx, &sslnewsession);
+		ret->strm->sess = NULL;
+		ret->strm->sslfailed = 0;
+#ifdef SSL_OP_ENABLE_KTLS
+		if (sslktls)
+			SSL_CTX_set_options(ret->strm->ctx, SSL_OP_ENABLE_KTLS);
+#endif
+
+		ret->strm->strmwrite = &sslwrite;
+		ret->strm->strmwritev = NULL;
+		ret->strm->strmflush = &sslflush;
+		ret->strm->strmclose = &sslclose;
+		ret->strm->strmerror = &sslerror;
+	} else
+#endif
+	{
+		ret->strm->strmwrite = &sockwrite;
+		ret->strm->strmwritev = &sockwritev;
+		ret->strm->strmflush = &sockflush;
+		ret->strm->strmclose = &sockclose;
+		ret->strm->strmerror = &sockerror;
+	}
+
+	ret->strm->fbuf = NULL;
+	if (ctype == CON_FILE) {
+		if ((ret->strm->fbuf = filebuf_new(ret->ip)) == NULL) {
+			free((char *)ret->ip);
+			free(ret->batch);
+			free(ret->strm);
+			free(ret);
+			return NULL;
+		}
+		ret->strm->strmwrite = &filewrite;
+		ret->strm->strmwritev = &filewritev;
+		ret->strm->strmflush = &fileflush;
+		ret->strm->strmclose = &fileclose;
+	}
+	
+	/* now see if we have a compressor defined */
+	if ((transport & 0xFFFF) == W_PLAIN) {
+		/* catch noop */
+	}
+#ifdef HAVE_GZIP
+	else if ((transport & 0xFFFF) == W_GZIP) {
+		z_strm *gzstrm = malloc(sizeof(z_strm));
+		if (gzstrm == NULL) {
+			if (ret->mtlspemcert != NULL)
+				free(ret->mtlspemcert);
+			if (ret->mtlspemkey != NULL)
+				free(ret->mtlspemkey);
+			free((char *)ret->ip);
+			free(ret->batch);
+			free(ret->strm);
+			free(ret);
+			return NULL;
+		}
+		gzstrm->strmwrite = &gzipwrite;
+		gzstrm->strmwritev = NULL;
+		gzstrm->strmflush = &gzipflush;
+		gzstrm->strmclose = &gzipclose;
+		gzstrm->strmerror = &gziperror;
+		gzstrm->jobs = NULL;
+		gzstrm->jobcnt = 0;
+		gzstrm->jobprev = NULL;
+		gzstrm->nextstrm = ret->strm;
+		ret->strm = gzstrm;
+	}
+#endif
+#ifdef HAVE_LZ4
+	else if ((transport & 0xFFFF) == W_LZ4) {
+		z_strm *lzstrm = malloc(sizeof(z_strm));
+		if (lzstrm == NULL) {
+			if (ret->mtlspemcert != NULL)
+				free(ret->mtlspemcert);
+			if (ret->mtlspemkey != NULL)
+				free(ret->mtlspemkey);
+			free((char *)ret->ip);
+			free(ret->batch);
+			free(ret->strm);
+			free(ret);
+			return NULL;
+		}
+		lzstrm->strmwrite = &lzwrite;
+		lzstrm->strmwritev = NULL;
+		lzstrm->strmflush = &lzflush;
+		lzstrm->strmclose = &lzclose;
+		lzstrm->strmerror = &lzerror;
+		lzstrm->jobs = NULL;
+		lzstrm->jobcnt = 0;
+		lzstrm->jobprev = NULL;
+		lzstrm->nextstrm = ret->strm;
+		ret->strm = lzstrm;
+	}
+#endif
+#ifdef HAVE_SNAPPY
+	else if ((transport & 0xFFFF) == W_SNAPPY) {
+		z_strm *snpstrm = malloc(sizeof(z_strm));
+		if (snpstrm == NULL) {
+			if (ret->mtlspemcert != NULL)
+				free(ret->mtlspemcert);
+			if (ret->mtlspemkey != NULL)
+				free(ret->mtlspemkey);
+			free((char *)ret->ip);
+			free(ret->batch);
+			free(ret->strm);
+			free(ret);
+			return NULL;
+		}
+		snpstrm->strmwrite = &snappywrite;
+		snpstrm->strmwritev = NULL;
+		snpstrm->strmflush = &snappyflush;
+		snpstrm->strmclose = &snappyclose;
+		snpstrm->strmerror = &snappyerror;
+		snpstrm->nextstrm = ret->strm;
+		ret->strm = snpstrm;
+	}
+#endif
+#ifdef HAVE_ZSTD
+	else if ((transport & 0xFFFF) == W_ZSTD) {
+		z_strm *zstdstrm = malloc(sizeof(z_strm));
+		if (zstdstrm == NULL ||
+				(zstdstrm->hdl.zstd = ZSTD_createCCtx()) == NULL)
+		{
+			if (zstdstrm != NULL)
+				free(zstdstrm);
+			if (ret->mtlspemcert != NULL)
+				free(ret->mtlspemcert);
+			if (ret->mtlspemkey != NULL)
+				free(ret->mtlspemkey);
+			free((char *)ret->ip);
+			free(ret->batch);
+			free(ret->strm);
+			free(ret);
+			return NULL;
+		}
+		/* the dictionary carries the level it was created with */
+		if (zstddict != NULL) {
+			ZSTD_CCtx_refCDict(zstdstrm->hdl.zstd, zstddict);
+		} else {
+			ZSTD_CCtx_setParameter(zstdstrm->hdl.zstd,
+					ZSTD_c_compressionLevel, zstdlevel);
+		}
+		zstdstrm->strmwrite = &zstdwrite;
+		zstdstrm->strmwritev = NULL;
+		zstdstrm->strmflush = &zstdflush;
+		zstdstrm->strmclose = &zstdclose;
+		zstdstrm->strmerror = &zstderror;
+		zstdstrm->nextstrm = ret->strm;
+		ret->strm = zstdstrm;
+	}
+#endif
+
+	ret->saddr = saddr;
+	ret->reresolve = 0;
+	ret->hint = NULL;
+	if (hint != NULL) {
+		ret->reresolve = 1;
+		ret->hint = hint;
+	}
+	ret->queue = queue_new(qsize);
+	if (ret->queue == NULL) {
+		if (ret->mtlspemcert != NULL)
+			free(ret->mtlspemcert);
+		if (ret->mtlspemkey != NULL)
+			free(ret->mtlspemkey);
+#ifdef HAVE_SSL
+		if (ret->strm->ctx != NULL)
+			SSL_CTX_free(ret->strm->ctx);
+#endif
+		if (ret->strm->nextstrm != NULL)
+			free(ret->strm->nextstrm);
+		free(ret->strm);
+		free(ret->batch);
+		free((char *)ret->ip);
+		free(ret);
+		return NULL;
+	}
+
+	ret->failover = 0;
+	ret->steal = 0;
+	ret->failure = 0;
+	ret->running = 0;
+	ret->keep_running = 1;
+	ret->reopen_con = 0;
+	ret->stallseq = 0;
+	ret->metrics = 0;
+	ret->dropped = 0;
+	ret->stalls = 0;
+	ret->ticks = 0;
+	ret->prevmetrics = 0;
+	ret->prevdropped = 0;
+	ret->prevstalls = 0;
+	ret->prevticks = 0;
+	ret->spool = NULL;
+	ret->spilled = 0;
+	ret->replayed = 0;
+	ret->prevspilled = 0;
+	ret->prevreplayed = 0;
+	ret->datagrams = 0;
+	ret->senderrors = 0;
+	ret->prevdatagrams = 0;
+	ret->prevsenderrors = 0;
+	ret->sslfull = 0;
+	ret->sslresumed = 0;
+	ret->prevsslfull = 0;
+	ret->prevsslresumed = 0;
+	ret->ktls = 0;
+	ret->prevktls = 0;
+	ret->stolen = 0;
+	ret->prevstolen = 0;
+	ret->breaker = BREAKER_CLOSED;
+	ret->connfails = 0;
+	ret->backoffms = 0;
+	ret->breakeropens = 0;
+	ret->prevbreakeropens = 0;
+	ret->breakerprobes = 0;
+	ret->prevbreakerprobes = 0;
+	ret->ratemetrics = 0;
+	ret->ratebytes = 0;
+	ret->rateburst = 0;
+	ret->catchuprate = 0;
+	ret->catchupabove = 0;
+	ret->tokens = 0.0;
+	ret->btokens = 0.0;
+	ret->ratems = 0;
+	ret->expireus = 0;
+	ret->expired = 0;
+	ret->prevexpired = 0;
+	ret->nostall = 0;
+	ret->stallsince = 0;
+	ret->stallticks = 0;
+	ret->prevstallticks = 0;
+	ret->pool = NULL;
+	ret->pending = NULL;
+	ret->pendoff = 0;
+	ret->cwalk = NULL;
+	ret->connecting = 0;
+	ret->resolving = 0;
+	ret->blocked = 0;
+	ret->woken = 0;
+	ret->retryms = 0;
+	ret->lastms = 0;
+	ret->nextms = 0;
+	ret->resolvenext = NULL;
+	ret->stamps = (size_t *)(ret->batch + bsize + 1);
+	ret->pickle = NULL;
+	pthread_mutex_init(&ret->wakelock, NULL);
+	pthread_cond_init(&ret->wakecond, NULL);
+	ret->sleeping = 0;
+	memset(ret->lathist, 0, sizeof(ret->lathist));
+	memset(ret->prevlathist, 0, sizeof(ret->prevlathist));
+	ret->parent = NULL;
+	ret->lanes = NULL;
+	ret->lanecnt = 0;
+	ret->conns = 1;
+	ret->ctlnext = 0;
+	ret->ctlqueued = 0;
+	ret->ctlticks = 0;
+	ret->ctlmetrics = 0;
+	ret->ctlcost = 0;
+	ret->ctlidle = 0;
+	ret->holduntil = 0;
+	ret->holdmark = 0;
+	ret->batchmark = 0;
+	ret->held = 0;
+	ret->tid = 0;
+
+	return ret;
+}
+
+/**
+ * Compare server s against the address info in saddr.  A server is
+ * considered to be equal is it is of the same socket family, type and
+ * protocol, and if the target address and port are the same.  When
+ * saddr is NULL, a match against the given ip is attempted, e.g. for
+ * file destinations.
+ */
+char
+server_cmp(server *s, struct addrinfo *saddr, const char *ip)
+{
+	if ((saddr == NULL || s->saddr == NULL)) {
+		if (strcmp(s->ip, ip) == 0)
+			return 0;
+	} else if (
+			s->saddr->ai_family == saddr->ai_family &&
+			s->saddr->ai_socktype == saddr->ai_socktype &&
+			s->saddr->ai_protocol == saddr->ai_protocol
+	   )
+	{
+		if (saddr->ai_family == AF_INET) {
+			struct sockaddr_in *l = ((struct sockaddr_in *)s->saddr->ai_addr);
+			struct sockaddr_in *r = ((struct sockaddr_in *)saddr->ai_addr);
+			if (l->sin_port == r->sin_port &&
+					l->sin_addr.s_addr == r->sin_addr.s_addr)
+				return 0;
+		} else if (saddr->ai_family == AF_INET6) {
+			struct sockaddr_in6 *l =
+				((struct sockaddr_in6 *)s->saddr->ai_addr);
+			struct sockaddr_in6 *r =
+				((struct sockaddr_in6 *)saddr->ai_addr);
+			if (l->sin6_port == r->sin6_port &&
+					memcmp(l->sin6_addr.s6_addr, r->sin6_addr.s6_addr,
+						sizeof(l->sin6_addr.s6_addr)) == 0)
+				return 0;
+		}
+	}
+
+	return 1;  /* not equal */
+}
+
+/**
+ * Creates and starts the extra connections (lanes) for s, up to
+ * maxconns in total.  Lanes are servers to the same destination with
+ * their own queue, that only get metrics once s decides to use more
+ * than one connection.  They are all set up front, so each costs a
+ * thread and a queue of the same size as that of s, even when it is
+ * never used.  Failing to set up lanes is not fatal, s just uses less
+ * connections.
+ */
+static void
+server_add_lanes(server *s)
+{
+	server **lanes;
+	server *l;
+	struct addrinfo *saddr;
+	struct addrinfo *hint;
+	char sport[8];
+	int cnt;
+
+	if ((lanes = malloc(sizeof(server *) * (maxconns - 1))) == NULL) {
+		logerr("failed to allocate memory for connections to %s:%u\n",
+				s->ip, s->port);
+		return;
+	}
+
+	snprintf(sport, sizeof(sport), "%u", s->port);
+	for (cnt = 0; cnt < maxconns - 1; cnt++) {
+		/* each server owns its address info, so get our own copy */
+		saddr = NULL;
+		hint = malloc(sizeof(struct addrinfo));
+		if (hint == NULL)
+			break;
+		if (s->hint != NULL) {
+			/* resolved on connect, like s */
+			memcpy(hint, s->hint, sizeof(struct addrinfo));
+		} else {
+			memset(hint, 0, sizeof(struct addrinfo));
+			hint->ai_family = PF_UNSPEC;
+			hint->ai_socktype = SOCK_STREAM;
+			hint->ai_protocol = IPPROTO_TCP;
+			hint->ai_flags = AI_NUMERICHOST | AI_NUMERICSERV;
+			if (getaddrinfo(s->ip, sport, hint, &saddr) != 0) {
+				free(hint);
+				break;
 			}
+			free(hint);
+			hint = NULL;
+		}
+		l = server_new(s->ip, s->port, s->type, s->transport,
+				s->mtlspemcert, s->mtlspemkey, s->ctype, saddr, hint,
+				queue_size(s->queue), s->bsize, s->maxstalls,
+				s->iotimeout, s->sockbufsize);
+		if (l == NULL) {
+			if (saddr != NULL)
+				freeaddrinfo(saddr);
+			if (hint != NULL)
+				free(hint);
+			break;
+		}
+		l->parent = s;
+		if (server_start(l) != 0) {
+			server_free(l);
+			break;
+		}
+		lanes[cnt] = l;
+	}
 
-			if (self->ctype == CON_PIPE) {
-				int intconn[2];
-				if (pipe(intconn) < 0) {
-					if (__sync_fetch_and_add(&(self->failure), 1) == 0)
-						logerr("failed to create pipe: %s\n", strerror(errno));
-					continue;
-				}
-				dispatch_addconnection(intconn[0], NULL);
-				self->fd = intconn[1];
-			} else if (self->ctype == CON_FILE) {
-				if ((self->fd = open(self->ip,
-								O_WRONLY | O_APPEND | O_CREAT,
-								S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH)) < 0)
-				{
-					if (__sync_fetch_and_add(&(self->failure), 1) == 0)
-						logerr("failed to open file '%s': %s\n",
-								self->ip, strerror(errno));
-					continue;
-				}
-			} else if (self->ctype == CON_UDP) {
-				struct addrinfo *walk;
+	if (cnt < maxconns - 1)
+		logerr("failed to set up all connections to %s:%u, "
+				"using at most %d\n", s->ip, s->port, cnt + 1);
+	if (cnt == 0) {
+		free(lanes);
+		return;
+	}
+	s->lanes = lanes;
+	/* publish the lanes only once they are complete */
+	__sync_add_and_fetch(&(s->lanecnt), cnt);
+}
 
-				for (walk = self->saddr; walk != NULL; walk = walk->ai_next) {
-					if ((self->fd = socket(walk->ai_family,
-									walk->ai_socktype,
-									walk->ai_protocol)) < 0)
-					{
-						if (walk->ai_next == NULL &&
-								__sync_fetch_and_add(&(self->failure), 1) == 0)
-							logerr("failed to create udp socket: %s\n",
-									strerror(errno));
-						continue;
-					}
-					if (connect(self->fd, walk->ai_addr, walk->ai_addrlen) < 0)
-					{
-						if (walk->ai_next == NULL &&
-								__sync_fetch_and_add(&(self->failure), 1) == 0)
-							logerr("failed to connect udp socket: %s\n",
-									strerror(errno));
-						close(self->fd);
-						self->fd = -1;
-						continue;
-					}
+/**
+ * Starts a previously created server using server_new().  Returns
+ * errno if starting a thread failed, after which the caller should
+ * server_free() the given s pointer.
+ */
+char
+server_start(server *s)
+{
+	char stamped;
+	int i;
 
-					/* we made it up here, so this connection is usable */
-					break;
-				}
-				/* if this didn't resolve to anything, treat as failure */
-				if (self->saddr == NULL)
-					__sync_add_and_fetch(&(self->failure), 1);
-				/* if all addrinfos failed, try again later */
-				if (self->fd < 0)
-					continue;
-			} else {  /* CON_TCP */
-				int ret;
-				int args;
-				struct addrinfo *walk;
+	/* the spool is opened here, and not in server_new, because on
+	 * reload the old server still holds it until server_swap_queue */
+	if (spooldir != NULL && s->spool == NULL && s->parent == NULL &&
+			(s->ctype == CON_TCP || s->ctype == CON_UDP))
+	{
+		char name[256];
+		char *p;
+
+		snprintf(name, sizeof(name), "%s:%u%s",
+				s->ip, s->port, s->ctype == CON_UDP ? "-udp" : "");
+		for (p = name; *p != '\0'; p++)
+			if (*p == '/')
+				*p = '_';
+		if ((s->spool = spool_new(spooldir, name, spoolsize)) == NULL)
+			logerr("failed to open spool for %s:%u, "
+					"metrics will be dropped on overflow\n",
+					s->ip, s->port);
+	}
+
+	/* any_of and failover clusters spread load over multiple servers
+	 * already, and move queues around, which lanes don't do */
+	if (maxconns > 1 && s->lanes == NULL && s->parent == NULL &&
+			s->ctype == CON_TCP && s->secondariescnt == 0 &&
+			s->ratemetrics == 0)
+		server_add_lanes(s);
+
+	/* enqueue times are only needed to report latencies, and to expire
+	 * metrics */
+	stamped = !(mode & MODE_SUBMISSION) || s->expireus > 0;
+	queue_set_stamped(s->queue, stamped);
+	for (i = 0; i < s->lanecnt; i++)
+		queue_set_stamped(s->lanes[i]->queue, stamped);
+
+	if (poolcnt > 0 && s->ctype == CON_TCP && s->transport == W_PLAIN &&
+			s->type != T_PICKLE && s->secondariescnt == 0)
+		return server_pool_add(s);
+
+	return pthread_create(&s->tid, NULL, &server_queuereader, s);
+}
+
+/**
+ * Enables spilling of metrics that do not fit in the queue of TCP and
+ * UDP servers to disk.  Each server gets its own spool in dir, holding
+ * at most maxbytes.  Must be called before servers are started.
+ */
+void
+server_set_spool(const char *dir, size_t maxbytes)
+{
+	if (spooldir != NULL)
+		free(spooldir);
+	spooldir = dir == NULL ? NULL : strdup(dir);
+	spoolsize = maxbytes;
+}
+
+/**
+ * Limits the memory used by metrics in the queues of all servers
+ * together to maxbytes.  When the budget is exhausted, excess metrics
+ * are dropped, or when stall is set, writers are stalled like for a
+ * full queue.  A maxbytes of 0 disables the budget.
+ */
+void
+server_set_membudget(size_t maxbytes, char stall)
+{
+	membudget = maxbytes;
+	membudget_stall = stall;
+}
+
+/**
+ * Allows TCP servers started from here on to use up to conns
+ * connections to their destination, depending on how well a single
+ * connection keeps up.
+ */
+void
+server_set_maxconns(int conns)
+{
+	maxconns = conns < 1 ? 1 :
+		conns > SERVER_MAX_CONNS ? SERVER_MAX_CONNS : conns;
+}
+
+/**
+ * Sets the maximum payload of the datagrams UDP servers send.  As many
+ * metrics as fit are packed into a single datagram.
+ */
+void
+server_set_udpsize(size_t bytes)
+{
+	udpsize = bytes < 1 ? 1 :
+		bytes > SERVER_UDP_MAXSIZE ? SERVER_UDP_MAXSIZE : bytes;
+}
+
+/**
+ * Keeps idle connections to SSL servers open, instead of closing them
+ * after a few seconds, such that no new handshake is necessary.
+ */
+void
+server_set_sslkeepalive(char keep)
+{
+	sslkeepalive = keep;
+}
+
+/**
+ * Makes servers flush their stream at least every ms milliseconds
+ * while they are busy writing.  Compressing transports normally only
+ * flush when the queue runs empty.  A ms of 0 keeps that behaviour.
+ */
+void
+server_set_maxflush(unsigned int ms)
+{
+	maxflush = ms;
+}
+
+/**
+ * Starts compressor threads for servers with gzip or lz4
+ * transport to hand their buffers to, such that a single destination
+ * can use more than one core for compression.  Returns 0 on success,
+ * or an errno value when the threads could not be started.
+ */
+int
+server_set_compressors(int threads)
+{
+#if defined(HAVE_GZIP) || defined(HAVE_LZ4)
+	pthread_t tid;
+	int err;
+
+	if (compressors > 0)
+		return 0;
+	for ( ; threads > 0; threads--) {
+		if ((err = pthread_create(&tid, NULL,
+						&zpool_compressor, NULL)) != 0)
+			return err;
+		pthread_detach(tid);
+		compressors++;
+	}
+#else
+	(void)threads;
+#endif
+
+	return 0;
+}
+
+#ifdef HAVE_ZSTD
+/**
+ * Sets the level for zstd transports, and the dictionary to prime them
+ * with, if dict is not NULL.  Returns 0 on success, or -1 when the
+ * dictionary could not be loaded.
+ */
+int
+server_set_zstd(int level, const void *dict, size_t dictlen)
+{
+	zstdlevel = level;
+	if (zstddict != NULL)
+		ZSTD_freeCDict(zstddict);
+	zstddict = NULL;
+	if (dict != NULL &&
+			(zstddict = ZSTD_createCDict(dict, dictlen, level)) == NULL)
+		return -1;
+	return 0;
+}
+#endif
+
+/**
+ * Adds a list of secondary servers to this server.  A secondary server
+ * is a server which' queue will be checked when this server has nothing
+ * to do.
+ */
+void
+server_add_secondaries(server *self, server **secondaries, size_t count)
+{
+	self->secondaries = secondaries;
+	self->secondariescnt = count;
+}
 
-				for (walk = self->saddr; walk != NULL; walk = walk->ai_next) {
-					if ((self->fd = socket(walk->ai_family,
-									walk->ai_socktype,
-									walk->ai_protocol)) < 0)
-					{
-						if (walk->ai_next == NULL &&
-								__sync_fetch_and_add(&(self->failure), 1) == 0)
-							logerr("failed to create socket: %s\n",
-									strerror(errno));
-						continue;
-					}
+/**
+ * Flags this server as part of a failover cluster, which means the
+ * secondaries are used only to offload on failure, not on queue stress.
+ */
+void
+server_set_failover(server *self)
+{
+	self->failover = 1;
+}
 
-					/* put socket in non-blocking mode such that we can
-					 * poll() (time-out) on the connect() call */
-					args = fcntl(self->fd, F_GETFL, NULL);
-					if (fcntl(self->fd, F_SETFL, args | O_NONBLOCK) < 0) {
-						logerr("failed to set socket non-blocking mode: %s\n",
-								strerror(errno));
-						close(self->fd);
-						self->fd = -1;
-						continue;
-					}
-					ret = connect(self->fd, walk->ai_addr, walk->ai_addrlen);
+/**
+ * Lets this server take over metrics from the secondaries with the
+ * largest backlog, when it has nothing to send itself.
+ */
+void
+server_set_steal(server *self)
+{
+	self->steal = 1;
+}
 
-					if (ret < 0 && errno == EINPROGRESS) {
-						/* wait for connection to succeed if the OS thinks
-						 * it can succeed */
-						struct pollfd ufds[1];
-						ufds[0].fd = self->fd;
-						ufds[0].events = POLLIN | POLLOUT;
-						ret = poll(ufds, 1, self->iotimeout + (rand() % 100));
-						if (ret == 0) {
-							/* time limit expired */
-							if (walk->ai_next == NULL &&
-									__sync_fetch_and_add(
-										&(self->failure), 1) == 0)
-								logerr("failed to connect() to "
-										"%s:%u: Operation timed out\n",
-										self->ip, self->port);
-							close(self->fd);
-							self->fd = -1;
-							continue;
-						} else if (ret < 0) {
-							/* some select error occurred */
-							if (walk->ai_next &&
-									__sync_fetch_and_add(
-										&(self->failure), 1) == 0)
-								logerr("failed to poll() for %s:%u: %s\n",
-										self->ip, self->port, strerror(errno));
-							close(self->fd);
-							self->fd = -1;
-							continue;
-						} else {
-							if (ufds[0].revents & POLLHUP) {
-								if (walk->ai_next == NULL &&
-										__sync_fetch_and_add(
-											&(self->failure), 1) == 0)
-									logerr("failed to connect() for %s:%u: "
-											"Connection refused\n",
-											self->ip, self->port);
-								close(self->fd);
-								self->fd = -1;
-								continue;
-							}
-						}
-					} else if (ret < 0) {
-						if (walk->ai_next == NULL &&
-								__sync_fetch_and_add(&(self->failure), 1) == 0)
-						{
-							logerr("failed to connect() to %s:%u: %s\n",
-									self->ip, self->port, strerror(errno));
-							dispatch_check_rlimit_and_warn();
-						}
-						close(self->fd);
-						self->fd = -1;
-						continue;
-					}
+/**
+ * Limits the rate at which metrics are sent to this server to metrics
+ * per second, and bytes per second unless bytes is 0.  Up to burst
+ * metrics can be sent in one go after a quiet period, defaulting to a
+ * second's worth.  While more than above metrics are queued, the
+ * metric rate is catchup instead, unless that is 0.  Extra connections
+ * are not used for rate limited servers.
+ */
+void
+server_set_rate(server *self, size_t metrics, size_t bytes,
+		size_t burst, size_t catchup, size_t above)
+{
+	self->ratemetrics = metrics;
+	self->ratebytes = bytes;
+	self->rateburst = burst > 0 ? burst : metrics;
+	self->catchuprate = catchup;
+	self->catchupabove = above;
+	self->tokens = (double)self->rateburst;
+	self->btokens = (double)bytes * self->rateburst / metrics;
+	self->ratems = 0;
+}
 
-					/* make socket blocking again */
-					if (fcntl(self->fd, F_SETFL, args) < 0) {
-						logerr("failed to remove socket non-blocking "
-								"mode: %s\n", strerror(errno));
-						close(self->fd);
-						self->fd = -1;
-						continue;
-					}
+/**
+ * Drops metrics that have been queued for more than seconds, instead
+ * of sending them to this server.
+ */
+void
+server_set_expire(server *self, int seconds)
+{
+	self->expireus = (size_t)seconds * 1000 * 1000;
+}
 
-					/* disable Nagle's algorithm, issue #208 */
-					args = 1;
-					if (setsockopt(self->fd, IPPROTO_TCP, TCP_NODELAY,
-								&args, sizeof(args)) != 0)
-						; /* ignore */
+/**
+ * Makes sending to this server drop the metrics that do not fit in its
+ * queue, instead of stalling the clients that sent them.
+ */
+void
+server_set_nostall(server *self)
+{
+	self->nostall = 1;
+}
 
-#ifdef TCP_USER_TIMEOUT
-					/* break out of connections when no ACK is being
-					 * received for +- 10 seconds instead of
-					 * retransmitting for +- 15 minutes available on
-					 * linux >= 2.6.37
-					 * the 10 seconds is in line with the SO_SNDTIMEO
-					 * set on the socket below */
-					args = 10000 + (rand() % 300);
-					if (setsockopt(self->fd, IPPROTO_TCP, TCP_USER_TIMEOUT,
-								&args, sizeof(args)) != 0)
-						; /* ignore */
-#endif
+/**
+ * Sets how this file server writes its file.  Metrics are collected in
+ * buffers of bufsize bytes, 0 writes each batch as it comes.  With dbl,
+ * a writer thread writes one buffer while the next is filled.  The
+ * file is synced every sync seconds, after each write when sync is -1,
+ * or never when 0.  The file is renamed and reopened every rotatesecs
+ * seconds or when it reaches rotatebytes, when set.
+ */
+void
+server_set_file(server *self, size_t bufsize, char dbl, int sync,
+		int rotatesecs, size_t rotatebytes)
+{
+	filebuf *fb = self->strm->fbuf;
+
+	/* a metric must always fit in the buffer */
+	fb->size = bufsize > 0 && bufsize < METRIC_BUFSIZ ?
+		METRIC_BUFSIZ : bufsize;
+	fb->dbl = bufsize > 0 && dbl;
+	fb->sync = sync;
+	fb->rotatesecs = rotatesecs;
+	fb->rotatebytes = rotatebytes;
+}
 
-					/* if we reached up here, we're good to go, so don't
-					 * continue with the other addrinfos */
-					break;
-				}
-				/* if this didn't resolve to anything, treat as failure */
-				if (self->saddr == NULL)
-					__sync_add_and_fetch(&(self->failure), 1);
-				/* all available addrinfos failed on us */
-				if (self->fd < 0)
-					continue;
-			}
+/**
+ * Sets instance name only used for carbon_ch cluster type.
+ */
+void
+server_set_instance(server *self, char *instance)
+{
+	if (self->instance != NULL)
+		free(self->instance);
+	self->instance = strdup(instance);
+}
 
-			/* ensure we will break out of connections being stuck more
-			 * quickly than the kernel would give up */
-			timeout.tv_sec = 10;
-			timeout.tv_usec = (rand() % 300) * 1000;
-			if (setsockopt(self->fd, SOL_SOCKET, SO_SNDTIMEO,
-						&timeout, sizeof(timeout)) != 0)
-				; /* ignore */
-			if (self->sockbufsize > 0)
-				if (setsockopt(self->fd, SOL_SOCKET, SO_SNDBUF,
-							&self->sockbufsize, sizeof(self->sockbufsize)) != 0)
-					; /* ignore */
-#ifdef SO_NOSIGPIPE
-			if (self->ctype == CON_TCP || self->ctype == CON_UDP) {
-				int enable = 1;
-				if (setsockopt(self->fd, SOL_SOCKET, SO_NOSIGPIPE,
-							(void *)&enable, sizeof(enable)) != 0)
-					logout("warning: failed to ignore SIGPIPE on socket: %s\n",
-							strerror(errno));
-			}
-#endif
+/**
+ * Thin wrapper around the associated queue with the server object.
+ * Returns true if the metric could be queued for sending, or the metric
+ * was dropped because the associated server is down.  Returns false
+ * otherwise (when a retry seems like it could succeed shortly).
+ */
+inline char
+server_send(server *s, const char *d, char force)
+{
+	return server_send_vector(s, &d, 1, force) == 1;
+}
 
-#ifdef HAVE_GZIP
-			if ((self->transport & 0xFFFF) == W_GZIP) {
-				self->strm->hdl.gz = malloc(sizeof(z_stream));
-				if (self->strm->hdl.gz != NULL) {
-					self->strm->hdl.gz->zalloc = Z_NULL;
-					self->strm->hdl.gz->zfree = Z_NULL;
-					self->strm->hdl.gz->opaque = Z_NULL;
-					self->strm->hdl.gz->next_in = Z_NULL;
-				}
-				if (self->strm->hdl.gz == NULL ||
-						deflateInit2(self->strm->hdl.gz,
-							Z_DEFAULT_COMPRESSION,
-							Z_DEFLATED,
-							15 + 16,
-							8,
-							Z_DEFAULT_STRATEGY) != Z_OK)
-				{
-					logerr("failed to open gzip stream: out of memory\n");
-					close(self->fd);
-					self->fd = -1;
-					continue;
-				}
-				self->strm->obuflen = 0;
-			}
-#endif
-#ifdef HAVE_LZ4
-			if ((self->transport & 0xFFFF) == W_LZ4) {
-				self->strm->obuflen = 0;
+/**
+ * Appends the len metrics from d to the on-disk spool, and releases
+ * them.  Metrics that do not fit in the spool are dropped.
+ */
+static void
+server_spill(server *s, const char **d, size_t len)
+{
+	size_t i;
+	size_t mlen;
 
-				/* get the maximum size that should ever be required and allocate for it */
+	for (i = 0; i < len; i++) {
+		mlen = *(size_t *)d[i];
+		if (spool_write(s->spool, d[i] + sizeof(size_t), mlen)) {
+			__sync_add_and_fetch(&(s->spilled), mlen);
+		} else {
+			if (mode & MODE_DEBUG)
+				logerr("dropping metric: %s", d[i] + sizeof(size_t));
+			__sync_add_and_fetch(&(s->dropped), 1);
+		}
+		free((char *)d[i]);
+	}
+}
 
-				self->strm->hdl.z.cbuflen = LZ4F_compressFrameBound(sizeof(self->strm->obuf), NULL);
-				if ((self->strm->hdl.z.cbuf = malloc(self->strm->hdl.z.cbuflen)) == NULL) {
-					logerr("Failed to allocate %lu bytes for compressed LZ4 data\n", self->strm->hdl.z.cbuflen);
-					close(self->fd);
-					self->fd = -1;
-					continue;
-				}
-			}
-#endif
-#ifdef HAVE_SNAPPY
-			if ((self->transport & 0xFFFF) == W_SNAPPY) {
-				self->strm->obuflen = 0;
-			}
-#endif
+/**
+ * Tells the sender of s there is something in its queue.  A sender
+ * thread is only signalled when it is waiting for its queue to fill.
+ */
+static inline void
+server_wakeup(server *s)
+{
+	if (s->pool != NULL) {
+		__sync_bool_compare_and_swap(&(s->woken), 0, 1);
+		server_pool_wake(s->pool);
+	} else if (__sync_bool_compare_and_swap(&(s->sleeping), 1, 1)) {
+		pthread_mutex_lock(&s->wakelock);
+		pthread_cond_signal(&s->wakecond);
+		pthread_mutex_unlock(&s->wakelock);
+	}
+}
 
-#ifdef HAVE_SSL
-			if (self->transport & W_SSL) {
-				int rv;
-				z_strm *sstrm;
+/**
+ * Returns how many of len metrics, destined for the lanes in lane, fit
+ * in the queues of those lanes, keeping their order.
+ */
+static size_t
+server_lanes_free(server *s, const unsigned char *lane, size_t len)
+{
+	size_t need[SERVER_MAX_CONNS];
+	size_t avail[SERVER_MAX_CONNS];
+	size_t i;
+	int l;
+
+	need[0] = 0;
+	avail[0] = queue_free(s->queue);
+	for (l = 0; l < s->lanecnt; l++) {
+		need[l + 1] = 0;
+		avail[l + 1] = queue_free(s->lanes[l]->queue);
+	}
+	for (i = 0; i < len; i++)
+		if (need[lane[i]]++ == avail[lane[i]])
+			break;
 
-				if ((self->transport & 0xFFFF) == W_PLAIN) {
- 					/* just SSL, nothing else */
-					sstrm = self->strm;
-				} else {
-					sstrm = self->strm->nextstrm;
-				}
+	return i;
+}
 
-				sstrm->hdl.ssl = SSL_new(sstrm->ctx);
-				SSL_set_tlsext_host_name(sstrm->hdl.ssl, self->ip);
-				if (SSL_set_fd(sstrm->hdl.ssl, self->fd) == 0) {
-					logerr("failed to SSL_set_fd: %s\n",
-							ERR_reason_error_string(ERR_get_error()));
-					sstrm->strmclose(sstrm);
-					self->fd = -1;
-					continue;
-				}
-				if (self->transport & W_MTLS) {
-					int ret;
+/**
+ * Queues the len metrics from d, either to the queue of s, or when
+ * lane is given, to the queues of the lanes they are destined for.
+ */
+static void
+server_enqueue(server *s, const char **d, size_t len, const unsigned char *lane)
+{
+	const char *sub[LANE_CHUNK];
+	server *t;
+	size_t i;
+	size_t n;
+	int l;
+
+	if (lane == NULL) {
+		queue_enqueue_vector(s->queue, d, len);
+		server_wakeup(s);
+		return;
+	}
 
-					/* issue #444 */
-					ret = SSL_use_certificate_chain_file(sstrm->hdl.ssl, self->mtlspemcert);
-					if (ret == 1) {
-						ret = SSL_use_PrivateKey_file(sstrm->hdl.ssl,
-													  self->mtlspemkey,
-													  SSL_FILETYPE_PEM);
-					}
+	for (l = 0; l <= s->lanecnt; l++) {
+		for (i = 0, n = 0; i < len; i++)
+			if (lane[i] == l)
+				sub[n++] = d[i];
+		if (n == 0)
+			continue;
+		t = l == 0 ? s : s->lanes[l - 1];
+		queue_enqueue_vector(t->queue, sub, n);
+		server_wakeup(t);
+	}
+}
 
-					if (ret != 1) {
-						logerr("failed to enable mTLS: %s\n",
-							   sslerror(sstrm, ret));
-						sstrm->strmclose(sstrm);
-						self->fd = -1;
-						continue;
-					}
-				}
-				if ((rv = SSL_connect(sstrm->hdl.ssl)) != 1) {
-					logerr("failed to connect ssl stream: %s\n",
-							sslerror(sstrm, rv));
-					sstrm->strmclose(sstrm);
-					self->fd = -1;
-					continue;
-				}
-				if ((rv = SSL_get_verify_result(sstrm->hdl.ssl)) != X509_V_OK) {
-					logerr("failed to verify ssl certificate: %s\n",
-							sslerror(sstrm, rv));
-					sstrm->strmclose(sstrm);
-					self->fd = -1;
-					continue;
-				}
-			} else
-#endif
-			{
-				z_strm *pstrm;
+/**
+ * Ends the stall of s, if any, and adds its duration to the time s
+ * held up clients.
+ */
+static inline void
+server_unstall(server *s)
+{
+	size_t since = __sync_add_and_fetch(&(s->stallsince), 0);
+	struct timeval now;
 
-				if (self->transport == W_PLAIN) { /* just plain socket */
-					pstrm = self->strm;
-				} else {
-					pstrm = self->strm->nextstrm;
-				}
-				pstrm->hdl.sock = self->fd;
-			}
-		}
+	if (since == 0 ||
+			!__sync_bool_compare_and_swap(&(s->stallsince), since, 0))
+		return;
+	gettimeofday(&now, NULL);
+	__sync_add_and_fetch(&(s->stallticks),
+			(size_t)now.tv_sec * 1000 * 1000 + now.tv_usec - since);
+}
 
-		/* send up to batch size */
-		len = queue_dequeue_vector(self->batch, self->queue, self->bsize);
-		self->batch[len] = NULL;
-		metric = self->batch;
+/**
+ * Does the work for server_send_vector, for at most LANE_CHUNK metrics
+ * when lane is set.
+ */
+static size_t
+server_queue_vector(server *s, const char **d, size_t len, char force,
+		const unsigned char *lane)
+{
+	size_t avail = lane == NULL ?
+		queue_free(s->queue) : server_lanes_free(s, lane, len);
+	char overbudget = 0;
+
+	if (s->spool != NULL && spool_len(s->spool) > 0) {
+		/* keep appending to the spool until it is drained, such that
+		 * metrics are replayed in order */
+		server_spill(s, d, len);
+		return len;
+	}
 
-		if (len != 0 &&
-				__sync_bool_compare_and_swap(&(self->keep_running), 0, 0))
-		{
-			/* be noisy during shutdown so we can track any slowing down
-			 * servers, possibly preventing us to shut down */
-			logerr("shutting down %s:%u: waiting for %zu metrics\n",
-					self->ip, self->port, len + queue_len(self->queue));
-		}
+	if (membudget > 0) {
+		/* only take what fits in the relay-wide memory budget */
+		size_t inuse = queue_totbytes();
+		size_t max = avail < len ? avail : len;
+		size_t n;
 
-		if (len == 0 && __sync_add_and_fetch(&(self->failure), 0)) {
-			/* if we don't have anything to send, we have at least a
-			 * connection succeed, so assume the server is up again,
-			 * this is in particular important for recovering this
-			 * node by probes, to avoid starvation of this server since
-			 * its queue is possibly being offloaded to secondaries */
-			if (self->ctype != CON_UDP)
-				logerr("server %s:%u: OK after probe\n", self->ip, self->port);
-			__sync_and_and_fetch(&(self->failure), 0);
+		for (n = 0; n < max; n++) {
+			inuse += QUEUE_ENTRY_BYTES(d[n]);
+			if (inuse > membudget)
+				break;
+		}
+		if (n < max) {
+			avail = n;
+			overbudget = 1;
 		}
+	}
 
-		for (; *metric != NULL; metric++) {
-			len = *(size_t *)(*metric);
-			/* Write to the stream, this may not succeed completely due
-			 * to flow control and whatnot, which the docs suggest need
-			 * resuming to complete.  So, use a loop, but to avoid
-			 * getting endlessly stuck on this, only try a limited
-			 * number of times for a single metric. */
-			for (cnt = 0, p = *metric + sizeof(size_t); cnt < 10; cnt++) {
-				if ((slen = self->strm->strmwrite(self->strm, p, len)) != len) {
-					if (slen >= 0) {
-						p += slen;
-						len -= slen;
-					} else if (errno != EINTR) {
-						break;
-					}
-					/* allow the remote to catch up */
-					usleep((50 + (rand() % 150)) * 1000);  /* 50ms - 200ms */
-				} else {
+	if (avail < len) {
+		char failure = __sync_add_and_fetch(&(s->failure), 0);
+		if (!force && s->secondariescnt > 0) {
+			size_t i;
+			/* don't immediately drop if we know there are others that
+			 * back us up */
+			for (i = 0; i < s->secondariescnt; i++) {
+				if (!__sync_add_and_fetch(&(s->secondaries[i]->failure), 0)) {
+					failure = 0;
 					break;
 				}
 			}
-			if (slen != len) {
-				/* not fully sent (after tries), or failure
-				 * close connection regardless so we don't get
-				 * synchonisation problems */
-				if (self->ctype != CON_UDP &&
-						__sync_fetch_and_add(&(self->failure), 1) == 0)
-					logerr("failed to write() to %s:%u: %s\n",
-							self->ip, self->port,
-							(slen < 0 ?
-							 self->strm->strmerror(self->strm, slen) :
-							 "incomplete write"));
-				self->strm->strmclose(self->strm);
-				self->fd = -1;
-				/* put back stuff we couldn't process */
-				for (; *metric != NULL; metric++) {
-					if (!queue_putback(self->queue, *metric)) {
-						if (mode & MODE_DEBUG)
-							logerr("server %s:%u: dropping metric: %s",
-									self->ip, self->port,
-									*metric + sizeof(size_t));
-						free((char *)*metric);
-						__sync_add_and_fetch(&(self->dropped), 1);
-					}
+		}
+		if (failure || force || s->nostall ||
+				(overbudget && !membudget_stall) ||
+				__sync_add_and_fetch(&(s->stallseq), 0) == s->maxstalls)
+		{
+			server_unstall(s);
+			if (s->spool != NULL) {
+				/* keep what fits in memory, the rest goes to disk */
+				if (avail > 0)
+					server_enqueue(s, d, avail, lane);
+				server_spill(s, d + avail, len - avail);
+				return len;
+			}
+			__sync_add_and_fetch(&(s->dropped), len - avail);
+			if (overbudget) {
+				/* dropping the oldest would not free up the budget
+				 * taken by other queues, so drop the excess instead */
+				size_t i;
+
+				if (avail > 0)
+					server_enqueue(s, d, avail, lane);
+				for (i = avail; i < len; i++) {
+					if (mode & MODE_DEBUG)
+						logerr("dropping metric: %s", d[i] + sizeof(size_t));
+					free((char *)d[i]);
 				}
-				break;
-			} else if (!__sync_bool_compare_and_swap(&(self->failure), 0, 0)) {
-				if (self->ctype != CON_UDP)
-					logerr("server %s:%u: OK\n", self->ip, self->port);
-				__sync_and_and_fetch(&(self->failure), 0);
+				return len;
 			}
-			free((char *)*metric);
-			__sync_add_and_fetch(&(self->metrics), 1);
+			/* excess events will be dropped by the enqueue below */
+		} else {
+			if (__sync_add_and_fetch(&(s->stallsince), 0) == 0) {
+				struct timeval now;
+
+				gettimeofday(&now, NULL);
+				__sync_bool_compare_and_swap(&(s->stallsince), 0,
+						(size_t)now.tv_sec * 1000 * 1000 + now.tv_usec);
+			}
+			if (avail > 0)
+				__sync_and_and_fetch(&(s->stallseq), 0);
+			__sync_add_and_fetch(&(s->stallseq), 1);
+			__sync_add_and_fetch(&(s->stalls), 1);
+			len = avail;
 		}
+	} else {
+		__sync_and_and_fetch(&(s->stallseq), 0);
+		server_unstall(s);
+	}
+	if (len > 0)
+		server_enqueue(s, d, len, lane);
 
-		gettimeofday(&stop, NULL);
-		__sync_add_and_fetch(&(self->ticks), timediff(start, stop));
+	return len;
+}
 
-		idle = 0;
+/**
+ * Queues the len metrics from d in one go.  The stall and drop logic
+ * of server_send applies to the vector as a whole: when the queue
+ * cannot hold all metrics, either the excess is dropped, or only the
+ * metrics that fit are queued.  Returns the number of metrics taken
+ * from d, the remainder should be retried later.
+ */
+size_t
+server_send_vector(server *s, const char **d, size_t len, char force)
+{
+	unsigned char lane[LANE_CHUNK];
+	int conns = __sync_add_and_fetch(&(s->conns), 0);
+	size_t done;
+	size_t chunk;
+	size_t n;
+	size_t i;
+
+	if (conns <= 1)
+		return server_queue_vector(s, d, len, force, NULL);
+
+	/* spread over the connections in use, in chunks such that a
+	 * partially queued chunk still leaves a remainder to retry */
+	for (done = 0; done < len; done += chunk) {
+		chunk = len - done < LANE_CHUNK ? len - done : LANE_CHUNK;
+		for (i = 0; i < chunk; i++)
+			lane[i] = (unsigned char)server_lane_index(d[done + i], conns);
+		n = server_queue_vector(s, d + done, chunk, force, lane);
+		if (n < chunk)
+			return done + n;
 	}
-	__sync_and_and_fetch(&(self->running), 0);
 
-	if (self->fd >= 0)
-		self->strm->strmclose(self->strm);
-	if (secpos != NULL)
-		free(secpos);
-	return NULL;
+	return len;
 }
 
 /**
- * Allocate a new (outbound) server.  Effectively this means a thread
- * that reads from the queue and sends this as good as it can to the ip
- * address and port associated.
+ * Flag worker main loop to close the connection if currently open.
  */
-server *
-server_new(
-		const char *ip,
-		unsigned short port,
-		con_type type,
-		con_trnsp transport,
-		char *mtlspemcert,
-		char *mtlspemkey,
-		con_proto ctype,
-		struct addrinfo *saddr,
-		struct addrinfo *hint,
-		size_t qsize,
-		size_t bsize,
-		int maxstalls,
-		unsigned short iotimeout,
-		unsigned int sockbufsize)
+void
+server_closecon(server *s)
 {
-	server *ret;
+	__sync_bool_compare_and_swap(&(s->reopen_con), 0, 1);
+	/* a pool sender only looks at idle servers when woken */
+	if (s->pool != NULL)
+		server_wakeup(s);
+}
 
-	if ((ret = malloc(sizeof(server))) == NULL)
-		return NULL;
+/**
+ * Tells this server to finish sending pending items from its queue.
+ */
+void
+server_shutdown(server *s)
+{
+	int i;
+	size_t failures;
+	size_t inqueue;
 
-	ret->type = type;
-	ret->transport = transport;
-	ret->mtlspemcert = mtlspemcert == NULL ? NULL : strdup(mtlspemcert);
-	ret->mtlspemkey = mtlspemkey == NULL ? NULL : strdup(mtlspemkey);
-	ret->ctype = ctype;
-	ret->tid = 0;
-	ret->secondaries = NULL;
-	ret->secondariescnt = 0;
-	ret->ip = strdup(ip);
-	if (ret->ip == NULL) {
-		if (ret->mtlspemcert != NULL)
-			free(ret->mtlspemcert);
-		if (ret->mtlspemkey != NULL)
-			free(ret->mtlspemkey);
-		free(ret);
-		return NULL;
-	}
-	ret->port = port;
-	ret->instance = NULL;
-	ret->bsize = bsize;
-	ret->iotimeout = iotimeout < 250 ? 600 : iotimeout;
-	ret->sockbufsize = sockbufsize;
-	ret->maxstalls = maxstalls;
-	if ((ret->batch = malloc(sizeof(char *) * (bsize + 1))) == NULL) {
-		if (ret->mtlspemcert != NULL)
-			free(ret->mtlspemcert);
-		if (ret->mtlspemkey != NULL)
-			free(ret->mtlspemkey);
-		free((char *)ret->ip);
-		free(ret);
-		return NULL;
+	/* this function should only be called on a running server */
+	if (__sync_bool_compare_and_swap(&(s->keep_running), 0, 0))
+		return;
+
+	if (s->secondariescnt > 0) {
+		/* if we have a working connection, or we still have stuff in
+		 * our queue, wait for our secondaries, as they might need us,
+		 * or we need them */
+		do {
+			failures = 0;
+			inqueue = 0;
+			for (i = 0; i < s->secondariescnt; i++) {
+				if (__sync_add_and_fetch(&(s->secondaries[i]->failure), 0))
+					failures++;
+				if (__sync_add_and_fetch(&(s->secondaries[i]->running), 0))
+					inqueue += queue_len(s->secondaries[i]->queue);
+			}
+			/* loop until we all failed, or nothing is in the queues */
+		} while (failures != s->secondariescnt &&
+				inqueue != 0 &&
+				logout("any_of cluster pending %zu metrics "
+					"(with %zu failed nodes)\n", inqueue, failures) >= -1 &&
+				usleep((200 + (rand() % 100)) * 1000) <= 0);
+		/* shut down entire cluster */
+		for (i = 0; i < s->secondariescnt; i++)
+			__sync_bool_compare_and_swap(
+					&(s->secondaries[i]->keep_running), 1, 0);
+		/* to pretend to be dead for above loop (just in case) */
+		if (inqueue != 0)
+			for (i = 0; i < s->secondariescnt; i++)
+				__sync_add_and_fetch(&(s->secondaries[i]->failure), 1);
+		/* wait for the secondaries to be stopped so we surely don't get
+		 * invalid reads when server_free is called */
+		for (i = 0; i < s->secondariescnt; i++) {
+			while (__sync_add_and_fetch(&(s->secondaries[i]->running), 0))
+				usleep((200 + (rand() % 100)) * 1000);
+		}
 	}
-	ret->fd = -1;
-	if ((ret->strm = malloc(sizeof(z_strm))) == NULL) {
-		if (ret->mtlspemcert != NULL)
-			free(ret->mtlspemcert);
-		if (ret->mtlspemkey != NULL)
-			free(ret->mtlspemkey);
-		free((char *)ret->ip);
-		free(ret->batch);
-		free(ret);
-		return NULL;
+
+	for (i = 0; i < s->lanecnt; i++)
+		server_shutdown(s->lanes[i]);
+
+	__sync_bool_compare_and_swap(&(s->keep_running), 1, 0);
+	/* don't let it sit out its wait */
+	if (s->pool != NULL) {
+		__sync_bool_compare_and_swap(&(s->woken), 0, 1);
+		server_pool_wake(s->pool);
+	} else {
+		pthread_mutex_lock(&s->wakelock);
+		pthread_cond_signal(&s->wakecond);
+		pthread_mutex_unlock(&s->wakelock);
 	}
-	ret->strm->nextstrm = NULL;
+}
+
+/**
+ * Frees this server and associated resources.  This includes joining
+ * the server thread.
+ */
+void
+server_free(server *s) {
+	int err;
 
-	/* setup normal or SSL-wrapped socket first */
-#ifdef HAVE_SSL
-	if (transport & W_SSL) {
-		/* create an auto-negotiate context */
-		const SSL_METHOD *m = SSLv23_client_method();
-		ret->strm->ctx = SSL_CTX_new(m);
+	if (s->tid != 0 && (err = pthread_join(s->tid, NULL)) != 0)
+		logerr("%s:%u: failed to join server thread: %s\n",
+				s->ip, s->port, strerror(err));
+	s->tid = 0;
+	if (s->pool != NULL) {
+		/* the sender thread stops stepping this server once its queue
+		 * is drained after server_shutdown */
+		while (__sync_add_and_fetch(&(s->running), 0))
+			usleep((200 + (rand() % 100)) * 1000);
+		server_pool_remove(s);
+	}
+	if (s->lanecnt > 0) {
+		int i;
+
+		for (i = 0; i < s->lanecnt; i++)
+			server_free(s->lanes[i]);
+		free(s->lanes);
+		s->lanes = NULL;
+		s->lanecnt = 0;
+	}
 
-		if (sslCA != NULL) {
-			if (ret->strm->ctx == NULL ||
-				SSL_CTX_load_verify_locations(ret->strm->ctx,
-											   sslCAisdir ? NULL : sslCA,
-											   sslCAisdir ? sslCA : NULL) == 0)
-			{
-				char *err = ERR_error_string(ERR_get_error(), NULL);
-				logerr("failed to load SSL verify locations from %s for "
-						"%s:%d: %s\n", sslCA, ret->ip, ret->port, err);
-				if (ret->mtlspemcert != NULL)
-					free(ret->mtlspemcert);
-				if (ret->mtlspemkey != NULL)
-					free(ret->mtlspemkey);
-				free((char *)ret->ip);
-				free(ret->batch);
-				SSL_CTX_free(ret->strm->ctx);
-				free(ret->strm);
-				free(ret);
-				return NULL;
-			}
-		}
-		SSL_CTX_set_verify(ret->strm->ctx, SSL_VERIFY_PEER, NULL);
+	if (s->spool != NULL) {
+		size_t len;
 
-		ret->strm->strmwrite = &sslwrite;
-		ret->strm->strmflush = &sslflush;
-		ret->strm->strmclose = &sslclose;
-		ret->strm->strmerror = &sslerror;
-	} else
-#endif
-	{
-		ret->strm->strmwrite = &sockwrite;
-		ret->strm->strmflush = &sockflush;
-		ret->strm->strmclose = &sockclose;
-		ret->strm->strmerror = &sockerror;
+		/* keep what is left for a next run */
+		while ((len = queue_dequeue_vector(s->batch, s->queue, s->bsize)) > 0)
+			server_spill(s, s->batch, len);
+	} else if (s->ctype == CON_TCP) {
+		size_t qlen = queue_len(s->queue);
+		if (qlen > 0)
+			logerr("dropping %zu metrics for %s:%u\n",
+					qlen, s->ip, s->port);
 	}
-	
-	/* now see if we have a compressor defined */
-	if ((transport & 0xFFFF) == W_PLAIN) {
-		/* catch noop */
+
+	queue_destroy(s->queue);
+	if (s->spool != NULL)
+		spool_free(s->spool);
+#ifdef HAVE_SSL
+	if (s->transport & W_SSL) {
+		z_strm *sstrm = (s->transport & 0xFFFF) == W_PLAIN ?
+			s->strm : s->strm->nextstrm;
+
+		if (sstrm->sess != NULL)
+			SSL_SESSION_free(sstrm->sess);
+		SSL_CTX_free(sstrm->ctx);
 	}
+#endif
+	free(s->batch);
+	if (s->pickle != NULL)
+		free(s->pickle);
+	pthread_cond_destroy(&s->wakecond);
+	pthread_mutex_destroy(&s->wakelock);
+	if (s->instance)
+		free(s->instance);
+	if (s->saddr != NULL)
+		freeaddrinfo(s->saddr);
+	if (s->hint)
+		free(s->hint);
+	if (s->mtlspemcert)
+		free(s->mtlspemcert);
+	if (s->mtlspemkey)
+		free(s->mtlspemkey);
+	free((char *)s->ip);
+#ifdef HAVE_ZSTD
+	if ((s->transport & 0xFFFF) == W_ZSTD)
+		ZSTD_freeCCtx(s->strm->hdl.zstd);
+#endif
 #ifdef HAVE_GZIP
-	else if ((transport & 0xFFFF) == W_GZIP) {
-		z_strm *gzstrm = malloc(sizeof(z_strm));
-		if (gzstrm == NULL) {
-			if (ret->mtlspemcert != NULL)
-				free(ret->mtlspemcert);
-			if (ret->mtlspemkey != NULL)
-				free(ret->mtlspemkey);
-			free((char *)ret->ip);
-			free(ret->batch);
-			free(ret->strm);
-			free(ret);
-			return NULL;
-		}
-		gzstrm->strmwrite = &gzipwrite;
-		gzstrm->strmflush = &gzipflush;
-		gzstrm->strmclose = &gzipclose;
-		gzstrm->strmerror = &gziperror;
-		gzstrm->nextstrm = ret->strm;
-		ret->strm = gzstrm;
-	}
+	if ((s->transport & 0xFFFF) == W_GZIP)
+		zpool_free(s->strm);
 #endif
 #ifdef HAVE_LZ4
-	else if ((transport & 0xFFFF) == W_LZ4) {
-		z_strm *lzstrm = malloc(sizeof(z_strm));
-		if (lzstrm == NULL) {
-			if (ret->mtlspemcert != NULL)
-				free(ret->mtlspemcert);
-			if (ret->mtlspemkey != NULL)
-				free(ret->mtlspemkey);
-			free((char *)ret->ip);
-			free(ret->batch);
-			free(ret->strm);
-			free(ret);
-			return NULL;
-		}
-		lzstrm->strmwrite = &lzwrite;
-		lzstrm->strmflush = &lzflush;
-		lzstrm->strmclose = &lzclose;
-		lzstrm->strmerror = &lzerror;
-		lzstrm->nextstrm = ret->strm;
-		ret->strm = lzstrm;
-	}
+	if ((s->transport & 0xFFFF) == W_LZ4)
+		zpool_free(s->strm);
 #endif
-#ifdef HAVE_SNAPPY
-	else if ((transport & 0xFFFF) == W_SNAPPY) {
-		z_strm *snpstrm = malloc(sizeof(z_strm));
-		if (snpstrm == NULL) {
-			if (ret->mtlspemcert != NULL)
-				free(ret->mtlspemcert);
-			if (ret->mtlspemkey != NULL)
-				free(ret->mtlspemkey);
-			free((char *)ret->ip);
-			free(ret->batch);
-			free(ret->strm);
-			free(ret);
-			return NULL;
+	if (s->ctype == CON_FILE)
+		filebuf_free(s->strm->fbuf);
+	if (s->strm->nextstrm != NULL)
+		free(s->strm->nextstrm);
+	free(s->strm);
+	s->ip = NULL;
+	free(s);
+}
+
+/**
+ * Swaps the queue between server l to r.  This is assumes both l and r
+ * are not running.
+ */
+void
+server_swap_queue(server *l, server *r)
+{
+	queue *t;
+	spool *sp;
+	const char *buf[256];
+	size_t stamps[256];
+	size_t len;
+	size_t left = 0;
+	int i;
+
+	assert(l->keep_running == 0 || l->tid == 0);
+	assert(r->keep_running == 0 || r->tid == 0);
+
+	t = l->queue;
+	l->queue = r->queue;
+	r->queue = t;
+	sp = l->spool;
+	l->spool = r->spool;
+	r->spool = sp;
+	
+	/* l has no lanes yet, so it takes over what r's lanes still had
+	 * queued, as far as it fits, the rest goes with r's lanes */
+	for (i = 0; i < r->lanecnt; i++) {
+		while ((len = queue_free(l->queue)) > 0) {
+			if (len > sizeof(buf) / sizeof(buf[0]))
+				len = sizeof(buf) / sizeof(buf[0]);
+			if ((len = queue_dequeue_vector_stamps(buf, stamps,
+							r->lanes[i]->queue, len)) == 0)
+				break;
+			queue_enqueue_vector_stamps(l->queue, buf, stamps, len);
 		}
-		snpstrm->strmwrite = &snappywrite;
-		snpstrm->strmflush = &snappyflush;
-		snpstrm->strmclose = &snappyclose;
-		snpstrm->strmerror = &snappyerror;
-		snpstrm->nextstrm = ret->strm;
-		ret->strm = snpstrm;
+		left += queue_len(r->lanes[i]->queue);
 	}
-#endif
 
-	ret->saddr = saddr;
-	ret->reresolve = 0;
-	ret->hint = NULL;
-	if (hint != NULL) {
-		ret->reresolve = 1;
-		ret->hint = hint;
+	/* swap associated statistics as well */
+	l->metrics = server_get_metrics(r);
+	l->dropped = server_get_dropped(r);
+	l->stalls = server_get_stalls(r);
+	l->ticks = server_get_ticks(r);
+	l->prevmetrics = r->prevmetrics;
+	l->prevdropped = r->prevdropped;
+	l->prevstalls = r->prevstalls;
+	l->prevticks = r->prevticks;
+	l->spilled = r->spilled;
+	l->replayed = r->replayed;
+	l->prevspilled = r->prevspilled;
+	l->prevreplayed = r->prevreplayed;
+	l->datagrams = r->datagrams;
+	l->senderrors = r->senderrors;
+	l->prevdatagrams = r->prevdatagrams;
+	l->prevsenderrors = r->prevsenderrors;
+	l->sslfull = r->sslfull;
+	l->sslresumed = r->sslresumed;
+	l->prevsslfull = r->prevsslfull;
+	l->prevsslresumed = r->prevsslresumed;
+	l->ktls = r->ktls;
+	l->prevktls = r->prevktls;
+	l->stolen = r->stolen;
+	l->prevstolen = r->prevstolen;
+	l->breakeropens = r->breakeropens;
+	l->prevbreakeropens = r->prevbreakeropens;
+	l->breakerprobes = r->breakerprobes;
+	l->prevbreakerprobes = r->prevbreakerprobes;
+	l->expired = r->expired;
+	l->prevexpired = r->prevexpired;
+	l->stallticks = r->stallticks;
+	l->prevstallticks = r->prevstallticks;
+
+	if (left > 0) {
+		logerr("server %s:%u: dropping %zu metrics queued for its "
+				"connections that don't fit its queue\n",
+				l->ip, l->port, left);
+		__sync_add_and_fetch(&(l->dropped), left);
 	}
-	ret->queue = queue_new(qsize);
-	if (ret->queue == NULL) {
-		if (ret->mtlspemcert != NULL)
-			free(ret->mtlspemcert);
-		if (ret->mtlspemkey != NULL)
-			free(ret->mtlspemkey);
-#ifdef HAVE_SSL
-		if (ret->strm->ctx != NULL)
-			SSL_CTX_free(ret->strm->ctx);
-#endif
-		if (ret->strm->nextstrm != NULL)
-			free(ret->strm->nextstrm);
-		free(ret->strm);
-		free(ret->batch);
-		free((char *)ret->ip);
-		free(ret);
+}
+
+/**
+ * Returns the ip address this server points to.
+ */
+inline const char *
+server_ip(server *s)
+{
+	if (s == NULL)
 		return NULL;
-	}
+	return s->ip;
+}
+
+/**
+ * Returns the port this server connects at.
+ */
+inline unsigned short
+server_port(server *s)
+{
+	if (s == NULL)
+		return 0;
+	return s->port;
+}
+
+/**
+ * Returns the instance associated with this server.
+ */
+inline char *
+server_instance(server *s)
+{
+	return s->instance;
+}
+
+/**
+ * Returns the connection protocol of this server.
+ */
+inline con_proto
+server_ctype(server *s)
+{
+	if (s == NULL)
+		return CON_PIPE;
+	return s->ctype;
+}
+
+/**
+ * Returns the connection transport of this server.
+ */
+inline con_trnsp
+server_transport(server *s)
+{
+	if (s == NULL)
+		return W_PLAIN;
+	return s->transport;
+}
+
+/**
+ * Returns the connection type of this server.
+ */
+inline con_type
+server_type(server *s)
+{
+	if (s == NULL)
+		return T_LINEMODE;
+	return s->type;
+}
+
+/**
+ * Returns whether the last action on this server caused a failure.
+ */
+inline char
+server_failed(server *s)
+{
+	if (s == NULL)
+		return 0;
+	if (!s->failover && s->secondariescnt > 0)
+		return __sync_add_and_fetch(&(s->failure), 0) >= FAIL_WAIT_TIME;
+	else
+		return __sync_add_and_fetch(&(s->failure), 0) > 0;
+}
 
-	ret->failover = 0;
-	ret->failure = 0;
-	ret->running = 0;
-	ret->keep_running = 1;
-	ret->stallseq = 0;
-	ret->metrics = 0;
-	ret->dropped = 0;
-	ret->stalls = 0;
-	ret->ticks = 0;
-	ret->prevmetrics = 0;
-	ret->prevdropped = 0;
-	ret->prevstalls = 0;
-	ret->prevticks = 0;
-	ret->tid = 0;
+/**
+ * Returns the wall-clock time in microseconds (us) consumed sending metrics.
+ */
+inline size_t
+server_get_ticks(server *s)
+{
+	size_t ret;
+	int i;
 
+	if (s == NULL)
+		return 0;
+	ret = __sync_add_and_fetch(&(s->ticks), 0);
+	for (i = 0; i < s->lanecnt; i++)
+		ret += __sync_add_and_fetch(&(s->lanes[i]->ticks), 0);
 	return ret;
 }
 
 /**
- * Compare server s against the address info in saddr.  A server is
- * considered to be equal is it is of the same socket family, type and
- * protocol, and if the target address and port are the same.  When
- * saddr is NULL, a match against the given ip is attempted, e.g. for
- * file destinations.
+ * Returns the wall-clock time in microseconds (us) consumed since last
+ * call to this function.
  */
-char
-server_cmp(server *s, struct addrinfo *saddr, const char *ip)
+inline size_t
+server_get_ticks_sub(server *s)
 {
-	if ((saddr == NULL || s->saddr == NULL)) {
-		if (strcmp(s->ip, ip) == 0)
-			return 0;
-	} else if (
-			s->saddr->ai_family == saddr->ai_family &&
-			s->saddr->ai_socktype == saddr->ai_socktype &&
-			s->saddr->ai_protocol == saddr->ai_protocol
-	   )
-	{
-		if (saddr->ai_family == AF_INET) {
-			struct sockaddr_in *l = ((struct sockaddr_in *)s->saddr->ai_addr);
-			struct sockaddr_in *r = ((struct sockaddr_in *)saddr->ai_addr);
-			if (l->sin_port == r->sin_port &&
-					l->sin_addr.s_addr == r->sin_addr.s_addr)
-				return 0;
-		} else if (saddr->ai_family == AF_INET6) {
-			struct sockaddr_in6 *l =
-				((struct sockaddr_in6 *)s->saddr->ai_addr);
-			struct sockaddr_in6 *r =
-				((struct sockaddr_in6 *)saddr->ai_addr);
-			if (l->sin6_port == r->sin6_port &&
-					memcmp(l->sin6_addr.s6_addr, r->sin6_addr.s6_addr,
-						sizeof(l->sin6_addr.s6_addr)) == 0)
-				return 0;
-		}
-	}
+	size_t d;
+	if (s == NULL)
+		return 0;
+	d = server_get_ticks(s) - s->prevticks;
+	s->prevticks += d;
+	return d;
+}
 
-	return 1;  /* not equal */
+/**
+ * Returns the number of metrics sent since start.
+ */
+inline size_t
+server_get_metrics(server *s)
+{
+	size_t ret;
+	int i;
+
+	if (s == NULL)
+		return 0;
+	ret = __sync_add_and_fetch(&(s->metrics), 0);
+	for (i = 0; i < s->lanecnt; i++)
+		ret += __sync_add_and_fetch(&(s->lanes[i]->metrics), 0);
+	return ret;
 }
 
 /**
- * Starts a previously created server using server_new().  Returns
- * errno if starting a thread failed, after which the caller should
- * server_free() the given s pointer.
+ * Returns the number of metrics sent since last call to this function.
  */
-char
-server_start(server *s)
+inline size_t
+server_get_metrics_sub(server *s)
 {
-	return pthread_create(&s->tid, NULL, &server_queuereader, s);
+	size_t d;
+	if (s == NULL)
+		return 0;
+	d = server_get_metrics(s) - s->prevmetrics;
+	s->prevmetrics += d;
+	return d;
 }
 
 /**
- * Adds a list of secondary servers to this server.  A secondary server
- * is a server which' queue will be checked when this server has nothing
- * to do.
+ * Returns the number of metrics dropped since start.
  */
-void
-server_add_secondaries(server *self, server **secondaries, size_t count)
+inline size_t
+server_get_dropped(server *s)
 {
-	self->secondaries = secondaries;
-	self->secondariescnt = count;
+	size_t ret;
+	int i;
+
+	if (s == NULL)
+		return 0;
+	ret = __sync_add_and_fetch(&(s->dropped), 0);
+	for (i = 0; i < s->lanecnt; i++)
+		ret += __sync_add_and_fetch(&(s->lanes[i]->dropped), 0);
+	return ret;
 }
 
 /**
- * Flags this server as part of a failover cluster, which means the
- * secondaries are used only to offload on failure, not on queue stress.
+ * Returns the number of metrics dropped since last call to this function.
  */
-void
-server_set_failover(server *self)
+inline size_t
+server_get_dropped_sub(server *s)
 {
-	self->failover = 1;
+	size_t d;
+	if (s == NULL)
+		return 0;
+	d = server_get_dropped(s) - s->prevdropped;
+	s->prevdropped += d;
+	return d;
 }
 
 /**
- * Sets instance name only used for carbon_ch cluster type.
+ * Returns the number of stalls since start.  A stall happens when the
+ * queue is full, but it appears as if it would be a good idea to wait
+ * for a brief period and retry.
  */
-void
-server_set_instance(server *self, char *instance)
+inline size_t
+server_get_stalls(server *s)
 {
-	if (self->instance != NULL)
-		free(self->instance);
-	self->instance = strdup(instance);
+	size_t ret;
+	int i;
+
+	if (s == NULL)
+		return 0;
+	ret = __sync_add_and_fetch(&(s->stalls), 0);
+	for (i = 0; i < s->lanecnt; i++)
+		ret += __sync_add_and_fetch(&(s->lanes[i]->stalls), 0);
+	return ret;
 }
 
 /**
- * Thin wrapper around the associated queue with the server object.
- * Returns true if the metric could be queued for sending, or the metric
- * was dropped because the associated server is down.  Returns false
- * otherwise (when a retry seems like it could succeed shortly).
+ * Returns the number of stalls since last call to this function.
  */
-inline char
-server_send(server *s, const char *d, char force)
+inline size_t
+server_get_stalls_sub(server *s)
 {
-	if (queue_free(s->queue) == 0) {
-		char failure = __sync_add_and_fetch(&(s->failure), 0);
-		if (!force && s->secondariescnt > 0) {
-			size_t i;
-			/* don't immediately drop if we know there are others that
-			 * back us up */
-			for (i = 0; i < s->secondariescnt; i++) {
-				if (!__sync_add_and_fetch(&(s->secondaries[i]->failure), 0)) {
-					failure = 0;
-					break;
-				}
-			}
-		}
-		if (failure || force ||
-				__sync_add_and_fetch(&(s->stallseq), 0) == s->maxstalls)
-		{
-			__sync_add_and_fetch(&(s->dropped), 1);
-			/* excess event will be dropped by the enqueue below */
-		} else {
-			__sync_add_and_fetch(&(s->stallseq), 1);
-			__sync_add_and_fetch(&(s->stalls), 1);
-			return 0;
-		}
-	} else {
-		__sync_and_and_fetch(&(s->stallseq), 0);
-	}
-	queue_enqueue(s->queue, d);
+	size_t d;
+	if (s == NULL)
+		return 0;
+	d = server_get_stalls(s) - s->prevstalls;
+	s->prevstalls += d;
+	return d;
+}
 
-	return 1;
+/**
+ * Returns the time in microseconds clients were stalled because the
+ * queue of this server was full, since start.  A stall is accounted
+ * for when it ends.
+ */
+inline size_t
+server_get_stallticks(server *s)
+{
+	if (s == NULL)
+		return 0;
+	return __sync_add_and_fetch(&(s->stallticks), 0);
 }
 
 /**
- * Flag worker main loop to close the connection if currently open.
+ * Returns the time in microseconds clients were stalled because the
+ * queue of this server was full, since last call to this function.
  */
-void
-server_closecon(server *s)
+inline size_t
+server_get_stallticks_sub(server *s)
 {
-	__sync_bool_compare_and_swap(&(s->reopen_con), 0, 1);
+	size_t d;
+	if (s == NULL)
+		return 0;
+	d = __sync_add_and_fetch(&(s->stallticks), 0) - s->prevstallticks;
+	s->prevstallticks += d;
+	return d;
 }
 
 /**
- * Tells this server to finish sending pending items from its queue.
+ * Returns the (approximate) number of metrics waiting to be sent.
  */
-void
-server_shutdown(server *s)
+inline size_t
+server_get_queue_len(server *s)
 {
+	size_t ret;
 	int i;
-	size_t failures;
-	size_t inqueue;
 
-	/* this function should only be called on a running server */
-	if (__sync_bool_compare_and_swap(&(s->keep_running), 0, 0))
-		return;
+	if (s == NULL)
+		return 0;
+	ret = queue_len(s->queue);
+	for (i = 0; i < s->lanecnt; i++)
+		ret += queue_len(s->lanes[i]->queue);
+	return ret;
+}
 
-	if (s->secondariescnt > 0) {
-		/* if we have a working connection, or we still have stuff in
-		 * our queue, wait for our secondaries, as they might need us,
-		 * or we need them */
-		do {
-			failures = 0;
-			inqueue = 0;
-			for (i = 0; i < s->secondariescnt; i++) {
-				if (__sync_add_and_fetch(&(s->secondaries[i]->failure), 0))
-					failures++;
-				if (__sync_add_and_fetch(&(s->secondaries[i]->running), 0))
-					inqueue += queue_len(s->secondaries[i]->queue);
-			}
-			/* loop until we all failed, or nothing is in the queues */
-		} while (failures != s->secondariescnt &&
-				inqueue != 0 &&
-				logout("any_of cluster pending %zu metrics "
-					"(with %zu failed nodes)\n", inqueue, failures) >= -1 &&
-				usleep((200 + (rand() % 100)) * 1000) <= 0);
-		/* shut down entire cluster */
-		for (i = 0; i < s->secondariescnt; i++)
-			__sync_bool_compare_and_swap(
-					&(s->secondaries[i]->keep_running), 1, 0);
-		/* to pretend to be dead for above loop (just in case) */
-		if (inqueue != 0)
-			for (i = 0; i < s->secondariescnt; i++)
-				__sync_add_and_fetch(&(s->secondaries[i]->failure), 1);
-		/* wait for the secondaries to be stopped so we surely don't get
-		 * invalid reads when server_free is called */
-		for (i = 0; i < s->secondariescnt; i++) {
-			while (__sync_add_and_fetch(&(s->secondaries[i]->running), 0))
-				usleep((200 + (rand() % 100)) * 1000);
-		}
-	}
+/**
+ * Returns the (approximate) number of bytes used by metrics waiting to
+ * be sent.
+ */
+inline size_t
+server_get_queue_bytes(server *s)
+{
+	size_t ret;
+	int i;
 
-	__sync_bool_compare_and_swap(&(s->keep_running), 1, 0);
+	if (s == NULL)
+		return 0;
+	ret = queue_bytes(s->queue);
+	for (i = 0; i < s->lanecnt; i++)
+		ret += queue_bytes(s->lanes[i]->queue);
+	return ret;
 }
 
 /**
- * Frees this server and associated resources.  This includes joining
- * the server thread.
+ * Returns the allocated size of the queue backing metrics waiting to be
+ * sent.
  */
-void
-server_free(server *s) {
-	int err;
+inline size_t
+server_get_queue_size(server *s)
+{
+	size_t ret;
+	int i;
 
-	if (s->tid != 0 && (err = pthread_join(s->tid, NULL)) != 0)
-		logerr("%s:%u: failed to join server thread: %s\n",
-				s->ip, s->port, strerror(err));
-	s->tid = 0;
+	if (s == NULL)
+		return 0;
+	ret = queue_size(s->queue);
+	for (i = 0; i < s->lanecnt; i++)
+		ret += queue_size(s->lanes[i]->queue);
+	return ret;
+}
 
-	if (s->ctype == CON_TCP) {
-		size_t qlen = queue_len(s->queue);
-		if (qlen > 0)
-			logerr("dropping %zu metrics for %s:%u\n",
-					qlen, s->ip, s->port);
-	}
+/**
+ * Returns the number of bytes written to the spool since start.
+ */
+inline size_t
+server_get_spilled(server *s)
+{
+	if (s == NULL)
+		return 0;
+	return __sync_add_and_fetch(&(s->spilled), 0);
+}
 
-	queue_destroy(s->queue);
-#ifdef HAVE_SSL
-	if (s->transport & W_SSL)
-		SSL_CTX_free(s->strm->ctx);
-#endif
-	free(s->batch);
-	if (s->instance)
-		free(s->instance);
-	if (s->saddr != NULL)
-		freeaddrinfo(s->saddr);
-	if (s->hint)
-		free(s->hint);
-	if (s->mtlspemcert)
-		free(s->mtlspemcert);
-	if (s->mtlspemkey)
-		free(s->mtlspemkey);
-	free((char *)s->ip);
-	if (s->strm->nextstrm != NULL)
-		free(s->strm->nextstrm);
-	free(s->strm);
-	s->ip = NULL;
-	free(s);
+/**
+ * Returns the number of bytes written to the spool since last call to
+ * this function.
+ */
+inline size_t
+server_get_spilled_sub(server *s)
+{
+	size_t d;
+	if (s == NULL)
+		return 0;
+	d = __sync_add_and_fetch(&(s->spilled), 0) - s->prevspilled;
+	s->prevspilled += d;
+	return d;
 }
 
 /**
- * Swaps the queue between server l to r.  This is assumes both l and r
- * are not running.
+ * Returns the number of bytes read back from the spool since start.
  */
-void
-server_swap_queue(server *l, server *r)
+inline size_t
+server_get_replayed(server *s)
 {
-	queue *t;
+	if (s == NULL)
+		return 0;
+	return __sync_add_and_fetch(&(s->replayed), 0);
+}
 
-	assert(l->keep_running == 0 || l->tid == 0);
-	assert(r->keep_running == 0 || r->tid == 0);
+/**
+ * Returns the number of bytes read back from the spool since last call
+ * to this function.
+ */
+inline size_t
+server_get_replayed_sub(server *s)
+{
+	size_t d;
+	if (s == NULL)
+		return 0;
+	d = __sync_add_and_fetch(&(s->replayed), 0) - s->prevreplayed;
+	s->prevreplayed += d;
+	return d;
+}
 
-	t = l->queue;
-	l->queue = r->queue;
-	r->queue = t;
-	
-	/* swap associated statistics as well */
-	l->metrics = r->metrics;
-	l->dropped = r->dropped;
-	l->stalls = r->stalls;
-	l->ticks = r->ticks;
-	l->prevmetrics = r->prevmetrics;
-	l->prevdropped = r->prevdropped;
-	l->prevstalls = r->prevstalls;
-	l->prevticks = r->prevticks;
+/**
+ * Returns the number of datagrams sent since start.
+ */
+inline size_t
+server_get_datagrams(server *s)
+{
+	if (s == NULL)
+		return 0;
+	return __sync_add_and_fetch(&(s->datagrams), 0);
 }
 
 /**
- * Returns the ip address this server points to.
+ * Returns the number of datagrams sent since last call to this
+ * function.
  */
-inline const char *
-server_ip(server *s)
+inline size_t
+server_get_datagrams_sub(server *s)
 {
+	size_t d;
 	if (s == NULL)
-		return NULL;
-	return s->ip;
+		return 0;
+	d = __sync_add_and_fetch(&(s->datagrams), 0) - s->prevdatagrams;
+	s->prevdatagrams += d;
+	return d;
 }
 
 /**
- * Returns the port this server connects at.
+ * Returns the number of failed datagram sends since start.
  */
-inline unsigned short
-server_port(server *s)
+inline size_t
+server_get_senderrors(server *s)
 {
 	if (s == NULL)
 		return 0;
-	return s->port;
+	return __sync_add_and_fetch(&(s->senderrors), 0);
 }
 
 /**
- * Returns the instance associated with this server.
+ * Returns the number of failed datagram sends since last call to this
+ * function.
  */
-inline char *
-server_instance(server *s)
+inline size_t
+server_get_senderrors_sub(server *s)
 {
-	return s->instance;
+	size_t d;
+	if (s == NULL)
+		return 0;
+	d = __sync_add_and_fetch(&(s->senderrors), 0) - s->prevsenderrors;
+	s->prevsenderrors += d;
+	return d;
 }
 
 /**
- * Returns the connection protocol of this server.
+ * Returns the number of full TLS handshakes since start.
  */
-inline con_proto
-server_ctype(server *s)
+inline size_t
+server_get_sslfull(server *s)
 {
 	if (s == NULL)
-		return CON_PIPE;
-	return s->ctype;
+		return 0;
+	return __sync_add_and_fetch(&(s->sslfull), 0);
 }
 
 /**
- * Returns the connection transport of this server.
+ * Returns the number of full TLS handshakes since last call to this
+ * function.
  */
-inline con_trnsp
-server_transport(server *s)
+inline size_t
+server_get_sslfull_sub(server *s)
 {
+	size_t d;
 	if (s == NULL)
-		return W_PLAIN;
-	return s->transport;
+		return 0;
+	d = __sync_add_and_fetch(&(s->sslfull), 0) - s->prevsslfull;
+	s->prevsslfull += d;
+	return d;
 }
 
 /**
- * Returns the connection type of this server.
+ * Returns the number of TLS handshakes that resumed a previous session
+ * since start.
  */
-inline con_type
-server_type(server *s)
+inline size_t
+server_get_sslresumed(server *s)
 {
 	if (s == NULL)
-		return T_LINEMODE;
-	return s->type;
+		return 0;
+	return __sync_add_and_fetch(&(s->sslresumed), 0);
 }
 
 /**
- * Returns whether the last action on this server caused a failure.
+ * Returns the number of TLS handshakes that resumed a previous session
+ * since last call to this function.
  */
-inline char
-server_failed(server *s)
+inline size_t
+server_get_sslresumed_sub(server *s)
 {
+	size_t d;
 	if (s == NULL)
 		return 0;
-	if (!s->failover && s->secondariescnt > 0)
-		return __sync_add_and_fetch(&(s->failure), 0) >= FAIL_WAIT_TIME;
-	else
-		return __sync_add_and_fetch(&(s->failure), 0) > 0;
+	d = __sync_add_and_fetch(&(s->sslresumed), 0) - s->prevsslresumed;
+	s->prevsslresumed += d;
+	return d;
 }
 
 /**
- * Returns the wall-clock time in microseconds (us) consumed sending metrics.
+ * Returns the number of connections encrypted by the kernel (kTLS)
+ * since start.
  */
 inline size_t
-server_get_ticks(server *s)
+server_get_ktls(server *s)
 {
 	if (s == NULL)
 		return 0;
-	return __sync_add_and_fetch(&(s->ticks), 0);
+	return __sync_add_and_fetch(&(s->ktls), 0);
 }
 
 /**
- * Returns the wall-clock time in microseconds (us) consumed since last
- * call to this function.
+ * Returns the number of connections encrypted by the kernel (kTLS)
+ * since last call to this function.
  */
 inline size_t
-server_get_ticks_sub(server *s)
+server_get_ktls_sub(server *s)
 {
 	size_t d;
 	if (s == NULL)
 		return 0;
-	d = __sync_add_and_fetch(&(s->ticks), 0) - s->prevticks;
-	s->prevticks += d;
+	d = __sync_add_and_fetch(&(s->ktls), 0) - s->prevktls;
+	s->prevktls += d;
 	return d;
 }
 
 /**
- * Returns the number of metrics sent since start.
+ * Returns the number of metrics taken over from other members of the
+ * any_of cluster since start.
  */
 inline size_t
-server_get_metrics(server *s)
+server_get_stolen(server *s)
 {
 	if (s == NULL)
 		return 0;
-	return __sync_add_and_fetch(&(s->metrics), 0);
+	return __sync_add_and_fetch(&(s->stolen), 0);
 }
 
 /**
- * Returns the number of metrics sent since last call to this function.
+ * Returns the number of metrics taken over from other members of the
+ * any_of cluster since last call to this function.
  */
 inline size_t
-server_get_metrics_sub(server *s)
+server_get_stolen_sub(server *s)
 {
 	size_t d;
 	if (s == NULL)
 		return 0;
-	d = __sync_add_and_fetch(&(s->metrics), 0) - s->prevmetrics;
-	s->prevmetrics += d;
+	d = __sync_add_and_fetch(&(s->stolen), 0) - s->prevstolen;
+	s->prevstolen += d;
 	return d;
 }
 
 /**
- * Returns the number of metrics dropped since start.
+ * Returns the state of the circuit breaker of this server, one of the
+ * BREAKER_* values.
+ */
+inline char
+server_get_breaker(server *s)
+{
+	if (s == NULL)
+		return BREAKER_CLOSED;
+	return __sync_add_and_fetch(&(s->breaker), 0);
+}
+
+/**
+ * Returns the number of times the circuit breaker of this server
+ * opened since start.
  */
 inline size_t
-server_get_dropped(server *s)
+server_get_breakeropens(server *s)
 {
 	if (s == NULL)
 		return 0;
-	return __sync_add_and_fetch(&(s->dropped), 0);
+	return __sync_add_and_fetch(&(s->breakeropens), 0);
 }
 
 /**
- * Returns the number of metrics dropped since last call to this function.
+ * Returns the number of times the circuit breaker of this server
+ * opened since last call to this function.
  */
 inline size_t
-server_get_dropped_sub(server *s)
+server_get_breakeropens_sub(server *s)
 {
 	size_t d;
 	if (s == NULL)
 		return 0;
-	d = __sync_add_and_fetch(&(s->dropped), 0) - s->prevdropped;
-	s->prevdropped += d;
+	d = __sync_add_and_fetch(&(s->breakeropens), 0) - s->prevbreakeropens;
+	s->prevbreakeropens += d;
 	return d;
 }
 
 /**
- * Returns the number of stalls since start.  A stall happens when the
- * queue is full, but it appears as if it would be a good idea to wait
- * for a brief period and retry.
+ * Returns the number of connects tried while the circuit breaker of
+ * this server was half-open since start.
  */
 inline size_t
-server_get_stalls(server *s)
+server_get_breakerprobes(server *s)
 {
 	if (s == NULL)
 		return 0;
-	return __sync_add_and_fetch(&(s->stalls), 0);
+	return __sync_add_and_fetch(&(s->breakerprobes), 0);
 }
 
 /**
- * Returns the number of stalls since last call to this function.
+ * Returns the number of connects tried while the circuit breaker of
+ * this server was half-open since last call to this function.
  */
 inline size_t
-server_get_stalls_sub(server *s)
+server_get_breakerprobes_sub(server *s)
 {
 	size_t d;
 	if (s == NULL)
 		return 0;
-	d = __sync_add_and_fetch(&(s->stalls), 0) - s->prevstalls;
-	s->prevstalls += d;
+	d = __sync_add_and_fetch(&(s->breakerprobes), 0) - s->prevbreakerprobes;
+	s->prevbreakerprobes += d;
 	return d;
 }
 
 /**
- * Returns the (approximate) number of metrics waiting to be sent.
+ * Returns the number of metrics dropped for being queued too long
+ * since start.
  */
 inline size_t
-server_get_queue_len(server *s)
+server_get_expired(server *s)
 {
 	if (s == NULL)
 		return 0;
-	return queue_len(s->queue);
+	return __sync_add_and_fetch(&(s->expired), 0);
 }
 
 /**
- * Returns the allocated size of the queue backing metrics waiting to be
- * sent.
+ * Returns the number of metrics dropped for being queued too long
+ * since last call to this function.
  */
 inline size_t
-server_get_queue_size(server *s)
+server_get_expired_sub(server *s)
+{
+	size_t d;
+	if (s == NULL)
+		return 0;
+	d = __sync_add_and_fetch(&(s->expired), 0) - s->prevexpired;
+	s->prevexpired += d;
+	return d;
+}
+
+/**
+ * Returns whether metrics queued for this server expire.
+ */
+inline char
+server_has_expire(server *s)
+{
+	if (s == NULL)
+		return 0;
+	return s->expireus > 0;
+}
+
+/**
+ * Returns whether this server takes over work from other members of
+ * its any_of cluster.
+ */
+inline char
+server_has_steal(server *s)
+{
+	if (s == NULL)
+		return 0;
+	return s->steal;
+}
+
+/**
+ * Returns whether this server spills to disk.
+ */
+inline char
+server_has_spool(server *s)
+{
+	return s != NULL && s->spool != NULL;
+}
+
+/**
+ * Returns the age in seconds of the oldest data in the spool, or 0 if
+ * the spool is empty.
+ */
+size_t
+server_get_spool_age(server *s)
+{
+	time_t t;
+
+	if (s == NULL || s->spool == NULL || (t = spool_age(s->spool)) == 0)
+		return 0;
+	t = time(NULL) - t;
+	return t < 0 ? 0 : (size_t)t;
+}
+
+/**
+ * Stores the 50th and 99th percentile of the time in microseconds
+ * between queueing and writing of the metrics written since the
+ * previous call in p50 and p99.  Both are 0 when nothing was written.
+ */
+void
+server_get_latency(server *s, size_t *p50, size_t *p99)
+{
+	size_t cnt[LAT_BUCKETS];
+	size_t total = 0;
+	size_t sum;
+	size_t d;
+	size_t i;
+	int l;
+
+	*p50 = *p99 = 0;
+	if (s == NULL)
+		return;
+	for (i = 0; i < LAT_BUCKETS; i++) {
+		cnt[i] = __sync_add_and_fetch(&(s->lathist[i]), 0) -
+			s->prevlathist[i];
+		s->prevlathist[i] += cnt[i];
+		for (l = 0; l < s->lanecnt; l++) {
+			d = __sync_add_and_fetch(&(s->lanes[l]->lathist[i]), 0) -
+				s->lanes[l]->prevlathist[i];
+			s->lanes[l]->prevlathist[i] += d;
+			cnt[i] += d;
+		}
+		total += cnt[i];
+	}
+	if (total == 0)
+		return;
+
+	for (i = 0, sum = 0; i < LAT_BUCKETS; i++) {
+		if (sum < (total + 1) / 2 && sum + cnt[i] >= (total + 1) / 2)
+			*p50 = server_latency_value(i);
+		sum += cnt[i];
+		if (sum >= total - total / 100) {
+			*p99 = server_latency_value(i);
+			break;
+		}
+	}
+}
+
+/**
+ * Returns whether this server may use multiple connections.
+ */
+inline char
+server_has_lanes(server *s)
+{
+	return s != NULL && s->lanecnt > 0;
+}
+
+/**
+ * Returns the number of connections this server currently uses.
+ */
+inline size_t
+server_get_conns(server *s)
 {
 	if (s == NULL)
 		return 0;
-	return queue_size(s->queue);
+	return (size_t)__sync_add_and_fetch(&(s->conns), 0);
 }
@@ -23,6 +23,15 @@
 #include "relay.h"
 
 #define SERVER_STALL_BITS  4  /* 0 up to 15 */
+#define SERVER_MAX_CONNS  16
+#define SERVER_UDP_SIZE     1472   /* 1500 byte MTU minus IP and UDP */
+#define SERVER_UDP_MAXSIZE  65507  /* largest IPv4 UDP payload */
+#define SERVER_FILE_BUFSIZ  (1024 * 1024)  /* default file write buffer */
+
+/* circuit breaker states, see server_get_breaker */
+#define BREAKER_CLOSED    0
+#define BREAKER_OPEN      1
+#define BREAKER_HALFOPEN  2
 
 typedef struct _server server;
 
@@ -46,8 +55,28 @@ char server_start(server *s);
 void server_closecon(server *s);
 void server_add_secondaries(server *d, server **sec, size_t cnt);
 void server_set_failover(server *d);
+void server_set_steal(server *d);
+void server_set_rate(server *d, size_t metrics, size_t bytes,
+		size_t burst, size_t catchup, size_t above);
+void server_set_expire(server *d, int seconds);
+void server_set_nostall(server *d);
+void server_set_file(server *d, size_t bufsize, char dbl, int sync,
+		int rotatesecs, size_t rotatebytes);
 void server_set_instance(server *d, char *inst);
+void server_set_spool(const char *dir, size_t maxbytes);
+void server_set_membudget(size_t maxbytes, char stall);
+void server_set_maxflush(unsigned int ms);
+int server_set_compressors(int threads);
+void server_set_maxconns(int conns);
+void server_set_udpsize(size_t bytes);
+void server_set_sslkeepalive(char keep);
+#ifdef HAVE_ZSTD
+int server_set_zstd(int level, const void *dict, size_t dictlen);
+#endif
+int server_set_pool(int threads);
+void server_stop_pool(void);
 char server_send(server *s, const char *d, char force);
+size_t server_send_vector(server *s, const char **d, size_t len, char force);
 void server_shutdown(server *s);
 void server_free(server *s);
 void server_swap_queue(server *l, server *r);
@@ -67,6 +96,39 @@ size_t server_get_metrics_sub(server *s);
 size_t server_get_stalls_sub(server *s);
 size_t server_get_dropped_sub(server *s);
 size_t server_get_queue_len(server *s);
+size_t server_get_queue_bytes(server *s);
 size_t server_get_queue_size(server *s);
+char server_has_spool(server *s);
+size_t server_get_spilled(server *s);
+size_t server_get_replayed(server *s);
+size_t server_get_spilled_sub(server *s);
+size_t server_get_replayed_sub(server *s);
+size_t server_get_datagrams(server *s);
+size_t server_get_senderrors(server *s);
+size_t server_get_datagrams_sub(server *s);
+size_t server_get_senderrors_sub(server *s);
+size_t server_get_sslfull(server *s);
+size_t server_get_sslresumed(server *s);
+size_t server_get_sslfull_sub(server *s);
+size_t server_get_sslresumed_sub(server *s);
+size_t server_get_ktls(server *s);
+size_t server_get_ktls_sub(server *s);
+size_t server_get_stolen(server *s);
+size_t server_get_stolen_sub(server *s);
+char server_has_steal(server *s);
+size_t server_get_expired(server *s);
+size_t server_get_expired_sub(server *s);
+char server_has_expire(server *s);
+size_t server_get_stallticks(server *s);
+size_t server_get_stallticks_sub(server *s);
+char server_get_breaker(server *s);
+size_t server_get_breakeropens(server *s);
+size_t server_get_breakeropens_sub(server *s);
+size_t server_get_breakerprobes(server *s);
+size_t server_get_breakerprobes_sub(server *s);
+size_t server_get_spool_age(server *s);
+void server_get_latency(server *s, size_t *p50, size_t *p99);
+char server_has_lanes(server *s);
+size_t server_get_conns(server *s);
 
 #endif
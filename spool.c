@@ -0,0 +1,450 @@
+/*
+ * Copyright 2013-2025 Fabian Groffen
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "relay.h"
+#include "spool.h"
+
+#define SPOOL_MAGIC          "CRSP"
+#define SPOOL_VERSION        1
+#define SPOOL_SEGMENT_SIZE   (16 * 1024 * 1024)
+#define SPOOL_MIN_SEGMENT    (64 * 1024)
+
+/* A spool is a sequence of segment files named <name>.<seq>.spool.
+ * Each segment starts with a header, followed by records consisting of
+ * a length, a CRC32 of the data, and the data itself.  Segments are
+ * created at full size, which means a zero length marks the end of the
+ * data written so far.  The read offset is kept in the header, such
+ * that draining resumes where it left off after a restart. */
+typedef struct {
+	char magic[4];
+	uint32_t version;
+	uint64_t seq;
+	int64_t ctime;
+	uint32_t crc;      /* over the fields above */
+	uint32_t reserved;
+	uint64_t rpos;     /* read offset, advanced while draining */
+} spool_hdr;
+
+typedef struct {
+	uint32_t len;
+	uint32_t crc;
+} spool_rec;
+
+typedef struct {
+	char *map;
+	size_t size;
+} spool_seg;
+
+struct _spool {
+	char *prefix;      /* <dir>/<name> */
+	size_t segsize;
+	size_t maxsegs;
+	uint64_t rseq;     /* oldest segment, being drained */
+	uint64_t wseq;     /* newest segment, being appended to */
+	spool_seg rseg;
+	spool_seg wseg;
+	size_t wpos;
+	size_t pending;    /* bytes of data waiting to be read */
+	pthread_mutex_t lock;
+};
+
+static uint32_t spool_crctab[256];
+
+static void
+spool_crcinit(void)
+{
+	uint32_t c;
+	int i;
+	int j;
+
+	if (spool_crctab[1] != 0)
+		return;
+	for (i = 0; i < 256; i++) {
+		c = (uint32_t)i;
+		for (j = 0; j < 8; j++)
+			c = c & 1 ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+		spool_crctab[i] = c;
+	}
+}
+
+static uint32_t
+spool_crc32(const void *buf, size_t len)
+{
+	const unsigned char *p = buf;
+	uint32_t c = 0xFFFFFFFF;
+
+	while (len-- > 0)
+		c = spool_crctab[(c ^ *p++) & 0xFF] ^ (c >> 8);
+	return c ^ 0xFFFFFFFF;
+}
+
+static inline uint32_t
+spool_hdrcrc(spool_hdr *hdr)
+{
+	return spool_crc32(hdr, offsetof(spool_hdr, crc));
+}
+
+static void
+spool_path(spool *s, uint64_t seq, char *buf, size_t bufsize)
+{
+	snprintf(buf, bufsize, "%s.%llu.spool", s->prefix, (unsigned long long)seq);
+}
+
+/**
+ * Maps segment seq into seg.  When create is set, the segment is
+ * created and initialised.  Returns 0 if the segment cannot be mapped
+ * or (when not created) fails validation.
+ */
+static char
+spool_map(spool *s, spool_seg *seg, uint64_t seq, char create)
+{
+	char path[1024];
+	struct stat st;
+	spool_hdr *hdr;
+	int fd;
+
+	spool_path(s, seq, path, sizeof(path));
+	if ((fd = open(path, create ? O_RDWR | O_CREAT | O_TRUNC : O_RDWR,
+					0600)) < 0)
+	{
+		if (create)
+			logerr("spool: failed to create %s: %s\n", path, strerror(errno));
+		return 0;
+	}
+	if (create && ftruncate(fd, s->segsize) != 0) {
+		logerr("spool: failed to size %s: %s\n", path, strerror(errno));
+		close(fd);
+		unlink(path);
+		return 0;
+	}
+	if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(spool_hdr)) {
+		close(fd);
+		return 0;
+	}
+	seg->size = (size_t)st.st_size;
+	seg->map = mmap(NULL, seg->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (seg->map == MAP_FAILED) {
+		logerr("spool: failed to map %s: %s\n", path, strerror(errno));
+		seg->map = NULL;
+		return 0;
+	}
+
+	hdr = (spool_hdr *)seg->map;
+	if (create) {
+		memcpy(hdr->magic, SPOOL_MAGIC, sizeof(hdr->magic));
+		hdr->version = SPOOL_VERSION;
+		hdr->seq = seq;
+		hdr->ctime = (int64_t)time(NULL);
+		hdr->crc = spool_hdrcrc(hdr);
+		hdr->reserved = 0;
+		hdr->rpos = sizeof(spool_hdr);
+	} else if (memcmp(hdr->magic, SPOOL_MAGIC, sizeof(hdr->magic)) != 0 ||
+			hdr->version != SPOOL_VERSION ||
+			hdr->seq != seq ||
+			hdr->crc != spool_hdrcrc(hdr) ||
+			hdr->rpos < sizeof(spool_hdr) ||
+			hdr->rpos > seg->size)
+	{
+		logerr("spool: ignoring invalid segment %s\n", path);
+		munmap(seg->map, seg->size);
+		seg->map = NULL;
+		return 0;
+	}
+
+	return 1;
+}
+
+static void
+spool_unmap(spool_seg *seg)
+{
+	if (seg->map == NULL)
+		return;
+	munmap(seg->map, seg->size);
+	seg->map = NULL;
+}
+
+/**
+ * Returns the length of the record at pos in seg, or 0 when there is
+ * no (intact) record at pos.
+ */
+static size_t
+spool_record(spool_seg *seg, size_t pos)
+{
+	spool_rec rec;
+
+	if (pos + sizeof(rec) > seg->size)
+		return 0;
+	memcpy(&rec, seg->map + pos, sizeof(rec));
+	if (rec.len == 0 || pos + sizeof(rec) + rec.len > seg->size)
+		return 0;
+	if (spool_crc32(seg->map + pos + sizeof(rec), rec.len) != rec.crc)
+		return 0;
+	return rec.len;
+}
+
+/**
+ * Ensures the segment to read from is mapped, skipping over segments
+ * that vanished or turned out to be invalid.  Returns 0 if there is
+ * nothing to read.
+ */
+static char
+spool_rmap(spool *s)
+{
+	while (s->rseg.map == NULL) {
+		if (s->wseg.map == NULL)
+			return 0;
+		if (spool_map(s, &s->rseg, s->rseq, 0))
+			break;
+		if (s->rseq >= s->wseq)
+			return 0;
+		s->rseq++;
+	}
+	return 1;
+}
+
+/**
+ * Opens the spool for name in directory dir, holding at most maxbytes
+ * on disk.  Segments left behind by a previous run are validated and
+ * their unread data is made available for reading again.
+ */
+spool *
+spool_new(const char *dir, const char *name, size_t maxbytes)
+{
+	spool *ret;
+	DIR *d;
+	struct dirent *de;
+	size_t namelen = strlen(name);
+	uint64_t seq;
+	uint64_t minseq = 0;
+	uint64_t maxseq = 0;
+	char *endp;
+	size_t pos;
+	size_t len;
+	spool_seg seg;
+
+	spool_crcinit();
+
+	if ((ret = malloc(sizeof(spool))) == NULL)
+		return NULL;
+	len = strlen(dir) + 1 + namelen + 1;
+	if ((ret->prefix = malloc(len)) == NULL) {
+		free(ret);
+		return NULL;
+	}
+	snprintf(ret->prefix, len, "%s/%s", dir, name);
+	/* use a couple of segments at least, such that draining frees up
+	 * space before the spool is empty */
+	ret->segsize = maxbytes / 8 < SPOOL_SEGMENT_SIZE ?
+		maxbytes / 8 : SPOOL_SEGMENT_SIZE;
+	if (ret->segsize < SPOOL_MIN_SEGMENT)
+		ret->segsize = SPOOL_MIN_SEGMENT;
+	ret->maxsegs = maxbytes / ret->segsize;
+	if (ret->maxsegs < 1)
+		ret->maxsegs = 1;
+	ret->rseq = ret->wseq = 0;
+	ret->rseg.map = ret->wseg.map = NULL;
+	ret->wpos = 0;
+	ret->pending = 0;
+	pthread_mutex_init(&ret->lock, NULL);
+
+	/* find segments from a previous run */
+	if ((d = opendir(dir)) == NULL) {
+		logerr("spool: cannot open directory %s: %s\n", dir, strerror(errno));
+		spool_free(ret);
+		return NULL;
+	}
+	while ((de = readdir(d)) != NULL) {
+		if (strncmp(de->d_name, name, namelen) != 0 ||
+				de->d_name[namelen] != '.')
+			continue;
+		seq = strtoull(de->d_name + namelen + 1, &endp, 10);
+		if (endp == de->d_name + namelen + 1 || strcmp(endp, ".spool") != 0)
+			continue;
+		if (minseq == 0 || seq < minseq)
+			minseq = seq;
+		if (seq > maxseq)
+			maxseq = seq;
+	}
+	closedir(d);
+
+	for (seq = minseq; maxseq > 0 && seq <= maxseq; seq++) {
+		if (!spool_map(ret, &seg, seq, 0))
+			continue;
+		for (pos = ((spool_hdr *)seg.map)->rpos;
+				(len = spool_record(&seg, pos)) > 0;
+				pos += sizeof(spool_rec) + len)
+			ret->pending += len;
+		if (ret->wseg.map == NULL)
+			ret->rseq = seq;
+		spool_unmap(&ret->wseg);
+		ret->wseg = seg;
+		ret->wseq = seq;
+		ret->wpos = pos;
+	}
+	if (ret->pending > 0)
+		logout("spool: resuming %zu bytes from %s\n", ret->pending, ret->prefix);
+
+	return ret;
+}
+
+/**
+ * Appends len bytes from buf to the spool.  Returns 0 when the spool
+ * has reached its size limit, or cannot be written to.
+ */
+char
+spool_write(spool *s, const char *buf, size_t len)
+{
+	spool_rec rec;
+
+	if (len == 0 || sizeof(spool_hdr) + sizeof(rec) + len > s->segsize)
+		return 0;
+
+	pthread_mutex_lock(&s->lock);
+	if (s->wseg.map == NULL || s->wpos + sizeof(rec) + len > s->wseg.size) {
+		if (s->wseg.map != NULL && s->pending == 0) {
+			/* everything was read, start afresh */
+			char path[1024];
+
+			spool_unmap(&s->rseg);
+			spool_unmap(&s->wseg);
+			for (; s->rseq <= s->wseq; s->rseq++) {
+				spool_path(s, s->rseq, path, sizeof(path));
+				unlink(path);
+			}
+		}
+		if (s->wseg.map != NULL) {
+			if (s->wseq - s->rseq + 1 >= s->maxsegs) {
+				pthread_mutex_unlock(&s->lock);
+				return 0;
+			}
+			msync(s->wseg.map, s->wseg.size, MS_ASYNC);
+			spool_unmap(&s->wseg);
+		}
+		if (!spool_map(s, &s->wseg, s->wseq + 1, 1)) {
+			pthread_mutex_unlock(&s->lock);
+			return 0;
+		}
+		s->wseq++;
+		s->wpos = sizeof(spool_hdr);
+		if (s->pending == 0)
+			s->rseq = s->wseq;
+	}
+
+	rec.len = (uint32_t)len;
+	rec.crc = spool_crc32(buf, len);
+	memcpy(s->wseg.map + s->wpos + sizeof(rec), buf, len);
+	memcpy(s->wseg.map + s->wpos, &rec, sizeof(rec));
+	s->wpos += sizeof(rec) + len;
+	s->pending += len;
+	pthread_mutex_unlock(&s->lock);
+
+	return 1;
+}
+
+/**
+ * Reads the oldest record from the spool into buf.  Returns its length,
+ * or 0 when the spool is empty.  Fully read segments are removed.
+ */
+size_t
+spool_read(spool *s, char *buf, size_t bufsize)
+{
+	char path[1024];
+	spool_hdr *hdr;
+	size_t len;
+
+	pthread_mutex_lock(&s->lock);
+	while (s->pending > 0 && spool_rmap(s)) {
+		hdr = (spool_hdr *)s->rseg.map;
+		if ((len = spool_record(&s->rseg, hdr->rpos)) > 0) {
+			hdr->rpos += sizeof(spool_rec) + len;
+			s->pending -= len > s->pending ? s->pending : len;
+			if (len > bufsize)
+				continue;  /* cannot have been written by us */
+			memcpy(buf, s->rseg.map + hdr->rpos - len, len);
+			pthread_mutex_unlock(&s->lock);
+			return len;
+		}
+
+		/* this segment is exhausted */
+		if (s->rseq >= s->wseq) {
+			s->pending = 0;
+			break;
+		}
+		spool_unmap(&s->rseg);
+		spool_path(s, s->rseq, path, sizeof(path));
+		unlink(path);
+		s->rseq++;
+	}
+	pthread_mutex_unlock(&s->lock);
+
+	return 0;
+}
+
+/**
+ * Returns the number of bytes waiting to be read from the spool.
+ */
+inline size_t
+spool_len(spool *s)
+{
+	return __sync_add_and_fetch(&s->pending, 0);
+}
+
+/**
+ * Returns the creation time of the oldest segment holding unread data,
+ * or 0 if the spool is empty.
+ */
+time_t
+spool_age(spool *s)
+{
+	time_t ret = 0;
+
+	pthread_mutex_lock(&s->lock);
+	if (s->pending > 0 && spool_rmap(s))
+		ret = (time_t)((spool_hdr *)s->rseg.map)->ctime;
+	pthread_mutex_unlock(&s->lock);
+
+	return ret;
+}
+
+/**
+ * Closes the spool.  Unread data remains on disk for a next run.
+ */
+void
+spool_free(spool *s)
+{
+	if (s->wseg.map != NULL)
+		msync(s->wseg.map, s->wseg.size, MS_SYNC);
+	spool_unmap(&s->wseg);
+	spool_unmap(&s->rseg);
+	pthread_mutex_destroy(&s->lock);
+	free(s->prefix);
+	free(s);
+}
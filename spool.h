@@ -0,0 +1,33 @@
+/*
+ * Copyright 2013-2025 Fabian Groffen
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SPOOL_H
+#define SPOOL_H 1
+
+#include <stdlib.h>
+#include <time.h>
+
+typedef struct _spool spool;
+
+spool *spool_new(const char *dir, const char *name, size_t maxbytes);
+char spool_write(spool *s, const char *buf, size_t len);
+size_t spool_read(spool *s, char *buf, size_t bufsize);
+size_t spool_len(spool *s);
+time_t spool_age(spool *s);
+void spool_free(spool *s);
+
+#endif
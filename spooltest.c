@@ -0,0 +1,336 @@
+/*
+ * Copyright 2013-2025 Fabian Groffen
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Tests for the on-disk spool.  A writer that dies halfway through
+ * draining must have its reader resume from where it left off, records
+ * that got damaged on disk must not be returned, and the segment and
+ * total size limits must hold. */
+
+#define _GNU_SOURCE  /* memmem */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "relay.h"
+#include "spool.h"
+
+#define KIB  1024
+
+static char dir[] = "/tmp/spooltest.XXXXXX";
+static char verbose = 0;
+
+/* the spool logs when it resumes or skips segments, which is expected
+ * here */
+int
+relaylog(enum logdst dest, const char *fmt, ...)
+{
+	va_list ap;
+	int ret = 0;
+
+	(void)dest;
+	if (verbose) {
+		va_start(ap, fmt);
+		ret = vfprintf(stderr, fmt, ap);
+		va_end(ap);
+	}
+	return ret;
+}
+
+#define fail(args...) { \
+	fprintf(stderr, "%s: ", __func__); \
+	fprintf(stderr, args); \
+	fprintf(stderr, "\n"); \
+	return 1; \
+}
+
+static size_t
+test_record(char *buf, size_t bufsize, size_t i)
+{
+	return (size_t)snprintf(buf, bufsize, "spool.test.%zu %zu 349830001\n",
+			i, i * 3);
+}
+
+/**
+ * Reads records from s, expecting those numbered from up to to.
+ * Returns 0 when they all come back intact and in order.
+ */
+static int
+test_drain(spool *s, size_t from, size_t to)
+{
+	char buf[256];
+	char want[256];
+	size_t len;
+	size_t wlen;
+
+	for (; from < to; from++) {
+		wlen = test_record(want, sizeof(want), from);
+		if ((len = spool_read(s, buf, sizeof(buf))) == 0)
+			fail("record %zu missing", from);
+		if (len != wlen || memcmp(buf, want, len) != 0)
+			fail("record %zu: got %.*s", from, (int)len, buf);
+	}
+	if ((len = spool_read(s, buf, sizeof(buf))) != 0)
+		fail("unexpected record %.*s", (int)len, buf);
+	return 0;
+}
+
+/**
+ * Counts the segment files for name in dir.
+ */
+static size_t
+test_segments(const char *name)
+{
+	DIR *d;
+	struct dirent *de;
+	size_t ret = 0;
+
+	if ((d = opendir(dir)) == NULL)
+		return 0;
+	while ((de = readdir(d)) != NULL)
+		if (strncmp(de->d_name, name, strlen(name)) == 0)
+			ret++;
+	closedir(d);
+	return ret;
+}
+
+/**
+ * A writer is killed after having read part of the spool.  Reopening
+ * it must only return what wasn't read yet.
+ */
+static int
+test_resume(void)
+{
+	spool *s;
+	char buf[256];
+	size_t len;
+	size_t pending = 0;
+	size_t i;
+	pid_t pid;
+	int status;
+
+	if ((pid = fork()) == 0) {
+		if ((s = spool_new(dir, "resume", 1024 * KIB)) == NULL)
+			_exit(1);
+		for (i = 0; i < 100; i++) {
+			len = test_record(buf, sizeof(buf), i);
+			if (!spool_write(s, buf, len))
+				_exit(1);
+		}
+		for (i = 0; i < 40; i++)
+			if (spool_read(s, buf, sizeof(buf)) == 0)
+				_exit(1);
+		/* no spool_free, like a crash */
+		_exit(0);
+	}
+	if (pid < 0 || waitpid(pid, &status, 0) != pid ||
+			!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+		fail("writer failed");
+
+	if ((s = spool_new(dir, "resume", 1024 * KIB)) == NULL)
+		fail("cannot reopen spool");
+	for (i = 40; i < 100; i++)
+		pending += test_record(buf, sizeof(buf), i);
+	if (spool_len(s) != pending)
+		fail("%zu bytes pending, expected %zu", spool_len(s), pending);
+	if (spool_age(s) == 0)
+		fail("no age for a non-empty spool");
+	if (test_drain(s, 40, 100) != 0)
+		return 1;
+	if (spool_len(s) != 0 || spool_age(s) != 0)
+		fail("spool not empty after draining");
+	spool_free(s);
+
+	/* a fully drained spool stays empty */
+	if ((s = spool_new(dir, "resume", 1024 * KIB)) == NULL)
+		fail("cannot reopen spool");
+	if (spool_len(s) != 0)
+		fail("%zu bytes pending after draining", spool_len(s));
+	spool_free(s);
+
+	return 0;
+}
+
+/**
+ * Damages a record on disk.  It, and anything after it, must not be
+ * returned, the records before it must.
+ */
+static int
+test_torn(void)
+{
+	spool *s;
+	char buf[256];
+	char path[1024];
+	char *seg;
+	char *p;
+	struct stat st;
+	FILE *f;
+	size_t len;
+	size_t pending = 0;
+	size_t i;
+
+	if ((s = spool_new(dir, "torn", 1024 * KIB)) == NULL)
+		fail("cannot open spool");
+	for (i = 0; i < 10; i++) {
+		len = test_record(buf, sizeof(buf), i);
+		if (i < 5)
+			pending += len;
+		if (!spool_write(s, buf, len))
+			fail("write %zu failed", i);
+	}
+	spool_free(s);
+
+	/* flip a bit in the sixth record */
+	snprintf(path, sizeof(path), "%s/torn.1.spool", dir);
+	if (stat(path, &st) != 0 || (seg = malloc(st.st_size)) == NULL)
+		fail("cannot load %s", path);
+	if ((f = fopen(path, "r+")) == NULL ||
+			fread(seg, 1, st.st_size, f) != (size_t)st.st_size)
+		fail("cannot read %s", path);
+	len = test_record(buf, sizeof(buf), 5);
+	if ((p = memmem(seg, st.st_size, buf, len)) == NULL)
+		fail("record 5 not found in %s", path);
+	fseek(f, (p - seg) + len / 2, SEEK_SET);
+	fputc(p[len / 2] ^ 0x10, f);
+	fclose(f);
+	free(seg);
+
+	if ((s = spool_new(dir, "torn", 1024 * KIB)) == NULL)
+		fail("cannot reopen spool");
+	if (spool_len(s) != pending)
+		fail("%zu bytes pending, expected %zu", spool_len(s), pending);
+	if (test_drain(s, 0, 5) != 0)
+		return 1;
+	spool_free(s);
+
+	return 0;
+}
+
+/**
+ * Writes until the spool is full, which must be within its size.
+ */
+static int
+test_limits(void)
+{
+	spool *s;
+	char buf[64 * KIB];
+	size_t maxbytes = 512 * KIB;
+	size_t written = 0;
+	size_t len;
+	size_t i;
+
+	if ((s = spool_new(dir, "limits", maxbytes)) == NULL)
+		fail("cannot open spool");
+
+	/* the segments are 64KiB here, a record cannot span them */
+	memset(buf, 'x', sizeof(buf));
+	if (spool_write(s, buf, sizeof(buf)))
+		fail("record larger than a segment accepted");
+
+	for (i = 0; i < 1000; i++) {
+		len = test_record(buf, sizeof(buf), i);
+		memset(buf + len - 1, ' ', 1000 - len);
+		buf[999] = '\n';
+		if (!spool_write(s, buf, 1000))
+			break;
+		written += 1000;
+	}
+	if (i == 1000)
+		fail("spool of %zu bytes took %zu bytes", maxbytes, written);
+	if (written > maxbytes || written < maxbytes / 2)
+		fail("spool of %zu bytes took %zu bytes", maxbytes, written);
+	if (test_segments("limits.") > 8)
+		fail("%zu segments on disk", test_segments("limits."));
+	if (spool_len(s) != written)
+		fail("%zu bytes pending, expected %zu", spool_len(s), written);
+
+	/* draining makes room again */
+	while ((len = spool_read(s, buf, sizeof(buf))) > 0)
+		written -= len;
+	if (written != 0)
+		fail("%zu bytes not read back", written);
+	len = test_record(buf, sizeof(buf), 0);
+	if (!spool_write(s, buf, len))
+		fail("write after draining failed");
+	if (test_drain(s, 0, 1) != 0)
+		return 1;
+	spool_free(s);
+
+	return 0;
+}
+
+static void
+do_usage(char *name, int exitcode)
+{
+	printf("Usage: %s [-v]\n", name);
+	printf("\n");
+	printf("Options:\n");
+	printf("  -v  print what the spool logs\n");
+
+	exit(exitcode);
+}
+
+int
+main(int argc, char *argv[])
+{
+	char path[1024];
+	DIR *d;
+	struct dirent *de;
+	int failed = 0;
+	int ch;
+
+	while ((ch = getopt(argc, argv, ":hv")) != -1) {
+		switch (ch) {
+			case 'v':
+				verbose = 1;
+				break;
+			case 'h':
+				do_usage(argv[0], 0);
+				break;
+			default:
+				do_usage(argv[0], 1);
+				break;
+		}
+	}
+
+	if (mkdtemp(dir) == NULL) {
+		fprintf(stderr, "failed to create %s\n", dir);
+		return 1;
+	}
+
+	failed += test_resume();
+	failed += test_torn();
+	failed += test_limits();
+
+	if ((d = opendir(dir)) != NULL) {
+		while ((de = readdir(d)) != NULL) {
+			snprintf(path, sizeof(path), "%s/%s", dir, de->d_name);
+			if (de->d_name[0] != '.')
+				unlink(path);
+		}
+		closedir(d);
+	}
+	rmdir(dir);
+
+	printf("spool: %d of %d tests failing\n", failed, 3);
+
+	return failed == 0 ? 0 : 1;
+}
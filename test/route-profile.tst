@@ -0,0 +1,37 @@
+sys.web1.cpu 1 349830000
+sys.web1.mem 1 349830000
+sys.web1.load 1 349830000
+sys.web1.disk 1 349830000
+sys.web1.net 1 349830000
+sys.web2.cpu 1 349830000
+sys.web2.mem 1 349830000
+sys.web2.load 1 349830000
+sys.web2.disk 1 349830000
+sys.web2.net 1 349830000
+sys.web3.cpu 1 349830000
+sys.web3.mem 1 349830000
+sys.web3.load 1 349830000
+sys.web3.disk 1 349830000
+sys.web3.net 1 349830000
+sys.db1.cpu 1 349830000
+sys.db1.mem 1 349830000
+sys.db1.load 1 349830000
+sys.db1.disk 1 349830000
+sys.db1.net 1 349830000
+sys.db2.cpu 1 349830000
+sys.db2.mem 1 349830000
+sys.db2.load 1 349830000
+sys.db2.disk 1 349830000
+sys.db2.net 1 349830000
+app.api.hits 2 349830000
+app.api.count 2 349830000
+app.api.errors 2 349830000
+app.auth.hits 2 349830000
+app.auth.count 2 349830000
+app.auth.errors 2 349830000
+app.cart.hits 2 349830000
+app.cart.count 2 349830000
+app.cart.errors 2 349830000
+misc.something 3 349830000
+
+nospace
@@ -23,7 +23,10 @@ POST="cat"
 CNFCLN=( sed -e '/^configuration:/,/^parsed configuration follows:/d'
              -e '/starting carbon-c-relay v/d'
              -e 's/^\[[0-9][0-9\-]* [0-9][0-9:]*\] //'
-             -e 's/_stub_[0-9a-fx][0-9a-fx]*__/_stub_0xc0d3__/')
+             -e 's/_stub_[0-9a-fx][0-9a-fx]*__/_stub_0xc0d3__/'
+             -e 's/ in [0-9.]*s using \([0-9]*\) workers: [0-9]* metrics\/s$/ using \1 workers/'
+             -e 's/, [0-9.]* ns\/try$//'
+             -e '/^ *[0-9.]* ns\/try  /d')
 
 buftest_generate() {
   i=1
@@ -38,6 +41,119 @@ buftest_generate() {
   ln -sf buftest.payload bundletest.payloadout
 }
 
+stage_generate() {
+  i=1
+  end=1000
+  rm -f dual-stage.payload dual-stage.payloadout
+  while [ $i -le $end ]; do
+    echo "stage.foo.bar.${i} 1 349830001" >> dual-stage.payload
+    i=$(($i+1))
+  done
+  ln -sf dual-stage.payload dual-stage.payloadout
+}
+
+spool_generate() {
+  i=1
+  end=500
+  rm -f dual-spool.payload dual-spool.payloadout
+  while [ $i -le $end ]; do
+    echo "spool.foo.bar.${i} 1 349830001" >> dual-spool.payload
+    i=$(($i+1))
+  done
+  ln -sf dual-spool.payload dual-spool.payloadout
+}
+
+budget_generate() {
+  local pad=$(printf '%0400d' 0)
+  i=1
+  end=2500
+  rm -f dual-budget.payload dual-budget.payloadout
+  while [ $i -le $end ]; do
+    echo "budget.${pad}.${i} 1 349830001" >> dual-budget.payload
+    i=$(($i+1))
+  done
+  ln -sf dual-budget.payload dual-budget.payloadout
+}
+
+wakeup_generate() {
+  i=1
+  end=200
+  rm -f dual-wakeup.payload dual-wakeup.payloadout \
+    dual-wakeup-pool.payload dual-wakeup-pool.payloadout
+  while [ $i -le $end ]; do
+    echo "wakeup.foo.bar.${i} ${i} 349830001" >> dual-wakeup.payload
+    i=$(($i+1))
+  done
+  ln -sf dual-wakeup.payload dual-wakeup.payloadout
+  ln -sf dual-wakeup.payload dual-wakeup-pool.payload
+  ln -sf dual-wakeup.payload dual-wakeup-pool.payloadout
+}
+
+lanes_generate() {
+  i=1
+  end=40
+  rm -f dual-lanes.payload dual-lanes.payloadout
+  while [ $i -le $end ]; do
+    m=1
+    while [ $m -le 64 ]; do
+      echo "lanes.foo.bar.${m} ${i} 349830001" >> dual-lanes.payload
+      m=$(($m+1))
+    done
+    i=$(($i+1))
+  done
+  sort -s -k1,1 dual-lanes.payload > dual-lanes.payloadout
+}
+
+steal_generate() {
+  i=1
+  end=1000
+  rm -f dual-steal.payload dual-steal.payloadout
+  while [ $i -le $end ]; do
+    echo "steal.foo.bar.${i} 1 349830001" >> dual-steal.payload
+    i=$(($i+1))
+  done
+  sort dual-steal.payload > dual-steal.payloadout
+}
+
+rate_generate() {
+  i=1
+  end=400
+  rm -f dual-rate.payload dual-rate.payloadout \
+    dual-rate-catchup.payload dual-rate-catchup.payloadout \
+    dual-rate-bytes.payload dual-rate-bytes.payloadout
+  while [ $i -le $end ]; do
+    echo "rate.foo.bar.${i} 1 349830001" >> dual-rate-catchup.payload
+    [ $i -le 300 ] && echo "rate.foo.bar.${i} 1 349830001" >> dual-rate.payload
+    [ $i -le 200 ] && echo "rate.foo.bar.${i} 1 349830001" >> dual-rate-bytes.payload
+    i=$(($i+1))
+  done
+  ln -sf dual-rate.payload dual-rate.payloadout
+  ln -sf dual-rate-catchup.payload dual-rate-catchup.payloadout
+  ln -sf dual-rate-bytes.payload dual-rate-bytes.payloadout
+}
+
+expire_generate() {
+  i=1
+  end=600
+  rm -f dual-expire-pool.payload dual-expire-pool.payloadout
+  while [ $i -le $end ]; do
+    echo "expire.foo.bar.${i} 1 349830001" >> dual-expire-pool.payload
+    i=$(($i+1))
+  done
+  ln -sf dual-expire-pool.payload dual-expire-pool.payloadout
+}
+
+rotate_generate() {
+  i=1
+  end=600
+  rm -f file-rotate.payload file-rotate.payloadout
+  while [ $i -le $end ]; do
+    echo "rotate.foo.bar.${i} ${i} 349830001" >> file-rotate.payload
+    i=$(($i+1))
+  done
+  ln -sf file-rotate.payload file-rotate.payloadout
+}
+
 large_generate() {
   i=1
   end=10000
@@ -82,18 +198,33 @@ dual_large_compress_generate() {
   i=1
   end=10000
   rm -f dual-large-compress.payload dual-large-compress.payloadout
+  rm -f dual-large.payload dual-large.payloadout
+  rm -f dual-writev.payload dual-writev.payloadout
   rm -f dual-large-gzip.payload dual-large-gzip.payloadout
   rm -f dual-large-lz4.payload dual-large-lz4.payloadout
+  rm -f dual-large-zstd.payload dual-large-zstd.payloadout
+  rm -f dual-large-gzip-parallel.payload dual-large-gzip-parallel.payloadout
+  rm -f dual-large-lz4-parallel.payload dual-large-lz4-parallel.payloadout
   echo "foo.bar 1 2" > dual-large-compress.payload
   while [ $i -le $end ]; do
     echo "large.foo.bar.${i} 1 2" >> dual-large-compress.payload
     echo "through-large.foo.bar.${i} 1 2" >> dual-large-compress.payloadout
     i=$(($i+1))
   done
+  ln -sf dual-large-compress.payload dual-large.payload
+  ln -sf dual-large-compress.payloadout dual-large.payloadout
+  ln -sf dual-large-compress.payload dual-writev.payload
+  ln -sf dual-large-compress.payloadout dual-writev.payloadout
   ln -sf dual-large-compress.payload dual-large-gzip.payload
   ln -sf dual-large-compress.payloadout dual-large-gzip.payloadout
   ln -sf dual-large-compress.payload dual-large-lz4.payload
   ln -sf dual-large-compress.payloadout dual-large-lz4.payloadout
+  ln -sf dual-large-compress.payload dual-large-gzip-parallel.payload
+  ln -sf dual-large-compress.payloadout dual-large-gzip-parallel.payloadout
+  ln -sf dual-large-compress.payload dual-large-lz4-parallel.payload
+  ln -sf dual-large-compress.payloadout dual-large-lz4-parallel.payloadout
+  ln -sf dual-large-compress.payload dual-large-zstd.payload
+  ln -sf dual-large-compress.payloadout dual-large-zstd.payloadout
   ln -sf dual-large-compress.payload dual-large-ssl.payload
   ln -sf dual-large-compress.payloadout dual-large-ssl.payloadout
 }
@@ -105,6 +236,7 @@ run_configtest() {
   local tdiff
 
   [[ -e ${conf} ]] || conf="../issues/${conf}"
+  [[ -e ${test}.args ]] && eflags+=" $(< ${test}.args)"
   echo -n "${test}: "
   tdiff=$(cat ${2} \
     | ( ${EXEC} ${eflags} -f "${conf}" ; trigger_bash_segv_print=$?) 2>&1 \
@@ -150,6 +282,8 @@ run_servertest() {
     SMARG="-c lz4"
   elif [ "${transport}" == "snappy" ]; then
     SMARG="-c snappy"
+  elif [ "${transport}" == "zstd" ]; then
+    SMARG="-c zstd"
   elif [ "${transport}" == "ssl" ]; then
     SMARG="-s"
   elif [ "${transport}" == "" ]; then
@@ -183,6 +317,7 @@ run_servertest() {
     local relayargs=
     [[ -e ${test}.args ]] && relayargs=$(< ${test}.args)
     [[ -e ${test}-${id}.args ]] && relayargs=$(< ${test}-${id}.args)
+    relayargs=${relayargs//@tmpdir@/${tmpdir}}
     [[ -e ${ca} ]] && relayargs+=" -C ${ca}"
 
     if [ "${transport}" == "ssl" ] || [ "${transport}" == "mtls" ]; then
@@ -214,15 +349,21 @@ run_servertest() {
         -e "s/@cert@/${cert}/g" \
         -e "s/@mcert@/${mcert}/g" \
         -e "s/@key@/${key}/g" \
+        -e "s|@tmpdir@|${tmpdir}|g" \
         "${confarg}"
     } > "${conf}"
 
-    ${EXEC} -d -w 1 -f "${conf}" -Htest.hostname -s -D \
+    # tests that check the statistics need the collector, which in
+    # debug mode logs them
+    local submission=-s
+    [[ -e ${test}.check ]] && submission=
+
+    ${EXEC} -d -w 1 -f "${conf}" -Htest.hostname ${submission} -D \
       -l "${output}" -P "${pidfile}" ${relayargs}
     if [[ $? != 0 ]] ; then
       # hmmm
       echo "failed to start relay ${id} in ${PWD}:"
-      echo ${EXEC} -d -f "${conf}" -Htest.hostname -s -D -l \
+      echo ${EXEC} -d -f "${conf}" -Htest.hostname ${submission} -D -l \
         "${output}" -P "${pidfile}" ${relayargs}
       echo "=== ${conf} ==="
       cat "${conf}"
@@ -256,6 +397,12 @@ run_servertest() {
       return 0
     fi
   fi
+  if [ "${HAVE_ZSTD}" == "0" ]; then
+    if grep -E '^listen type linemode transport zstd ' ${confarg} >/dev/null; then
+      echo "SKIP"
+      return 0
+    fi
+  fi
   if [ "${HAVE_SSL}" == "0" ]; then
     if grep -E '^listen type linemode transport .* (ssl|mtls) ' ${confarg} >/dev/null; then
       echo "SKIP"
@@ -263,14 +410,24 @@ run_servertest() {
     fi
   fi
 
-  start_server 1 "" ${confarg} "${transport}" || return 1
-  port=${start_server_result[0]}
-  unixsock=${start_server_result[1]}
-  pidfile=${start_server_result[2]}
-  output=${start_server_result[3]}
+  # with a .late file, relay 1 only comes up the given number of
+  # seconds after the payload was sent to relay 2, on the port relay 2
+  # was told to forward to
+  local late=
+  [[ ${mode} == DUAL && -e ${test}.late ]] && late=$(< ${test}.late)
+
+  if [[ -z ${late} ]] ; then
+    start_server 1 "" ${confarg} "${transport}" || return 1
+    port=${start_server_result[0]}
+    unixsock=${start_server_result[1]}
+    pidfile=${start_server_result[2]}
+    output=${start_server_result[3]}
+  else
+    port=$((start_server_lastport + 1))
+  fi
   if [[ ${mode} == DUAL ]] ; then
     if ! start_server 2 ${port} ${confarg2} "" ; then
-      kill -KILL $(< ${pidfile})
+      [[ -n ${pidfile} ]] && kill -KILL $(< ${pidfile})
       return 1
     fi
     port2=${start_server_result[0]}
@@ -281,13 +438,37 @@ run_servertest() {
 
   local smargs=
   [[ -e ${test}.sargs ]] && smargs=$(< ${test}.sargs)
-  ${SMEXEC} ${SMARG} ${smargs} "${unixsock}" < "${payload}"
+  # with a .pause file, the payload is sent in two halves, the given
+  # number of seconds apart
+  local pause=
+  local half=
+  [[ -e ${test}.pause ]] && pause=$(< ${test}.pause)
+  if [[ -n ${pause} ]] ; then
+    half=$(( $(wc -l < "${payload}") / 2 ))
+    head -n ${half} "${payload}" | \
+      ${SMEXEC} ${SMARG} ${smargs} "${unixsock}" && \
+      sleep ${pause} && \
+      tail -n +$((half + 1)) "${payload}" | \
+      ${SMEXEC} ${SMARG} ${smargs} "${unixsock}"
+  else
+    ${SMEXEC} ${SMARG} ${smargs} "${unixsock}" < "${payload}"
+  fi
   if [[ $? != 0 ]] ; then
     # hmmm
     echo "failed to send payload"
     exit 1
     return 1
   fi
+
+  if [[ -n ${late} ]] ; then
+    sleep ${late}
+    if ! start_server 1 "" ${confarg} "${transport}" ; then
+      kill -KILL $(< ${pidfile2})
+      return 1
+    fi
+    pidfile=${start_server_result[2]}
+    output=${start_server_result[3]}
+  fi
   # allow everything to be processed
   sleep 4
 
@@ -310,6 +491,14 @@ run_servertest() {
   [[ -n ${output2} ]] && \
     sed -n 's/^.*(ERR)/relay 2:/p' ${output2} >> "${dataout}"
 
+  # let the test inspect the output and logs, and produce what to
+  # compare against instead
+  if [[ -e ${test}.check ]] ; then
+    ./${test}.check "${dataout}" "${output}" "${output2}" \
+      > "${dataout}.check"
+    mv "${dataout}.check" "${dataout}"
+  fi
+
   # compare some notes
   local ret
   ${DIFF} "${payloadexpect}" "${dataout}" \
@@ -359,6 +548,15 @@ done
 
 echo -n "generating datasets ..."
 buftest_generate
+stage_generate
+spool_generate
+budget_generate
+wakeup_generate
+lanes_generate
+steal_generate
+rate_generate
+expire_generate
+rotate_generate
 large_generate
 large_ssl_generate
 large_compress_generate
@@ -367,6 +565,7 @@ dual_large_compress_generate
 ${EXEC} -v | grep -w gzip >/dev/null && HAVE_GZIP=1 || HAVE_GZIP=0
 ${EXEC} -v | grep -w lz4 >/dev/null && HAVE_LZ4=1 || HAVE_LZ4=0
 ${EXEC} -v | grep -w snappy >/dev/null && HAVE_SNAPPY=1 || HAVE_SNAPPY=0
+${EXEC} -v | grep -w zstd >/dev/null && HAVE_ZSTD=1 || HAVE_ZSTD=0
 ${EXEC} -v | grep -w ssl >/dev/null && HAVE_SSL=1 || HAVE_SSL=0
 
 test x$HAVE_SSL = x1 && sh ./create-self-cert.sh
@@ -417,6 +616,13 @@ for t in $* ; do
         tstfailed="${tstfailed} ${t}.snappy.stst"
       }
     fi
+    if [ -e ${t}.zstd.stst -a "${HAVE_ZSTD}" == "1" ]; then
+      : $((tstcnt++))
+      run_servertest "${t}.zstd.stst" "${t}.payload" "zstd" || {
+        : $((tstfail++))
+        tstfailed="${tstfailed} ${t}.zstd.stst"
+      }
+    fi
     if [ -e ${t}.ssl.stst -a "${HAVE_SSL}" == "1" ]; then
       : $((tstcnt++))
       run_servertest "${t}.ssl.stst" "${t}.payload" "ssl" || {
@@ -437,12 +643,29 @@ done
 rm -f buftest.payload buftest.payloadout \
   parttest.payload parttest.payloadout \
   bundletest.payload bundletest.payloadout \
+  dual-stage.payload dual-stage.payloadout \
+  dual-spool.payload dual-spool.payloadout \
+  dual-budget.payload dual-budget.payloadout \
+  dual-wakeup.payload dual-wakeup.payloadout \
+  dual-wakeup-pool.payload dual-wakeup-pool.payloadout \
+  dual-lanes.payload dual-lanes.payloadout \
+  dual-steal.payload dual-steal.payloadout \
+  dual-rate.payload dual-rate.payloadout \
+  dual-rate-catchup.payload dual-rate-catchup.payloadout \
+  dual-rate-bytes.payload dual-rate-bytes.payloadout \
+  dual-expire-pool.payload dual-expire-pool.payloadout \
+  file-rotate.payload file-rotate.payloadout \
   large.payload large.payloadout large-ssl.payload large-ssl.payloadout \
   large-compress.payload large-compress.payloadout \
   large-gzip.payload large-gzip.payloadout \
   large-lz4.payload large-lz4.payloadout \
+  dual-large.payload dual-large.payloadout \
+  dual-writev.payload dual-writev.payloadout \
   dual-large-gzip.payload dual-large-gzip.payloadout \
   dual-large-lz4.payload dual-large-lz4.payloadout \
+  dual-large-gzip-parallel.payload dual-large-gzip-parallel.payloadout \
+  dual-large-lz4-parallel.payload dual-large-lz4-parallel.payloadout \
+  dual-large-zstd.payload dual-large-zstd.payloadout \
   dual-large-ssl.payload dual-large-ssl.payloadout \
   dual-large-compress.payload dual-large-compress.payloadout
 
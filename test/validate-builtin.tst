@@ -0,0 +1,17 @@
+num.a 42 349830000
+num.b -4.2e-3 349830000
+num.c .5 349830000
+num.d nan 349830000
+num.e 4.2.1 349830000
+num.f 0x10 349830000
+num.g e5 349830000
+fin.a 1e308 349830000
+fin.b 1e309 349830000
+fin.c -inf 349830000
+fin.d 42 -1
+fin.e 42 349830000.5
+recent.a 1 349830000
+recent.b 1 349830100
+recent.c 1 349829900
+blah 1 349830000
+blah 1 now